@@ -0,0 +1,93 @@
+/// \file TaskConfig.h
+/// \brief FreeRTOSタスクの配置コア・優先度・スタックサイズ・周期の一覧
+///
+/// platformio.ini の build_flags で配置を切り替える
+/// - (指定なし)                   センサ系を APP_CPU，DSP・送信・監視を PRO_CPU に分ける
+/// - -D TASK_LAYOUT_APP_CPU_ONLY  全タスクを APP_CPU に置く（従来の配置）
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TASKCONFIG_H
+#define CCBT_KOROGARU_KOEN_PARK_TASKCONFIG_H
+
+#include <Arduino.h>
+
+
+struct TaskConfig {
+    const char *name;       // FreeRTOSのタスク名
+    const char *id;         // OSCアドレスに使う短い名前
+    uint32_t stackSize;
+    UBaseType_t priority;
+    BaseType_t core;
+    TickType_t period;      // 0: イベント駆動
+};
+
+enum class TaskId : size_t {
+    HealthCheck,
+    Imu,
+    Mic,
+    SendImuOsc,
+    SendMicOsc,
+    SendMicBandsOsc,
+    ClockSync,
+    Control,
+    Congestion,
+    Display,
+    MotionEvent,
+    Capture,
+    Count
+};
+
+const size_t numTasks = static_cast<size_t>(TaskId::Count);
+
+const TickType_t healthCheckInterval = pdMS_TO_TICKS(30000);         // 30   s
+const TickType_t imuUpdateInterval = pdMS_TO_TICKS(10);              // 10   ms (100  Hz)
+const TickType_t oscSendInterval_60fps = pdMS_TO_TICKS(16.6);        // 16.6 ms (60   Hz)
+const TickType_t oscSendInterval_30fps = pdMS_TO_TICKS(33.3);        // 33.3 ms (30   Hz)
+const TickType_t oscSendInterval_15fps = pdMS_TO_TICKS(66.6);        // 66.6 ms (15   Hz)
+const TickType_t clockSyncInterval = pdMS_TO_TICKS(1000);            // 1    s
+const TickType_t congestionInterval = pdMS_TO_TICKS(1000);           // 1    s
+const TickType_t displayInterval = pdMS_TO_TICKS(100);               // 100  ms (10   fps)
+const TickType_t captureInterval = pdMS_TO_TICKS(50);                // 50   ms
+
+// TaskId の順に並べる
+#ifdef TASK_LAYOUT_APP_CPU_ONLY
+const TaskConfig taskConfigs[numTasks] = {
+        // name                  id           stack  prio  core         period
+        {"Health Check Task",    "health",    4096,  1,    APP_CPU_NUM, healthCheckInterval},
+        {"IMU Task",             "imu",       4096,  2,    APP_CPU_NUM, imuUpdateInterval},
+        {"MIC Task",             "mic",       3072,  3,    APP_CPU_NUM, 0},
+        {"IMU OSC Task",         "imu_osc",   4096,  2,    APP_CPU_NUM, oscSendInterval_60fps},
+        {"MIC OSC Task",         "mic_osc",   4096,  4,    APP_CPU_NUM, oscSendInterval_30fps},
+        {"MIC Bands OSC Task",   "bands_osc", 4096,  1,    APP_CPU_NUM, oscSendInterval_15fps},
+        {"Clock Sync Task",      "sync",      3072,  2,    APP_CPU_NUM, clockSyncInterval},
+        {"Control Task",         "control",   4096,  2,    APP_CPU_NUM, 0},
+        {"Congestion Task",      "congestion", 3072, 1,    APP_CPU_NUM, congestionInterval},
+        {"Display Task",         "display",   4096,  1,    APP_CPU_NUM, displayInterval},
+        {"Motion Event Task",    "event",     3072,  3,    APP_CPU_NUM, 0},
+        {"Capture Task",         "capture",   6144,  1,    APP_CPU_NUM, captureInterval},
+};
+#else
+// APP_CPU: IMUの取得と送信だけを置き，サンプリング周期を乱さない
+// PRO_CPU: WiFiスタックと同じコアでマイクのDSP・送信・監視を行う
+const TaskConfig taskConfigs[numTasks] = {
+        // name                  id           stack  prio  core         period
+        {"Health Check Task",    "health",    4096,  1,    PRO_CPU_NUM, healthCheckInterval},
+        {"IMU Task",             "imu",       4096,  3,    APP_CPU_NUM, imuUpdateInterval},
+        {"MIC Task",             "mic",       3072,  3,    PRO_CPU_NUM, 0},
+        {"IMU OSC Task",         "imu_osc",   4096,  2,    APP_CPU_NUM, oscSendInterval_60fps},
+        {"MIC OSC Task",         "mic_osc",   4096,  2,    PRO_CPU_NUM, oscSendInterval_30fps},
+        {"MIC Bands OSC Task",   "bands_osc", 4096,  1,    PRO_CPU_NUM, oscSendInterval_15fps},
+        {"Clock Sync Task",      "sync",      3072,  2,    PRO_CPU_NUM, clockSyncInterval},
+        {"Control Task",         "control",   4096,  2,    PRO_CPU_NUM, 0},
+        {"Congestion Task",      "congestion", 3072, 1,    PRO_CPU_NUM, congestionInterval},
+        {"Display Task",         "display",   4096,  1,    PRO_CPU_NUM, displayInterval},
+        {"Motion Event Task",    "event",     3072,  3,    APP_CPU_NUM, 0},
+        {"Capture Task",         "capture",   6144,  1,    PRO_CPU_NUM, captureInterval},
+};
+#endif
+
+inline const TaskConfig &getTaskConfig(TaskId id) {
+    return taskConfigs[static_cast<size_t>(id)];
+}
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TASKCONFIG_H
@@ -0,0 +1,105 @@
+/// \file AudioDSP.cpp
+/// \brief マイク入力のブロック処理に使う整数演算ベースのカーネル
+
+#include <cmath>
+#include <cstring>
+#include "AudioDSP.h"
+
+namespace AudioDSP {
+
+    BlockMoments computeMoments(const int16_t *samples, size_t count) {
+        // 2系統の累算器に分けてループを展開し，積和が詰まって並ぶようにする
+        int64_t sum0 = 0;
+        int64_t sum1 = 0;
+        int64_t squares0 = 0;
+        int64_t squares1 = 0;
+        int16_t minValue = INT16_MAX;
+        int16_t maxValue = INT16_MIN;
+
+        size_t n = 0;
+        for (; n + 1 < count; n += 2) {
+            const int32_t a = samples[n];
+            const int32_t b = samples[n + 1];
+            sum0 += a;
+            sum1 += b;
+            squares0 += a * a;
+            squares1 += b * b;
+            if (a < minValue) minValue = a;
+            if (a > maxValue) maxValue = a;
+            if (b < minValue) minValue = b;
+            if (b > maxValue) maxValue = b;
+        }
+        if (n < count) {
+            const int32_t a = samples[n];
+            sum0 += a;
+            squares0 += a * a;
+            if (a < minValue) minValue = a;
+            if (a > maxValue) maxValue = a;
+        }
+
+        BlockMoments moments;
+        moments.sum = sum0 + sum1;
+        moments.sumSquares = squares0 + squares1;
+        moments.min = minValue;
+        moments.max = maxValue;
+        moments.count = count;
+        return moments;
+    }
+
+    float rmsAround(const BlockMoments &moments, float center) {
+        if (moments.count == 0) {
+            return 0.0f;
+        }
+
+        // center = k + f (k: 整数部) に分け，整数部は桁落ちしないよう整数のまま計算する
+        //   sum((x - k)^2)     = S2 - 2kS1 + nk^2
+        //   sum((x - k - f)^2) = sum((x - k)^2) - 2f * sum(x - k) + nf^2
+        const auto n = static_cast<int64_t>(moments.count);
+        const auto k = static_cast<int64_t>(floorf(center));
+        const float f = center - static_cast<float>(k);
+
+        const int64_t centeredSum = moments.sum - n * k;
+        const int64_t centeredSquares = moments.sumSquares - 2 * k * moments.sum + n * k * k;
+
+        float squares = static_cast<float>(centeredSquares)
+                        - 2.0f * f * static_cast<float>(centeredSum)
+                        + static_cast<float>(n) * f * f;
+        if (squares < 0.0f) {
+            squares = 0.0f;
+        }
+        return sqrtf(squares / static_cast<float>(n));
+    }
+
+    float peakAround(const BlockMoments &moments, float center) {
+        if (moments.count == 0) {
+            return 0.0f;
+        }
+        const float above = moments.max - center;
+        const float below = center - moments.min;
+        return above > below ? above : below;
+    }
+
+    float fastLog2(float x) {
+        // 指数部はそのまま取り出し，仮数部 m ∈ [√0.5, √2) の log2 を級数で近似する
+        //   ln(m) = 2(t + t^3/3 + t^5/5 + ...), t = (m - 1) / (m + 1), |t| < 0.172
+        uint32_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        auto exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127;
+        bits = (bits & 0x007FFFFF) | 0x3F800000;
+        float m;
+        memcpy(&m, &bits, sizeof(m));
+        if (m > 1.41421356f) {
+            m *= 0.5f;
+            exponent++;
+        }
+
+        const float t = (m - 1.0f) / (m + 1.0f);
+        const float t2 = t * t;
+        const float lnM = 2.0f * t * (1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f)));
+        return static_cast<float>(exponent) + lnM * 1.44269504f;  // 1 / ln(2)
+    }
+
+    float fastLog10(float x) {
+        return fastLog2(x) * 0.30102999566f;  // log10(2)
+    }
+}
@@ -0,0 +1,43 @@
+/// \file AudioDSP.h
+/// \brief マイク入力のブロック処理に使う整数演算ベースのカーネル
+///
+/// ESP32の単精度FPUでも軽く動くよう，サンプルの走査は1パスの整数演算だけで行い，
+/// DCオフセットの補正は総和と二乗和から代数的に求める．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_AUDIODSP_H
+#define CCBT_KOROGARU_KOEN_PARK_AUDIODSP_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace AudioDSP {
+
+    /// 1ブロック分の総和・二乗和・最小値・最大値
+    struct BlockMoments {
+        int64_t sum;
+        int64_t sumSquares;
+        int16_t min;
+        int16_t max;
+        size_t count;
+    };
+
+    /// サンプルを1回だけ走査して BlockMoments を求める
+    BlockMoments computeMoments(const int16_t *samples, size_t count);
+
+    /// center を基準にした二乗平均平方根
+    /// sum((x - center)^2) を総和と二乗和から求める
+    float rmsAround(const BlockMoments &moments, float center);
+
+    /// center からの最大偏差
+    float peakAround(const BlockMoments &moments, float center);
+
+    /// log2 の近似 (正規化数 x > 0, 誤差 1e-5 程度)
+    float fastLog2(float x);
+
+    /// log10 の近似 (x > 0)
+    float fastLog10(float x);
+}
+
+#endif //CCBT_KOROGARU_KOEN_PARK_AUDIODSP_H
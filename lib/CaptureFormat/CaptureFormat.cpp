@@ -0,0 +1,254 @@
+/// \file CaptureFormat.cpp
+/// \brief IMUのサンプルとマイクの特徴量をフラッシュに追記していく記録ファイルの形式
+
+#include <cmath>
+#include <cstring>
+#include "CaptureFormat.h"
+
+namespace CaptureFormat {
+
+    namespace {
+        const uint8_t fileMagic[4] = {'K', 'C', 'A', 'P'};
+        const uint8_t blockMagic[2] = {'K', 'B'};
+        const int32_t maxLevel = 1 << 20;  // int16 の振幅の16倍より大きい
+
+        int32_t quantize(float value, float scale) {
+            const float scaled = roundf(value * scale);
+            if (!(scaled > INT16_MIN)) {
+                return INT16_MIN;  // NaN と -inf もここに入る
+            }
+            return scaled < INT16_MAX ? static_cast<int32_t>(scaled) : INT16_MAX;
+        }
+
+        int32_t quantizeLevel(float value) {
+            const float scaled = roundf(value * levelScale);
+            if (!(scaled > 0.0f)) {
+                return 0;
+            }
+            return scaled < maxLevel ? static_cast<int32_t>(scaled) : maxLevel;
+        }
+
+        void write16(uint8_t *p, uint16_t value) {
+            p[0] = value;
+            p[1] = value >> 8;
+        }
+
+        void write32(uint8_t *p, uint32_t value) {
+            p[0] = value;
+            p[1] = value >> 8;
+            p[2] = value >> 16;
+            p[3] = value >> 24;
+        }
+
+        uint16_t read16(const uint8_t *p) {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+
+        uint32_t read32(const uint8_t *p) {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+    }
+
+    void encodeFileHeader(const FileHeader &header, uint8_t *out) {
+        memset(out, 0, fileHeaderSize);
+        memcpy(&out[0], fileMagic, sizeof(fileMagic));
+        write16(&out[4], version);
+        write16(&out[6], fileHeaderSize);
+        out[8] = header.nodeId;
+        memcpy(&out[12], header.clientName.data(), clientNameSize);
+        write32(&out[28], header.startUs);
+    }
+
+    bool decodeFileHeader(const uint8_t *data, size_t size, FileHeader &header) {
+        if (size < fileHeaderSize || memcmp(data, fileMagic, sizeof(fileMagic)) != 0 ||
+            read16(&data[4]) != version || read16(&data[6]) != fileHeaderSize) {
+            return false;
+        }
+        header.nodeId = data[8];
+        header.clientName.fill('\0');
+        memcpy(header.clientName.data(), &data[12], clientNameSize);
+        header.startUs = read32(&data[28]);
+        return true;
+    }
+
+    bool decodeBlockHeader(const uint8_t *data, size_t size, BlockHeader &header) {
+        if (size < blockHeaderSize || memcmp(data, blockMagic, sizeof(blockMagic)) != 0 ||
+            data[2] >= static_cast<uint8_t>(Stream::Count)) {
+            return false;
+        }
+        header.stream = static_cast<Stream>(data[2]);
+        header.payloadSize = read16(&data[4]);
+        header.records = read16(&data[6]);
+        header.sequence = read32(&data[8]);
+        header.dropped = read32(&data[12]);
+        header.crc = read32(&data[16]);
+        return true;
+    }
+
+    void sealBlock(uint8_t *block) {
+        write32(&block[16], crc32(&block[blockHeaderSize], read16(&block[4])));
+    }
+
+    uint32_t crc32(const uint8_t *data, size_t size) {
+        // 4bitずつのテーブル (IEEE 802.3, 0xEDB88320)
+        static const uint32_t table[16] = {
+                0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+                0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+        };
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < size; i++) {
+            crc ^= data[i];
+            crc = (crc >> 4) ^ table[crc & 0x0F];
+            crc = (crc >> 4) ^ table[crc & 0x0F];
+        }
+        return ~crc;
+    }
+
+
+    BlockEncoder::BlockEncoder() = default;
+
+    void BlockEncoder::begin(Stream stream, uint32_t sequence, uint32_t dropped, uint8_t *buffer, size_t capacity) {
+        this->buffer = buffer;
+        this->capacity = capacity;
+        this->stream = stream;
+        this->sequence = sequence;
+        this->dropped = dropped;
+        length = blockHeaderSize;
+        records = 0;
+        previousUs = 0;
+        previous.fill(0);
+    }
+
+    bool BlockEncoder::addImu(const std::array<float, 3> &acc, const std::array<float, 3> &gyro,
+                              uint32_t timestampUs) {
+        if (capacity - length < maxImuRecordSize || records == UINT16_MAX) {
+            return false;
+        }
+        writeUnsigned(timestampUs - previousUs);
+        previousUs = timestampUs;
+        // acc[3], gyro[3] の順 (BlockDecoder と同じ)
+        for (size_t i = 0; i < 3; i++) {
+            const int32_t a = quantize(acc[i], accScale);
+            writeSigned(a - previous[i]);
+            previous[i] = a;
+        }
+        for (size_t i = 0; i < 3; i++) {
+            const int32_t g = quantize(gyro[i], gyroScale);
+            writeSigned(g - previous[3 + i]);
+            previous[3 + i] = g;
+        }
+        records++;
+        return true;
+    }
+
+    bool BlockEncoder::addAudio(float rms, float peak, uint32_t timestampUs) {
+        if (capacity - length < maxAudioRecordSize || records == UINT16_MAX) {
+            return false;
+        }
+        writeUnsigned(timestampUs - previousUs);
+        previousUs = timestampUs;
+        const int32_t r = quantizeLevel(rms);
+        const int32_t p = quantizeLevel(peak);
+        writeSigned(r - previous[0]);
+        writeSigned(p - previous[1]);
+        previous[0] = r;
+        previous[1] = p;
+        records++;
+        return true;
+    }
+
+    size_t BlockEncoder::finish() {
+        memcpy(&buffer[0], blockMagic, sizeof(blockMagic));
+        buffer[2] = static_cast<uint8_t>(stream);
+        buffer[3] = 0;
+        write16(&buffer[4], static_cast<uint16_t>(length - blockHeaderSize));
+        write16(&buffer[6], records);
+        write32(&buffer[8], sequence);
+        write32(&buffer[12], dropped);
+        write32(&buffer[16], 0);
+        return length;
+    }
+
+    uint16_t BlockEncoder::getRecords() const {
+        return records;
+    }
+
+    void BlockEncoder::writeUnsigned(uint32_t value) {
+        while (value >= 0x80) {
+            buffer[length++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        buffer[length++] = static_cast<uint8_t>(value);
+    }
+
+    void BlockEncoder::writeSigned(int32_t value) {
+        // zigzag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+        writeUnsigned((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+    }
+
+
+    BlockDecoder::BlockDecoder(const BlockHeader &header, const uint8_t *payload)
+            : stream(header.stream), data(payload), size(header.payloadSize), remaining(header.records) {}
+
+    bool BlockDecoder::next(Record &record) {
+        if (remaining == 0) {
+            return false;
+        }
+        uint32_t dt = 0;
+        if (!readUnsigned(dt)) {
+            return false;
+        }
+        previousUs += dt;
+        record.stream = stream;
+        record.timestampUs = previousUs;
+
+        const size_t fields = stream == Stream::Imu ? 6 : 2;
+        for (size_t i = 0; i < fields; i++) {
+            int32_t delta = 0;
+            if (!readSigned(delta)) {
+                return false;
+            }
+            previous[i] += delta;
+        }
+        if (stream == Stream::Imu) {
+            for (size_t i = 0; i < 3; i++) {
+                record.acc[i] = previous[i] / accScale;
+                record.gyro[i] = previous[3 + i] / gyroScale;
+            }
+            record.rms = 0.0f;
+            record.peak = 0.0f;
+        } else {
+            record.acc.fill(0.0f);
+            record.gyro.fill(0.0f);
+            record.rms = previous[0] / levelScale;
+            record.peak = previous[1] / levelScale;
+        }
+        remaining--;
+        return true;
+    }
+
+    bool BlockDecoder::readUnsigned(uint32_t &value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 35; shift += 7) {
+            if (position >= size) {
+                return false;
+            }
+            const uint8_t byte = data[position++];
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool BlockDecoder::readSigned(int32_t &value) {
+        uint32_t encoded = 0;
+        if (!readUnsigned(encoded)) {
+            return false;
+        }
+        value = static_cast<int32_t>((encoded >> 1) ^ (~(encoded & 1) + 1));
+        return true;
+    }
+}
@@ -0,0 +1,169 @@
+/// \file CaptureFormat.h
+/// \brief IMUのサンプルとマイクの特徴量をフラッシュに追記していく記録ファイルの形式
+///
+/// ファイルはヘッダ (32バイト) の後にブロックを追記していくだけで，書いたところは書き換えない．
+/// ブロックは1つのストリーム (IMU または MIC) のレコードだけを含み，先頭のレコードは前の値を 0 として
+/// 差分を取るので，ブロックごとに単独で復元できる (電源が切れて末尾が欠けても，それまでのブロックは読める)．
+/// すべてリトルエンディアン．Arduinoに依存しないのでホスト側 (tools/) でもそのまま使える．
+///
+/// ファイルヘッダ
+///  offset size
+///   0     4    magic ("KCAP")
+///   4     2    version
+///   6     2    headerSize (32)
+///   8     1    nodeId
+///   9     3    (予約)
+///  12    16    clientName (NUL で埋める)
+///  28     4    startUs (記録を始めた時刻 micros())
+///
+/// ブロックヘッダ (この後に payloadSize バイトのレコードが続く)
+///  offset size
+///   0     2    magic ("KB")
+///   2     1    stream (0: IMU, 1: MIC)
+///   3     1    (予約)
+///   4     2    payloadSize
+///   6     2    records
+///   8     4    sequence (ストリームごとに記録を始めてから1ずつ増える．ファイルを切り替えても続く)
+///  12     4    dropped  (このブロックの前に，リングが満杯で捨てたレコードの数)
+///  16     4    crc      (payload の CRC-32)
+///
+/// レコード (前のレコードとの差分．符号付きの値は zigzag の後に可変長整数 (LEB128) にする)
+///  IMU: dt [us], acc[3] (1/4096 G), gyro[3] (1/16 deg/s)
+///  MIC: dt [us], rms (1/16), peak (1/16)
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_CAPTUREFORMAT_H
+#define CCBT_KOROGARU_KOEN_PARK_CAPTUREFORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace CaptureFormat {
+
+    const uint16_t version = 1;
+    const size_t fileHeaderSize = 32;
+    const size_t blockHeaderSize = 20;
+    const size_t clientNameSize = 16;
+
+    // 量子化の分解能 (WireFormat と同じ)
+    const float accScale = 4096.0f;     // ±8 G
+    const float gyroScale = 16.0f;      // ±2048 deg/s
+    const float levelScale = 16.0f;     // マイクの RMS・ピーク
+
+    // 1レコードの最大長 (可変長整数は 32bit で最大5バイト)
+    const size_t maxImuRecordSize = 5 + 6 * 3;
+    const size_t maxAudioRecordSize = 5 * 3;
+
+    enum class Stream : uint8_t {
+        Imu,
+        Audio,
+        Count
+    };
+
+    struct FileHeader {
+        uint8_t nodeId;
+        std::array<char, clientNameSize + 1> clientName;
+        uint32_t startUs;
+    };
+
+    struct BlockHeader {
+        Stream stream;
+        uint16_t payloadSize;
+        uint16_t records;
+        uint32_t sequence;
+        uint32_t dropped;
+        uint32_t crc;
+    };
+
+    /// 復元した1レコード
+    struct Record {
+        Stream stream;
+        uint32_t timestampUs;
+        std::array<float, 3> acc;   // IMU
+        std::array<float, 3> gyro;  // IMU
+        float rms;                  // MIC
+        float peak;                 // MIC
+    };
+
+    /// \param out fileHeaderSize バイト以上のバッファ
+    void encodeFileHeader(const FileHeader &header, uint8_t *out);
+
+    /// \return magic・version が一致しない場合 false
+    bool decodeFileHeader(const uint8_t *data, size_t size, FileHeader &header);
+
+    /// \return magic が一致しない・stream が不正な場合 false (crc は確かめない)
+    bool decodeBlockHeader(const uint8_t *data, size_t size, BlockHeader &header);
+
+    /// ブロックヘッダの crc を payload から計算して書き込む
+    /// (CRCの計算は記録するタスクではなく書き出すタスクで行う)
+    void sealBlock(uint8_t *block);
+
+    uint32_t crc32(const uint8_t *data, size_t size);
+
+
+    /// 1ブロック分のレコードを固定長のバッファに詰める
+    /// begin() してから add*() を繰り返し，収まらなくなったら finish() する．
+    class BlockEncoder {
+    public:
+        BlockEncoder();
+
+        /// \param buffer capacity バイトのバッファ (ヘッダを含む)
+        void begin(Stream stream, uint32_t sequence, uint32_t dropped, uint8_t *buffer, size_t capacity);
+
+        /// \return 残りの容量に収まらない場合 false (何も書き込まない)
+        bool addImu(const std::array<float, 3> &acc, const std::array<float, 3> &gyro, uint32_t timestampUs);
+
+        bool addAudio(float rms, float peak, uint32_t timestampUs);
+
+        /// ヘッダを書き込む (crc は sealBlock() で書き込む)
+        /// \return ブロック全体のバイト数
+        size_t finish();
+
+        uint16_t getRecords() const;
+
+    private:
+        uint8_t *buffer = nullptr;
+        size_t capacity = 0;
+        size_t length = 0;
+        Stream stream = Stream::Imu;
+        uint32_t sequence = 0;
+        uint32_t dropped = 0;
+        uint16_t records = 0;
+
+        // 差分の基準 (ブロックの先頭では 0)
+        uint32_t previousUs = 0;
+        std::array<int32_t, 6> previous{};
+
+        void writeUnsigned(uint32_t value);
+
+        void writeSigned(int32_t value);
+    };
+
+
+    /// 1ブロックのレコードを順に復元する
+    class BlockDecoder {
+    public:
+        /// \param payload ブロックヘッダの直後
+        BlockDecoder(const BlockHeader &header, const uint8_t *payload);
+
+        /// \return レコードがもうない・壊れている場合 false
+        bool next(Record &record);
+
+    private:
+        Stream stream;
+        const uint8_t *data;
+        size_t size;
+        size_t position = 0;
+        uint16_t remaining;
+        uint32_t previousUs = 0;
+        std::array<int32_t, 6> previous{};
+
+        bool readUnsigned(uint32_t &value);
+
+        bool readSigned(int32_t &value);
+    };
+}
+
+#endif //CCBT_KOROGARU_KOEN_PARK_CAPTUREFORMAT_H
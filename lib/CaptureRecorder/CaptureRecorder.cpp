@@ -0,0 +1,281 @@
+/// \file CaptureRecorder.cpp
+/// \brief IMUのサンプルとマイクの特徴量を取得したレートのまま LittleFS のファイルに記録するクラス
+
+#include <algorithm>
+#include <cstring>
+#include <LittleFS.h>
+#include "CaptureRecorder.h"
+
+namespace {
+    const char basePath[] = "/capture";
+    const char fileExtension[] = ".kcap";
+}
+
+CaptureRecorder::CaptureRecorder()
+        : recording(false), startRequested(false), stopRequested(false), generation(0), dropped(0) {}
+
+bool CaptureRecorder::setup(const char *partitionLabel, const char *clientName, uint8_t nodeId) {
+    // 初めて使うパーティションはフォーマットする
+    mounted = LittleFS.begin(true, basePath, 2, partitionLabel);
+    if (!mounted) {
+        return false;
+    }
+
+    fileHeader.nodeId = nodeId;
+    fileHeader.clientName.fill('\0');
+    strncpy(fileHeader.clientName.data(), clientName, CaptureFormat::clientNameSize);
+
+    // ファイル名は連番 (000001.kcap, 000002.kcap, ...)．続きの番号から記録する
+    uint32_t minIndex = UINT32_MAX;
+    uint32_t maxIndex = 0;
+    File root = LittleFS.open("/");
+    File entry = root.openNextFile();
+    while (entry) {
+        const char *name = strrchr(entry.name(), '/');
+        name = name != nullptr ? name + 1 : entry.name();
+        char *end = nullptr;
+        const uint32_t index = strtoul(name, &end, 10);
+        if (!entry.isDirectory() && index > 0 && strcmp(end, fileExtension) == 0) {
+            minIndex = std::min(minIndex, index);
+            maxIndex = std::max(maxIndex, index);
+        }
+        entry = root.openNextFile();
+    }
+    fileIndex = maxIndex;
+    oldestIndex = minIndex != UINT32_MAX ? minIndex : 1;
+
+    for (uint8_t i = 0; i < numImuBlocks; i++) {
+        imu.freeBlocks.push(i);
+    }
+    for (uint8_t i = 0; i < numAudioBlocks; i++) {
+        audio.freeBlocks.push(i);
+    }
+    return true;
+}
+
+void CaptureRecorder::requestStart() {
+    startRequested = true;
+}
+
+void CaptureRecorder::requestStop() {
+    stopRequested = true;
+}
+
+bool CaptureRecorder::isRecording() const {
+    return recording;
+}
+
+void CaptureRecorder::recordImu(const std::array<float, 3> &acc, const std::array<float, 3> &gyro,
+                                uint32_t timestampUs) {
+    record(imu, CaptureFormat::Stream::Imu, timestampUs, [&](CaptureFormat::BlockEncoder &encoder) {
+        return encoder.addImu(acc, gyro, timestampUs);
+    });
+}
+
+void CaptureRecorder::recordAudio(float rms, float peak, uint32_t timestampUs) {
+    record(audio, CaptureFormat::Stream::Audio, timestampUs, [&](CaptureFormat::BlockEncoder &encoder) {
+        return encoder.addAudio(rms, peak, timestampUs);
+    });
+}
+
+template<size_t N, typename Add>
+void CaptureRecorder::record(Channel<N> &channel, CaptureFormat::Stream stream, uint32_t timestampUs, Add add) {
+    if (!recording) {
+        // 停止の要求の後は書きかけのブロックを渡して終わる
+        if (channel.holding) {
+            submit(channel);
+        }
+        return;
+    }
+
+    // 前回の記録の書きかけは新しいファイルに混ぜない
+    const uint32_t current = generation;
+    if (channel.generation != current) {
+        channel.generation = current;
+        channel.sequence = 0;
+        channel.dropped = 0;
+        if (channel.current >= 0) {
+            dropped += channel.encoder.getRecords();
+            channel.encoder.begin(stream, channel.sequence++, 0, channel.blocks[channel.current].data(), blockSize);
+            channel.blockStartUs = timestampUs;
+            channel.holding = false;
+        }
+    }
+
+    // 記録の少ないストリームも，電源が切れた時に失う分を maxBlockAgeUs までにする
+    if (channel.holding && timestampUs - channel.blockStartUs >= maxBlockAgeUs) {
+        submit(channel);
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (channel.current < 0) {
+            uint8_t index = 0;
+            if (!channel.freeBlocks.pop(index)) {
+                // 書き出しが追いついていない．待たずに捨てる
+                channel.dropped++;
+                dropped++;
+                return;
+            }
+            channel.current = index;
+            channel.encoder.begin(stream, channel.sequence++, channel.dropped, channel.blocks[index].data(), blockSize);
+            channel.dropped = 0;
+            channel.blockStartUs = timestampUs;
+        }
+        if (add(channel.encoder)) {
+            channel.holding = true;
+            return;
+        }
+        submit(channel);
+    }
+}
+
+template<size_t N>
+void CaptureRecorder::submit(Channel<N> &channel) {
+    if (channel.current < 0) {
+        return;
+    }
+    const size_t size = channel.encoder.finish();
+    channel.filledBlocks.push({static_cast<uint8_t>(channel.current), static_cast<uint16_t>(size)});
+    channel.current = -1;
+    channel.holding = false;
+}
+
+bool CaptureRecorder::service() {
+    if (!mounted) {
+        return false;
+    }
+    const bool wasRecording = recording;
+
+    if (startRequested.exchange(false) && !recording && !stopping) {
+        if (ensureFreeSpace(maxFileBytes * 2) && openFile()) {
+            generation++;
+            recording = true;
+        }
+    }
+    if (stopRequested.exchange(false) && recording) {
+        recording = false;
+        stopping = true;
+        stopStartMs = millis();
+    }
+
+    writeFilled(imu);
+    writeFilled(audio);
+
+    if (fileOpen && recording) {
+        // 大きくなったら次のファイルに切り替える (古いファイルから消せるように)
+        if (fileBytes >= maxFileBytes) {
+            closeFile();
+            if (!ensureFreeSpace(maxFileBytes * 2) || !openFile()) {
+                recording = false;
+            }
+        } else if (millis() - lastSyncMs >= syncIntervalMs) {
+            lastSyncMs = millis();
+            file.flush();
+        }
+    }
+
+    // 記録するタスクが書きかけのブロックを渡し終えるのを待ってから閉じる
+    // (MICを止めている間などは stopTimeoutMs で諦める)
+    if (stopping && ((!imu.holding && !audio.holding) || millis() - stopStartMs >= stopTimeoutMs)) {
+        writeFilled(imu);
+        writeFilled(audio);
+        closeFile();
+        stopping = false;
+    }
+    if (!recording && !stopping && fileOpen) {
+        // 書き込みに失敗して止めた場合
+        closeFile();
+    }
+    return recording != wasRecording;
+}
+
+CaptureRecorder::Stats CaptureRecorder::takeStats() {
+    Stats stats;
+    stats.recording = recording;
+    stats.fileIndex = fileIndex;
+    stats.writtenBytes = writtenBytes;
+    stats.dropped = dropped;
+    stats.writeMaxUs = writeMaxUs;
+    stats.freeBytes = mounted ? getFreeBytes() : 0;
+    writeMaxUs = 0;
+    return stats;
+}
+
+template<size_t N>
+void CaptureRecorder::writeFilled(Channel<N> &channel) {
+    FilledBlock block{};
+    while (channel.filledBlocks.pop(block)) {
+        uint8_t *data = channel.blocks[block.index].data();
+        if (fileOpen) {
+            CaptureFormat::sealBlock(data);
+            const uint32_t startUs = micros();
+            const size_t written = file.write(data, block.size);
+            writeMaxUs = std::max<uint32_t>(writeMaxUs, micros() - startUs);
+            fileBytes += written;
+            writtenBytes += written;
+            if (written != block.size) {
+                // 空きがない．次の service() で閉じる
+                recording = false;
+            }
+        } else {
+            // ファイルを閉じた後に届いたブロック
+            CaptureFormat::BlockHeader header{};
+            if (CaptureFormat::decodeBlockHeader(data, block.size, header)) {
+                dropped += header.records;
+            }
+        }
+        channel.freeBlocks.push(block.index);
+    }
+}
+
+bool CaptureRecorder::openFile() {
+    char path[32];
+    makePath(fileIndex + 1, path, sizeof(path));
+    file = LittleFS.open(path, FILE_WRITE);
+    if (!file) {
+        return false;
+    }
+    fileIndex++;
+
+    uint8_t header[CaptureFormat::fileHeaderSize];
+    fileHeader.startUs = micros();
+    CaptureFormat::encodeFileHeader(fileHeader, header);
+    fileBytes = file.write(header, sizeof(header));
+    writtenBytes += fileBytes;
+    fileOpen = true;
+    lastSyncMs = millis();
+    return true;
+}
+
+void CaptureRecorder::closeFile() {
+    if (!fileOpen) {
+        return;
+    }
+    file.close();
+    fileOpen = false;
+}
+
+bool CaptureRecorder::ensureFreeSpace(uint32_t reserve) {
+    while (getFreeBytes() < reserve) {
+        // 記録中のファイルは消さない
+        if (oldestIndex > fileIndex || (fileOpen && oldestIndex == fileIndex)) {
+            return getFreeBytes() >= blockSize * 4;
+        }
+        char path[32];
+        makePath(oldestIndex++, path, sizeof(path));
+        if (LittleFS.exists(path)) {
+            LittleFS.remove(path);
+        }
+    }
+    return true;
+}
+
+uint32_t CaptureRecorder::getFreeBytes() const {
+    const size_t total = LittleFS.totalBytes();
+    const size_t used = LittleFS.usedBytes();
+    return total > used ? total - used : 0;
+}
+
+void CaptureRecorder::makePath(uint32_t index, char *path, size_t size) {
+    snprintf(path, size, "/%06u%s", static_cast<unsigned>(index), fileExtension);
+}
@@ -0,0 +1,143 @@
+/// \file CaptureRecorder.h
+/// \brief IMUのサンプルとマイクの特徴量を取得したレートのまま LittleFS のファイルに記録するクラス
+///
+/// 記録するタスク (IMU・MIC) は record*() でRAM上のブロックに差分を詰めるだけで，フラッシュには触れない．
+/// 満杯になった (または maxBlockAgeUs 経った) ブロックはリングで書き出しタスクに渡し，
+/// 書き出しタスクが service() で CRC を付けてファイルに追記する．
+/// 空きブロックがなければそのレコードは捨てて数えるだけで，記録するタスクを待たせることはない．
+///
+/// ファイルは maxFileBytes ごとに新しくし，空きが足りなくなったら古いファイルから消す．
+/// 形式は CaptureFormat.h．
+///
+/// recordImu() は1つのタスクから，recordAudio() は別の1つのタスクから，
+/// service() は書き出しタスクからのみ呼ぶ．requestStart() / requestStop() はどのタスクから呼んでもよい．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_CAPTURERECORDER_H
+#define CCBT_KOROGARU_KOEN_PARK_CAPTURERECORDER_H
+
+#include <array>
+#include <atomic>
+#include <Arduino.h>
+#include <FS.h>
+#include "CaptureFormat.h"
+#include "SpscRing.h"
+
+
+class CaptureRecorder {
+public:
+    static const size_t blockSize = 1024;
+    static const size_t numImuBlocks = 8;               // 1 kHz で約0.7秒分
+    static const size_t numAudioBlocks = 2;             // 約5秒分
+    static const uint32_t maxBlockAgeUs = 1000000;      // 満杯でなくてもこれだけ経ったら書き出す
+    static const uint32_t syncIntervalMs = 2000;        // ファイルのメタデータを確定させる間隔
+    static const uint32_t maxFileBytes = 256 * 1024;
+    static const uint32_t stopTimeoutMs = 500;          // 停止時に記録中のブロックを待つ時間
+
+    /// 記録の状態 (dropped・writtenBytes は起動時からの累計)
+    struct Stats {
+        bool recording;
+        uint32_t fileIndex;
+        uint32_t writtenBytes;
+        uint32_t dropped;
+        uint32_t writeMaxUs;   // 前回の takeStats() からの1ブロックの書き込み時間の最大
+        uint32_t freeBytes;
+    };
+
+    CaptureRecorder();
+
+    /// パーティションをマウントし，既存のファイルの番号を調べる
+    /// \return マウントできなかった場合 false (以降の記録は何もしない)
+    bool setup(const char *partitionLabel, const char *clientName, uint8_t nodeId);
+
+    /// 次の service() で新しいファイルを開いて記録を始める
+    void requestStart();
+
+    /// 次の service() から記録を止め，溜まっているブロックを書き出してファイルを閉じる
+    void requestStop();
+
+    bool isRecording() const;
+
+    /// IMUのサンプルを記録する (IMUタスクから)
+    void recordImu(const std::array<float, 3> &acc, const std::array<float, 3> &gyro, uint32_t timestampUs);
+
+    /// マイクの特徴量を記録する (MICタスクから)
+    void recordAudio(float rms, float peak, uint32_t timestampUs);
+
+    /// 書き出し・ファイルの切り替え・開始と停止の要求を処理する (書き出しタスクから周期的に呼ぶ)
+    /// \return 記録中かどうかが変わった場合 true
+    bool service();
+
+    /// 状態を返し，writeMaxUs をリセットする (書き出しタスクから)
+    Stats takeStats();
+
+private:
+    struct FilledBlock {
+        uint8_t index;
+        uint16_t size;
+    };
+
+    template<size_t N>
+    struct Channel {
+        std::array<std::array<uint8_t, blockSize>, N> blocks;
+        SpscRing<uint8_t, N> freeBlocks;        // 書き出しタスク -> 記録するタスク
+        SpscRing<FilledBlock, N> filledBlocks;  // 記録するタスク -> 書き出しタスク
+        std::atomic<bool> holding;              // 記録するタスクが書きかけのブロックを持っている
+
+        // 以下は記録するタスクだけが触る
+        CaptureFormat::BlockEncoder encoder;
+        int current = -1;
+        uint32_t blockStartUs = 0;
+        uint32_t sequence = 0;
+        uint32_t dropped = 0;     // 次のブロックのヘッダに書く
+        uint32_t generation = 0;
+
+        Channel() : blocks(), holding(false) {}
+    };
+
+    bool mounted = false;
+    CaptureFormat::FileHeader fileHeader{};
+
+    std::atomic<bool> recording;
+    std::atomic<bool> startRequested;
+    std::atomic<bool> stopRequested;
+    std::atomic<uint32_t> generation;  // 記録を始めるたびに増やす
+    std::atomic<uint32_t> dropped;
+
+    Channel<numImuBlocks> imu;
+    Channel<numAudioBlocks> audio;
+
+    // 以下は書き出しタスクだけが触る
+    fs::File file;
+    bool fileOpen = false;
+    bool stopping = false;
+    uint32_t stopStartMs = 0;
+    uint32_t lastSyncMs = 0;
+    uint32_t fileIndex = 0;
+    uint32_t oldestIndex = 0;    // 残っている最も古いファイル
+    uint32_t fileBytes = 0;
+    uint32_t writtenBytes = 0;
+    uint32_t writeMaxUs = 0;
+
+    template<size_t N, typename Add>
+    void record(Channel<N> &channel, CaptureFormat::Stream stream, uint32_t timestampUs, Add add);
+
+    template<size_t N>
+    void submit(Channel<N> &channel);
+
+    template<size_t N>
+    void writeFilled(Channel<N> &channel);
+
+    bool openFile();
+
+    void closeFile();
+
+    /// 空きが reserve バイト以上になるまで古いファイルを消す
+    bool ensureFreeSpace(uint32_t reserve);
+
+    uint32_t getFreeBytes() const;
+
+    static void makePath(uint32_t index, char *path, size_t size);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_CAPTURERECORDER_H
@@ -0,0 +1,164 @@
+/// \file ClockSync.cpp
+/// \brief NTP形式の ping/pong からサーバーとの時計のずれ (オフセット) と進み方の差 (ドリフト) を推定するクラス
+
+#include "ClockSync.h"
+
+namespace {
+    // 同期済みとみなすのに必要な往復の回数
+    const size_t minExchanges = 4;
+
+    // ドリフトを求めるのに必要な履歴の時間幅 [us]
+    const uint64_t minDriftSpanUs = 60000000ULL;
+}
+
+ClockSync::ClockSync() = default;
+
+uint64_t ClockSync::beginExchange(uint64_t localUs) {
+    if (pending) {
+        lost++;
+    }
+    pending = true;
+    pendingT1 = localUs;
+    return localUs;
+}
+
+bool ClockSync::completeExchange(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4) {
+    if (!pending || t1 != pendingT1 || t4 < t1 || t3 < t2) {
+        return false;
+    }
+    pending = false;
+
+    // サーバー内の処理時間 (t3 - t2) は往復時間から除く
+    const uint64_t roundTrip = t4 - t1;
+    const uint64_t processing = t3 - t2;
+    const uint32_t rtt = roundTrip > processing ? static_cast<uint32_t>(roundTrip - processing) : 0;
+
+    Sample sample;
+    sample.localUs = t1 + roundTrip / 2;
+    sample.offsetUs = (static_cast<int64_t>(t2 - t1) + static_cast<int64_t>(t3 - t4)) / 2;
+    sample.rttUs = rtt;
+
+    window[windowIndex] = sample;
+    windowIndex = (windowIndex + 1) % windowSize;
+    if (windowCount < windowSize) {
+        windowCount++;
+    }
+
+    exchanges++;
+    latestRtt.publish(Rtt{rtt, ++rttSequence, t4});
+    rttSumUs += rtt;
+    if (rtt < rttMinUs) {
+        rttMinUs = rtt;
+    }
+    if (rtt > rttMaxUs) {
+        rttMaxUs = rtt;
+    }
+
+    // windowSize 回ごとに採用した値を履歴に残す
+    const Sample &best = bestInWindow();
+    if (++exchangesSinceHistory >= windowSize) {
+        exchangesSinceHistory = 0;
+        history[historyIndex] = best;
+        historyIndex = (historyIndex + 1) % historySize;
+        if (historyCount < historySize) {
+            historyCount++;
+        }
+    }
+
+    current.synced = windowCount >= minExchanges;
+    current.referenceUs = best.localUs;
+    current.offsetUs = best.offsetUs;
+    current.driftPpm = estimateDrift();
+    estimate.publish(current);
+    return true;
+}
+
+bool ClockSync::isSynced() const {
+    return estimate.read().synced;
+}
+
+ClockSync::Rtt ClockSync::getLatestRtt() const {
+    return latestRtt.read();
+}
+
+uint64_t ClockSync::toServerTime(uint64_t localUs) const {
+    const Estimate e = estimate.read();
+    if (!e.synced) {
+        return localUs;
+    }
+    // 基準時刻からの経過時間にドリフトをかけて補正する
+    const auto elapsed = static_cast<float>(static_cast<int64_t>(localUs - e.referenceUs));
+    const auto correction = static_cast<int64_t>(elapsed * e.driftPpm * 1e-6f);
+    return localUs + e.offsetUs + correction;
+}
+
+uint64_t ClockSync::extend(uint32_t sampleUs, uint64_t nowUs) {
+    // sampleUs は nowUs 以前（71分以内）の時刻とみなす
+    const auto age = static_cast<uint32_t>(static_cast<uint32_t>(nowUs) - sampleUs);
+    return nowUs - age;
+}
+
+ClockSync::Stats ClockSync::takeStats() {
+    Stats stats;
+    stats.synced = current.synced;
+    stats.offsetUs = current.offsetUs;
+    stats.driftPpm = current.driftPpm;
+    stats.exchanges = exchanges;
+    stats.lost = lost;
+    stats.rttMinUs = exchanges > 0 ? rttMinUs : 0;
+    stats.rttMeanUs = exchanges > 0 ? static_cast<uint32_t>(rttSumUs / exchanges) : 0;
+    stats.rttMaxUs = rttMaxUs;
+
+    exchanges = 0;
+    lost = 0;
+    rttMinUs = UINT32_MAX;
+    rttMaxUs = 0;
+    rttSumUs = 0;
+    return stats;
+}
+
+const ClockSync::Sample &ClockSync::bestInWindow() const {
+    size_t best = 0;
+    for (size_t i = 1; i < windowCount; i++) {
+        if (window[i].rttUs < window[best].rttUs) {
+            best = i;
+        }
+    }
+    return window[best];
+}
+
+float ClockSync::estimateDrift() const {
+    if (historyCount < 2) {
+        return 0.0f;
+    }
+
+    // 履歴のオフセットをローカル時刻に対して最小二乗で直線に当てはめた傾き
+    // 桁落ちを避けるため，最も古い履歴からの差で計算する
+    const Sample &oldest = history[historyCount < historySize ? 0 : historyIndex];
+    double sumX = 0.0;
+    double sumY = 0.0;
+    double sumXX = 0.0;
+    double sumXY = 0.0;
+    uint64_t span = 0;
+    for (size_t i = 0; i < historyCount; i++) {
+        const auto dx = static_cast<double>(static_cast<int64_t>(history[i].localUs - oldest.localUs));
+        const auto dy = static_cast<double>(history[i].offsetUs - oldest.offsetUs);
+        sumX += dx;
+        sumY += dy;
+        sumXX += dx * dx;
+        sumXY += dx * dy;
+        if (history[i].localUs - oldest.localUs > span) {
+            span = history[i].localUs - oldest.localUs;
+        }
+    }
+    if (span < minDriftSpanUs) {
+        return 0.0f;
+    }
+
+    const double n = static_cast<double>(historyCount);
+    const double denominator = n * sumXX - sumX * sumX;
+    if (denominator <= 0.0) {
+        return 0.0f;
+    }
+    return static_cast<float>((n * sumXY - sumX * sumY) / denominator * 1e6);
+}
@@ -0,0 +1,116 @@
+/// \file ClockSync.h
+/// \brief NTP形式の ping/pong からサーバーとの時計のずれ (オフセット) と進み方の差 (ドリフト) を推定するクラス
+///
+/// ノードが t1 (送信時刻) を送り，サーバーが t2 (受信時刻)・t3 (返信時刻) を付けて返し，ノードが t4 (受信時刻) を記録する．
+///   offset = ((t2 - t1) + (t3 - t4)) / 2
+///   rtt    = (t4 - t1) - (t3 - t2)
+/// 直近 windowSize 回のうち往復時間が最小の組を採用し（行きと帰りの遅延の差による誤差が最も小さい），
+/// windowSize 回ごとに採用した値を履歴に残して，その傾きからドリフトを求める．
+///
+/// 推定値は SnapshotBuffer で公開するので，toServerTime() は ping/pong を行うタスク以外からも呼べる．
+/// Arduinoに依存しないのでホスト側でもそのまま使える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_CLOCKSYNC_H
+#define CCBT_KOROGARU_KOEN_PARK_CLOCKSYNC_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "SnapshotBuffer.h"
+
+
+class ClockSync {
+public:
+    static const size_t windowSize = 8;
+    static const size_t historySize = 16;
+
+    /// 前回の takeStats() からの集計
+    struct Stats {
+        bool synced;
+        int64_t offsetUs;       // サーバーの時刻 - ローカル時刻
+        float driftPpm;         // ローカルの時計に対するサーバーの時計の進み [ppm]
+        uint32_t exchanges;     // pong が返ってきた回数
+        uint32_t lost;          // pong が返ってこなかった ping の数
+        uint32_t rttMinUs;
+        uint32_t rttMeanUs;
+        uint32_t rttMaxUs;
+    };
+
+    /// 最後に返ってきた pong の往復時間
+    struct Rtt {
+        uint32_t rttUs;         // 往復時間 [us] (まだなければ 0)
+        uint32_t sequence;      // 何回目の pong か (前回読んだ値と同じなら新しい測定はない)
+        uint64_t receivedUs;    // pong を受け取ったローカル時刻 (t4)
+    };
+
+    ClockSync();
+
+    /// ping を送る直前に呼ぶ（前回の ping の pong が返っていなければ欠落として数える）
+    /// \return ping に載せる t1
+    uint64_t beginExchange(uint64_t localUs);
+
+    /// pong を受け取った時に呼ぶ
+    /// \return 直前の ping に対する pong でなかった場合 false
+    bool completeExchange(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4);
+
+    bool isSynced() const;
+
+    /// 最後に返ってきた pong の往復時間
+    /// takeStats() でリセットされないので，他のタスクから遅延の傾向を見るのに使う．
+    /// pong が途絶えると同じ値が残り続けるので，sequence か receivedUs で新しい測定かを確かめる
+    Rtt getLatestRtt() const;
+
+    /// ローカル時刻をサーバーの時刻に変換する（同期前はそのまま返す）
+    uint64_t toServerTime(uint64_t localUs) const;
+
+    /// 32bit の micros() で記録した時刻を，現在のローカル時刻 (64bit) を基準に展開する
+    static uint64_t extend(uint32_t sampleUs, uint64_t nowUs);
+
+    /// 前回からの集計を返してリセットする
+    Stats takeStats();
+
+private:
+    struct Sample {
+        uint64_t localUs;   // t1 と t4 の中点
+        int64_t offsetUs;
+        uint32_t rttUs;
+    };
+
+    /// toServerTime() が使う推定値
+    struct Estimate {
+        bool synced;
+        uint64_t referenceUs;   // offsetUs を測ったローカル時刻
+        int64_t offsetUs;
+        float driftPpm;
+    };
+
+    std::array<Sample, windowSize> window{};
+    size_t windowCount = 0;
+    size_t windowIndex = 0;
+
+    std::array<Sample, historySize> history{};
+    size_t historyCount = 0;
+    size_t historyIndex = 0;
+    size_t exchangesSinceHistory = 0;
+
+    SnapshotBuffer<Estimate> estimate;
+    Estimate current{};
+
+    bool pending = false;
+    uint64_t pendingT1 = 0;
+
+    uint32_t exchanges = 0;
+    uint32_t lost = 0;
+    uint32_t rttMinUs = UINT32_MAX;
+    uint32_t rttMaxUs = 0;
+    uint64_t rttSumUs = 0;
+    SnapshotBuffer<Rtt> latestRtt;
+    uint32_t rttSequence = 0;
+
+    const Sample &bestInWindow() const;
+
+    float estimateDrift() const;
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_CLOCKSYNC_H
@@ -0,0 +1,107 @@
+/// \file CongestionController.cpp
+/// \brief 送信の失敗・バッファ不足・RSSI・往復時間から送信レートの倍率を決めるクラス (AIMD)
+
+#include <algorithm>
+#include "CongestionController.h"
+
+namespace {
+    // 基準の往復時間を引き上げる速さ (経路が変わって遅くなった場合に追従する)
+    const uint32_t baseRttRise = 64;
+}
+
+CongestionController::Parameters CongestionController::defaultParameters() {
+    Parameters p;
+    p.minScale = 0.125f;
+    p.decrease = 0.5f;
+    p.increase = 0.05f;
+    p.holdUpdates = 3;
+    p.lossThreshold = 0.02f;
+    p.minErrors = 2;
+    p.weakRssi = -80;
+    p.weakRssiScale = 0.5f;
+    p.rttMarginUs = 20000;
+    p.bundleBelow = 0.5f;
+    p.bundleAbove = 0.75f;
+    return p;
+}
+
+CongestionController::CongestionController()
+        : params(defaultParameters()), rateScale(1.0f), bundled(false), backoffs(0) {}
+
+void CongestionController::setup(const Parameters &parameters) {
+    params = parameters;
+    holdRemaining = 0;
+    baseRttUs = 0;
+    rateScale = 1.0f;
+    bundled = false;
+}
+
+uint8_t CongestionController::update(const Sample &sample) {
+    uint8_t signals = 0;
+    if (sample.errors >= params.minErrors &&
+        static_cast<float>(sample.errors) > params.lossThreshold * sample.attempts) {
+        signals |= signalLoss;
+    }
+    if (sample.bufferFull > 0) {
+        signals |= signalBuffer;
+    }
+    if (isRttCongested(sample.rttUs)) {
+        signals |= signalRtt;
+    }
+
+    float scale = rateScale;
+    if (signals != 0) {
+        scale *= params.decrease;
+        holdRemaining = params.holdUpdates;
+        backoffs++;
+    } else if (holdRemaining > 0) {
+        holdRemaining--;
+    } else {
+        scale += params.increase;
+    }
+
+    // 電波が弱い間は混雑していなくても上限を下げておく
+    float ceiling = 1.0f;
+    if (sample.rssi != 0 && sample.rssi < params.weakRssi) {
+        signals |= signalWeakRssi;
+        ceiling = params.weakRssiScale;
+    }
+    scale = std::max(params.minScale, std::min(ceiling, scale));
+    rateScale = scale;
+
+    if (scale <= params.bundleBelow) {
+        bundled = true;
+    } else if (scale >= params.bundleAbove) {
+        bundled = false;
+    }
+    return signals;
+}
+
+float CongestionController::getRateScale() const {
+    return rateScale;
+}
+
+bool CongestionController::isBundled() const {
+    return bundled;
+}
+
+uint32_t CongestionController::getBackoffs() const {
+    return backoffs;
+}
+
+uint32_t CongestionController::getBaseRttUs() const {
+    return baseRttUs;
+}
+
+bool CongestionController::isRttCongested(uint32_t rttUs) {
+    if (rttUs == 0) {
+        return false;
+    }
+    if (baseRttUs == 0 || rttUs < baseRttUs) {
+        baseRttUs = rttUs;
+        return false;
+    }
+    const bool congested = rttUs > 2 * baseRttUs + params.rttMarginUs;
+    baseRttUs += (rttUs - baseRttUs) / baseRttRise;
+    return congested;
+}
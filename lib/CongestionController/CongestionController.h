@@ -0,0 +1,86 @@
+/// \file CongestionController.h
+/// \brief 送信の失敗・バッファ不足・RSSI・往復時間から送信レートの倍率を決めるクラス (AIMD)
+///
+/// 1秒程度ごとに update() で観測値を与える．
+/// - 送信の失敗率がしきい値を超えた・バッファ不足で送れなかった・往復時間が基準の2倍を超えた場合は
+///   混雑とみなし，倍率を半分にする (multiplicative decrease)．その後 holdUpdates 回は増やさない
+/// - 混雑していなければ倍率を少しずつ 1 に戻す (additive increase)
+/// - RSSIが弱い間は倍率の上限を下げる
+/// 倍率が bundleBelow 以下になったらメッセージを Bundle にまとめて送るよう指示する（bundleAbove 以上で戻す）．
+///
+/// update() は1つのタスクから呼ぶ．倍率と Bundle の指示は他のタスクから読んでもよい．
+/// Arduinoに依存しないのでホスト側でもそのまま使える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_CONGESTIONCONTROLLER_H
+#define CCBT_KOROGARU_KOEN_PARK_CONGESTIONCONTROLLER_H
+
+#include <atomic>
+#include <cstdint>
+
+
+class CongestionController {
+public:
+    // 混雑とみなした理由
+    static const uint8_t signalLoss = 0x01;
+    static const uint8_t signalBuffer = 0x02;
+    static const uint8_t signalRtt = 0x04;
+    static const uint8_t signalWeakRssi = 0x08;
+
+    /// update() 1回分の観測値 (前回からの差分)
+    struct Sample {
+        uint32_t attempts;    // 送信しようとしたパケット数
+        uint32_t errors;      // うち失敗した数
+        uint32_t bufferFull;  // うち送信バッファ不足で失敗した数
+        int32_t rssi;         // [dBm] (0 なら不明)
+        uint32_t rttUs;       // 直近の往復時間 (0 なら不明)
+    };
+
+    struct Parameters {
+        float minScale;          // 倍率の下限
+        float decrease;          // 混雑時にかける値
+        float increase;          // 混雑していない時に足す値
+        uint32_t holdUpdates;    // 減らした後に増やさない回数
+        float lossThreshold;     // 失敗率のしきい値
+        uint32_t minErrors;      // 混雑とみなすのに必要な失敗数 (送信数が少ない時の偶然の失敗を除く)
+        int32_t weakRssi;        // これより弱いと上限を weakRssiScale にする [dBm]
+        float weakRssiScale;
+        uint32_t rttMarginUs;    // 基準の往復時間の2倍にこれを足した値を超えたら混雑とみなす
+        float bundleBelow;
+        float bundleAbove;
+    };
+
+    static Parameters defaultParameters();
+
+    CongestionController();
+
+    void setup(const Parameters &parameters);
+
+    /// \return 混雑とみなした理由 (signal* の論理和，なければ 0)
+    uint8_t update(const Sample &sample);
+
+    /// 送信レートの倍率 (minScale - 1)．送信周期はこの逆数倍にする
+    float getRateScale() const;
+
+    /// メッセージを Bundle にまとめて送るべきかどうか
+    bool isBundled() const;
+
+    /// 起動時から倍率を下げた回数
+    uint32_t getBackoffs() const;
+
+    /// 基準の往復時間 (これまでの最小値を少しずつ引き上げたもの)
+    uint32_t getBaseRttUs() const;
+
+private:
+    Parameters params;
+    uint32_t holdRemaining = 0;
+    uint32_t baseRttUs = 0;
+
+    std::atomic<float> rateScale;
+    std::atomic<bool> bundled;
+    std::atomic<uint32_t> backoffs;
+
+    bool isRttCongested(uint32_t rttUs);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_CONGESTIONCONTROLLER_H
@@ -0,0 +1,77 @@
+/// \file DeltaGate.h
+/// \brief 前回送信した値から変化していないフレームを間引くゲート
+///
+/// 各軸ごとのしきい値を超えて変化した場合だけ送信を許可する．
+/// 変化がなくても keyframeIntervalUs ごとに必ず1回は送信させ，受信側が生存確認できるようにする．
+/// 1つの送信タスクからだけ呼ぶこと．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_DELTAGATE_H
+#define CCBT_KOROGARU_KOEN_PARK_DELTAGATE_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+
+/// 送信したフレーム数と間引いたフレーム数の累計
+struct DeltaGateStats {
+    uint32_t sent;
+    uint32_t suppressed;
+};
+
+
+template<size_t N>
+class DeltaGate {
+public:
+    DeltaGate() = default;
+
+    /// \param thresholds_ 軸ごとのしきい値 (これを超えて変化したら送る．0 ならわずかな変化でも送る)
+    /// \param keyframeIntervalUs_ 変化がなくても送信する間隔 [us]
+    void setup(const std::array<float, N> &thresholds_, uint32_t keyframeIntervalUs_) {
+        thresholds = thresholds_;
+        keyframeIntervalUs = keyframeIntervalUs_;
+        enabled = true;
+        hasSent = false;
+    }
+
+    /// 送信すべきかを判定する．true を返した場合はその値を送信したものとして記録する
+    bool pass(const std::array<float, N> &values, uint32_t nowUs) {
+        if (!enabled || !hasSent || nowUs - lastSentUs >= keyframeIntervalUs || changed(values)) {
+            lastSent = values;
+            lastSentUs = nowUs;
+            hasSent = true;
+            sent++;
+            return true;
+        }
+        suppressed++;
+        return false;
+    }
+
+    DeltaGateStats getStats() const {
+        return {sent, suppressed};
+    }
+
+private:
+    std::array<float, N> thresholds{};
+    std::array<float, N> lastSent{};
+    uint32_t keyframeIntervalUs = 0;
+    uint32_t lastSentUs = 0;
+    bool enabled = false;  // setup() されるまではすべて通す
+    bool hasSent = false;
+
+    volatile uint32_t sent = 0;
+    volatile uint32_t suppressed = 0;
+
+    bool changed(const std::array<float, N> &values) const {
+        for (size_t i = 0; i < N; i++) {
+            if (fabsf(values[i] - lastSent[i]) > thresholds[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_DELTAGATE_H
@@ -2,9 +2,26 @@
 // Created by Daiki Miura on 2023/06/24.
 //
 
+#include <algorithm>
+#include <cstring>
 #include "DisplayManager.h"
 
-DisplayManager::DisplayManager() = default;
+namespace {
+    const int labelWidth = 24;
+    const int meterGap = 4;
+    const uint32_t meterBackground = TFT_DARKGREY;
+
+    /// 行の内容のハッシュ (FNV-1a)
+    uint32_t hashBytes(const void *data, size_t size, uint32_t hash = 2166136261u) {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+}
+
+DisplayManager::DisplayManager() : strip(&M5.Display) {}
 
 void DisplayManager::showInitScreen() const {
     M5.Display.setFont(&fonts::Font0);
@@ -50,7 +67,7 @@ void DisplayManager::showWiFiSettingFailedScreen() {
     M5.Display.endWrite();
 }
 
-void DisplayManager::showStatusScreen(const char *ClientName, int oscPort) {
+void DisplayManager::showStatusScreen(const char *ClientName, int oscPort, int batteryLevel, bool charging) {
     M5.Display.startWrite();
     M5.Display.clear(TFT_BLACK);
     M5.Display.setTextColor(WHITE, TFT_BLACK);
@@ -70,11 +87,10 @@ void DisplayManager::showStatusScreen(const char *ClientName, int oscPort) {
     M5.Display.printf("Port: %d (Send to)", oscPort);
     M5.Display.setCursor(0, 36);
     // Battery Level
-    M5.Display.printf("BAT:  %d%%", M5.Power.getBatteryLevel());
+    M5.Display.printf("BAT:  %d%%", batteryLevel);
     M5.Display.setCursor(0, 45);
     // Battery
-    auto isCharging = M5.Power.isCharging();
-    M5.Display.printf("Charging: %s", isCharging ? "Yes" : "No");
+    M5.Display.printf("Charging: %s", charging ? "Yes" : "No");
     M5.Display.setCursor(0, 54);
     M5.Display.endWrite();
 }
@@ -95,4 +111,131 @@ void DisplayManager::showResetConfirmScreen() {
 
 void DisplayManager::println(const char *str) {
     M5.Display.println(str);
-}
\ No newline at end of file
+}
+
+bool DisplayManager::beginDashboard() {
+    if (!dashboardReady) {
+        strip.setColorDepth(16);
+        dashboardReady = strip.createSprite(M5.Display.width(), rowHeight) != nullptr;
+    }
+    invalidate();
+    return dashboardReady;
+}
+
+void DisplayManager::invalidate() {
+    // どの行の内容とも一致しないハッシュにしておく
+    rowKeys.fill(0);
+}
+
+size_t DisplayManager::drawDashboard(const DashboardState &state) {
+    if (!dashboardReady) {
+        return 0;
+    }
+
+    size_t pushed = 0;
+    char text[48];
+    M5.Display.startWrite();
+
+    snprintf(text, sizeof(text), "%s  %u.%u.%u.%u", state.clientName,
+             state.localIp[0], state.localIp[1], state.localIp[2], state.localIp[3]);
+    pushed += drawTextRow(0, text, TFT_WHITE);
+
+    snprintf(text, sizeof(text), "Send %s:%d", state.serverIp, state.serverPort);
+    pushed += drawTextRow(1, text, TFT_WHITE);
+
+    if (state.rssi != 0) {
+        snprintf(text, sizeof(text), "RSSI %d dBm  BAT %d%%%s", static_cast<int>(state.rssi),
+                 static_cast<int>(state.batteryLevel), state.charging ? " CHG" : "");
+    } else {
+        snprintf(text, sizeof(text), "RSSI ---     BAT %d%%%s",
+                 static_cast<int>(state.batteryLevel), state.charging ? " CHG" : "");
+    }
+    pushed += drawTextRow(2, text, state.rssi != 0 && state.rssi < -80 ? TFT_ORANGE : TFT_WHITE);
+
+    pushed += drawMeterRow(3, "ACC", state.acc.data(), state.acc.size(), -2.0f, 2.0f, TFT_CYAN);
+    pushed += drawMeterRow(4, "GYR", state.gyro.data(), state.gyro.size(), -500.0f, 500.0f, TFT_YELLOW);
+    pushed += drawMeterRow(5, "ROT", state.rotation.data(), state.rotation.size(), -180.0f, 180.0f, TFT_GREEN);
+
+    // マイクを止めている間は空のメーターにする
+    const float micDb = state.micEnabled ? state.micDb : 0.0f;
+    pushed += drawMeterRow(6, "MIC", &micDb, 1, 30.0f, 110.0f, TFT_ORANGE);
+
+    snprintf(text, sizeof(text), "IMU %3d Hz  TX %4d/s", static_cast<int>(state.imuHz + 0.5f),
+             static_cast<int>(state.sentPerSecond + 0.5f));
+    pushed += drawTextRow(7, text, TFT_WHITE);
+
+    snprintf(text, sizeof(text), "ERR %u", static_cast<unsigned>(state.sendErrors));
+    pushed += drawTextRow(8, text, state.sendErrors > 0 ? TFT_ORANGE : TFT_WHITE);
+
+    M5.Display.endWrite();
+    return pushed;
+}
+
+bool DisplayManager::drawTextRow(size_t row, const char *text, uint32_t color) {
+    uint32_t key = hashBytes(text, strlen(text));
+    key = hashBytes(&color, sizeof(color), key);
+    if (!beginRow(row, key)) {
+        return false;
+    }
+    strip.setFont(&fonts::Font0);
+    strip.setTextColor(color, TFT_BLACK);
+    strip.setTextDatum(0);  // top_left
+    strip.drawString(text, 0, (rowHeight - 8) / 2);
+    pushRow(row);
+    return true;
+}
+
+bool DisplayManager::drawMeterRow(size_t row, const char *label, const float *values, size_t count,
+                                  float minValue, float maxValue, uint32_t color) {
+    // 値をバーの長さ [px] に量子化し，長さが変わらなければ転送しない
+    const int width = (strip.width() - labelWidth - meterGap * static_cast<int>(count - 1)) / static_cast<int>(count);
+    const bool bipolar = minValue < 0.0f;
+    std::array<int16_t, 3> lengths{};
+    count = std::min(count, lengths.size());
+    for (size_t i = 0; i < count; i++) {
+        const float ratio = (std::max(minValue, std::min(maxValue, values[i])) - minValue) / (maxValue - minValue);
+        lengths[i] = static_cast<int16_t>(ratio * (width - 2) + 0.5f);
+    }
+    uint32_t key = hashBytes(label, strlen(label));
+    key = hashBytes(lengths.data(), sizeof(lengths), key);
+    if (!beginRow(row, key)) {
+        return false;
+    }
+
+    strip.setFont(&fonts::Font0);
+    strip.setTextColor(TFT_WHITE, TFT_BLACK);
+    strip.setTextDatum(0);  // top_left
+    strip.drawString(label, 0, (rowHeight - 8) / 2);
+    for (size_t i = 0; i < count; i++) {
+        const int x = labelWidth + static_cast<int>(i) * (width + meterGap);
+        const int inner = width - 2;
+        strip.drawRect(x, 2, width, rowHeight - 4, meterBackground);
+        if (bipolar) {
+            // 中央から値の側へ伸ばす
+            const int center = inner / 2;
+            const int start = std::min<int>(center, lengths[i]);
+            const int end = std::max<int>(center, lengths[i]);
+            strip.fillRect(x + 1 + start, 3, std::max(1, end - start), rowHeight - 6, color);
+            strip.drawFastVLine(x + 1 + center, 2, rowHeight - 4, TFT_WHITE);
+        } else {
+            strip.fillRect(x + 1, 3, lengths[i], rowHeight - 6, color);
+        }
+    }
+    pushRow(row);
+    return true;
+}
+
+bool DisplayManager::beginRow(size_t row, uint32_t key) {
+    // 0 は invalidate() 用に空けておく
+    key = key != 0 ? key : 1;
+    if (row >= numRows || rowKeys[row] == key) {
+        return false;
+    }
+    rowKeys[row] = key;
+    strip.fillScreen(TFT_BLACK);
+    return true;
+}
+
+void DisplayManager::pushRow(size_t row) {
+    strip.pushSprite(0, static_cast<int32_t>(row) * rowHeight);
+}
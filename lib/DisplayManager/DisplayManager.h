@@ -5,10 +5,31 @@
 #ifndef CCBT_KOROGARU_KOEN_PARK_DISPLAYMANAGER_H
 #define CCBT_KOROGARU_KOEN_PARK_DISPLAYMANAGER_H
 
+#include <array>
 #include "M5Unified.h"
 #include "WiFi.h"
 
 
+/// ライブ表示に使う値 (表示タスクが共有のスナップショットから集める)
+struct DashboardState {
+    const char *clientName;
+    IPAddress localIp;
+    const char *serverIp;
+    int serverPort;
+    int32_t rssi;              // [dBm] (0 なら未接続)
+    int32_t batteryLevel;      // [%]
+    bool charging;
+    std::array<float, 3> acc;
+    std::array<float, 3> gyro;
+    std::array<float, 2> rotation;
+    float micDb;
+    bool micEnabled;
+    float imuHz;               // IMUの更新回数 [Hz]
+    float sentPerSecond;       // 送信したパケット数 [/s]
+    uint32_t sendErrors;       // 起動からの送信失敗数
+};
+
+
 class DisplayManager {
 public:
     uint32_t defaultFontColor = WHITE;
@@ -31,9 +52,39 @@ public:
 
     void showInitScreen() const;
 
-    static void showStatusScreen(const char* oscClientName, int oscPort);
+    /// \param batteryLevel, charging 呼び出し側で読んだ値 (ここでは内部I2Cを読まない)
+    static void showStatusScreen(const char* oscClientName, int oscPort, int batteryLevel, bool charging);
 
     void showBatteryStatus();
+
+    /// ライブ表示用のスプライトを確保する
+    /// \return メモリが足りなかった場合 false
+    bool beginDashboard();
+
+    /// ライブ表示を1フレーム分描き，前回から変わった行だけをLCDに転送する
+    /// \return 転送した行数
+    size_t drawDashboard(const DashboardState &state);
+
+    /// 次の drawDashboard() ですべての行を描き直す (他の画面を表示した後に呼ぶ)
+    void invalidate();
+
+private:
+    // 1行ずつ同じスプライトに描いて転送する (画面全体のスプライトは大きすぎるため)
+    static const int rowHeight = 15;
+    static const size_t numRows = 9;
+
+    M5Canvas strip;
+    bool dashboardReady = false;
+    std::array<uint32_t, numRows> rowKeys{};  // 前回転送した行の内容のハッシュ
+
+    bool drawTextRow(size_t row, const char *text, uint32_t color);
+
+    bool drawMeterRow(size_t row, const char *label, const float *values, size_t count,
+                      float minValue, float maxValue, uint32_t color);
+
+    bool beginRow(size_t row, uint32_t key);
+
+    void pushRow(size_t row);
 };
 
 
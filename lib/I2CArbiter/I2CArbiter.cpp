@@ -0,0 +1,141 @@
+/// \file I2CArbiter.cpp
+/// \brief 内部I2Cバス (MPU6886・AXP192) の使用を1つずつに並べ，IMUの読み出しを優先させるクラス
+
+#include <M5Unified.h>
+#include "I2CArbiter.h"
+
+I2CArbiter::Lock::Lock(I2CArbiter *arbiter, Client client) : arbiter(arbiter), client(client) {
+    if (arbiter != nullptr) {
+        startUs = arbiter->acquire(client);
+    }
+}
+
+I2CArbiter::Lock::~Lock() {
+    if (arbiter != nullptr) {
+        arbiter->release(client, startUs);
+    }
+}
+
+I2CArbiter::I2CArbiter() : imuWaiting(false), imuPeriodUs(0), lastImuUs(0), counters() {}
+
+void I2CArbiter::setup() {
+    if (mutex == nullptr) {
+        mutex = xSemaphoreCreateMutex();
+    }
+    const uint32_t now = micros();
+    for (auto &c: counters) {
+        c.lastTakeUs = now;
+    }
+}
+
+void I2CArbiter::setImuPeriod(uint32_t periodUs) {
+    imuPeriodUs = periodUs;
+}
+
+I2CArbiter::PowerReading I2CArbiter::readPower(uint32_t maxAgeMs) {
+    PowerReading reading = power.read();
+    if (reading.readMs != 0 && millis() - reading.readMs < maxAgeMs) {
+        return reading;
+    }
+
+    Lock lock(this, Client::Power);
+    // 待っている間に他のタスクが読み直していればそれを使う
+    reading = power.read();
+    if (reading.readMs != 0 && millis() - reading.readMs < maxAgeMs) {
+        return reading;
+    }
+    reading.batteryLevel = M5.Power.getBatteryLevel();
+    reading.charging = M5.Power.isCharging();
+    reading.batteryVoltage = M5.Power.getBatteryVoltage();
+    reading.readMs = millis();
+    if (reading.readMs == 0) {
+        reading.readMs = 1;
+    }
+    power.publish(reading);
+    return reading;
+}
+
+I2CArbiter::ClientStats I2CArbiter::takeStats(Client client) {
+    Counters &c = counters[static_cast<size_t>(client)];
+    const uint32_t now = micros();
+    ClientStats stats;
+    stats.transactions = c.transactions.exchange(0);
+    stats.busyUs = c.busyUs.exchange(0);
+    stats.waitMaxUs = c.waitMaxUs.exchange(0);
+    stats.deferred = c.deferred.exchange(0);
+    stats.elapsedUs = now - c.lastTakeUs;
+    c.lastTakeUs = now;
+    return stats;
+}
+
+const char *I2CArbiter::getName(Client client) {
+    switch (client) {
+        case Client::Imu:
+            return "imu";
+        case Client::Power:
+            return "power";
+        case Client::System:
+            return "system";
+        default:
+            return "unknown";
+    }
+}
+
+uint32_t I2CArbiter::acquire(Client client) {
+    if (mutex == nullptr) {
+        return micros();
+    }
+    const uint32_t requestUs = micros();
+    Counters &c = counters[static_cast<size_t>(client)];
+
+    if (client == Client::Imu) {
+        imuWaiting = true;
+    } else {
+        // IMUが待っている間と，次のIMUの読み出しが近い間は譲る (IMUの読み出しの後に入る)
+        bool deferred = false;
+        while ((imuWaiting || isImuDue(micros())) && micros() - requestUs < maxDeferUs) {
+            deferred = true;
+            vTaskDelay(1);
+        }
+        if (deferred) {
+            c.deferred++;
+        }
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    const uint32_t startUs = micros();
+    if (client == Client::Imu) {
+        imuWaiting = false;
+        lastImuUs = startUs;
+    }
+
+    const uint32_t waitUs = startUs - requestUs;
+    if (waitUs > c.waitMaxUs) {
+        c.waitMaxUs = waitUs;
+    }
+    return startUs;
+}
+
+void I2CArbiter::release(Client client, uint32_t startUs) {
+    if (mutex == nullptr) {
+        return;
+    }
+    Counters &c = counters[static_cast<size_t>(client)];
+    c.transactions++;
+    c.busyUs += micros() - startUs;
+    xSemaphoreGive(mutex);
+}
+
+bool I2CArbiter::isImuDue(uint32_t nowUs) const {
+    const uint32_t period = imuPeriodUs;
+    // 周期が短すぎると譲る隙間がないので，IMUが待っている時だけ譲る
+    if (period <= guardUs * 2) {
+        return false;
+    }
+    const uint32_t sinceLast = nowUs - lastImuUs;
+    if (sinceLast >= period) {
+        // 読み出しが遅れている．すぐに来るはずなので譲る
+        return sinceLast < period + guardUs;
+    }
+    return period - sinceLast < guardUs;
+}
@@ -0,0 +1,109 @@
+/// \file I2CArbiter.h
+/// \brief 内部I2Cバス (MPU6886・AXP192) の使用を1つずつに並べ，IMUの読み出しを優先させるクラス
+///
+/// バスを使う処理は Lock のスコープの中で行う．
+/// - IMU以外のクライアントは，IMUが待っている間と次のIMUの読み出しの直前 (guardUs) を避けてから確保する
+///   (最大 maxDeferUs まで譲り，それ以上は待たせない)
+/// - 電池残量などの変化の遅い値は readPower() でキャッシュし，古くなった時だけ読み直す
+/// - クライアントごとにバスを使った時間・確保までの待ち時間の最大を集計する
+///
+/// Lock は他のタスクから同時に使ってよい．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_I2CARBITER_H
+#define CCBT_KOROGARU_KOEN_PARK_I2CARBITER_H
+
+#include <array>
+#include <atomic>
+#include <Arduino.h>
+#include "SnapshotBuffer.h"
+
+
+class I2CArbiter {
+public:
+    enum class Client : size_t {
+        Imu,     // IMUのサンプル読み出しと設定
+        Power,   // 電源管理IC (電池残量・充電状態・電圧)
+        System,  // M5.update() (電源ボタンの読み出し) など
+        Count
+    };
+
+    static const size_t numClients = static_cast<size_t>(Client::Count);
+    static const uint32_t guardUs = 1000;
+    static const uint32_t maxDeferUs = 20000;
+
+    /// 前回の takeStats() からの集計
+    struct ClientStats {
+        uint32_t transactions;  // Lock の回数
+        uint32_t busyUs;        // バスを使っていた時間の合計
+        uint32_t waitMaxUs;     // バスを確保するまでに待った時間の最大
+        uint32_t deferred;      // IMUに譲った回数
+        uint32_t elapsedUs;     // 集計した期間
+    };
+
+    /// 電源管理ICから読んだ値
+    struct PowerReading {
+        int32_t batteryLevel;     // [%]
+        bool charging;
+        int16_t batteryVoltage;   // [mV]
+        uint32_t readMs;          // 読んだ時刻 millis() (0 ならまだ読んでいない)
+    };
+
+    /// バスを確保している間だけ有効なスコープ
+    class Lock {
+    public:
+        /// \param arbiter nullptr なら何もしない (setup() 前や調停しない場合)
+        Lock(I2CArbiter *arbiter, Client client);
+
+        ~Lock();
+
+        Lock(const Lock &) = delete;
+
+        Lock &operator=(const Lock &) = delete;
+
+    private:
+        I2CArbiter *arbiter;
+        Client client;
+        uint32_t startUs = 0;
+    };
+
+    I2CArbiter();
+
+    void setup();
+
+    /// IMUの読み出し周期を伝える (0 なら直前を避けない)
+    void setImuPeriod(uint32_t periodUs);
+
+    /// 電池残量・充電状態・電圧を返す
+    /// \param maxAgeMs これより古ければバスを確保して読み直す
+    PowerReading readPower(uint32_t maxAgeMs);
+
+    /// 前回からの集計を返してリセットする
+    ClientStats takeStats(Client client);
+
+    static const char *getName(Client client);
+
+private:
+    struct Counters {
+        std::atomic<uint32_t> transactions;
+        std::atomic<uint32_t> busyUs;
+        std::atomic<uint32_t> waitMaxUs;
+        std::atomic<uint32_t> deferred;
+        uint32_t lastTakeUs;
+    };
+
+    SemaphoreHandle_t mutex = nullptr;
+    std::atomic<bool> imuWaiting;
+    std::atomic<uint32_t> imuPeriodUs;
+    std::atomic<uint32_t> lastImuUs;
+    std::array<Counters, numClients> counters;
+    SnapshotBuffer<PowerReading> power;
+
+    uint32_t acquire(Client client);
+
+    void release(Client client, uint32_t startUs);
+
+    bool isImuDue(uint32_t nowUs) const;
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_I2CARBITER_H
@@ -3,12 +3,60 @@
 /// \author Daiki Miura
 /// \date 2021/06/21
 
+#include <algorithm>
 #include <array>
 #include "IMUManager.h"
 
+namespace {
+    // MPU6886
+    const uint8_t mpu6886Address = 0x68;
+    const uint32_t i2cFreq = 400000;
+
+    const uint8_t regSmplrtDiv = 0x19;
+    const uint8_t regConfig = 0x1A;
+    const uint8_t regGyroConfig = 0x1B;
+    const uint8_t regAccelConfig = 0x1C;
+    const uint8_t regAccelConfig2 = 0x1D;
+    const uint8_t regAccelWomXThr = 0x20;
+    const uint8_t regAccelWomYThr = 0x21;
+    const uint8_t regAccelWomZThr = 0x22;
+    const uint8_t regFifoEn = 0x23;
+    const uint8_t regIntPinCfg = 0x37;
+    const uint8_t regIntEnable = 0x38;
+    const uint8_t regIntStatus = 0x3A;
+    const uint8_t regAccelXoutH = 0x3B;
+    const uint8_t regAccelIntelCtrl = 0x69;
+    const uint8_t regUserCtrl = 0x6A;
+    const uint8_t regFifoCountH = 0x72;
+    const uint8_t regFifoRW = 0x74;
+
+    const size_t fifoSize = 1024;
+
+    // バースト読み出しの値が M5.Imu と食い違うとみなす差 (何回か読んだ平均どうしを比べる)
+    const int rawReadSamples = 16;
+    const uint32_t rawReadIntervalMs = 2;
+    const float rawReadAccTolerance = 0.1f;   // [G]
+    const float rawReadGyroTolerance = 5.0f;  // [deg/s]
+
+    // 静止とみなす範囲: 角速度の各軸と，加速度の大きさの 1 G からのずれ
+    const float stillGyroThreshold = 3.0f;   // [deg/s]
+    const float stillAccThreshold = 0.05f;   // [G]
+
+    // OrientationFilter のゲイン
+    const float madgwickBeta = 0.1f;
+    const float mahonyKp = 1.0f;
+    const float mahonyKi = 0.0f;
+}
+
 IMUManager::IMUManager() = default;
 
+void IMUManager::setBus(I2CArbiter *arbiter) {
+    bus = arbiter;
+}
+
 void IMUManager::setup() {
+    checkRawRead();
+
     preferences.begin("imu_calibration", true);
     bool calibrated = preferences.getBool("calibrated", false);
 #ifdef DEBUG
@@ -37,6 +85,7 @@ void IMUManager::setup() {
 
 void IMUManager::setup(bool forceCalibration) {
     if (forceCalibration) {
+        checkRawRead();
         calibration();
         saveCalibration();
 
@@ -51,15 +100,199 @@ void IMUManager::setup(bool forceCalibration) {
     applyCalibration();
     kalmanX.setAngle(getRoll());
     kalmanY.setAngle(getPitch());
+    lastMs = sampleUs;
+    publishSnapshot();
+}
+
+bool IMUManager::enableFifo(uint16_t sampleRateHz) {
+    // FIFOのパケットもバースト読み出しと同じ並びなので，そろえられない場合は使わない
+    if (!rawReadEnabled) {
+        return false;
+    }
+    sampleRateHz = std::max<uint16_t>(4, std::min<uint16_t>(1000, sampleRateHz));
+    const uint8_t divider = 1000 / sampleRateHz - 1;
+    fifoPeriodUs = toFifoPeriodUs(sampleRateHz);
+
+    I2CArbiter::Lock lock(bus, I2CArbiter::Client::Imu);
+    // FIFOを止めてリセットしてから設定する
+    M5.In_I2C.writeRegister8(mpu6886Address, regUserCtrl, 0x04, i2cFreq);
+    delay(1);
+
+    // 内部1 kHz (DLPF 176 Hz) を分周して出力レートを決める
+    // FIFOが満杯になったら書き込みを止める (満杯時の扱いは readFifo())
+    M5.In_I2C.writeRegister8(mpu6886Address, regSmplrtDiv, divider, i2cFreq);
+    M5.In_I2C.writeRegister8(mpu6886Address, regConfig, 0x41, i2cFreq);
+    M5.In_I2C.writeRegister8(mpu6886Address, regGyroConfig, 0x18, i2cFreq);
+    M5.In_I2C.writeRegister8(mpu6886Address, regAccelConfig, 0x10, i2cFreq);
+    M5.In_I2C.writeRegister8(mpu6886Address, regAccelConfig2, 0x01, i2cFreq);
+    readFullScale();
+
+    // 加速度と角速度を同じサンプル時刻でFIFOに積む
+    M5.In_I2C.writeRegister8(mpu6886Address, regFifoEn, 0x18, i2cFreq);
+    M5.In_I2C.writeRegister8(mpu6886Address, regUserCtrl, 0x40, i2cFreq);
+
+    acquisitionMode = AcquisitionMode::Fifo;
     lastMs = micros();
+    return true;
+}
+
+uint32_t IMUManager::getMaxFifoReadPeriodUs(uint16_t sampleRateHz) {
+    return maxFifoSamples * toFifoPeriodUs(sampleRateHz);
+}
+
+uint32_t IMUManager::toFifoPeriodUs(uint16_t sampleRateHz) {
+    // 内部 1 kHz を整数で分周するので，実際のレートは指定より高くなることがある
+    sampleRateHz = std::max<uint16_t>(4, std::min<uint16_t>(1000, sampleRateHz));
+    return 1000UL * (1000 / sampleRateHz);
+}
+
+void IMUManager::setWakeOnMotion(bool enable, uint16_t thresholdMg) {
+    I2CArbiter::Lock lock(bus, I2CArbiter::Client::Imu);
+    if (!enable) {
+        M5.In_I2C.writeRegister8(mpu6886Address, regIntEnable, 0x00, i2cFreq);
+        M5.In_I2C.writeRegister8(mpu6886Address, regAccelIntelCtrl, 0x00, i2cFreq);
+        return;
+    }
+
+    const auto threshold = static_cast<uint8_t>(std::min<uint16_t>(255, thresholdMg / 4));
+    M5.In_I2C.writeRegister8(mpu6886Address, regAccelWomXThr, threshold, i2cFreq);
+    M5.In_I2C.writeRegister8(mpu6886Address, regAccelWomYThr, threshold, i2cFreq);
+    M5.In_I2C.writeRegister8(mpu6886Address, regAccelWomZThr, threshold, i2cFreq);
+    // 前のサンプルとの差を比べ，どれか1軸でも超えたら割り込みを出す
+    M5.In_I2C.writeRegister8(mpu6886Address, regAccelIntelCtrl, 0xC0, i2cFreq);
+    // アクティブHIGH・プッシュプル・ステータスを読むまでラッチ
+    M5.In_I2C.writeRegister8(mpu6886Address, regIntPinCfg, 0x30, i2cFreq);
+    M5.In_I2C.readRegister8(mpu6886Address, regIntStatus, i2cFreq);  // 残っている割り込みを消す
+    M5.In_I2C.writeRegister8(mpu6886Address, regIntEnable, 0xE0, i2cFreq);
+}
+
+void IMUManager::clearMotionInterrupt() {
+    I2CArbiter::Lock lock(bus, I2CArbiter::Client::Imu);
+    M5.In_I2C.readRegister8(mpu6886Address, regIntStatus, i2cFreq);
+}
+
+void IMUManager::setMotionDetector(MotionDetector *detector) {
+    if (detector != nullptr) {
+        detector->reset();
+    }
+    motionDetector = detector;
+}
+
+bool IMUManager::popMotionEvent(MotionDetector::Event &event) {
+    return motionEvents.pop(event);
+}
+
+bool IMUManager::hasMotionEvent() const {
+    return motionEvents.size() > 0;
+}
+
+uint32_t IMUManager::getDroppedMotionEvents() const {
+    return motionEvents.getDropped();
+}
+
+void IMUManager::setRecorder(CaptureRecorder *captureRecorder) {
+    recorder = captureRecorder;
+}
+
+void IMUManager::setFusionMode(FusionMode mode) {
+    fusionMode = mode;
+    if (mode == FusionMode::Kalman) {
+        return;
+    }
+
+    if (mode == FusionMode::Madgwick) {
+        orientationFilter.setup(OrientationFilter::Algorithm::Madgwick, madgwickBeta);
+    } else {
+        orientationFilter.setup(OrientationFilter::Algorithm::Mahony, mahonyKp, mahonyKi);
+    }
+    orientationFilter.reset(acc[0], acc[1], acc[2]);
 }
 
 void IMUManager::update() {
+    if (acquisitionMode == AcquisitionMode::Fifo) {
+        updateFromFifo();
+        return;
+    }
+
     readImu();
     applyCalibration();
+    onSample();
+
+    float dt = (sampleUs - lastMs) / 1000000.0f;
+    lastMs = sampleUs;
+    filter(dt);
+
+    publishSnapshot();
+}
+
+void IMUManager::updateFromFifo() {
+    size_t available = 0;
+    const size_t count = readFifo(available);
+    if (count == 0) {
+        return;
+    }
+
+    // 最後に積まれたサンプルを現在時刻とみなし，出力レートから各サンプルの時刻を逆算する
+    const unsigned long now = micros();
+    const float dt = fifoPeriodUs / 1000000.0f;
+    for (size_t i = 0; i < count; i++) {
+        decodePacket(&fifoBuffer[i * fifoPacketSize]);
+        sampleUs = now - (available - 1 - i) * fifoPeriodUs;
+
+        applyCalibration();
+        onSample();
+        filter(dt);
+    }
+    lastMs = sampleUs;
+
+    publishSnapshot();
+}
+
+size_t IMUManager::readFifo(size_t &available) {
+    // 残量の確認と読み出しの間に他のクライアントを挟まない
+    I2CArbiter::Lock lock(bus, I2CArbiter::Client::Imu);
+    uint8_t countBytes[2];
+    if (!M5.In_I2C.readRegister(mpu6886Address, regFifoCountH, countBytes, 2, i2cFreq)) {
+        return 0;
+    }
+
+    const size_t bytes = ((countBytes[0] & 0x1F) << 8) | countBytes[1];
+    if (bytes + fifoPacketSize > fifoSize) {
+        // 1024 バイトは 14 バイトのパケットの倍数ではなく，満杯のFIFOの末尾には
+        // パケットの先頭 2 バイトだけが残る．そのまま読むと以降の境界がすべてずれるので，
+        // 溜まっている分は捨ててリセットし，次のパケットから読み直す
+        fifoOverflowCount++;
+        resetFifo();
+        available = 0;
+        return 0;
+    }
+
+    available = bytes / fifoPacketSize;
+    const size_t count = available < maxFifoSamples ? available : maxFifoSamples;
+    if (count == 0) {
+        return 0;
+    }
+
+    // 1回のバースト読み出しでまとめて取り出す
+    if (!M5.In_I2C.readRegister(mpu6886Address, regFifoRW, fifoBuffer.data(), count * fifoPacketSize, i2cFreq)) {
+        // どこまで読み出されたかわからないので，境界がずれないようリセットする
+        resetFifo();
+        return 0;
+    }
+    return count;
+}
+
+void IMUManager::resetFifo() {
+    // FIFO_EN を立てたまま FIFO_RST を書く (FIFO_RST は自動で 0 に戻る)
+    M5.In_I2C.writeRegister8(mpu6886Address, regUserCtrl, 0x44, i2cFreq);
+}
+
+void IMUManager::filter(float dt) {
+    if (fusionMode != FusionMode::Kalman) {
+        orientationFilter.update(gyro[0], gyro[1], gyro[2], acc[0], acc[1], acc[2], dt);
+        return;
+    }
 
-    float dt = (micros() - lastMs) / 1000000.0f;
-    lastMs = micros();
     float roll = getRoll();
     float pitch = getPitch();
 
@@ -94,19 +327,12 @@ float IMUManager::getPitch() {
     return atan(-acc[0] / sqrt((acc[1] * acc[1]) + (acc[2] * acc[2]))) * RAD_TO_DEG;
 }
 
-std::array<float, 3> IMUManager::getAcc() {
-    return acc;
-}
-
-std::array<float, 3> IMUManager::getGyro() {
-    return gyro;
+IMUSnapshot IMUManager::getSnapshot() const {
+    return snapshot.read();
 }
 
-std::array<float, 2> IMUManager::getRotation() {
-    return {
-            kalAngleX,
-            kalAngleY
-    };
+uint32_t IMUManager::getFifoOverflowCount() const {
+    return fifoOverflowCount;
 }
 
 void IMUManager::calibration() {
@@ -133,10 +359,71 @@ void IMUManager::calibration() {
 }
 
 void IMUManager::readImu() {
+    I2CArbiter::Lock lock(bus, I2CArbiter::Client::Imu);
+    sampleUs = micros();
+
+    // 加速度・温度・角速度の14バイトを1回のバースト読み出しで取り出す
+    // (M5.Imu で加速度と角速度を別々に読むとトランザクションが2回になる)
+    uint8_t packet[fifoPacketSize];
+    if (rawReadEnabled &&
+        M5.In_I2C.readRegister(mpu6886Address, regAccelXoutH, packet, sizeof(packet), i2cFreq)) {
+        decodePacket(packet);
+        return;
+    }
+
+    // MPU6886 以外のIMUや，M5.Imu と向きをそろえられない場合は M5Unified に任せる
     M5.Imu.getGyroData(&gyro[0], &gyro[1], &gyro[2]);
     M5.Imu.getAccelData(&acc[0], &acc[1], &acc[2]);
 }
 
+void IMUManager::decodePacket(const uint8_t *packet) {
+    // FIFOのパケットもデータレジスタも同じ並びで，M5.Imu と同じ向きにそろえる
+    const auto sample = IMUPacket::decode(packet, accRes, gyroRes);
+    acc = sample.acc;
+    gyro = sample.gyro;
+}
+
+void IMUManager::readFullScale() {
+    // ACCEL_FS_SEL / GYRO_FS_SEL (bit 4:3): ±2/4/8/16 G, ±250/500/1000/2000 dps
+    const uint8_t accelConfig = M5.In_I2C.readRegister8(mpu6886Address, regAccelConfig, i2cFreq);
+    const uint8_t gyroConfig = M5.In_I2C.readRegister8(mpu6886Address, regGyroConfig, i2cFreq);
+    accRes = IMUPacket::toAccRes(accelConfig);
+    gyroRes = IMUPacket::toGyroRes(gyroConfig);
+}
+
+void IMUManager::checkRawRead() {
+    {
+        I2CArbiter::Lock lock(bus, I2CArbiter::Client::Imu);
+        readFullScale();
+    }
+    rawReadEnabled = true;
+
+    // 静止した状態で交互に読んだ加速度・角速度の平均を比べ，軸の向きやレンジが M5.Imu と食い違えば使わない
+    IMUPacket::Sample expected{};
+    IMUPacket::Sample raw{};
+    for (int n = 0; n < rawReadSamples; n++) {
+        std::array<float, 3> expectedAcc{};
+        std::array<float, 3> expectedGyro{};
+        {
+            I2CArbiter::Lock lock(bus, I2CArbiter::Client::Imu);
+            M5.Imu.getAccelData(&expectedAcc[0], &expectedAcc[1], &expectedAcc[2]);
+            M5.Imu.getGyroData(&expectedGyro[0], &expectedGyro[1], &expectedGyro[2]);
+        }
+        readImu();
+        for (size_t i = 0; i < 3; i++) {
+            expected.acc[i] += expectedAcc[i] / rawReadSamples;
+            expected.gyro[i] += expectedGyro[i] / rawReadSamples;
+            raw.acc[i] += acc[i] / rawReadSamples;
+            raw.gyro[i] += gyro[i] / rawReadSamples;
+        }
+        delay(rawReadIntervalMs);
+    }
+    rawReadEnabled = IMUPacket::agrees(raw, expected, rawReadAccTolerance, rawReadGyroTolerance);
+    if (!rawReadEnabled) {
+        Serial.println("IMU: burst read disagrees with M5.Imu, falling back to M5.Imu");
+    }
+}
+
 void IMUManager::applyCalibration() {
     gyro[0] -= gyroOffset[0];
     gyro[1] -= gyroOffset[1];
@@ -160,5 +447,50 @@ void IMUManager::saveCalibration() {
     preferences.end();
 }
 
+void IMUManager::updateStillness() {
+    const float accNorm = sqrtf(acc[0] * acc[0] + acc[1] * acc[1] + acc[2] * acc[2]);
+    const bool still = fabsf(gyro[0]) < stillGyroThreshold
+                       && fabsf(gyro[1]) < stillGyroThreshold
+                       && fabsf(gyro[2]) < stillGyroThreshold
+                       && fabsf(accNorm - 1.0f) < stillAccThreshold;
+
+    // micros() の折り返しをまたいでも続くように経過時間を積み上げる
+    const unsigned long elapsed = sampleUs - stillCheckedUs;
+    stillCheckedUs = sampleUs;
+    stillUs = still ? stillUs + elapsed : 0;
+}
+
+void IMUManager::onSample() {
+    if (recorder != nullptr) {
+        recorder->recordImu(acc, gyro, sampleUs);
+    }
+    if (motionDetector == nullptr) {
+        return;
+    }
+    std::array<MotionDetector::Event, MotionDetector::maxEventsPerSample> events{};
+    const size_t count = motionDetector->update(acc, gyro, sampleUs, events.data());
+    for (size_t i = 0; i < count; i++) {
+        motionEvents.push(events[i]);
+    }
+}
 
+void IMUManager::publishSnapshot() {
+    updateStillness();
 
+    IMUSnapshot s;
+    s.acc = acc;
+    s.gyro = gyro;
+    if (fusionMode == FusionMode::Kalman) {
+        s.rotation = {kalAngleX, kalAngleY};
+    } else {
+        // 三角関数を使う変換は公開時に1回だけ行う
+        s.quaternion = orientationFilter.getQuaternion();
+        s.euler = orientationFilter.getEuler();
+        s.linearAcc = orientationFilter.getLinearAcceleration(acc[0], acc[1], acc[2]);
+        s.rotation = {s.euler[0], s.euler[1]};
+    }
+    s.timestampUs = sampleUs;
+    s.sequence = ++sequence;
+    s.stillMs = static_cast<uint32_t>(std::min<uint64_t>(stillUs / 1000, UINT32_MAX));
+    snapshot.publish(s);
+}
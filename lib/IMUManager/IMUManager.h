@@ -10,31 +10,113 @@
 #include <array>
 #include <Preferences.h>
 #include <M5Unified.h>
+#include "CaptureRecorder.h"
+#include "I2CArbiter.h"
+#include "IMUPacket.h"
 #include "Kalman.h"
+#include "MotionDetector.h"
+#include "OrientationFilter.h"
+#include "SnapshotBuffer.h"
+#include "SpscRing.h"
+
+
+/// update() 1回分の計測結果
+struct IMUSnapshot {
+    std::array<float, 3> acc{};
+    std::array<float, 3> gyro{};
+    std::array<float, 2> rotation{};
+    std::array<float, 4> quaternion{1.0f, 0.0f, 0.0f, 0.0f};  // w, x, y, z (Kalman では単位クォータニオンのまま)
+    std::array<float, 3> euler{};      // roll, pitch, yaw [deg] (Kalman では計算しない)
+    std::array<float, 3> linearAcc{};  // 重力を除いた加速度 [G] (Kalman では計算しない)
+    uint32_t timestampUs = 0;  // サンプル取得時刻 micros()
+    uint32_t sequence = 0;     // update() ごとに1ずつ増える
+    uint32_t stillMs = 0;      // 静止が続いている時間 [ms] (動いていれば 0)
+};
 
 
 class IMUManager {
 public:
+    /// 取得方法
+    /// Polling: update() ごとに加速度・角速度を個別に読み出す
+    /// Fifo:    IMUのFIFOに一定周期で溜めたサンプルをまとめて読み出す
+    enum class AcquisitionMode {
+        Polling,
+        Fifo
+    };
+
+    /// 姿勢推定の方法
+    /// Kalman:   ロール・ピッチを独立した1次元カルマンフィルタで推定する（従来どおり）
+    /// Madgwick: クォータニオンで3軸の姿勢を推定する (OrientationFilter)
+    /// Mahony:   同上
+    enum class FusionMode {
+        Kalman,
+        Madgwick,
+        Mahony
+    };
+
     IMUManager();
 
+    /// 内部I2Cの調停役を設定する (setup() より前に呼ぶ．設定しなければ調停しない)
+    void setBus(I2CArbiter *arbiter);
+
     void setup();
 
     void setup(bool forceCalibration);
 
+    /// FIFOによる取得に切り替える (setup() の後に呼ぶ)
+    /// \param sampleRateHz IMUの出力レート (4 - 1000 Hz)
+    /// \return バースト読み出しの値を M5.Imu とそろえられず，切り替えなかった場合 false
+    bool enableFifo(uint16_t sampleRateHz);
+
+    /// FIFOが溢れないIMUの読み出し周期の上限 [us]
+    /// (1回の update() で読み出す maxFifoSamples 個が溜まるまでの時間．FIFOには 73 個まで入る)
+    static uint32_t getMaxFifoReadPeriodUs(uint16_t sampleRateHz);
+
+    /// 姿勢推定の方法を切り替える (setup() の後に呼ぶ)
+    /// Kalman 以外では rotation にクォータニオンから求めたロール・ピッチが入る
+    void setFusionMode(FusionMode mode);
+
     void update();
 
     void draw();
 
+    /// IMUの Wake-on-Motion 割り込みを設定する
+    /// 有効にすると，前のサンプルからの加速度の変化がしきい値を超えた時にINTピンがHIGHになる
+    /// (clearMotionInterrupt() で読み出すまで保持される)
+    /// \param thresholdMg しきい値 [mG] (4 mG 刻み)
+    void setWakeOnMotion(bool enable, uint16_t thresholdMg);
+
+    /// 割り込みステータスを読み出してINTピンを戻す
+    void clearMotionInterrupt();
+
+    /// サンプルごとに動きのイベントを検出する (setup() の後に呼ぶ．nullptr で止める)
+    /// FIFOによる取得では，まとめて読み出したサンプルの1つずつに対して検出する
+    void setMotionDetector(MotionDetector *detector);
+
+    /// 検出したイベントを古い順に1つ取り出す（1つのタスクからのみ呼ぶ）
+    /// \return なければ false
+    bool popMotionEvent(MotionDetector::Event &event);
 
-    std::array<float, 3> getAcc();
+    bool hasMotionEvent() const;
 
-    std::array<float, 3> getGyro();
+    /// 取り出されずに溢れて捨てたイベントの累計
+    uint32_t getDroppedMotionEvents() const;
 
-    std::array<float, 2> getRotation();
+    /// 校正済みのサンプルを取得したレートのまま記録する (setup() の後に呼ぶ．nullptr で止める)
+    void setRecorder(CaptureRecorder *captureRecorder);
+
+
+    /// 最新の計測結果を返す
+    /// 他のタスクから呼んでもupdate()をブロックしない
+    IMUSnapshot getSnapshot() const;
+
+    /// FIFOが満杯になりサンプルを取りこぼした回数 (満杯になるとFIFOを空にして読み直す)
+    uint32_t getFifoOverflowCount() const;
 
 
 private:
     Preferences preferences;
+    I2CArbiter *bus = nullptr;
     std::array<float, 3> acc{};
     std::array<float, 3> accOffset{};
     std::array<float, 3> gyro{};
@@ -49,19 +131,74 @@ private:
 
     Kalman kalmanX;
     Kalman kalmanY;
+    FusionMode fusionMode = FusionMode::Kalman;
+    OrientationFilter orientationFilter;
     unsigned long lastMs = 0;
     unsigned long tick = 0;
+    unsigned long sampleUs = 0;
+    uint32_t sequence = 0;
+
+    // 静止判定
+    unsigned long stillCheckedUs = 0;
+    uint64_t stillUs = 0;
+
+    SnapshotBuffer<IMUSnapshot> snapshot;
+
+    // 動きのイベント
+    MotionDetector *motionDetector = nullptr;
+    SpscRing<MotionDetector::Event, 16> motionEvents;
+
+    CaptureRecorder *recorder = nullptr;
+
+    // FIFO
+    static const size_t fifoPacketSize = IMUPacket::packetSize;   // acc(6) + temp(2) + gyro(6)
+    static const size_t maxFifoSamples = 64;
+    AcquisitionMode acquisitionMode = AcquisitionMode::Polling;
+    unsigned long fifoPeriodUs = 0;
+    uint32_t fifoOverflowCount = 0;
+    std::array<uint8_t, fifoPacketSize * maxFifoSamples> fifoBuffer{};
 
     void calibration();
 
     void readImu();
 
+    void decodePacket(const uint8_t *packet);
+
+    // バースト読み出し・FIFOの値の換算 [G/LSB], [dps/LSB] (readFullScale() でレジスタから読む)
+    float accRes = 8.0f / 32768.0f;
+    float gyroRes = 2000.0f / 32768.0f;
+    bool rawReadEnabled = true;
+
+    /// 加速度・角速度のレンジをレジスタから読む (呼び出し側で I2CArbiter のロックを取っておく)
+    void readFullScale();
+
+    /// バースト読み出しの値が M5.Imu と一致するか確かめる (setup() の最初に呼ぶ)
+    void checkRawRead();
+
+    size_t readFifo(size_t &available);
+
+    static uint32_t toFifoPeriodUs(uint16_t sampleRateHz);
+
+    /// FIFOの中身を捨てて空にする (呼び出し側で I2CArbiter のロックを取っておく)
+    void resetFifo();
+
+    void updateFromFifo();
+
+    void filter(float dt);
+
     void applyCalibration();
 
     void loadCalibration();
 
     void saveCalibration();
 
+    void updateStillness();
+
+    /// サンプル1つごとの処理 (動きの検出と記録)
+    void onSample();
+
+    void publishSnapshot();
+
 };
 
 #endif //CCBT_KOROGARU_KOEN_PARK_IMUMANAGER_H
@@ -0,0 +1,42 @@
+/// \file IMUPacket.cpp
+/// \brief MPU6886 の加速度・温度・角速度14バイトを M5.Imu と同じ向き・単位の値に直す
+
+#include <cmath>
+#include "IMUPacket.h"
+
+namespace IMUPacket {
+
+    namespace {
+        int16_t toInt16(const uint8_t *p) {
+            return static_cast<int16_t>((p[0] << 8) | p[1]);
+        }
+    }
+
+    float toAccRes(uint8_t accelConfig) {
+        return 2.0f * (1 << ((accelConfig >> 3) & 0x03)) / 32768.0f;
+    }
+
+    float toGyroRes(uint8_t gyroConfig) {
+        return 250.0f * (1 << ((gyroConfig >> 3) & 0x03)) / 32768.0f;
+    }
+
+    Sample decode(const uint8_t *packet, float accRes, float gyroRes) {
+        Sample sample{};
+        for (size_t i = 0; i < 3; i++) {
+            sample.acc[i] = axisSign[i] * toInt16(&packet[i * 2]) * accRes;
+            sample.gyro[i] = axisSign[i] * toInt16(&packet[8 + i * 2]) * gyroRes;
+        }
+        return sample;
+    }
+
+    bool agrees(const Sample &a, const Sample &b, float accTolerance, float gyroTolerance) {
+        for (size_t i = 0; i < 3; i++) {
+            // NaN が混ざった場合も一致しないとみなす
+            if (!(fabsf(a.acc[i] - b.acc[i]) <= accTolerance) ||
+                !(fabsf(a.gyro[i] - b.gyro[i]) <= gyroTolerance)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,46 @@
+/// \file IMUPacket.h
+/// \brief MPU6886 の加速度・温度・角速度14バイトを M5.Imu と同じ向き・単位の値に直す
+///
+/// バースト読み出しのデータレジスタと FIFO のパケットはどちらもこの並び (ビッグエンディアン)．
+/// Arduinoに依存しないのでホスト上のテストでも同じ換算を確かめられる．
+///
+///  offset size
+///   0     6    acc[3]  (int16)
+///   6     2    temp    (int16, 使わない)
+///   8     6    gyro[3] (int16)
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_IMUPACKET_H
+#define CCBT_KOROGARU_KOEN_PARK_IMUPACKET_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace IMUPacket {
+
+    const size_t packetSize = 14;
+
+    // M5Unified は M5StickC Plus の MPU6886 の X軸・Z軸を反転して返す (基板の裏に実装されているため)
+    const std::array<float, 3> axisSign = {{-1.0f, 1.0f, -1.0f}};
+
+    struct Sample {
+        std::array<float, 3> acc;   // [G]
+        std::array<float, 3> gyro;  // [deg/s]
+    };
+
+    /// ACCEL_CONFIG (0x1C) の ACCEL_FS_SEL から換算係数 [G/LSB] を求める (±2/4/8/16 G)
+    float toAccRes(uint8_t accelConfig);
+
+    /// GYRO_CONFIG (0x1B) の GYRO_FS_SEL から換算係数 [dps/LSB] を求める (±250/500/1000/2000 dps)
+    float toGyroRes(uint8_t gyroConfig);
+
+    /// 14バイトのパケットを M5.Imu と同じ軸の向き・単位に直す
+    Sample decode(const uint8_t *packet, float accRes, float gyroRes);
+
+    /// 2つのサンプルの差が各軸とも許容範囲に収まっているか
+    bool agrees(const Sample &a, const Sample &b, float accTolerance, float gyroTolerance);
+}
+
+#endif //CCBT_KOROGARU_KOEN_PARK_IMUPACKET_H
@@ -0,0 +1,213 @@
+/// \file MicManager.cpp
+/// \brief PDMマイクの入力をI2S DMAから途切れなく取り込み，ブロックごとの特徴量を計算するクラス
+
+#include "AudioDSP.h"
+#include "MicManager.h"
+#include "PerfMonitor.h"
+
+namespace {
+    // 止めている間に再開の要求を確かめる間隔
+    const TickType_t stoppedPollTicks = pdMS_TO_TICKS(100);
+}
+
+MicManager::MicManager() = default;
+
+void MicManager::setup(int clkPin, int dataPin) {
+    // DMAバッファ1つを処理ブロック1つに対応させ，
+    // 処理が遅れても dmaBufferCount 個分までは取りこぼさないようにする
+    i2s_config_t i2s_config = {
+            .mode = (i2s_mode_t) (I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_PDM),
+            .sample_rate =  sampleRate,
+            .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+            .channel_format = I2S_CHANNEL_FMT_ALL_RIGHT,
+            .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+            .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+            .dma_buf_count = dmaBufferCount,
+            .dma_buf_len = hopSize,
+    };
+
+    i2s_pin_config_t pinConfig;
+    pinConfig.bck_io_num = I2S_PIN_NO_CHANGE;
+    pinConfig.ws_io_num = clkPin;
+    pinConfig.data_out_num = I2S_PIN_NO_CHANGE;
+    pinConfig.data_in_num = dataPin;
+
+    i2s_driver_install(I2S_NUM_0, &i2s_config, eventQueueLength, &eventQueue);
+    i2s_set_pin(I2S_NUM_0, &pinConfig);
+    i2s_set_clk(I2S_NUM_0, sampleRate, I2S_BITS_PER_SAMPLE_16BIT, I2S_CHANNEL_MONO);
+}
+
+void MicManager::update() {
+    i2s_event_t event;
+    if (waitForEvent(event)) {
+        handleEvent(event);
+    }
+}
+
+bool MicManager::waitForEvent(i2s_event_t &event) {
+    // 止めている間はイベントが来ないので，再開の要求を見落とさないよう時間を区切って待つ
+    applyEnabled();
+    return xQueueReceive(eventQueue, &event, enabled ? portMAX_DELAY : stoppedPollTicks) == pdTRUE;
+}
+
+void MicManager::handleEvent(const i2s_event_t &event) {
+    switch (event.type) {
+        case I2S_EVENT_RX_DONE:
+            readBlocks();
+            break;
+        case I2S_EVENT_RX_Q_OVF:
+            // ドライバが最も古いDMAバッファを上書きした．取りこぼしはここでだけ数える
+            overruns++;
+            droppedSamples += hopSize;
+            break;
+        case I2S_EVENT_DMA_ERROR:
+            overruns++;
+            break;
+        default:
+            break;
+    }
+}
+
+void MicManager::readBlocks() {
+    // 処理が遅れてイベントが溜まっていても，読めるDMAバッファは1回のイベントでまとめて読み出す．
+    // 足りない分は次のイベントで続きから埋めるので，短い読み出しは取りこぼしではない
+    bool woke = false;
+    for (;;) {
+        size_t readBytes = 0;
+        i2s_read(I2S_NUM_0,
+                 (char *) (block.data() + blockFill),
+                 (hopSize - blockFill) * sizeof(int16_t),
+                 &readBytes,
+                 0);
+        blockFill += readBytes / sizeof(int16_t);
+        if (blockFill < hopSize) {
+            break;
+        }
+        blockFill = 0;
+
+        // 起床周期はブロックを読み出せたイベントでだけ測る (先に読み出し済みで空振りしたイベントは数えない)
+        if (!woke) {
+            woke = true;
+            PERF_WAKE(MicWake, 1000000UL * hopSize / sampleRate);
+        }
+
+        processSignal(block.data(), hopSize);
+        blocks++;
+
+        // 窓は毎ブロック更新し，FFTは間引いて実行する
+        if (spectrumEnabled) {
+            spectrumAnalyzer.push(block.data(), hopSize);
+            if (++spectrumHops >= spectrumDecimation) {
+                spectrumHops = 0;
+                spectrum.publish(spectrumAnalyzer.analyze());
+            }
+        }
+
+        if (numDrained == drained.size()) {
+            publishFeatures(0);
+        }
+    }
+
+    // まとめて読み出したブロックの時刻は，読み出し時刻からその後に届いたサンプル数の分だけ遡って求める
+    publishFeatures(blockFill);
+}
+
+void MicManager::publishFeatures(size_t trailingSamples) {
+    const auto nowUs = static_cast<uint32_t>(micros());
+    for (size_t i = 0; i < numDrained; i++) {
+        const size_t laterSamples = (numDrained - 1 - i) * hopSize + trailingSamples;
+        AudioFeature &feature = drained[i];
+        feature.timestampUs = nowUs - static_cast<uint32_t>(laterSamples * 1000000ULL / sampleRate);
+        featureRing.push(feature);
+        if (recorder != nullptr) {
+            recorder->recordAudio(feature.rms, feature.peak, feature.timestampUs);
+        }
+    }
+    numDrained = 0;
+}
+
+bool MicManager::popFeature(AudioFeature &feature) {
+    return featureRing.pop(feature);
+}
+
+void MicManager::enableSpectrum(size_t decimation) {
+    spectrumAnalyzer.setup(sampleRate, 125.0f);
+    spectrumDecimation = decimation > 0 ? decimation : 1;
+    spectrumHops = 0;
+    spectrumEnabled = true;
+}
+
+SpectrumAnalyzer::Result MicManager::getSpectrum() const {
+    return spectrum.read();
+}
+
+void MicManager::setRecorder(CaptureRecorder *captureRecorder) {
+    recorder = captureRecorder;
+}
+
+void MicManager::setEnabled(bool enable) {
+    requestedEnabled = enable;
+}
+
+void MicManager::applyEnabled() {
+    const bool enable = requestedEnabled;
+    if (enable == enabled) {
+        return;
+    }
+    // 再開時はDMAバッファが空の状態から始まるので，止めていた間の分は取りこぼしに数えない
+    if (enable) {
+        blockFill = 0;
+        i2s_start(I2S_NUM_0);
+    } else {
+        i2s_stop(I2S_NUM_0);
+    }
+    enabled = enable;
+}
+
+bool MicManager::isEnabled() const {
+    return enabled;
+}
+
+MicStats MicManager::getStats() const {
+    MicStats stats;
+    stats.blocks = blocks;
+    stats.overruns = overruns;
+    stats.droppedSamples = droppedSamples;
+    stats.droppedFeatures = featureRing.getDropped();
+    return stats;
+}
+
+float MicManager::calcDecibel(float value) {
+    // https://m5stack.oss-cn-shenzhen.aliyuncs.com/resource/docs/datasheet/core/SPM1423HM4H-B_datasheet_en.pdf
+    // 8.6859 * ln(x) = 20 * log10(x)
+    if (value <= 0.0f) {
+        return -INFINITY;
+    }
+    return 20.0f * AudioDSP::fastLog10(value) + 25.6699f;
+}
+
+void MicManager::processSignal(const int16_t *samples, size_t count) {
+    // https://gist.github.com/tomoto/6a1b67d9e963f9932a43c984171d80fb
+    // Author: Tomoto Mizuma (Jul 23, 2021.)
+    // Code Changed by: Daiki Miura (June 30, 2023.)
+
+    PERF_SCOPE(MicProcess);
+
+    // 総和・二乗和・最小値・最大値を1パスで求める
+    const auto moments = AudioDSP::computeMoments(samples, count);
+
+    // 平均を取ってゼロ点を自動的に補正する
+    const auto base = static_cast<float>(moments.sum) / count;
+
+    // フィルタをかけて変化を緩やかにする
+    // 512 サンプルごとに 0.98 (時定数 約 1.6 s) だったものを 256 サンプルのブロックに換算した値 (0.98^(256/512))
+    const auto alpha = 0.98995f;
+    filteredBase = filteredBase * alpha + base * (1 - alpha);
+
+    // 二乗平均平方根とピークを取る (時刻は publishFeatures() で付ける)
+    drained[numDrained++] = {
+            AudioDSP::rmsAround(moments, filteredBase),
+            AudioDSP::peakAround(moments, filteredBase),
+            0
+    };
+}
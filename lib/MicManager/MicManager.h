@@ -0,0 +1,114 @@
+/// \file MicManager.h
+/// \brief PDMマイクの入力をI2S DMAから途切れなく取り込み，ブロックごとの特徴量を計算するクラス
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_MICMANAGER_H
+#define CCBT_KOROGARU_KOEN_PARK_MICMANAGER_H
+
+#include <array>
+#include <atomic>
+#include <Arduino.h>
+#include <driver/i2s.h>
+#include "CaptureRecorder.h"
+#include "SnapshotBuffer.h"
+#include "SpectrumAnalyzer.h"
+#include "SpscRing.h"
+
+
+/// 1ブロック分のマイク入力の特徴量
+struct AudioFeature {
+    float rms;
+    float peak;
+    uint32_t timestampUs;  // ブロックの最後のサンプルが届いた時刻 micros() (読み出し時刻から後続のサンプル数の分だけ遡る)
+};
+
+/// ストリームが連続しているかを確認するためのカウンタ
+struct MicStats {
+    uint32_t blocks;          // 処理したブロック数
+    uint32_t overruns;        // DMAバッファが溢れた回数
+    uint32_t droppedSamples;  // 溢れたことで失われたサンプル数
+    uint32_t droppedFeatures; // 送信側が取り出す前にリングが満杯で捨てた特徴量の数
+};
+
+
+class MicManager {
+public:
+    static const int sampleRate = 16000;     // サンプリング周波数 16 kHz
+    static const size_t hopSize = 256;       // 処理ブロック長 (16 ms)
+    static const int dmaBufferCount = 8;     // 128 ms 分のDMAバッファ
+    static const int eventQueueLength = 16;
+
+    MicManager();
+
+    void setup(int clkPin, int dataPin);
+
+    /// DMAバッファが埋まるのを待ち，届いたブロックを処理する (micTaskから繰り返し呼ぶ)
+    void update();
+
+    /// I2Sドライバのイベントを待つ (update() の前半．待ちと処理を分けて測る場合に使う)
+    /// 待つ前に setEnabled() の要求を反映し，止めている間は一定時間ごとに false を返す
+    bool waitForEvent(i2s_event_t &event);
+
+    /// 届いたイベントを処理する (update() の後半)
+    void handleEvent(const i2s_event_t &event);
+
+    /// 処理済みの特徴量を古い順に取り出す (送信タスクから呼ぶ)
+    bool popFeature(AudioFeature &feature);
+
+    /// 帯域エネルギーの解析を有効にする
+    /// \param decimation 何ブロックに1回解析するか
+    void enableSpectrum(size_t decimation);
+
+    /// 最新の帯域エネルギーの解析結果を返す
+    SpectrumAnalyzer::Result getSpectrum() const;
+
+    /// ブロックごとの特徴量を記録する (nullptr で止める)
+    void setRecorder(CaptureRecorder *captureRecorder);
+
+    /// I2Sの受信を止める・再開するよう要求する (どのタスクから呼んでもよい)
+    /// i2s_stop()・i2s_start() はブロックの処理の合間に update() を呼ぶタスクで行う
+    void setEnabled(bool enable);
+
+    bool isEnabled() const;
+
+    MicStats getStats() const;
+
+    static float calcDecibel(float value);
+
+private:
+    QueueHandle_t eventQueue = nullptr;
+    std::array<int16_t, hopSize> block{};
+    size_t blockFill = 0;  // block に読み込み済みのサンプル数
+    SpscRing<AudioFeature, 16> featureRing;
+    std::array<AudioFeature, dmaBufferCount> drained{};  // 1回の読み出しで揃った，時刻を付ける前の特徴量
+    size_t numDrained = 0;
+    CaptureRecorder *recorder = nullptr;
+
+    float filteredBase = 0.0f;
+
+    SpectrumAnalyzer spectrumAnalyzer;
+    SnapshotBuffer<SpectrumAnalyzer::Result> spectrum;
+    bool spectrumEnabled = false;
+    size_t spectrumDecimation = 1;
+    size_t spectrumHops = 0;
+
+    volatile bool enabled = true;
+    std::atomic<bool> requestedEnabled{true};
+    volatile uint32_t blocks = 0;
+    volatile uint32_t overruns = 0;
+    volatile uint32_t droppedSamples = 0;
+
+    /// 読めるDMAバッファをすべて読み出し，揃ったブロックごとに処理する
+    void readBlocks();
+
+    void processSignal(const int16_t *samples, size_t count);
+
+    /// setEnabled() の要求をI2Sに反映する (update() を呼ぶタスクからだけ呼ぶ)
+    void applyEnabled();
+
+    /// drained に溜めた特徴量に時刻を付けて送信タスク・記録に渡す
+    /// \param trailingSamples 最後のブロックの後に読み出し済みのサンプル数
+    void publishFeatures(size_t trailingSamples);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_MICMANAGER_H
@@ -0,0 +1,248 @@
+/// \file MotionDetector.cpp
+/// \brief IMUのサンプルごとに衝撃・回転・振り・静止を検出するクラス
+
+#include <algorithm>
+#include <cmath>
+#include "MotionDetector.h"
+
+const char *MotionDetector::getName(EventType type) {
+    switch (type) {
+        case EventType::Impact:
+            return "impact";
+        case EventType::Roll:
+            return "roll";
+        case EventType::Shake:
+            return "shake";
+        case EventType::Still:
+            return "still";
+        default:
+            return "unknown";
+    }
+}
+
+MotionDetector::Parameters MotionDetector::defaultParameters() {
+    Parameters p;
+    p.impactThreshold = 3.0f;
+    p.impactRelease = 1.5f;
+    p.impactWindowUs = 20000;
+    p.impactRefractoryUs = 100000;
+
+    p.rollStartDps = 90.0f;
+    p.rollStopDps = 45.0f;
+    p.rollStartUs = 200000;
+    p.rollStopUs = 300000;
+    p.rollReportStepDps = 30.0f;
+    p.rollReportIntervalUs = 100000;
+    p.rollSmoothingUs = 50000;
+
+    p.shakeHigh = 0.8f;
+    p.shakeLow = 0.3f;
+    p.shakeMinSwings = 4;
+    p.shakeGapUs = 300000;
+    p.shakeQuietUs = 500000;
+
+    // 開始は IMUManager の静止判定と同じ範囲
+    p.stillGyroEnter = 3.0f;
+    p.stillAccEnter = 0.05f;
+    p.stillGyroExit = 10.0f;
+    p.stillAccExit = 0.15f;
+    p.stillEnterUs = 1000000;
+    return p;
+}
+
+MotionDetector::MotionDetector() : params(defaultParameters()) {}
+
+void MotionDetector::setup(const Parameters &parameters) {
+    params = parameters;
+    reset();
+}
+
+void MotionDetector::reset() {
+    started = false;
+    impactState = ImpactState::Armed;
+    impactPeak = 0.0f;
+    rollRate = 0.0f;
+    rolling = false;
+    rollConditionUs = 0;
+    swingArmed = true;
+    swings = 0;
+    shakePeak = 0.0f;
+    shaking = false;
+    still = false;
+    stillConditionUs = 0;
+}
+
+size_t MotionDetector::update(const std::array<float, 3> &acc, const std::array<float, 3> &gyro,
+                              uint32_t timestampUs, Event *events) {
+    if (!started) {
+        started = true;
+        lastUs = timestampUs;
+    }
+    // micros() の折り返しをまたいでも差は正しい
+    const uint32_t dtUs = timestampUs - lastUs;
+    lastUs = timestampUs;
+
+    const float accNorm = sqrtf(acc[0] * acc[0] + acc[1] * acc[1] + acc[2] * acc[2]);
+    const float gyroNorm = sqrtf(gyro[0] * gyro[0] + gyro[1] * gyro[1] + gyro[2] * gyro[2]);
+
+    size_t count = 0;
+    if (detectImpact(accNorm, timestampUs, events[count])) {
+        count++;
+    }
+    if (detectRoll(gyroNorm, dtUs, timestampUs, events[count])) {
+        count++;
+    }
+    if (detectShake(accNorm, timestampUs, events[count])) {
+        count++;
+    }
+    if (detectStill(accNorm, gyro, dtUs, timestampUs, events[count])) {
+        count++;
+    }
+    return count;
+}
+
+bool MotionDetector::isRolling() const {
+    return rolling;
+}
+
+bool MotionDetector::isShaking() const {
+    return shaking;
+}
+
+bool MotionDetector::isStill() const {
+    return still;
+}
+
+bool MotionDetector::detectImpact(float accNorm, uint32_t nowUs, Event &event) {
+    switch (impactState) {
+        case ImpactState::Armed:
+            if (accNorm > params.impactThreshold) {
+                impactState = ImpactState::Peak;
+                impactPeak = accNorm;
+                impactStartUs = nowUs;
+            }
+            return false;
+
+        case ImpactState::Peak:
+            impactPeak = std::max(impactPeak, accNorm);
+            // 山を下りたら (長く続く場合は impactWindowUs で打ち切って) すぐに通知する
+            if (accNorm > params.impactThreshold && nowUs - impactStartUs < params.impactWindowUs) {
+                return false;
+            }
+            impactState = ImpactState::Refractory;
+            event = {EventType::Impact, true, impactPeak, impactStartUs};
+            return true;
+
+        case ImpactState::Refractory:
+        default:
+            if (accNorm < params.impactRelease && nowUs - impactStartUs >= params.impactRefractoryUs) {
+                impactState = ImpactState::Armed;
+            }
+            return false;
+    }
+}
+
+bool MotionDetector::detectRoll(float gyroNorm, uint32_t dtUs, uint32_t nowUs, Event &event) {
+    // 1次のローパスで細かい揺れを除く (時定数はサンプル間隔によらない)
+    const float alpha = static_cast<float>(dtUs) / (params.rollSmoothingUs + dtUs);
+    rollRate += alpha * (gyroNorm - rollRate);
+
+    if (!rolling) {
+        rollConditionUs = rollRate > params.rollStartDps ? rollConditionUs + dtUs : 0;
+        if (rollConditionUs < params.rollStartUs) {
+            return false;
+        }
+        rolling = true;
+        rollStartedUs = nowUs - rollConditionUs;
+        rollConditionUs = 0;
+        rollReportedRate = rollRate;
+        rollReportedUs = nowUs;
+        event = {EventType::Roll, true, rollRate, nowUs};
+        return true;
+    }
+
+    rollConditionUs = rollRate < params.rollStopDps ? rollConditionUs + dtUs : 0;
+    if (rollConditionUs >= params.rollStopUs) {
+        // 下回り始めた時点で止まったとみなす
+        const uint32_t stoppedUs = nowUs - rollConditionUs;
+        rolling = false;
+        rollConditionUs = 0;
+        event = {EventType::Roll, false, (stoppedUs - rollStartedUs) / 1000000.0f, nowUs};
+        return true;
+    }
+
+    if (fabsf(rollRate - rollReportedRate) < params.rollReportStepDps ||
+        nowUs - rollReportedUs < params.rollReportIntervalUs) {
+        return false;
+    }
+    rollReportedRate = rollRate;
+    rollReportedUs = nowUs;
+    event = {EventType::Roll, true, rollRate, nowUs};
+    return true;
+}
+
+bool MotionDetector::detectShake(float accNorm, uint32_t nowUs, Event &event) {
+    // 向きによらないよう，加速度の大きさの 1 G からのずれの山を数える
+    const float deviation = accNorm - 1.0f;
+    if (swingArmed && deviation > params.shakeHigh) {
+        swingArmed = false;
+        if (swings > 0 && nowUs - lastSwingUs > params.shakeGapUs && !shaking) {
+            swings = 0;
+        }
+        if (swings == 0) {
+            firstSwingUs = nowUs;
+            shakePeak = 0.0f;
+        }
+        swings++;
+        lastSwingUs = nowUs;
+    }
+    if (!swingArmed) {
+        shakePeak = std::max(shakePeak, deviation);
+        if (deviation < params.shakeLow) {
+            swingArmed = true;
+        }
+    }
+
+    if (!shaking) {
+        if (swings < params.shakeMinSwings) {
+            return false;
+        }
+        shaking = true;
+        event = {EventType::Shake, true, shakePeak, nowUs};
+        return true;
+    }
+
+    if (nowUs - lastSwingUs < params.shakeQuietUs) {
+        return false;
+    }
+    shaking = false;
+    swings = 0;
+    event = {EventType::Shake, false, (lastSwingUs - firstSwingUs) / 1000000.0f, nowUs};
+    return true;
+}
+
+bool MotionDetector::detectStill(float accNorm, const std::array<float, 3> &gyro, uint32_t dtUs, uint32_t nowUs,
+                                 Event &event) {
+    const float accDeviation = fabsf(accNorm - 1.0f);
+    const float gyroMax = std::max(std::max(fabsf(gyro[0]), fabsf(gyro[1])), fabsf(gyro[2]));
+
+    if (!still) {
+        const bool inside = gyroMax < params.stillGyroEnter && accDeviation < params.stillAccEnter;
+        stillConditionUs = inside ? stillConditionUs + dtUs : 0;
+        if (stillConditionUs < params.stillEnterUs) {
+            return false;
+        }
+        still = true;
+        stillStartedUs = nowUs - stillConditionUs;
+        stillConditionUs = 0;
+        event = {EventType::Still, true, 0.0f, nowUs};
+        return true;
+    }
+
+    if (gyroMax <= params.stillGyroExit && accDeviation <= params.stillAccExit) {
+        return false;
+    }
+    still = false;
+    event = {EventType::Still, false, (nowUs - stillStartedUs) / 1000000.0f, nowUs};
+    return true;
+}
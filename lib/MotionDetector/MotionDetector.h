@@ -0,0 +1,146 @@
+/// \file MotionDetector.h
+/// \brief IMUのサンプルごとに衝撃・回転・振り・静止を検出するクラス
+///
+/// update() に校正済みの加速度 [G]・角速度 [deg/s] とサンプル時刻を順に与える．
+/// - Impact: 加速度の大きさが impactThreshold を超えた山の最大値 (山が終わるか impactWindowUs で確定)
+/// - Roll:   角速度の大きさ (平滑化したもの) が rollStartDps を rollStartUs 続けたら開始，
+///           rollStopDps を下回って rollStopUs 続いたら終了．回転中は rollReportStepDps 以上変わるたびに通知
+/// - Shake:  加速度の大きさの 1 G からのずれが shakeHigh を超える山 (shakeLow まで戻るごとに1回) が
+///           shakeGapUs 以内の間隔で shakeMinSwings 回続いたら開始，shakeQuietUs 山がなければ終了
+/// - Still:  IMUManager の静止判定と同じ範囲に stillEnterUs 留まったら開始，より広い範囲を出たら終了
+/// 開始と終了のしきい値を分けて，境目の値でイベントが繰り返し出ないようにする．
+///
+/// update() は1つのタスクから呼ぶ．
+/// Arduinoに依存しないのでホスト側で記録したデータをそのまま流して確かめられる．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_MOTIONDETECTOR_H
+#define CCBT_KOROGARU_KOEN_PARK_MOTIONDETECTOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+class MotionDetector {
+public:
+    enum class EventType : uint8_t {
+        Impact,
+        Roll,
+        Shake,
+        Still,
+        Count
+    };
+
+    static const size_t numEventTypes = static_cast<size_t>(EventType::Count);
+
+    /// 検出したイベント
+    /// active: Roll・Shake・Still は開始 (回転中の速さの変化も含む) なら true，終了なら false．Impact は常に true
+    /// value:  開始時は大きさ (Impact: 最大の加速度 [G], Roll: 角速度 [deg/s], Shake: 最大のずれ [G], Still: 0)，
+    ///         終了時は続いた時間 [s]
+    struct Event {
+        EventType type;
+        bool active;
+        float value;
+        uint32_t timestampUs;  // 検出したサンプルの時刻
+    };
+
+    struct Parameters {
+        float impactThreshold;      // [G]
+        float impactRelease;        // これを下回るまで次の衝撃を数えない [G]
+        uint32_t impactWindowUs;    // 山の最大値を探す時間の上限
+        uint32_t impactRefractoryUs;
+
+        float rollStartDps;
+        float rollStopDps;
+        uint32_t rollStartUs;
+        uint32_t rollStopUs;
+        float rollReportStepDps;
+        uint32_t rollReportIntervalUs;  // 速さの変化を通知する最短の間隔
+        uint32_t rollSmoothingUs;       // 角速度を平滑化する時定数
+
+        float shakeHigh;            // [G]
+        float shakeLow;             // [G]
+        uint32_t shakeMinSwings;
+        uint32_t shakeGapUs;
+        uint32_t shakeQuietUs;
+
+        float stillGyroEnter;       // [deg/s] (各軸)
+        float stillAccEnter;        // [G]
+        float stillGyroExit;
+        float stillAccExit;
+        uint32_t stillEnterUs;
+    };
+
+    /// 1サンプルで出るイベントは種類ごとに1つまで
+    static const size_t maxEventsPerSample = numEventTypes;
+
+    static const char *getName(EventType type);
+
+    static Parameters defaultParameters();
+
+    MotionDetector();
+
+    void setup(const Parameters &parameters);
+
+    /// 状態を初期化する (次のサンプルから検出し直す)
+    void reset();
+
+    /// \param events maxEventsPerSample 個以上の配列
+    /// \return events に書き込んだイベントの数
+    size_t update(const std::array<float, 3> &acc, const std::array<float, 3> &gyro, uint32_t timestampUs,
+                  Event *events);
+
+    bool isRolling() const;
+
+    bool isShaking() const;
+
+    bool isStill() const;
+
+private:
+    Parameters params;
+    bool started = false;
+    uint32_t lastUs = 0;
+
+    // Impact
+    enum class ImpactState : uint8_t {
+        Armed,
+        Peak,
+        Refractory
+    };
+    ImpactState impactState = ImpactState::Armed;
+    float impactPeak = 0.0f;
+    uint32_t impactStartUs = 0;
+
+    // Roll
+    float rollRate = 0.0f;
+    bool rolling = false;
+    uint32_t rollConditionUs = 0;  // 開始 (終了) の条件を満たし続けている時間
+    uint32_t rollStartedUs = 0;
+    float rollReportedRate = 0.0f;
+    uint32_t rollReportedUs = 0;
+
+    // Shake
+    bool swingArmed = true;
+    uint32_t swings = 0;
+    uint32_t firstSwingUs = 0;
+    uint32_t lastSwingUs = 0;
+    float shakePeak = 0.0f;
+    bool shaking = false;
+
+    // Still
+    bool still = false;
+    uint32_t stillConditionUs = 0;
+    uint32_t stillStartedUs = 0;
+
+    bool detectImpact(float accNorm, uint32_t nowUs, Event &event);
+
+    bool detectRoll(float gyroNorm, uint32_t dtUs, uint32_t nowUs, Event &event);
+
+    bool detectShake(float accNorm, uint32_t nowUs, Event &event);
+
+    bool detectStill(float accNorm, const std::array<float, 3> &gyro, uint32_t dtUs, uint32_t nowUs,
+                     Event &event);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_MOTIONDETECTOR_H
@@ -0,0 +1,86 @@
+/// \file OSCBundleBuilder.cpp
+/// \brief OSC Bundleを固定長バッファ上で組み立てるクラス
+
+#include <cstring>
+#include "OSCBundleBuilder.h"
+
+OSCBundleBuilder::OSCBundleBuilder() = default;
+
+void OSCBundleBuilder::begin(uint64_t timetagUs) {
+    length = 0;
+    nestedStart = 0;
+    writeString("#bundle");
+    writeTimetag(timetagUs);
+}
+
+bool OSCBundleBuilder::beginNested(uint64_t timetagUs) {
+    // 長さは閉じる時に書き込む
+    const size_t start = length;
+    if (!writeInt32(0) || !writeString("#bundle") || !writeTimetag(timetagUs)) {
+        length = start;
+        return false;
+    }
+    nestedStart = start;
+    return true;
+}
+
+void OSCBundleBuilder::endNested() {
+    // 開始に失敗していた場合は何もしない (外側のBundleのヘッダがあるので 0 にはならない)
+    if (nestedStart == 0) {
+        return;
+    }
+    const size_t end = length;
+    length = nestedStart;
+    writeInt32(end - nestedStart - 4);
+    length = end;
+    nestedStart = 0;
+}
+
+bool OSCBundleBuilder::add(const OSCMessageTemplate &message) {
+    if (length + 4 + message.size() > bufferSize) {
+        return false;
+    }
+    writeInt32(message.size());
+    memcpy(&buffer[length], message.data(), message.size());
+    length += message.size();
+    return true;
+}
+
+const uint8_t *OSCBundleBuilder::data() const {
+    return buffer.data();
+}
+
+size_t OSCBundleBuilder::size() const {
+    return length;
+}
+
+bool OSCBundleBuilder::writeString(const char *str) {
+    // OSC-string: NUL終端を含めて4バイト境界までNULで埋める
+    const size_t len = strlen(str);
+    const size_t padded = (len + 4) & ~static_cast<size_t>(3);
+    if (length + padded > bufferSize) {
+        return false;
+    }
+    memcpy(&buffer[length], str, len);
+    memset(&buffer[length + len], 0, padded - len);
+    length += padded;
+    return true;
+}
+
+bool OSCBundleBuilder::writeInt32(uint32_t value) {
+    if (length + 4 > bufferSize) {
+        return false;
+    }
+    buffer[length++] = value >> 24;
+    buffer[length++] = value >> 16;
+    buffer[length++] = value >> 8;
+    buffer[length++] = value;
+    return true;
+}
+
+bool OSCBundleBuilder::writeTimetag(uint64_t timetagUs) {
+    // NTP形式 (32bit 秒 + 32bit 小数部)
+    const auto seconds = static_cast<uint32_t>(timetagUs / 1000000ULL);
+    const auto fraction = static_cast<uint32_t>(((timetagUs % 1000000ULL) << 32) / 1000000ULL);
+    return writeInt32(seconds) && writeInt32(fraction);
+}
@@ -0,0 +1,54 @@
+/// \file OSCBundleBuilder.h
+/// \brief OSC Bundleを固定長バッファ上で組み立てるクラス
+///
+/// Arduinoに依存しないので，ホストのテストでもファームウェアと同じバイト列を作れる．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_OSCBUNDLEBUILDER_H
+#define CCBT_KOROGARU_KOEN_PARK_OSCBUNDLEBUILDER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "OSCMessageTemplate.h"
+
+
+class OSCBundleBuilder {
+public:
+    static const size_t bufferSize = 512;
+
+    OSCBundleBuilder();
+
+    /// Bundleの組み立てを開始する
+    /// \param timetagUs タイムタグとして埋め込む時刻 [us]
+    void begin(uint64_t timetagUs);
+
+    /// 組み立て中のBundleの中に別のタイムタグを持つBundleを開始する (入れ子は1段まで)
+    /// \param timetagUs 外側のBundle以降の時刻であること (OSC 1.0)
+    /// \return バッファに収まらなかった場合 false
+    bool beginNested(uint64_t timetagUs);
+
+    /// beginNested() で開始したBundleを閉じる
+    void endNested();
+
+    /// Bundleにメッセージを追加する
+    /// \return バッファに収まらなかった場合 false
+    bool add(const OSCMessageTemplate &message);
+
+    const uint8_t *data() const;
+
+    size_t size() const;
+
+private:
+    std::array<uint8_t, bufferSize> buffer{};
+    size_t length = 0;
+    size_t nestedStart = 0;  // 入れ子のBundleの長さを書き込む位置
+
+    bool writeString(const char *str);
+
+    bool writeInt32(uint32_t value);
+
+    bool writeTimetag(uint64_t timetagUs);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_OSCBUNDLEBUILDER_H
@@ -0,0 +1,179 @@
+/// \file OSCManager.cpp
+/// \brief OSCパケットを固定長バッファ上で組み立ててUDPで送信するクラス
+
+#include <cerrno>
+#include "OSCManager.h"
+#include "PerfMonitor.h"
+
+OSCManager::OSCManager() = default;
+
+bool OSCManager::setup(const char *host, uint16_t port, uint16_t localPort) {
+    // やり直す場合は前のソケットを閉じてから開き直す
+    if (socketFd >= 0) {
+        close(socketFd);
+        socketFd = -1;
+    }
+    numDestinations = 0;
+
+    const int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) {
+        Serial.print("OSC socket() failed: errno ");
+        Serial.println(errno);
+        return false;
+    }
+
+    // 受信 (時計合わせの pong や設定変更など) のため bind しておく
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(localPort);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&local), sizeof(local)) < 0) {
+        Serial.print("OSC bind() to port ");
+        Serial.print(localPort);
+        Serial.print(" failed: errno ");
+        Serial.println(errno);
+        close(fd);
+        return false;
+    }
+
+    socketFd = fd;
+    if (!addDestination(host, port)) {
+        Serial.print("Invalid OSC server: ");
+        Serial.print(host);
+        Serial.print(":");
+        Serial.println(port);
+        close(socketFd);
+        socketFd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool OSCManager::addDestination(const char *host, uint16_t port) {
+    IPAddress ip;
+    if (numDestinations >= maxDestinations || !ip.fromString(host) || port == 0) {
+        return false;
+    }
+    Destination &destination = destinations[numDestinations];
+    destination.address = sockaddr_in{};
+    destination.address.sin_family = AF_INET;
+    destination.address.sin_addr.s_addr = static_cast<uint32_t>(ip);
+    destination.address.sin_port = htons(port);
+    destination.sent = 0;
+    destination.errors = 0;
+    numDestinations++;
+    return true;
+}
+
+size_t OSCManager::getNumDestinations() const {
+    return numDestinations;
+}
+
+OSCManager::DestinationStats OSCManager::getDestinationStats(size_t index) const {
+    if (index >= numDestinations) {
+        return {0, 0};
+    }
+    return {destinations[index].sent.load(), destinations[index].errors.load()};
+}
+
+uint32_t OSCManager::getBufferFullCount() const {
+    return bufferFull;
+}
+
+uint32_t OSCManager::getFirstSendUs() const {
+    return firstSendUs;
+}
+
+void OSCManager::beginBundle(uint64_t timetagUs) {
+    bundle.begin(timetagUs);
+}
+
+bool OSCManager::beginNestedBundle(uint64_t timetagUs) {
+    return bundle.beginNested(timetagUs);
+}
+
+void OSCManager::endNestedBundle() {
+    bundle.endNested();
+}
+
+bool OSCManager::addMessage(const OSCMessageTemplate &message) {
+    return bundle.add(message);
+}
+
+bool OSCManager::sendBundle() {
+    return sendPacket(bundle.data(), bundle.size(), numDestinations);
+}
+
+size_t OSCManager::getBundleSize() const {
+    return bundle.size();
+}
+
+bool OSCManager::send(const OSCMessageTemplate &message) {
+    return sendPacket(message.data(), message.size(), numDestinations);
+}
+
+bool OSCManager::send(const uint8_t *data, size_t size) {
+    return sendPacket(data, size, numDestinations);
+}
+
+bool OSCManager::sendToServer(const OSCMessageTemplate &message) {
+    return sendPacket(message.data(), message.size(), 1);
+}
+
+size_t OSCManager::receive(uint8_t *data, size_t size, uint32_t timeoutMs, bool &fromServer) {
+    fromServer = false;
+    if (socketFd < 0) {
+        // 呼び出し側が待たずに繰り返し呼んでも CPU を占有しないよう，受信を待つ代わりに眠る
+        delay(timeoutMs);
+        return 0;
+    }
+
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(socketFd, &readSet);
+    timeval timeout{};
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    if (select(socketFd + 1, &readSet, nullptr, nullptr, &timeout) <= 0) {
+        return 0;
+    }
+
+    sockaddr_in from{};
+    socklen_t fromLength = sizeof(from);
+    const auto received = recvfrom(socketFd, data, size, MSG_DONTWAIT,
+                                   reinterpret_cast<sockaddr *>(&from), &fromLength);
+    if (received <= 0) {
+        return 0;
+    }
+    fromServer = numDestinations > 0 && from.sin_addr.s_addr == destinations[0].address.sin_addr.s_addr;
+    return static_cast<size_t>(received);
+}
+
+bool OSCManager::sendPacket(const uint8_t *data, size_t size, size_t count) {
+    PERF_SCOPE(OscSend);
+    if (socketFd < 0) {
+        return false;
+    }
+    // 組み立てたバッファをそのまま各送信先へ送る (送信先ごとのコピーはしない)
+    bool allSent = true;
+    for (size_t i = 0; i < count && i < numDestinations; i++) {
+        Destination &destination = destinations[i];
+        const auto sent = sendto(socketFd, data, size, 0,
+                                 reinterpret_cast<const sockaddr *>(&destination.address),
+                                 sizeof(destination.address));
+        if (sent == static_cast<ssize_t>(size)) {
+            destination.sent++;
+            if (firstSendUs == 0) {
+                uint32_t unset = 0;
+                firstSendUs.compare_exchange_strong(unset, micros());
+            }
+        } else {
+            destination.errors++;
+            if (sent < 0 && (errno == ENOMEM || errno == ENOBUFS || errno == EAGAIN)) {
+                bufferFull++;
+            }
+            allSent = false;
+        }
+    }
+    return allSent;
+}
@@ -0,0 +1,117 @@
+/// \file OSCManager.h
+/// \brief OSCパケットを固定長バッファ上で組み立ててUDPで送信するクラス
+///
+/// 送信先は最大 maxDestinations 個（先頭が OSC サーバー）で，マルチキャストアドレスも指定できる．
+/// パケットは一度だけ組み立て，同じバッファを sendto() で送信先ごとに送る．
+/// 1つのソケットを sendto() で使うので，複数のタスクから同時に送信してもよい．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_OSCMANAGER_H
+#define CCBT_KOROGARU_KOEN_PARK_OSCMANAGER_H
+
+#include <array>
+#include <atomic>
+#include <Arduino.h>
+#include <lwip/sockets.h>
+#include "OSCBundleBuilder.h"
+#include "OSCMessageTemplate.h"
+
+
+class OSCManager {
+public:
+    /// 送信レイアウト
+    /// Message: 1アドレス1パケット（従来どおり）
+    /// Bundle:  1フレーム分のメッセージを1つのOSC Bundleにまとめて送る
+    /// Binary:  1フレーム分を WireFormat の32バイトのパケットにして送る（状態通知はOSCのまま）
+    enum class Layout {
+        Message,
+        Bundle,
+        Binary
+    };
+
+    static const size_t bufferSize = OSCBundleBuilder::bufferSize;
+    static const size_t maxDestinations = 4;
+
+    /// 送信先ごとの送信数
+    struct DestinationStats {
+        uint32_t sent;
+        uint32_t errors;
+    };
+
+    OSCManager();
+
+    /// ソケットを開き，OSCサーバーを最初の送信先にする (失敗した場合はもう一度呼んでよい)
+    /// \param localPort 受信用に bind するポート (0 なら空いているポート)
+    /// \return socket() か bind() に失敗した場合，host が IPv4 アドレスでない場合 false (送信も受信もしない)
+    bool setup(const char *host, uint16_t port, uint16_t localPort = 0);
+
+    /// 送信先を追加する（setup() の後，送信を始める前に呼ぶ）
+    /// \return アドレスが不正か，送信先が maxDestinations 個を超える場合 false
+    bool addDestination(const char *host, uint16_t port);
+
+    size_t getNumDestinations() const;
+
+    /// 起動時からの送信数
+    DestinationStats getDestinationStats(size_t index) const;
+
+    /// 起動時からの，送信バッファが足りずに sendto() が失敗した回数
+    /// (WiFiの送信が詰まっている目安．送信先ごとの errors にも含まれる)
+    uint32_t getBufferFullCount() const;
+
+    /// 最初にパケットを送れた時刻 micros() (まだ送れていなければ 0)
+    uint32_t getFirstSendUs() const;
+
+    /// Bundleの組み立てを開始する
+    /// \param timetagUs タイムタグとして埋め込む時刻 [us]
+    void beginBundle(uint64_t timetagUs);
+
+    /// 組み立て中のBundleの中に別のタイムタグを持つBundleを開始する (入れ子は1段まで)
+    /// \param timetagUs 外側のBundle以降の時刻であること (OSC 1.0)
+    /// \return バッファに収まらなかった場合 false
+    bool beginNestedBundle(uint64_t timetagUs);
+
+    /// beginNestedBundle() で開始したBundleを閉じる
+    void endNestedBundle();
+
+    /// Bundleにメッセージを追加する
+    /// \return バッファに収まらなかった場合 false
+    bool addMessage(const OSCMessageTemplate &message);
+
+    /// 組み立てたBundleを1つのUDPパケットとして送信する
+    bool sendBundle();
+
+    size_t getBundleSize() const;
+
+    /// メッセージを単体のUDPパケットとして送信する
+    bool send(const OSCMessageTemplate &message);
+
+    /// メッセージを OSC サーバー（最初の送信先）にだけ送信する
+    bool sendToServer(const OSCMessageTemplate &message);
+
+    /// 組み立て済みのバイト列を単体のUDPパケットとして送信する
+    bool send(const uint8_t *data, size_t size);
+
+    /// 送信用のソケットに届いたパケットを1つ読み出す (timeoutMs まで待つ．ソケットがなければ timeoutMs 眠る)
+    /// \param fromServer OSCサーバー (最初の送信先) のアドレスから届いたかどうか
+    /// \return 読み出したバイト数 (届かなければ 0，size を超える部分は切り捨てる)
+    size_t receive(uint8_t *data, size_t size, uint32_t timeoutMs, bool &fromServer);
+
+private:
+    struct Destination {
+        sockaddr_in address;
+        std::atomic<uint32_t> sent;
+        std::atomic<uint32_t> errors;
+    };
+
+    int socketFd = -1;
+    std::array<Destination, maxDestinations> destinations{};
+    size_t numDestinations = 0;
+    std::atomic<uint32_t> bufferFull{0};
+    std::atomic<uint32_t> firstSendUs{0};
+
+    OSCBundleBuilder bundle;
+
+    bool sendPacket(const uint8_t *data, size_t size, size_t count);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_OSCMANAGER_H
@@ -0,0 +1,223 @@
+/// \file OSCMessageReader.cpp
+/// \brief 受信したOSCパケット (Message / Bundle) からメッセージを順に取り出して読むクラス
+
+#include <cstring>
+#include "OSCMessageReader.h"
+
+namespace {
+    const char bundleTag[] = "#bundle";
+    const size_t bundleHeaderLength = 16;  // "#bundle\0" + タイムタグ
+}
+
+OSCMessageReader::OSCMessageReader() = default;
+
+bool OSCMessageReader::begin(const uint8_t *packet, size_t packetSize) {
+    data = packet;
+    size = packetSize;
+    depth = 0;
+    address = nullptr;
+    typeTags = nullptr;
+    numArgs = 0;
+    rootPending = packetSize >= 4 && packetSize % 4 == 0;
+    return rootPending;
+}
+
+bool OSCMessageReader::next() {
+    while (true) {
+        size_t start = 0;
+        size_t length = 0;
+        if (rootPending) {
+            rootPending = false;
+            length = size;
+        } else {
+            // 読み終わった Bundle から抜ける
+            while (depth > 0 && frames[depth - 1].position >= frames[depth - 1].end) {
+                depth--;
+            }
+            if (depth == 0) {
+                return false;
+            }
+
+            // Bundle の要素: 長さ (int32) + 中身
+            Frame &frame = frames[depth - 1];
+            if (frame.position + 4 > frame.end) {
+                depth--;
+                continue;
+            }
+            length = readBigEndian(frame.position);
+            start = frame.position + 4;
+            if (length > frame.end - start || length % 4 != 0) {
+                // 長さが壊れていると以降の境界がわからないので，この Bundle は読み捨てる
+                depth--;
+                continue;
+            }
+            frame.position = start + length;
+        }
+
+        if (length >= sizeof(bundleTag) && memcmp(&data[start], bundleTag, sizeof(bundleTag)) == 0) {
+            if (length >= bundleHeaderLength && depth < maxDepth) {
+                frames[depth++] = {start + bundleHeaderLength, start + length};
+            }
+            continue;
+        }
+        if (parseMessage(start, length)) {
+            return true;
+        }
+    }
+}
+
+const char *OSCMessageReader::getAddress() const {
+    return address;
+}
+
+size_t OSCMessageReader::getNumArgs() const {
+    return numArgs;
+}
+
+char OSCMessageReader::getType(size_t index) const {
+    return index < numArgs ? typeTags[index] : '\0';
+}
+
+bool OSCMessageReader::getNumber(size_t index, float &value) const {
+    if (index >= numArgs) {
+        return false;
+    }
+    const size_t offset = argOffsets[index];
+    switch (typeTags[index]) {
+        case 'i':
+            value = static_cast<float>(static_cast<int32_t>(readBigEndian(offset)));
+            return true;
+        case 'f': {
+            const uint32_t bits = readBigEndian(offset);
+            memcpy(&value, &bits, sizeof(value));
+            return true;
+        }
+        case 'h': {
+            const uint64_t bits = (static_cast<uint64_t>(readBigEndian(offset)) << 32) | readBigEndian(offset + 4);
+            value = static_cast<float>(static_cast<int64_t>(bits));
+            return true;
+        }
+        case 'd': {
+            const uint64_t bits = (static_cast<uint64_t>(readBigEndian(offset)) << 32) | readBigEndian(offset + 4);
+            double number;
+            memcpy(&number, &bits, sizeof(number));
+            value = static_cast<float>(number);
+            return true;
+        }
+        case 'T':
+            value = 1.0f;
+            return true;
+        case 'F':
+            value = 0.0f;
+            return true;
+        default:
+            return false;
+    }
+}
+
+const char *OSCMessageReader::getString(size_t index) const {
+    if (index >= numArgs || (typeTags[index] != 's' && typeTags[index] != 'S')) {
+        return nullptr;
+    }
+    return reinterpret_cast<const char *>(&data[argOffsets[index]]);
+}
+
+bool OSCMessageReader::parseMessage(size_t start, size_t length) {
+    const size_t end = start + length;
+    size_t position = start;
+
+    const char *messageAddress = readString(position, end, position);
+    if (messageAddress == nullptr || messageAddress[0] != '/') {
+        return false;
+    }
+
+    // タイプタグがない古い形式は引数なしとみなす
+    const char *tags = "";
+    if (position < end) {
+        tags = readString(position, end, position);
+        if (tags == nullptr || tags[0] != ',') {
+            return false;
+        }
+        tags++;
+    }
+
+    // 引数の位置を先に求めておく (収まらない・読めない型があればメッセージごと捨てる)
+    size_t count = 0;
+    for (const char *tag = tags; *tag != '\0'; tag++) {
+        if (count >= maxArgs) {
+            return false;
+        }
+        argOffsets[count++] = position;
+        size_t argLength = 0;
+        switch (*tag) {
+            case 'i':
+            case 'f':
+            case 'c':
+            case 'r':
+            case 'm':
+                argLength = 4;
+                break;
+            case 'h':
+            case 'd':
+            case 't':
+                argLength = 8;
+                break;
+            case 's':
+            case 'S': {
+                size_t next = 0;
+                if (readString(position, end, next) == nullptr) {
+                    return false;
+                }
+                argLength = next - position;
+                break;
+            }
+            case 'b': {
+                if (position + 4 > end) {
+                    return false;
+                }
+                const size_t blobLength = readBigEndian(position);
+                if (blobLength > end - position - 4) {
+                    return false;
+                }
+                argLength = 4 + ((blobLength + 3) & ~static_cast<size_t>(3));
+                break;
+            }
+            case 'T':
+            case 'F':
+            case 'N':
+            case 'I':
+                break;
+            default:
+                return false;
+        }
+        if (argLength > end - position) {
+            return false;
+        }
+        position += argLength;
+    }
+
+    address = messageAddress;
+    typeTags = tags;
+    numArgs = count;
+    return true;
+}
+
+const char *OSCMessageReader::readString(size_t position, size_t end, size_t &next) const {
+    const void *terminator = memchr(&data[position], '\0', end - position);
+    if (terminator == nullptr) {
+        return nullptr;
+    }
+    const size_t length = static_cast<const uint8_t *>(terminator) - &data[position];
+    next = position + ((length + 4) & ~static_cast<size_t>(3));
+    if (next > end) {
+        return nullptr;
+    }
+    return reinterpret_cast<const char *>(&data[position]);
+}
+
+uint32_t OSCMessageReader::readBigEndian(size_t offset) const {
+    return (static_cast<uint32_t>(data[offset]) << 24) |
+           (static_cast<uint32_t>(data[offset + 1]) << 16) |
+           (static_cast<uint32_t>(data[offset + 2]) << 8) |
+           static_cast<uint32_t>(data[offset + 3]);
+}
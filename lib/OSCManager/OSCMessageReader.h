@@ -0,0 +1,73 @@
+/// \file OSCMessageReader.h
+/// \brief 受信したOSCパケット (Message / Bundle) からメッセージを順に取り出して読むクラス
+///
+/// アドレスや引数の型が決まっていないメッセージ（設定変更など）を読むためのもの．
+/// Bundle は入れ子も含めて中のメッセージを順に辿る（タイムタグは見ない）．
+/// パケットはコピーせず，読み終わるまで呼び出し側のバッファを参照する．
+/// Arduinoに依存しないのでホスト側でもそのまま使える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_OSCMESSAGEREADER_H
+#define CCBT_KOROGARU_KOEN_PARK_OSCMESSAGEREADER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+class OSCMessageReader {
+public:
+    static const size_t maxArgs = 8;
+    static const size_t maxDepth = 4;
+
+    OSCMessageReader();
+
+    /// パケットを読み始める (最初のメッセージは next() で取り出す)
+    /// \return OSCパケットとして長さが不正な場合 false
+    bool begin(const uint8_t *data, size_t size);
+
+    /// 次のメッセージに進む (壊れている要素は読み飛ばす)
+    /// \return メッセージが残っていない場合 false
+    bool next();
+
+    const char *getAddress() const;
+
+    size_t getNumArgs() const;
+
+    /// \return 引数の型 ('i', 'f', 's', 'T', 'F' など)．範囲外なら '\0'
+    char getType(size_t index) const;
+
+    /// 数値として読む ('i', 'h', 'f', 'd' はそのまま，'T' は 1，'F' は 0)
+    /// \return 数値として読めない場合 false
+    bool getNumber(size_t index, float &value) const;
+
+    /// \return 's' の引数の文字列．それ以外は nullptr
+    const char *getString(size_t index) const;
+
+private:
+    struct Frame {
+        size_t position;
+        size_t end;
+    };
+
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    bool rootPending = false;
+    std::array<Frame, maxDepth> frames{};
+    size_t depth = 0;
+
+    const char *address = nullptr;
+    const char *typeTags = nullptr;  // 先頭の ',' を除いたもの
+    std::array<size_t, maxArgs> argOffsets{};
+    size_t numArgs = 0;
+
+    bool parseMessage(size_t start, size_t length);
+
+    /// NUL終端の文字列を読み，4バイト境界に揃えた次の位置を返す
+    /// \return 終端が end までに見つからない場合 nullptr
+    const char *readString(size_t position, size_t end, size_t &next) const;
+
+    uint32_t readBigEndian(size_t offset) const;
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_OSCMESSAGEREADER_H
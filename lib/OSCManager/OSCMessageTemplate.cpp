@@ -0,0 +1,164 @@
+/// \file OSCMessageTemplate.cpp
+/// \brief アドレスとタイプタグを事前にエンコードしておくOSCメッセージ
+
+#include <cstring>
+#include "OSCMessageTemplate.h"
+
+namespace {
+    // NUL終端を含めて4バイト境界に揃えた長さ
+    size_t paddedLength(size_t len) {
+        return (len + 4) & ~static_cast<size_t>(3);
+    }
+
+    // 引数のペイロードの大きさ (bool は 0)
+    size_t payloadLength(char typeTag) {
+        switch (typeTag) {
+            case 'f':
+            case 'i':
+                return 4;
+            case 't':
+                return 8;
+            default:
+                return 0;
+        }
+    }
+}
+
+OSCMessageTemplate::OSCMessageTemplate() = default;
+
+bool OSCMessageTemplate::build(const char *address, const char *typeTags) {
+    length = 0;
+    numArgs = 0;
+
+    const size_t addressLen = strlen(address);
+    const size_t tagCount = strlen(typeTags);
+    const size_t addressSize = paddedLength(addressLen);
+    const size_t tagSize = paddedLength(tagCount + 1);
+
+    size_t payloadSize = 0;
+    for (size_t i = 0; i < tagCount; i++) {
+        if (payloadLength(typeTags[i]) > 0) {
+            payloadSize += payloadLength(typeTags[i]);
+        } else if (typeTags[i] != 'T' && typeTags[i] != 'F') {
+            return false;
+        }
+    }
+
+    if (tagCount > maxArgs || addressSize + tagSize + payloadSize > maxSize) {
+        return false;
+    }
+
+    bytes.fill(0);
+    memcpy(&bytes[0], address, addressLen);
+
+    const size_t tagOffset = addressSize;
+    bytes[tagOffset] = ',';
+    size_t payloadOffset = tagOffset + tagSize;
+    for (size_t i = 0; i < tagCount; i++) {
+        const size_t tagPos = tagOffset + 1 + i;
+        bytes[tagPos] = typeTags[i];
+        if (payloadLength(typeTags[i]) > 0) {
+            argOffsets[i] = payloadOffset;
+            payloadOffset += payloadLength(typeTags[i]);
+        } else {
+            // bool はペイロードを持たずタイプタグ自体が値になる
+            argOffsets[i] = tagPos;
+        }
+    }
+
+    numArgs = tagCount;
+    headerLength = tagOffset + tagSize;
+    length = payloadOffset;
+    return true;
+}
+
+void OSCMessageTemplate::setFloat(size_t index, float value) {
+    if (index >= numArgs) {
+        return;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeBigEndian(argOffsets[index], bits);
+}
+
+void OSCMessageTemplate::setInt(size_t index, int32_t value) {
+    if (index >= numArgs) {
+        return;
+    }
+    writeBigEndian(argOffsets[index], static_cast<uint32_t>(value));
+}
+
+void OSCMessageTemplate::setBool(size_t index, bool value) {
+    if (index >= numArgs) {
+        return;
+    }
+    bytes[argOffsets[index]] = value ? 'T' : 'F';
+}
+
+void OSCMessageTemplate::setTimetag(size_t index, uint64_t timeUs) {
+    if (index >= numArgs) {
+        return;
+    }
+    // NTP形式 (32bit 秒 + 32bit 小数部)
+    const auto seconds = static_cast<uint32_t>(timeUs / 1000000ULL);
+    const auto fraction = static_cast<uint32_t>(((timeUs % 1000000ULL) << 32) / 1000000ULL);
+    writeBigEndian(argOffsets[index], seconds);
+    writeBigEndian(argOffsets[index] + 4, fraction);
+}
+
+bool OSCMessageTemplate::parse(const uint8_t *data, size_t size) {
+    if (length == 0 || size != length || memcmp(data, bytes.data(), headerLength) != 0) {
+        return false;
+    }
+    memcpy(&bytes[headerLength], &data[headerLength], length - headerLength);
+    return true;
+}
+
+float OSCMessageTemplate::getFloat(size_t index) const {
+    if (index >= numArgs) {
+        return 0.0f;
+    }
+    const uint32_t bits = readBigEndian(argOffsets[index]);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int32_t OSCMessageTemplate::getInt(size_t index) const {
+    if (index >= numArgs) {
+        return 0;
+    }
+    return static_cast<int32_t>(readBigEndian(argOffsets[index]));
+}
+
+uint64_t OSCMessageTemplate::getTimetag(size_t index) const {
+    if (index >= numArgs) {
+        return 0;
+    }
+    // 小数部は四捨五入して [us] に戻す (setTimetag() と往復しても値が変わらない)
+    const uint64_t seconds = readBigEndian(argOffsets[index]);
+    const uint64_t fraction = readBigEndian(argOffsets[index] + 4);
+    return seconds * 1000000ULL + ((fraction * 1000000ULL + (1ULL << 31)) >> 32);
+}
+
+const uint8_t *OSCMessageTemplate::data() const {
+    return bytes.data();
+}
+
+size_t OSCMessageTemplate::size() const {
+    return length;
+}
+
+void OSCMessageTemplate::writeBigEndian(size_t offset, uint32_t value) {
+    bytes[offset] = value >> 24;
+    bytes[offset + 1] = value >> 16;
+    bytes[offset + 2] = value >> 8;
+    bytes[offset + 3] = value;
+}
+
+uint32_t OSCMessageTemplate::readBigEndian(size_t offset) const {
+    return static_cast<uint32_t>(bytes[offset]) << 24 |
+           static_cast<uint32_t>(bytes[offset + 1]) << 16 |
+           static_cast<uint32_t>(bytes[offset + 2]) << 8 |
+           static_cast<uint32_t>(bytes[offset + 3]);
+}
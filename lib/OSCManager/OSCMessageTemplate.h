@@ -0,0 +1,70 @@
+/// \file OSCMessageTemplate.h
+/// \brief アドレスとタイプタグを事前にエンコードしておくOSCメッセージ
+///
+/// build() でアドレス・タイプタグ・引数の配置を一度だけ決め，
+/// 送信時は set*() で引数のバイト列だけを書き換える．
+/// 受信時は parse() でアドレスとタイプタグが一致するか確かめ，get*() で引数を読み出す．
+/// Arduinoに依存しないのでホスト側でもそのまま使える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_OSCMESSAGETEMPLATE_H
+#define CCBT_KOROGARU_KOEN_PARK_OSCMESSAGETEMPLATE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+class OSCMessageTemplate {
+public:
+    static const size_t maxSize = 128;
+    static const size_t maxArgs = 16;
+
+    OSCMessageTemplate();
+
+    /// メッセージの雛形を作る
+    /// \param address OSCアドレス
+    /// \param typeTags 引数の型 ('f': float, 'i': int32, 'T': bool, 't': timetag) を並べた文字列（先頭の ',' は不要）
+    /// \return 雛形がバッファに収まらなかった場合 false
+    bool build(const char *address, const char *typeTags);
+
+    void setFloat(size_t index, float value);
+
+    void setInt(size_t index, int32_t value);
+
+    void setBool(size_t index, bool value);
+
+    /// \param timeUs タイムタグとして埋め込む時刻 [us] (NTP形式の 32bit 秒 + 32bit 小数部に変換する)
+    void setTimetag(size_t index, uint64_t timeUs);
+
+    /// 受信したパケットがこの雛形と同じアドレス・タイプタグ・長さなら取り込む
+    /// \return 一致しなかった場合 false (内容は変わらない)
+    bool parse(const uint8_t *data, size_t size);
+
+    float getFloat(size_t index) const;
+
+    int32_t getInt(size_t index) const;
+
+    /// \return タイムタグを [us] に戻した値
+    uint64_t getTimetag(size_t index) const;
+
+    const uint8_t *data() const;
+
+    size_t size() const;
+
+private:
+    std::array<uint8_t, maxSize> bytes{};
+    size_t length = 0;
+    size_t headerLength = 0;  // アドレス + タイプタグ
+
+    // 引数ごとの書き換え位置
+    // float/int/timetag はペイロードの先頭，bool はタイプタグ文字の位置
+    std::array<uint8_t, maxArgs> argOffsets{};
+    size_t numArgs = 0;
+
+    void writeBigEndian(size_t offset, uint32_t value);
+
+    uint32_t readBigEndian(size_t offset) const;
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_OSCMESSAGETEMPLATE_H
@@ -0,0 +1,194 @@
+/// \file OrientationFilter.cpp
+/// \brief 加速度と角速度から姿勢をクォータニオンで推定するフィルタ (Madgwick / Mahony)
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "OrientationFilter.h"
+
+namespace {
+    const float degToRad = 0.017453292519943295f;
+    const float radToDeg = 57.295779513082320f;
+}
+
+OrientationFilter::OrientationFilter() : q{1.0f, 0.0f, 0.0f, 0.0f} {}
+
+void OrientationFilter::setup(Algorithm algorithm_, float gain_, float integralGain_) {
+    algorithm = algorithm_;
+    gain = gain_;
+    integralGain = integralGain_;
+    integralError = {0.0f, 0.0f, 0.0f};
+}
+
+void OrientationFilter::reset(float ax, float ay, float az) {
+    // 初期化時だけ三角関数を使う
+    const float roll = atan2f(ay, az);
+    const float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+    const float cr = cosf(roll * 0.5f);
+    const float sr = sinf(roll * 0.5f);
+    const float cp = cosf(pitch * 0.5f);
+    const float sp = sinf(pitch * 0.5f);
+    q = {cr * cp, sr * cp, cr * sp, -sr * sp};
+    integralError = {0.0f, 0.0f, 0.0f};
+}
+
+void OrientationFilter::update(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    gx *= degToRad;
+    gy *= degToRad;
+    gz *= degToRad;
+
+    if (algorithm == Algorithm::Mahony) {
+        updateMahony(gx, gy, gz, ax, ay, az, dt);
+    } else {
+        updateMadgwick(gx, gy, gz, ax, ay, az, dt);
+    }
+}
+
+void OrientationFilter::updateMadgwick(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+
+    // 角速度によるクォータニオンの変化率
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    // 加速度が0 (自由落下) のときは補正しない
+    const float accNorm = ax * ax + ay * ay + az * az;
+    if (accNorm > 0.0f) {
+        const float accRecip = fastInvSqrt(accNorm);
+        ax *= accRecip;
+        ay *= accRecip;
+        az *= accRecip;
+
+        const float _2q0 = 2.0f * q0;
+        const float _2q1 = 2.0f * q1;
+        const float _2q2 = 2.0f * q2;
+        const float _2q3 = 2.0f * q3;
+        const float _4q0 = 4.0f * q0;
+        const float _4q1 = 4.0f * q1;
+        const float _4q2 = 4.0f * q2;
+        const float _8q1 = 8.0f * q1;
+        const float _8q2 = 8.0f * q2;
+        const float q0q0 = q0 * q0;
+        const float q1q1 = q1 * q1;
+        const float q2q2 = q2 * q2;
+        const float q3q3 = q3 * q3;
+
+        // 推定した重力方向と測定値の誤差関数の勾配
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+        const float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (sNorm > 0.0f) {
+            const float sRecip = fastInvSqrt(sNorm);
+            s0 *= sRecip;
+            s1 *= sRecip;
+            s2 *= sRecip;
+            s3 *= sRecip;
+
+            qDot0 -= gain * s0;
+            qDot1 -= gain * s1;
+            qDot2 -= gain * s2;
+            qDot3 -= gain * s3;
+        }
+    }
+
+    q[0] = q0 + qDot0 * dt;
+    q[1] = q1 + qDot1 * dt;
+    q[2] = q2 + qDot2 * dt;
+    q[3] = q3 + qDot3 * dt;
+    normalize();
+}
+
+void OrientationFilter::updateMahony(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    const float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+
+    const float accNorm = ax * ax + ay * ay + az * az;
+    if (accNorm > 0.0f) {
+        const float accRecip = fastInvSqrt(accNorm);
+        ax *= accRecip;
+        ay *= accRecip;
+        az *= accRecip;
+
+        // 推定した重力方向 (の半分)
+        const float halfVx = q1 * q3 - q0 * q2;
+        const float halfVy = q0 * q1 + q2 * q3;
+        const float halfVz = q0 * q0 - 0.5f + q3 * q3;
+
+        // 測定した重力方向との外積が回転誤差になる
+        const float halfEx = ay * halfVz - az * halfVy;
+        const float halfEy = az * halfVx - ax * halfVz;
+        const float halfEz = ax * halfVy - ay * halfVx;
+
+        if (integralGain > 0.0f) {
+            integralError[0] += 2.0f * integralGain * halfEx * dt;
+            integralError[1] += 2.0f * integralGain * halfEy * dt;
+            integralError[2] += 2.0f * integralGain * halfEz * dt;
+            gx += integralError[0];
+            gy += integralError[1];
+            gz += integralError[2];
+        }
+
+        gx += 2.0f * gain * halfEx;
+        gy += 2.0f * gain * halfEy;
+        gz += 2.0f * gain * halfEz;
+    }
+
+    const float halfDt = 0.5f * dt;
+    gx *= halfDt;
+    gy *= halfDt;
+    gz *= halfDt;
+    q[0] = q0 - q1 * gx - q2 * gy - q3 * gz;
+    q[1] = q1 + q0 * gx + q2 * gz - q3 * gy;
+    q[2] = q2 + q0 * gy - q1 * gz + q3 * gx;
+    q[3] = q3 + q0 * gz + q1 * gy - q2 * gx;
+    normalize();
+}
+
+void OrientationFilter::normalize() {
+    const float recip = fastInvSqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    q[0] *= recip;
+    q[1] *= recip;
+    q[2] *= recip;
+    q[3] *= recip;
+}
+
+const std::array<float, 4> &OrientationFilter::getQuaternion() const {
+    return q;
+}
+
+std::array<float, 3> OrientationFilter::getEuler() const {
+    const float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    float sinPitch = 2.0f * (q0 * q2 - q3 * q1);
+    sinPitch = sinPitch > 1.0f ? 1.0f : (sinPitch < -1.0f ? -1.0f : sinPitch);
+    return {
+            atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * radToDeg,
+            asinf(sinPitch) * radToDeg,
+            atan2f(2.0f * (q0 * q3 + q1 * q2), 1.0f - 2.0f * (q2 * q2 + q3 * q3)) * radToDeg
+    };
+}
+
+std::array<float, 3> OrientationFilter::getLinearAcceleration(float ax, float ay, float az) const {
+    // ワールド座標の重力 (0, 0, 1) をセンサ座標に戻して差し引く
+    const float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    return {
+            ax - 2.0f * (q1 * q3 - q0 * q2),
+            ay - 2.0f * (q0 * q1 + q2 * q3),
+            az - (q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3)
+    };
+}
+
+float OrientationFilter::fastInvSqrt(float x) {
+    // 指数部を半分にした初期値からニュートン法を2回
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5f375a86u - (bits >> 1);
+    float y;
+    memcpy(&y, &bits, sizeof(y));
+    const float halfX = 0.5f * x;
+    y = y * (1.5f - halfX * y * y);
+    y = y * (1.5f - halfX * y * y);
+    return y;
+}
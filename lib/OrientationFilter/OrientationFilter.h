@@ -0,0 +1,66 @@
+/// \file OrientationFilter.h
+/// \brief 加速度と角速度から姿勢をクォータニオンで推定するフィルタ (Madgwick / Mahony)
+///
+/// 更新処理は四則演算と高速逆平方根だけで行い，三角関数は使わない．
+/// 姿勢をクォータニオンで持つので，ロール・ピッチが ±90° を超えても破綻しない．
+/// Arduinoに依存しないのでホスト側でもそのまま使える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_ORIENTATIONFILTER_H
+#define CCBT_KOROGARU_KOEN_PARK_ORIENTATIONFILTER_H
+
+#include <array>
+
+
+class OrientationFilter {
+public:
+    /// Madgwick: 勾配降下法で重力方向の誤差を補正する
+    /// Mahony:   重力方向の誤差をPI制御で角速度に帰還する
+    enum class Algorithm {
+        Madgwick,
+        Mahony
+    };
+
+    OrientationFilter();
+
+    /// \param algorithm 推定アルゴリズム
+    /// \param gain Madgwick の beta / Mahony の比例ゲイン Kp
+    /// \param integralGain Mahony の積分ゲイン Ki (Madgwick では使わない)
+    void setup(Algorithm algorithm, float gain, float integralGain = 0.0f);
+
+    /// 加速度から傾きを求めて初期姿勢とする (ヨーは 0)
+    void reset(float ax, float ay, float az);
+
+    /// \param gx,gy,gz 角速度 [deg/s]
+    /// \param ax,ay,az 加速度 [G]
+    /// \param dt 前回からの経過時間 [s]
+    void update(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+    /// センサ座標からワールド座標への回転 (w, x, y, z)
+    const std::array<float, 4> &getQuaternion() const;
+
+    /// ロール (x軸回り)・ピッチ (y軸回り)・ヨー (z軸回り) [deg]
+    std::array<float, 3> getEuler() const;
+
+    /// 重力成分を除いた加速度 (センサ座標) [G]
+    std::array<float, 3> getLinearAcceleration(float ax, float ay, float az) const;
+
+    /// 1 / sqrt(x) の近似 (x > 0, 相対誤差 5e-6 程度)
+    static float fastInvSqrt(float x);
+
+private:
+    Algorithm algorithm = Algorithm::Madgwick;
+    float gain = 0.1f;
+    float integralGain = 0.0f;
+
+    std::array<float, 4> q{};
+    std::array<float, 3> integralError{};
+
+    void updateMadgwick(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+    void updateMahony(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+    void normalize();
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_ORIENTATIONFILTER_H
@@ -0,0 +1,121 @@
+/// \file PerfMonitor.cpp
+/// \brief ホットパスの実行時間・起床周期・送信時間を esp_timer で計測するクラス
+
+#include <algorithm>
+#include "PerfMonitor.h"
+
+#if PERF_ENABLED
+
+std::array<PerfMonitor::Histogram, PerfMonitor::numMetrics> PerfMonitor::histograms;
+
+const char *PerfMonitor::getName(Metric metric) {
+    switch (metric) {
+        case Metric::ImuWake:
+            return "imu_wake";
+        case Metric::ImuUpdate:
+            return "imu_update";
+        case Metric::MicWake:
+            return "mic_wake";
+        case Metric::MicProcess:
+            return "mic_process";
+        case Metric::ImuOscWake:
+            return "imu_osc_wake";
+        case Metric::MicOscWake:
+            return "mic_osc_wake";
+        case Metric::OscSend:
+            return "osc_send";
+        default:
+            return "unknown";
+    }
+}
+
+uint32_t PerfMonitor::now() {
+    return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+void PerfMonitor::record(Metric metric, uint32_t startUs) {
+    add(histograms[static_cast<size_t>(metric)], now() - startUs);
+}
+
+void PerfMonitor::wake(Metric metric, uint32_t nominalUs) {
+    // 起床周期は同じタスクからしか呼ばれないので lastWake は排他しなくてよい
+    auto &histogram = histograms[static_cast<size_t>(metric)];
+    const uint32_t current = now();
+    const uint32_t last = histogram.lastWake;
+    histogram.lastWake = current;
+    if (last == 0) {
+        return;
+    }
+
+    const uint32_t us = current - last;
+    add(histogram, us);
+    if (us > nominalUs + nominalUs / 2) {
+        histogram.missed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PerfMonitor::Summary PerfMonitor::report(Metric metric) {
+    auto &histogram = histograms[static_cast<size_t>(metric)];
+
+    // 集計中にも記録は続くので，取り出すと同時にゼロに戻す
+    std::array<uint32_t, numBuckets> counts{};
+    uint32_t total = 0;
+    for (size_t i = 0; i < numBuckets; i++) {
+        counts[i] = histogram.buckets[i].exchange(0, std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Summary summary{};
+    summary.count = total;
+    summary.maxUs = histogram.maxUs.exchange(0, std::memory_order_relaxed);
+    summary.missed = histogram.missed.exchange(0, std::memory_order_relaxed);
+    if (total == 0) {
+        return summary;
+    }
+
+    const uint32_t p50 = (total * 50 + 99) / 100;
+    const uint32_t p90 = (total * 90 + 99) / 100;
+    const uint32_t p99 = (total * 99 + 99) / 100;
+    uint32_t cumulative = 0;
+    for (size_t i = 0; i < numBuckets; i++) {
+        const uint32_t before = cumulative;
+        cumulative += counts[i];
+        const uint32_t value = std::min(fromBucket(i), summary.maxUs);
+        if (before < p50 && cumulative >= p50) summary.p50Us = value;
+        if (before < p90 && cumulative >= p90) summary.p90Us = value;
+        if (before < p99 && cumulative >= p99) summary.p99Us = value;
+    }
+    return summary;
+}
+
+void PerfMonitor::add(Histogram &histogram, uint32_t us) {
+    histogram.buckets[toBucket(us)].fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t currentMax = histogram.maxUs.load(std::memory_order_relaxed);
+    while (us > currentMax &&
+           !histogram.maxUs.compare_exchange_weak(currentMax, us, std::memory_order_relaxed)) {
+    }
+}
+
+size_t PerfMonitor::toBucket(uint32_t us) {
+    // 0 - 15 us は 1 us 刻み，それ以上は1オクターブを4分割する (相対誤差 25% 以内)
+    if (us < 16) {
+        return us;
+    }
+    const auto octave = static_cast<size_t>(31 - __builtin_clz(us));
+    const size_t sub = (us >> (octave - 2)) & 3;
+    const size_t bucket = 16 + (octave - 4) * 4 + sub;
+    return bucket < numBuckets ? bucket : numBuckets - 1;
+}
+
+uint32_t PerfMonitor::fromBucket(size_t bucket) {
+    // バケットの上端を代表値とする
+    if (bucket < 16) {
+        return bucket;
+    }
+    const size_t octave = (bucket - 16) / 4 + 4;
+    const size_t sub = (bucket - 16) % 4;
+    return ((4 + sub + 1) << (octave - 2)) - 1;
+}
+
+#endif
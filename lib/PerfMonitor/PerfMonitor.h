@@ -0,0 +1,107 @@
+/// \file PerfMonitor.h
+/// \brief ホットパスの実行時間・起床周期・送信時間を esp_timer で計測するクラス
+///
+/// 計測値は固定長のヒストグラムに積み，report() でパーセンタイルにまとめる．
+/// 省電力でCPUクロックが変わってもサイクル数の換算がずれないよう，時刻は esp_timer の [us] で取る．
+/// RELEASE ビルドでは PERF_* マクロが空になり，計測コードは一切残らない．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_PERFMONITOR_H
+#define CCBT_KOROGARU_KOEN_PARK_PERFMONITOR_H
+
+#ifndef RELEASE
+#define PERF_ENABLED 1
+#else
+#define PERF_ENABLED 0
+#endif
+
+#include <array>
+#include <atomic>
+#include <Arduino.h>
+#include <esp_timer.h>
+
+
+class PerfMonitor {
+public:
+    enum class Metric : size_t {
+        ImuWake,        // imuTask の起床周期
+        ImuUpdate,      // IMUManager::update() の実行時間
+        MicWake,        // micTask がブロックを読み出せた起床の間隔
+        MicProcess,     // processSignal() の実行時間
+        ImuOscWake,     // sendImuOscTask の起床周期
+        MicOscWake,     // sendMicOscTask の起床周期
+        OscSend,        // UDPパケット1つの送信時間
+        Count
+    };
+
+    static const size_t numMetrics = static_cast<size_t>(Metric::Count);
+    static const size_t numBuckets = 64;
+
+    struct Summary {
+        uint32_t count;
+        uint32_t p50Us;
+        uint32_t p90Us;
+        uint32_t p99Us;
+        uint32_t maxUs;
+        uint32_t missed;   // 起床周期が規定の1.5倍を超えた回数
+    };
+
+    static const char *getName(Metric metric);
+
+    /// 現在時刻 [us] (下位32bit．差だけを使う)
+    static uint32_t now();
+
+    /// 経過時間を記録する
+    static void record(Metric metric, uint32_t startUs);
+
+    /// 起床周期を記録する
+    /// \param nominalUs 規定の周期 [us]
+    static void wake(Metric metric, uint32_t nominalUs);
+
+    /// 前回の report() からの集計を返し，ヒストグラムをリセットする
+    static Summary report(Metric metric);
+
+private:
+    struct Histogram {
+        std::array<std::atomic<uint32_t>, numBuckets> buckets;
+        std::atomic<uint32_t> maxUs;
+        std::atomic<uint32_t> missed;
+        uint32_t lastWake;
+    };
+
+    static std::array<Histogram, numMetrics> histograms;
+
+    static void add(Histogram &histogram, uint32_t us);
+
+    static size_t toBucket(uint32_t us);
+
+    static uint32_t fromBucket(size_t bucket);
+};
+
+
+/// スコープの実行時間を記録する
+class PerfScope {
+public:
+    explicit PerfScope(PerfMonitor::Metric metric) : metric(metric), start(PerfMonitor::now()) {}
+
+    ~PerfScope() {
+        PerfMonitor::record(metric, start);
+    }
+
+private:
+    PerfMonitor::Metric metric;
+    uint32_t start;
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+
+#if PERF_ENABLED
+#define PERF_SCOPE(metric) PerfScope PERF_CONCAT(perfScope, __LINE__)(PerfMonitor::Metric::metric)
+#define PERF_WAKE(metric, nominalUs) PerfMonitor::wake(PerfMonitor::Metric::metric, nominalUs)
+#else
+#define PERF_SCOPE(metric)
+#define PERF_WAKE(metric, nominalUs)
+#endif
+
+#endif //CCBT_KOROGARU_KOEN_PARK_PERFMONITOR_H
@@ -0,0 +1,86 @@
+/// \file PowerGovernor.cpp
+/// \brief IMUの静止時間から電力状態 (Active / Idle / Sleep) を決めるクラス
+
+#include "PowerGovernor.h"
+
+PowerGovernor::PowerGovernor() : state(static_cast<uint8_t>(PowerState::Active)), enteredMs(0), wakeups(0) {
+    for (auto &r: residencyMs) {
+        r = 0;
+    }
+}
+
+void PowerGovernor::setup(uint32_t idle, uint32_t sleep, uint32_t nowMs) {
+    idleAfterMs = idle;
+    sleepAfterMs = sleep;
+    wokenMs = nowMs;
+    state = static_cast<uint8_t>(PowerState::Active);
+    enteredMs = nowMs;
+}
+
+bool PowerGovernor::update(uint32_t stillMs, uint32_t nowMs) {
+    // 割り込みで起こされた後は，その時刻から静止時間を数え直す
+    const uint32_t sinceWake = nowMs - wokenMs;
+    if (stillMs > sinceWake) {
+        stillMs = sinceWake;
+    }
+
+    PowerState next = PowerState::Active;
+    if (stillMs >= sleepAfterMs) {
+        next = PowerState::Sleep;
+    } else if (stillMs >= idleAfterMs) {
+        next = PowerState::Idle;
+    }
+    return enter(next, nowMs);
+}
+
+bool PowerGovernor::wake(uint32_t nowMs) {
+    wokenMs = nowMs;
+    return enter(PowerState::Active, nowMs);
+}
+
+PowerState PowerGovernor::getState() const {
+    return static_cast<PowerState>(state.load());
+}
+
+uint32_t PowerGovernor::getResidencyMs(PowerState s, uint32_t nowMs) const {
+    const auto index = static_cast<size_t>(s);
+    if (index >= numPowerStates) {
+        return 0;
+    }
+    uint32_t total = residencyMs[index];
+    if (state == index) {
+        total += nowMs - enteredMs;
+    }
+    return total;
+}
+
+uint32_t PowerGovernor::getWakeups() const {
+    return wakeups;
+}
+
+const char *PowerGovernor::getName(PowerState s) {
+    switch (s) {
+        case PowerState::Active:
+            return "active";
+        case PowerState::Idle:
+            return "idle";
+        case PowerState::Sleep:
+            return "sleep";
+        default:
+            return "";
+    }
+}
+
+bool PowerGovernor::enter(PowerState next, uint32_t nowMs) {
+    const auto current = static_cast<PowerState>(state.load());
+    if (next == current) {
+        return false;
+    }
+    residencyMs[static_cast<size_t>(current)] += nowMs - enteredMs;
+    enteredMs = nowMs;
+    state = static_cast<uint8_t>(next);
+    if (next == PowerState::Active) {
+        wakeups++;
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+/// \file PowerGovernor.h
+/// \brief IMUの静止時間から電力状態 (Active / Idle / Sleep) を決めるクラス
+///
+/// - Active: 通常の周期で取得・送信する
+/// - Idle:   idleAfterMs 以上静止が続いた状態
+/// - Sleep:  sleepAfterMs 以上静止が続いた状態
+/// 動き出したら (IMUの値か Wake-on-Motion 割り込み) 直ちに Active に戻す．
+/// 状態ごとに何をするか (周期・CPUクロック・スリープ) は呼び出し側で決める．
+///
+/// update()・wake() は1つのタスクから呼ぶ．状態と滞在時間は他のタスクから読んでもよい．
+/// Arduinoに依存しないのでホスト側でもそのまま使える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_POWERGOVERNOR_H
+#define CCBT_KOROGARU_KOEN_PARK_POWERGOVERNOR_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+enum class PowerState : uint8_t {
+    Active,
+    Idle,
+    Sleep,
+    Count
+};
+
+const size_t numPowerStates = static_cast<size_t>(PowerState::Count);
+
+
+class PowerGovernor {
+public:
+    PowerGovernor();
+
+    /// \param idleAfterMs この時間以上静止が続いたら Idle にする
+    /// \param sleepAfterMs この時間以上静止が続いたら Sleep にする
+    void setup(uint32_t idleAfterMs, uint32_t sleepAfterMs, uint32_t nowMs);
+
+    /// IMUの静止時間から状態を更新する
+    /// \param stillMs 静止が続いている時間 (動いていれば 0)
+    /// \return 状態が変わった場合 true
+    bool update(uint32_t stillMs, uint32_t nowMs);
+
+    /// 動き出したことを知らせる (Wake-on-Motion 割り込み)
+    /// 以降の静止時間はこの時刻から数え直す
+    /// \return 状態が変わった場合 true
+    bool wake(uint32_t nowMs);
+
+    PowerState getState() const;
+
+    /// 起動時からの状態ごとの滞在時間 [ms]
+    uint32_t getResidencyMs(PowerState state, uint32_t nowMs) const;
+
+    /// Idle・Sleep から Active に戻った回数
+    uint32_t getWakeups() const;
+
+    static const char *getName(PowerState state);
+
+private:
+    uint32_t idleAfterMs = 0;
+    uint32_t sleepAfterMs = 0;
+    uint32_t wokenMs = 0;
+
+    std::atomic<uint8_t> state;
+    std::atomic<uint32_t> enteredMs;
+    std::array<std::atomic<uint32_t>, numPowerStates> residencyMs;
+    std::atomic<uint32_t> wakeups;
+
+    bool enter(PowerState next, uint32_t nowMs);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_POWERGOVERNOR_H
@@ -0,0 +1,69 @@
+/// \file SnapshotBuffer.h
+/// \brief 1つの書き込みタスクから複数の読み出しタスクへ値を渡すロックフリーなダブルバッファ
+///
+/// 書き込み側はスロットを交互に使い，スロットごとのシーケンス番号 (seqlock) で
+/// 書き込み中かどうかを示す．読み出し側は最新の書き込み済みスロットをコピーし，
+/// コピー中に上書きされていた場合だけやり直す．
+/// 書き込み側が書き込み途中で横取りされても，もう一方のスロットは完結しているので
+/// 読み出し側が書き込み側を待ち続けることはない．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_SNAPSHOTBUFFER_H
+#define CCBT_KOROGARU_KOEN_PARK_SNAPSHOTBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+
+template<typename T>
+class SnapshotBuffer {
+public:
+    SnapshotBuffer() : slots(), latest(0) {}
+
+    /// 値を公開する（書き込みタスクは1つだけであること）
+    void publish(const T &value) {
+        const uint32_t next = latest.load(std::memory_order_relaxed) + 1;
+        Slot &slot = slots[next & 1];
+
+        const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.value = value;
+
+        slot.seq.store(seq + 2, std::memory_order_release);
+        latest.store(next, std::memory_order_release);
+    }
+
+    /// 最新の値をコピーして返す（ブロックしない）
+    T read() const {
+        while (true) {
+            const Slot &slot = slots[latest.load(std::memory_order_acquire) & 1];
+
+            const uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+
+            T value = slot.value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.seq.load(std::memory_order_relaxed) == before) {
+                return value;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        Slot() : seq(0), value() {}
+
+        std::atomic<uint32_t> seq;
+        T value;
+    };
+
+    Slot slots[2];
+    std::atomic<uint32_t> latest;
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_SNAPSHOTBUFFER_H
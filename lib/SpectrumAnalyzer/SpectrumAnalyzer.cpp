@@ -0,0 +1,166 @@
+/// \file SpectrumAnalyzer.cpp
+/// \brief マイク入力を窓掛け実数FFTし，対数間隔の帯域エネルギー・スペクトル重心・フラックスを求めるクラス
+
+#include <cmath>
+#include <cstring>
+#include "AudioDSP.h"
+#include "SpectrumAnalyzer.h"
+
+namespace {
+    const float twoPi = 6.28318530718f;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer() = default;
+
+void SpectrumAnalyzer::setup(float rate, float minFrequency) {
+    sampleRate = rate;
+
+    // 回転因子 W_N^k = exp(-2πik/N), k < N/2
+    for (size_t k = 0; k < halfSize; k++) {
+        const float angle = -twoPi * k / fftSize;
+        cosTable[k] = cosf(angle);
+        sinTable[k] = sinf(angle);
+    }
+
+    // Hann窓
+    auto windowSum = 0.0f;
+    for (size_t n = 0; n < fftSize; n++) {
+        window[n] = 0.5f - 0.5f * cosf(twoPi * n / fftSize);
+        windowSum += window[n];
+    }
+
+    // 片側スペクトルのパワーを振幅 32768 の正弦波で 0 dB になるよう正規化する
+    powerScale = 4.0f / (windowSum * windowSum * 32768.0f * 32768.0f);
+
+    // N/2 点の複素FFT用のビット反転表
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < halfSize) {
+        bits++;
+    }
+    for (size_t n = 0; n < halfSize; n++) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; b++) {
+            reversed |= ((n >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[n] = reversed;
+    }
+
+    // 対数間隔の帯域境界 (ビン番号)．各帯域が最低1ビンを持つようにする
+    const float binHz = sampleRate / fftSize;
+    const float maxFrequency = sampleRate / 2;
+    for (size_t b = 0; b <= numBands; b++) {
+        const float frequency = minFrequency * powf(maxFrequency / minFrequency, static_cast<float>(b) / numBands);
+        auto bin = static_cast<size_t>(lroundf(frequency / binHz));
+        if (b > 0 && bin <= bandEdges[b - 1]) {
+            bin = bandEdges[b - 1] + 1;
+        }
+        if (bin > halfSize) {
+            bin = halfSize;
+        }
+        bandEdges[b] = bin;
+    }
+
+    history.fill(0);
+    lastMagnitude.fill(0);
+}
+
+void SpectrumAnalyzer::push(const int16_t *samples, size_t count) {
+    if (count >= fftSize) {
+        memcpy(history.data(), samples + count - fftSize, sizeof(history));
+        return;
+    }
+    memmove(history.data(), history.data() + count, (fftSize - count) * sizeof(int16_t));
+    memcpy(history.data() + fftSize - count, samples, count * sizeof(int16_t));
+}
+
+const SpectrumAnalyzer::Result &SpectrumAnalyzer::analyze() {
+    transform();
+    computePower();
+
+    // 帯域ごとの平均パワー
+    for (size_t b = 0; b < numBands; b++) {
+        auto sum = 0.0f;
+        for (size_t k = bandEdges[b]; k < bandEdges[b + 1]; k++) {
+            sum += power[k];
+        }
+        const auto width = static_cast<float>(bandEdges[b + 1] - bandEdges[b]);
+        result.bands[b] = 10.0f * AudioDSP::fastLog10(sum / width + 1e-12f);
+    }
+
+    // スペクトル重心とフラックス（DC成分は除く）
+    const float binHz = sampleRate / fftSize;
+    auto weighted = 0.0f;
+    auto total = 0.0f;
+    auto flux = 0.0f;
+    for (size_t k = 1; k < numBins; k++) {
+        weighted += k * binHz * power[k];
+        total += power[k];
+
+        const float diff = magnitude[k] - lastMagnitude[k];
+        if (diff > 0.0f) {
+            flux += diff;
+        }
+    }
+    lastMagnitude = magnitude;
+
+    result.centroid = total > 0.0f ? weighted / total : 0.0f;
+    result.flux = flux;
+    return result;
+}
+
+const SpectrumAnalyzer::Result &SpectrumAnalyzer::getResult() const {
+    return result;
+}
+
+void SpectrumAnalyzer::transform() {
+    // 実数 N 点を複素 N/2 点に詰め (偶数番目を実部，奇数番目を虚部)，
+    // 窓掛けとビット反転並べ替えを読み込み時に同時に行う
+    for (size_t n = 0; n < halfSize; n++) {
+        const size_t i = bitReverse[n];
+        re[i] = history[2 * n] * window[2 * n];
+        im[i] = history[2 * n + 1] * window[2 * n + 1];
+    }
+
+    // 基数2 の in-place バタフライ
+    for (size_t length = 2; length <= halfSize; length <<= 1) {
+        const size_t half = length / 2;
+        const size_t stride = fftSize / length;
+        for (size_t start = 0; start < halfSize; start += length) {
+            for (size_t j = 0; j < half; j++) {
+                const float wr = cosTable[j * stride];
+                const float wi = sinTable[j * stride];
+                const size_t a = start + j;
+                const size_t b = a + half;
+                const float tr = re[b] * wr - im[b] * wi;
+                const float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+void SpectrumAnalyzer::computePower() {
+    // 複素 N/2 点の結果 Z から実数 N 点のスペクトル X を取り出す
+    //   X[k] = (Z[k] + Z*[M-k]) / 2 + W_N^k (Z[k] - Z*[M-k]) / 2i
+    power[0] = (re[0] + im[0]) * (re[0] + im[0]) * powerScale;
+    power[halfSize] = (re[0] - im[0]) * (re[0] - im[0]) * powerScale;
+
+    for (size_t k = 1; k < halfSize; k++) {
+        const size_t m = halfSize - k;
+        const float evenRe = 0.5f * (re[k] + re[m]);
+        const float evenIm = 0.5f * (im[k] - im[m]);
+        const float oddRe = 0.5f * (im[k] + im[m]);
+        const float oddIm = -0.5f * (re[k] - re[m]);
+
+        const float xr = evenRe + cosTable[k] * oddRe - sinTable[k] * oddIm;
+        const float xi = evenIm + cosTable[k] * oddIm + sinTable[k] * oddRe;
+        power[k] = (xr * xr + xi * xi) * powerScale;
+    }
+
+    for (size_t k = 0; k < numBins; k++) {
+        magnitude[k] = sqrtf(power[k]);
+    }
+}
@@ -0,0 +1,69 @@
+/// \file SpectrumAnalyzer.h
+/// \brief マイク入力を窓掛け実数FFTし，対数間隔の帯域エネルギー・スペクトル重心・フラックスを求めるクラス
+///
+/// 回転因子・窓関数・ビット反転表は setup() で一度だけ作り，
+/// 解析はすべてメンバの固定長バッファ上で行う（動的確保なし）．
+/// Arduinoに依存しないのでホスト側でもそのまま使える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_SPECTRUMANALYZER_H
+#define CCBT_KOROGARU_KOEN_PARK_SPECTRUMANALYZER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+class SpectrumAnalyzer {
+public:
+    static const size_t fftSize = 512;
+    static const size_t numBands = 8;
+
+    struct Result {
+        std::array<float, numBands> bands;  // 帯域ごとの平均パワー [dBFS]
+        float centroid;                      // スペクトル重心 [Hz]
+        float flux;                          // 前回からの振幅スペクトルの増加量の総和
+    };
+
+    SpectrumAnalyzer();
+
+    /// \param sampleRate サンプリング周波数 [Hz]
+    /// \param minFrequency 最も低い帯域の下端 [Hz] (上端はナイキスト周波数)
+    void setup(float sampleRate, float minFrequency);
+
+    /// 解析窓にサンプルを追加する（古いサンプルから押し出される）
+    void push(const int16_t *samples, size_t count);
+
+    /// 現在の解析窓を解析する
+    const Result &analyze();
+
+    const Result &getResult() const;
+
+private:
+    static const size_t halfSize = fftSize / 2;
+    static const size_t numBins = halfSize + 1;
+
+    float sampleRate = 0.0f;
+    float powerScale = 0.0f;
+
+    std::array<int16_t, fftSize> history{};
+    std::array<float, fftSize> window{};
+    std::array<float, halfSize> cosTable{};
+    std::array<float, halfSize> sinTable{};
+    std::array<uint16_t, halfSize> bitReverse{};
+    std::array<uint16_t, numBands + 1> bandEdges{};
+
+    std::array<float, halfSize> re{};
+    std::array<float, halfSize> im{};
+    std::array<float, numBins> power{};
+    std::array<float, numBins> magnitude{};
+    std::array<float, numBins> lastMagnitude{};
+
+    Result result{};
+
+    void transform();
+
+    void computePower();
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_SPECTRUMANALYZER_H
@@ -0,0 +1,69 @@
+/// \file SpscRing.h
+/// \brief 単一プロデューサ・単一コンシューマのロックフリーなリングバッファ
+///
+/// push() は1つのタスクから，pop() は別の1つのタスクからのみ呼ぶこと．
+/// 満杯の時は新しい要素を捨てて getDropped() を増やす．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_SPSCRING_H
+#define CCBT_KOROGARU_KOEN_PARK_SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+template<typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0) {}
+
+    /// 要素を追加する（プロデューサ側）
+    /// \return 満杯で追加できなかった場合 false
+    bool push(const T &item) {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// 最も古い要素を取り出す（コンシューマ側）
+    /// \return 空の場合 false
+    bool pop(T &item) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    /// 満杯で捨てた要素の累計
+    uint32_t getDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<T, N> items{};
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_SPSCRING_H
@@ -0,0 +1,128 @@
+/// \file TaskMonitor.cpp
+/// \brief タスクごと・コアごとのCPU使用率を求めるクラス
+
+#include <esp_timer.h>
+#include "TaskMonitor.h"
+
+TaskMonitor::Busy::Busy(TaskMonitor &monitor_, size_t index_) : monitor(monitor_), index(index_) {
+#if !TASK_MONITOR_RUN_TIME_STATS
+    startUs = esp_timer_get_time();
+#endif
+}
+
+TaskMonitor::Busy::~Busy() {
+#if !TASK_MONITOR_RUN_TIME_STATS
+    if (index < maxTasks) {
+        monitor.busyUs[index] += static_cast<uint32_t>(esp_timer_get_time() - startUs);
+    }
+#endif
+}
+
+TaskMonitor::TaskMonitor() = default;
+
+void TaskMonitor::add(size_t index, TaskHandle_t handle, BaseType_t core) {
+    if (index < maxTasks) {
+        handles[index] = handle;
+        cores[index] = core;
+    }
+#if !TASK_MONITOR_RUN_TIME_STATS
+    // 最初の sample() はタスクを登録したときからの区間にする
+    if (lastSampleUs == 0) {
+        lastSampleUs = esp_timer_get_time();
+    }
+#endif
+}
+
+bool TaskMonitor::sample() {
+#if TASK_MONITOR_RUN_TIME_STATS
+    const bool sampled = sampleRunTimeStats();
+    source = sampled ? Source::RunTimeStats : Source::Unsupported;
+#else
+    const bool sampled = sampleTaskTiming();
+    source = sampled ? Source::TaskTiming : Source::Unsupported;
+#endif
+    return sampled;
+}
+
+TaskMonitor::Source TaskMonitor::getSource() const {
+    return source;
+}
+
+#if TASK_MONITOR_RUN_TIME_STATS
+bool TaskMonitor::sampleRunTimeStats() {
+    uint32_t totalRunTime = 0;
+    const UBaseType_t count = uxTaskGetSystemState(statusBuffer.data(), statusBuffer.size(), &totalRunTime);
+    if (count == 0) {
+        return false;
+    }
+
+    // 各コアは同じ時間だけ時間が進むので，経過時間はコア1つ分の実行時間とみなせる
+    const uint32_t elapsed = totalRunTime - lastTotalRunTime;
+    lastTotalRunTime = totalRunTime;
+    if (elapsed == 0) {
+        return false;
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const auto &status = statusBuffer[i];
+
+        for (size_t t = 0; t < maxTasks; t++) {
+            if (handles[t] != nullptr && handles[t] == status.xHandle) {
+                const uint32_t delta = status.ulRunTimeCounter - lastRunTime[t];
+                lastRunTime[t] = status.ulRunTimeCounter;
+                loads[t].cpuPercent = 100.0f * delta / elapsed;
+                loads[t].stackHighWaterMark = status.usStackHighWaterMark;
+            }
+        }
+
+        for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++) {
+            if (status.xHandle == xTaskGetIdleTaskHandleForCPU(core)) {
+                const uint32_t delta = status.ulRunTimeCounter - lastIdleRunTime[core];
+                lastIdleRunTime[core] = status.ulRunTimeCounter;
+                coreLoads[core] = 100.0f - 100.0f * delta / elapsed;
+            }
+        }
+    }
+    return true;
+}
+#else
+bool TaskMonitor::sampleTaskTiming() {
+    const int64_t nowUs = esp_timer_get_time();
+    const int64_t elapsed = nowUs - lastSampleUs;
+    if (lastSampleUs == 0 || elapsed <= 0) {
+        return false;
+    }
+    lastSampleUs = nowUs;
+
+    coreLoads.fill(0.0f);
+    for (size_t t = 0; t < maxTasks; t++) {
+        if (handles[t] == nullptr) {
+            continue;
+        }
+        loads[t].cpuPercent = 100.0f * busyUs[t].exchange(0) / elapsed;
+        loads[t].stackHighWaterMark = uxTaskGetStackHighWaterMark(handles[t]);
+        if (cores[t] >= 0 && cores[t] < portNUM_PROCESSORS) {
+            coreLoads[cores[t]] += loads[t].cpuPercent;
+        }
+    }
+    return true;
+}
+#endif
+
+float TaskMonitor::getCoreLoad(BaseType_t core) const {
+    if (core < 0 || core >= portNUM_PROCESSORS) {
+        return 0.0f;
+    }
+    return coreLoads[core];
+}
+
+TaskMonitor::TaskLoad TaskMonitor::getTaskLoad(size_t index) const {
+    if (index >= maxTasks) {
+        return TaskLoad{0.0f, 0};
+    }
+    return loads[index];
+}
+
+bool TaskMonitor::isTracked(size_t index) const {
+    return index < maxTasks && handles[index] != nullptr;
+}
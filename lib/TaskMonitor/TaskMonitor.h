@@ -0,0 +1,101 @@
+/// \file TaskMonitor.h
+/// \brief タスクごと・コアごとのCPU使用率を求めるクラス
+///
+/// sdkconfig で CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS が有効ならFreeRTOSの実行時間統計を使う．
+/// 標準の arduino-esp32 のように無効な場合は，各タスクが Busy で囲んだ区間の時間を esp_timer で積算する
+/// (コアの使用率は監視しているタスクの合計で，WiFiなどシステムのタスクは含まない)．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TASKMONITOR_H
+#define CCBT_KOROGARU_KOEN_PARK_TASKMONITOR_H
+
+#include <array>
+#include <atomic>
+#include <Arduino.h>
+
+#if configUSE_TRACE_FACILITY == 1 && configGENERATE_RUN_TIME_STATS == 1
+#define TASK_MONITOR_RUN_TIME_STATS 1
+#else
+#define TASK_MONITOR_RUN_TIME_STATS 0
+#endif
+
+
+class TaskMonitor {
+public:
+    static const size_t maxTasks = 16;
+    static const size_t maxSystemTasks = 32;
+
+    /// 使用率の求め方
+    enum class Source : uint8_t {
+        Unsupported,    // 求められなかった
+        RunTimeStats,   // FreeRTOSの実行時間統計
+        TaskTiming      // Busy で囲んだ区間の時間
+    };
+
+    struct TaskLoad {
+        float cpuPercent;           // 前回の sample() からのコア1つに対する使用率 [%]
+        uint32_t stackHighWaterMark; // スタックの最小空き [byte]
+    };
+
+    /// タスクが処理をしている区間 (待ちを含まない) を囲む
+    /// 実行時間統計が使える場合は何もしない
+    class Busy {
+    public:
+        Busy(TaskMonitor &monitor, size_t index);
+
+        ~Busy();
+
+        Busy(const Busy &) = delete;
+
+        Busy &operator=(const Busy &) = delete;
+
+    private:
+        TaskMonitor &monitor;
+        size_t index;
+        int64_t startUs = 0;
+    };
+
+    TaskMonitor();
+
+    /// 監視するタスクを登録する
+    /// \param core タスクを置いたコア (Busy で測る場合にコアごとに合計する)
+    void add(size_t index, TaskHandle_t handle, BaseType_t core);
+
+    /// 前回の呼び出しからの使用率を計算する
+    /// \return 使用率を求められなかった場合 false
+    bool sample();
+
+    /// sample() で使った求め方
+    Source getSource() const;
+
+    /// コアの使用率 [%] (アイドルタスク以外が動いていた割合)
+    float getCoreLoad(BaseType_t core) const;
+
+    TaskLoad getTaskLoad(size_t index) const;
+
+    bool isTracked(size_t index) const;
+
+private:
+    std::array<TaskHandle_t, maxTasks> handles{};
+    std::array<BaseType_t, maxTasks> cores{};
+    std::array<TaskLoad, maxTasks> loads{};
+
+    std::array<float, portNUM_PROCESSORS> coreLoads{};
+    Source source = Source::Unsupported;
+
+#if TASK_MONITOR_RUN_TIME_STATS
+    std::array<uint32_t, maxTasks> lastRunTime{};
+    std::array<uint32_t, portNUM_PROCESSORS> lastIdleRunTime{};
+    uint32_t lastTotalRunTime = 0;
+    std::array<TaskStatus_t, maxSystemTasks> statusBuffer{};
+
+    bool sampleRunTimeStats();
+#else
+    std::array<std::atomic<uint32_t>, maxTasks> busyUs{};
+    int64_t lastSampleUs = 0;
+
+    bool sampleTaskTiming();
+#endif
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TASKMONITOR_H
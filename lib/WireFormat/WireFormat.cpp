@@ -0,0 +1,91 @@
+/// \file WireFormat.cpp
+/// \brief IMU/MICの1フレームを32バイトに量子化して詰めるバイナリ形式
+
+#include <cmath>
+#include "WireFormat.h"
+
+namespace WireFormat {
+
+    namespace {
+        int16_t quantize(float value, float scale) {
+            const float scaled = roundf(value * scale);
+            if (!(scaled > INT16_MIN)) {
+                return INT16_MIN;  // NaN と -inf もここに入る
+            }
+            return scaled < INT16_MAX ? static_cast<int16_t>(scaled) : INT16_MAX;
+        }
+
+        uint16_t quantizeUnsigned(float value) {
+            const float rounded = roundf(value);
+            if (!(rounded > 0.0f)) {
+                return 0;
+            }
+            return rounded < UINT16_MAX ? static_cast<uint16_t>(rounded) : UINT16_MAX;
+        }
+
+        void write16(uint8_t *p, uint16_t value) {
+            p[0] = value;
+            p[1] = value >> 8;
+        }
+
+        void write32(uint8_t *p, uint32_t value) {
+            p[0] = value;
+            p[1] = value >> 8;
+            p[2] = value >> 16;
+            p[3] = value >> 24;
+        }
+
+        uint16_t read16(const uint8_t *p) {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+
+        uint32_t read32(const uint8_t *p) {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+    }
+
+    size_t encode(const Frame &frame, uint8_t *out) {
+        out[0] = magic;
+        out[1] = version;
+        out[2] = frame.nodeId;
+        out[3] = frame.flags;
+        write32(&out[4], frame.sequence);
+        write32(&out[8], frame.timestampUs);
+        for (size_t i = 0; i < 3; i++) {
+            write16(&out[12 + i * 2], quantize(frame.acc[i], accScale));
+            write16(&out[18 + i * 2], quantize(frame.gyro[i], gyroScale));
+        }
+        for (size_t i = 0; i < 2; i++) {
+            write16(&out[24 + i * 2], quantize(frame.rotation[i], rotationScale));
+        }
+        write16(&out[28], quantizeUnsigned(frame.micPower));
+        write16(&out[30], quantize(frame.micDb, dbScale));
+        return packetSize;
+    }
+
+    bool decode(const uint8_t *data, size_t size, Frame &frame) {
+        if (size != packetSize || data[0] != magic || data[1] != version) {
+            return false;
+        }
+        frame.nodeId = data[2];
+        frame.flags = data[3];
+        frame.sequence = read32(&data[4]);
+        frame.timestampUs = read32(&data[8]);
+        for (size_t i = 0; i < 3; i++) {
+            frame.acc[i] = static_cast<int16_t>(read16(&data[12 + i * 2])) / accScale;
+            frame.gyro[i] = static_cast<int16_t>(read16(&data[18 + i * 2])) / gyroScale;
+        }
+        for (size_t i = 0; i < 2; i++) {
+            frame.rotation[i] = static_cast<int16_t>(read16(&data[24 + i * 2])) / rotationScale;
+        }
+        frame.micPower = read16(&data[28]);
+        const auto db = static_cast<int16_t>(read16(&data[30]));
+        frame.micDb = db == INT16_MIN ? -INFINITY : db / dbScale;
+        return true;
+    }
+
+    bool isWireFormat(const uint8_t *data, size_t size) {
+        return size > 0 && data[0] == magic;
+    }
+}
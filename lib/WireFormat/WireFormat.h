@@ -0,0 +1,67 @@
+/// \file WireFormat.h
+/// \brief IMU/MICの1フレームを32バイトに量子化して詰めるバイナリ形式
+///
+/// OSCではアドレス文字列とパディングが大半を占めるため，
+/// 固定長ヘッダ + int16 に量子化した値だけを1つのUDPパケットで送る．
+/// すべてリトルエンディアン．Arduinoに依存しないのでホスト側 (tools/) でもそのまま使える．
+///
+///  offset size
+///   0     1    magic (0xCB)
+///   1     1    version
+///   2     1    nodeId
+///   3     1    flags (bit0: MICの値を含む)
+///   4     4    sequence   (uint32, フレームごとに1ずつ増える)
+///   8     4    timestampUs (uint32, サンプル取得時刻 micros())
+///  12     6    acc[3]     (int16, 1/4096 G)
+///  18     6    gyro[3]    (int16, 1/16 deg/s)
+///  24     4    rotation[2] (int16, 1/100 deg)
+///  28     2    micPower   (uint16, RMS)
+///  30     2    micDb      (int16, 1/100 dB, -inf は INT16_MIN)
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_WIREFORMAT_H
+#define CCBT_KOROGARU_KOEN_PARK_WIREFORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace WireFormat {
+
+    const uint8_t magic = 0xCB;
+    const uint8_t version = 1;
+    const size_t packetSize = 32;
+
+    const uint8_t flagMic = 0x01;
+
+    // 量子化の分解能 (1単位あたりの物理量の逆数)
+    const float accScale = 4096.0f;     // ±8 G
+    const float gyroScale = 16.0f;      // ±2048 deg/s
+    const float rotationScale = 100.0f; // ±327 deg
+    const float dbScale = 100.0f;       // ±327 dB
+
+    struct Frame {
+        uint8_t nodeId;
+        uint8_t flags;
+        uint32_t sequence;
+        uint32_t timestampUs;
+        std::array<float, 3> acc;
+        std::array<float, 3> gyro;
+        std::array<float, 2> rotation;
+        float micPower;
+        float micDb;
+    };
+
+    /// \param out packetSize バイト以上のバッファ
+    /// \return 書き込んだバイト数 (packetSize)
+    size_t encode(const Frame &frame, uint8_t *out);
+
+    /// \return magic・version・長さが一致しない場合 false
+    bool decode(const uint8_t *data, size_t size, Frame &frame);
+
+    /// 先頭バイトからこの形式のパケットかどうかを判定する (OSCは '/' か '#' で始まる)
+    bool isWireFormat(const uint8_t *data, size_t size);
+}
+
+#endif //CCBT_KOROGARU_KOEN_PARK_WIREFORMAT_H
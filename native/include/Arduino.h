@@ -0,0 +1,225 @@
+/// \file Arduino.h
+/// \brief ホスト (Linux) ビルド用の Arduino API の代替
+///
+/// ファームウェアのソースをそのままホストでビルド・実行するための最小限の実装．
+/// 時刻は std::chrono::steady_clock，シリアル出力は標準出力に対応させる．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_ARDUINO_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_ARDUINO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define PI 3.1415926535897932384626433832795
+#define sq(x) ((x)*(x))
+
+#define IRAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define INPUT_PULLUP 0x05
+#define OUTPUT 0x03
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define WHITE 0xFFFF
+#define BLACK 0x0000
+
+typedef bool boolean;
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+
+unsigned long micros();
+
+void delay(uint32_t ms);
+
+void delayMicroseconds(uint32_t us);
+
+inline void pinMode(uint8_t, uint8_t) {}
+
+inline int digitalRead(uint8_t) { return HIGH; }
+
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+
+/// 割り込みハンドラを登録する (nativeRaiseInterrupt() で呼ばれる)
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+
+void detachInterrupt(uint8_t pin);
+
+/// ホストビルド専用: ピンの割り込みを発生させ，登録されたハンドラを呼ぶ
+void nativeRaiseInterrupt(uint8_t pin);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+
+uint32_t getCpuFrequencyMhz();
+
+
+class String {
+public:
+    String() = default;
+
+    String(const char *str) : value(str != nullptr ? str : "") {}
+
+    String(const std::string &str) : value(str) {}
+
+    String(char c) : value(1, c) {}
+
+    String(int number) : value(std::to_string(number)) {}
+
+    String(unsigned int number) : value(std::to_string(number)) {}
+
+    String(long number) : value(std::to_string(number)) {}
+
+    String(unsigned long number) : value(std::to_string(number)) {}
+
+    String(float number, unsigned int decimals = 2);
+
+    const char *c_str() const { return value.c_str(); }
+
+    unsigned int length() const { return value.size(); }
+
+    bool isEmpty() const { return value.empty(); }
+
+    int toInt() const { return atoi(value.c_str()); }
+
+    float toFloat() const { return atof(value.c_str()); }
+
+    int indexOf(char c, unsigned int from = 0) const;
+
+    int indexOf(const String &str, unsigned int from = 0) const;
+
+    String substring(unsigned int from) const;
+
+    String substring(unsigned int from, unsigned int to) const;
+
+    bool startsWith(const String &prefix) const;
+
+    bool endsWith(const String &suffix) const;
+
+    void trim();
+
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : '\0'; }
+
+    String &operator+=(const String &rhs) {
+        value += rhs.value;
+        return *this;
+    }
+
+    friend String operator+(const String &lhs, const String &rhs) { return String(lhs.value + rhs.value); }
+
+    friend String operator+(const char *lhs, const String &rhs) { return String(std::string(lhs) + rhs.value); }
+
+    friend String operator+(const String &lhs, const char *rhs) { return String(lhs.value + rhs); }
+
+    bool operator==(const String &rhs) const { return value == rhs.value; }
+
+    bool operator!=(const String &rhs) const { return value != rhs.value; }
+
+    bool operator<(const String &rhs) const { return value < rhs.value; }
+
+private:
+    std::string value;
+};
+
+
+class IPAddress {
+public:
+    IPAddress() : bytes{0, 0, 0, 0} {}
+
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+
+    /// ネットワークバイトオーダーの32bit値から作る (ESP32と同じ)
+    IPAddress(uint32_t address);
+
+    bool fromString(const char *address);
+
+    bool fromString(const String &address) { return fromString(address.c_str()); }
+
+    String toString() const;
+
+    /// ネットワークバイトオーダーの32bit値 (ESP32と同じ)
+    operator uint32_t() const;
+
+    uint8_t operator[](int index) const { return bytes[index]; }
+
+    uint8_t &operator[](int index) { return bytes[index]; }
+
+    bool operator==(const IPAddress &rhs) const { return memcmp(bytes, rhs.bytes, 4) == 0; }
+
+    bool operator!=(const IPAddress &rhs) const { return !(*this == rhs); }
+
+private:
+    uint8_t bytes[4];
+};
+
+
+class HardwareSerial {
+public:
+    void begin(unsigned long) {}
+
+    size_t print(const char *str);
+
+    size_t print(const String &str) { return print(str.c_str()); }
+
+    size_t print(char c);
+
+    size_t print(int number);
+
+    size_t print(unsigned int number);
+
+    size_t print(long number);
+
+    size_t print(unsigned long number);
+
+    size_t print(double number, int digits = 2);
+
+    size_t print(const IPAddress &address) { return print(address.toString()); }
+
+    template<typename T>
+    size_t println(const T &value) {
+        const size_t n = print(value);
+        return n + println();
+    }
+
+    size_t println();
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+
+class EspClass {
+public:
+    [[noreturn]] void restart();
+
+    /// CPUのサイクルカウンタ相当 (経過時間 × CPU周波数)
+    uint32_t getCycleCount();
+
+    uint32_t getCpuFreqMHz() { return getCpuFrequencyMhz(); }
+
+    uint32_t getFreeHeap() { return 0; }
+};
+
+extern EspClass ESP;
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_ARDUINO_H
@@ -0,0 +1,68 @@
+/// \file FS.h
+/// \brief ホスト (Linux) ビルド用の FS (File) の代替
+///
+/// ファイルはホストのディレクトリの下にそのまま置く (LittleFS.h)．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_FS_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_FS_H
+
+#include <memory>
+#include <string>
+#include <Arduino.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+    class File {
+    public:
+        File() = default;
+
+        size_t write(const uint8_t *data, size_t size);
+
+        size_t read(uint8_t *data, size_t size);
+
+        void flush();
+
+        void close();
+
+        size_t size() const;
+
+        operator bool() const;
+
+        const char *name() const;
+
+        bool isDirectory() const;
+
+        File openNextFile();
+
+    private:
+        struct Impl;
+        std::shared_ptr<Impl> impl;
+
+        friend class FS;
+    };
+
+    class FS {
+    public:
+        File open(const char *path, const char *mode = FILE_READ, bool create = false);
+
+        bool exists(const char *path);
+
+        bool remove(const char *path);
+
+        bool mkdir(const char *path);
+
+    protected:
+        std::string root;
+
+        std::string hostPath(const char *path) const;
+    };
+}
+
+using fs::File;
+using fs::FS;
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_FS_H
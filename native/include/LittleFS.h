@@ -0,0 +1,28 @@
+/// \file LittleFS.h
+/// \brief ホスト (Linux) ビルド用の LittleFS の代替
+///
+/// パーティションの代わりに環境変数 NATIVE_LITTLEFS のディレクトリ
+/// (指定しなければ /tmp/littlefs-{パーティション名}) を使う．
+/// 容量はファームウェアのパーティション (partitions_capture.csv) と同じとみなす．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_LITTLEFS_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_LITTLEFS_H
+
+#include <FS.h>
+
+class LittleFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false, const char *basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char *partitionLabel = "spiffs");
+
+    void end();
+
+    size_t totalBytes();
+
+    size_t usedBytes();
+};
+
+extern LittleFSFS LittleFS;
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_LITTLEFS_H
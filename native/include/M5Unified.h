@@ -0,0 +1,218 @@
+/// \file M5Unified.h
+/// \brief ホスト (Linux) ビルド用の M5Unified の代替
+///
+/// IMUは時刻から決まる合成モーション (起動後2秒間は静止，その後ゆっくり傾きが揺れる) を返す．
+/// 環境変数 NATIVE_MOTION="動く秒数,止まる秒数" を与えると，動きと静止を交互に繰り返す．
+/// 画面 (スプライトを含む)・ボタン・スピーカーは何もしない．内部I2Cは MPU6886 のデータレジスタの読み出しだけに応じる (FIFOの読み出しは失敗する)．
+/// MPU6886の Wake-on-Motion を有効にすると，静止から動き出した時にINTピン (GPIO35) の割り込みを発生させる．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_M5UNIFIED_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_M5UNIFIED_H
+
+#include <Arduino.h>
+
+#define TFT_BLACK 0x0000
+#define TFT_BLUE 0x001F
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_YELLOW 0xFFE0
+#define TFT_ORANGE 0xFDA0
+#define TFT_DARKGREY 0x7BEF
+#define TFT_WHITE 0xFFFF
+
+namespace fonts {
+    struct IFont {
+    };
+    extern const IFont Font0;
+    extern const IFont Font2;
+    extern const IFont Font4;
+}
+
+/// 描画先の代替 (すべて何もしない)
+class LGFXBase {
+public:
+    void setRotation(uint8_t) {}
+
+    void setBrightness(uint8_t) {}
+
+    void setFont(const fonts::IFont *) {}
+
+    void setTextSize(float) {}
+
+    void setTextColor(uint32_t) {}
+
+    void setTextColor(uint32_t, uint32_t) {}
+
+    void setTextDatum(uint8_t) {}
+
+    void setCursor(int32_t, int32_t) {}
+
+    void startWrite() {}
+
+    void endWrite() {}
+
+    void clear(uint32_t = TFT_BLACK) {}
+
+    void clearDisplay(uint32_t = TFT_BLACK) {}
+
+    void fillScreen(uint32_t) {}
+
+    void fillRect(int32_t, int32_t, int32_t, int32_t, uint32_t) {}
+
+    void drawRect(int32_t, int32_t, int32_t, int32_t, uint32_t) {}
+
+    void drawFastHLine(int32_t, int32_t, int32_t, uint32_t) {}
+
+    void drawFastVLine(int32_t, int32_t, int32_t, uint32_t) {}
+
+    void drawString(const char *, int32_t, int32_t) {}
+
+    int32_t width() const { return 240; }
+
+    int32_t height() const { return 135; }
+
+    int32_t fontHeight() const { return 8; }
+
+    template<typename T>
+    size_t print(const T &) { return 0; }
+
+    template<typename T>
+    size_t println(const T &) { return 0; }
+
+    size_t println() { return 0; }
+
+    size_t printf(const char *, ...) { return 0; }
+};
+
+class M5GFX : public LGFXBase {
+};
+
+class M5Canvas : public LGFXBase {
+public:
+    M5Canvas() = default;
+
+    explicit M5Canvas(LGFXBase *) {}
+
+    void setColorDepth(int) {}
+
+    void *createSprite(int32_t w, int32_t h) {
+        spriteWidth = w;
+        spriteHeight = h;
+        return this;
+    }
+
+    void deleteSprite() {}
+
+    void pushSprite(int32_t, int32_t) {}
+
+    int32_t width() const { return spriteWidth; }
+
+    int32_t height() const { return spriteHeight; }
+
+private:
+    int32_t spriteWidth = 0;
+    int32_t spriteHeight = 0;
+};
+
+namespace m5 {
+    class I2C_Class {
+    public:
+        /// MPU6886のデータレジスタ (0x3B から14バイト) だけを合成モーションから返す
+        bool readRegister(uint8_t address, uint8_t reg, uint8_t *data, size_t length, uint32_t) const;
+
+        /// MPU6886の割り込みステータスだけを返す (読み出しでクリアされる)
+        uint8_t readRegister8(uint8_t address, uint8_t reg, uint32_t) const;
+
+        bool writeRegister(uint8_t, uint8_t, const uint8_t *, size_t, uint32_t) const { return false; }
+
+        /// MPU6886への書き込みは Wake-on-Motion の設定として記録する
+        bool writeRegister8(uint8_t address, uint8_t reg, uint8_t value, uint32_t) const;
+
+        bool bitOn(uint8_t, uint8_t, uint8_t, uint32_t) const { return false; }
+
+        bool bitOff(uint8_t, uint8_t, uint8_t, uint32_t) const { return false; }
+    };
+
+    class IMU_Class {
+    public:
+        bool init() { return true; }
+
+        bool isEnabled() const { return true; }
+
+        /// 合成モーションの加速度 [G]
+        bool getAccelData(float *ax, float *ay, float *az);
+
+        /// 合成モーションの角速度 [deg/s]
+        bool getGyroData(float *gx, float *gy, float *gz);
+
+        bool getTemp(float *t) {
+            *t = 25.0f;
+            return true;
+        }
+    };
+
+    class Power_Class {
+    public:
+        void begin() {}
+
+        int32_t getBatteryLevel() { return 100; }
+
+        int16_t getBatteryVoltage() { return 4200; }
+
+        int isCharging() { return 1; }
+    };
+
+    class Button_Class {
+    public:
+        bool wasPressed() const { return false; }
+
+        bool wasReleased() const { return false; }
+
+        bool wasClicked() const { return false; }
+
+        bool wasReleaseFor(uint32_t) const { return false; }
+
+        bool isPressed() const { return false; }
+    };
+
+    class Speaker_Class {
+    public:
+        bool begin() { return true; }
+
+        void end() {}
+    };
+
+    class Mic_Class {
+    public:
+        bool begin() { return true; }
+
+        void end() {}
+    };
+
+    class M5Unified {
+    public:
+        void begin() {}
+
+        void update() {}
+
+        M5GFX Display;
+        M5GFX &Lcd = Display;
+        IMU_Class Imu;
+        Power_Class Power;
+        Button_Class BtnA;
+        Button_Class BtnB;
+        Speaker_Class Speaker;
+        Mic_Class Mic;
+        I2C_Class &In_I2C;
+
+        M5Unified();
+    };
+
+    extern I2C_Class In_I2C;
+}
+
+extern m5::M5Unified M5;
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_M5UNIFIED_H
@@ -0,0 +1,73 @@
+/// \file Preferences.h
+/// \brief ホスト (Linux) ビルド用の Preferences (NVS) の代替
+///
+/// 値はプロセス内のメモリに保持する．
+/// 起動時に環境変数 NATIVE_PREFERENCES ("namespace.key=value;..." 形式) から初期値を読み込む．
+/// 例: NATIVE_PREFERENCES="osc.oscServerIp=127.0.0.1;osc.clientName=ccbt2"
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_PREFERENCES_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_PREFERENCES_H
+
+#include <string>
+#include <Arduino.h>
+
+class Preferences {
+public:
+    bool begin(const char *name, bool readOnly = false);
+
+    void end();
+
+    bool clear();
+
+    bool remove(const char *key);
+
+    bool isKey(const char *key);
+
+    size_t putBool(const char *key, bool value);
+
+    size_t putUChar(const char *key, uint8_t value);
+
+    size_t putUShort(const char *key, uint16_t value);
+
+    size_t putInt(const char *key, int32_t value);
+
+    size_t putUInt(const char *key, uint32_t value);
+
+    size_t putFloat(const char *key, float value);
+
+    size_t putString(const char *key, const char *value);
+
+    size_t putString(const char *key, const String &value) { return putString(key, value.c_str()); }
+
+    size_t putBytes(const char *key, const void *value, size_t length);
+
+    bool getBool(const char *key, bool defaultValue = false);
+
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0);
+
+    uint16_t getUShort(const char *key, uint16_t defaultValue = 0);
+
+    int32_t getInt(const char *key, int32_t defaultValue = 0);
+
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+
+    float getFloat(const char *key, float defaultValue = NAN);
+
+    String getString(const char *key, const String &defaultValue = String());
+
+    size_t getBytesLength(const char *key);
+
+    size_t getBytes(const char *key, void *buffer, size_t length);
+
+private:
+    std::string space;
+    bool opened = false;
+    bool readOnly = false;
+
+    bool find(const char *key, std::string &value);
+
+    size_t store(const char *key, const std::string &value);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_PREFERENCES_H
@@ -0,0 +1,80 @@
+/// \file WiFi.h
+/// \brief ホスト (Linux) ビルド用の WiFi の代替
+///
+/// 常に接続済みとして振る舞い，IPアドレスはループバックを返す．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFI_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFI_H
+
+#include <Arduino.h>
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1
+} wifi_mode_t;
+
+typedef enum {
+    WIFI_PS_NONE,
+    WIFI_PS_MIN_MODEM,
+    WIFI_PS_MAX_MODEM
+} wifi_ps_type_t;
+
+class WiFiClass {
+public:
+    static wl_status_t status() { return WL_CONNECTED; }
+
+    static bool mode(wifi_mode_t) { return true; }
+
+    wl_status_t begin(const char *, const char * = nullptr, int32_t = 0, const uint8_t * = nullptr, bool = true) {
+        return WL_CONNECTED;
+    }
+
+    bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(), IPAddress = IPAddress()) { return true; }
+
+    bool disconnect(bool = false, bool = false) { return true; }
+
+    bool reconnect() { return true; }
+
+    bool setSleep(bool) { return true; }
+
+    bool setSleep(wifi_ps_type_t) { return true; }
+
+    bool setAutoReconnect(bool) { return true; }
+
+    bool persistent(bool) { return true; }
+
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+
+    IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+
+    IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+
+    IPAddress dnsIP(uint8_t = 0) { return IPAddress(127, 0, 0, 1); }
+
+    String macAddress() { return String("00:00:00:00:00:00"); }
+
+    String SSID() { return String("native"); }
+
+    int8_t RSSI() { return -50; }
+
+    int32_t channel() { return 1; }
+
+    uint8_t *BSSID() {
+        static uint8_t bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+        return bssid;
+    }
+};
+
+extern WiFiClass WiFi;
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFI_H
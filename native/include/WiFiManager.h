@@ -0,0 +1,62 @@
+/// \file WiFiManager.h
+/// \brief ホスト (Linux) ビルド用の WiFiManager の代替
+///
+/// 設定ポータルは開かず，パラメータは既定値のまま接続に成功したものとして扱う．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFIMANAGER_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFIMANAGER_H
+
+#include <functional>
+#include <string>
+#include <WiFi.h>
+
+class WiFiManagerParameter {
+public:
+    WiFiManagerParameter(const char *id, const char *label, const char *defaultValue, int length)
+            : id(id), value(defaultValue != nullptr ? defaultValue : "") {
+        (void) label;
+        (void) length;
+    }
+
+    const char *getID() const { return id; }
+
+    const char *getValue() const { return value.c_str(); }
+
+private:
+    const char *id;
+    std::string value;
+};
+
+class WiFiManager {
+public:
+    void setConnectRetries(uint8_t) {}
+
+    void setConnectTimeout(unsigned long) {}
+
+    void setConfigPortalTimeout(unsigned long) {}
+
+    void setMinimumSignalQuality(int = 8) {}
+
+    void setSTAStaticIPConfig(IPAddress, IPAddress, IPAddress) {}
+
+    void setSaveConfigCallback(std::function<void()>) {}
+
+    void setEnableConfigPortal(bool) {}
+
+    void setWiFiAutoReconnect(bool) {}
+
+    void addParameter(WiFiManagerParameter *) {}
+
+    String getDefaultAPName() { return String("ESP_native"); }
+
+    String getWiFiSSID(bool = false) { return WiFi.SSID(); }
+
+    String getWiFiPass(bool = false) { return String(); }
+
+    bool autoConnect(const char *) { return true; }
+
+    bool startConfigPortal(const char *) { return true; }
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFIMANAGER_H
@@ -0,0 +1,71 @@
+/// \file WiFiUdp.h
+/// \brief ホスト (Linux) ビルド用の WiFiUDP の代替
+///
+/// POSIXのUDPソケットで実際に送受信する．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFIUDP_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFIUDP_H
+
+#include <vector>
+#include <Arduino.h>
+
+class WiFiUDP {
+public:
+    WiFiUDP() = default;
+
+    ~WiFiUDP();
+
+    WiFiUDP(const WiFiUDP &) = delete;
+
+    WiFiUDP &operator=(const WiFiUDP &) = delete;
+
+    /// \param port 受信ポート (0 の場合は任意のポート)
+    uint8_t begin(uint16_t port);
+
+    void stop();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+
+    int beginPacket(const char *host, uint16_t port);
+
+    size_t write(uint8_t data);
+
+    size_t write(const uint8_t *data, size_t size);
+
+    int endPacket();
+
+    /// 受信パケットがあれば読み出し，そのサイズを返す (ブロックしない)
+    int parsePacket();
+
+    int available();
+
+    int read();
+
+    int read(uint8_t *data, size_t size);
+
+    int read(char *data, size_t size) { return read(reinterpret_cast<uint8_t *>(data), size); }
+
+    /// 読み出し途中の受信パケットを捨てる
+    void flush();
+
+    IPAddress remoteIP() const { return remoteAddress; }
+
+    uint16_t remotePort() const { return remotePortNumber; }
+
+private:
+    int fd = -1;
+
+    IPAddress destinationAddress;
+    uint16_t destinationPort = 0;
+    std::vector<uint8_t> txBuffer;
+
+    IPAddress remoteAddress;
+    uint16_t remotePortNumber = 0;
+    std::vector<uint8_t> rxBuffer;
+    size_t rxPosition = 0;
+
+    bool open();
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_WIFIUDP_H
@@ -0,0 +1,13 @@
+/// \file esp_timer.h
+/// \brief ホスト (Linux) ビルド用の esp_timer の代替 (64bit の経過時間だけ)
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_ESP_TIMER_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_ESP_TIMER_H
+
+#include <cstdint>
+
+/// 起動からの経過時間 [us] (micros() と同じ時計で，32bit で折り返さない)
+int64_t esp_timer_get_time();
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_ESP_TIMER_H
@@ -0,0 +1,14 @@
+/// \file sockets.h
+/// \brief ホスト (Linux) ビルド用の lwIP ソケットAPIの代替 (POSIXのソケットをそのまま使う)
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_NATIVE_LWIP_SOCKETS_H
+#define CCBT_KOROGARU_KOEN_PARK_NATIVE_LWIP_SOCKETS_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#endif //CCBT_KOROGARU_KOEN_PARK_NATIVE_LWIP_SOCKETS_H
@@ -0,0 +1,211 @@
+/// \file Arduino.cpp
+/// \brief ホスト (Linux) ビルド用の Arduino API の代替
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <thread>
+#include <Arduino.h>
+#include <esp_timer.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace {
+    const auto startTime = std::chrono::steady_clock::now();
+    uint32_t cpuFrequencyMhz = 240;
+    std::array<std::atomic<void (*)()>, 40> interruptHandlers{};
+
+    uint64_t elapsedNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - startTime).count();
+    }
+}
+
+unsigned long millis() {
+    return static_cast<unsigned long>(elapsedNs() / 1000000ULL);
+}
+
+unsigned long micros() {
+    // ESP32と同じく32bitで折り返す
+    return static_cast<uint32_t>(elapsedNs() / 1000ULL);
+}
+
+int64_t esp_timer_get_time() {
+    return static_cast<int64_t>(elapsedNs() / 1000ULL);
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+    cpuFrequencyMhz = mhz;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return cpuFrequencyMhz;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(), int) {
+    if (pin < interruptHandlers.size()) {
+        interruptHandlers[pin] = handler;
+    }
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < interruptHandlers.size()) {
+        interruptHandlers[pin] = nullptr;
+    }
+}
+
+void nativeRaiseInterrupt(uint8_t pin) {
+    if (pin >= interruptHandlers.size()) {
+        return;
+    }
+    const auto handler = interruptHandlers[pin].load();
+    if (handler != nullptr) {
+        handler();
+    }
+}
+
+
+// ====== String ======
+String::String(float number, unsigned int decimals) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, number);
+    value = buffer;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    const auto pos = value.find(c, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int String::indexOf(const String &str, unsigned int from) const {
+    const auto pos = value.find(str.value, from);
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+String String::substring(unsigned int from) const {
+    return from < value.size() ? String(value.substr(from)) : String();
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        std::swap(from, to);
+    }
+    return from < value.size() ? String(value.substr(from, to - from)) : String();
+}
+
+bool String::startsWith(const String &prefix) const {
+    return value.compare(0, prefix.value.size(), prefix.value) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+    return value.size() >= suffix.value.size() &&
+           value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+}
+
+void String::trim() {
+    const auto begin = value.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        value.clear();
+        return;
+    }
+    const auto end = value.find_last_not_of(" \t\r\n");
+    value = value.substr(begin, end - begin + 1);
+}
+
+
+// ====== IPAddress ======
+IPAddress::IPAddress(uint32_t address) {
+    memcpy(bytes, &address, 4);
+}
+
+bool IPAddress::fromString(const char *address) {
+    unsigned int a, b, c, d;
+    char rest;
+    if (sscanf(address, "%u.%u.%u.%u%c", &a, &b, &c, &d, &rest) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+        return false;
+    }
+    bytes[0] = a;
+    bytes[1] = b;
+    bytes[2] = c;
+    bytes[3] = d;
+    return true;
+}
+
+String IPAddress::toString() const {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(buffer);
+}
+
+IPAddress::operator uint32_t() const {
+    uint32_t address;
+    memcpy(&address, bytes, 4);
+    return address;
+}
+
+
+// ====== Serial ======
+size_t HardwareSerial::print(const char *str) {
+    return fputs(str, stdout) >= 0 ? strlen(str) : 0;
+}
+
+size_t HardwareSerial::print(char c) {
+    return fputc(c, stdout) != EOF ? 1 : 0;
+}
+
+size_t HardwareSerial::print(int number) {
+    return ::printf("%d", number);
+}
+
+size_t HardwareSerial::print(unsigned int number) {
+    return ::printf("%u", number);
+}
+
+size_t HardwareSerial::print(long number) {
+    return ::printf("%ld", number);
+}
+
+size_t HardwareSerial::print(unsigned long number) {
+    return ::printf("%lu", number);
+}
+
+size_t HardwareSerial::print(double number, int digits) {
+    return ::printf("%.*f", digits, number);
+}
+
+size_t HardwareSerial::println() {
+    const size_t n = print("\r\n");
+    fflush(stdout);
+    return n;
+}
+
+size_t HardwareSerial::printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int n = vprintf(format, args);
+    va_end(args);
+    return n > 0 ? n : 0;
+}
+
+
+// ====== ESP ======
+void EspClass::restart() {
+    fflush(stdout);
+    fprintf(stderr, "ESP.restart() called, exiting\n");
+    exit(1);
+}
+
+uint32_t EspClass::getCycleCount() {
+    return static_cast<uint32_t>(elapsedNs() * cpuFrequencyMhz / 1000ULL);
+}
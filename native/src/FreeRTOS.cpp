@@ -0,0 +1,223 @@
+/// \file FreeRTOS.cpp
+/// \brief ホスト (Linux) ビルド用の FreeRTOS API の代替
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+
+struct NativeTask {
+    std::string name;
+    BaseType_t core;
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint32_t notifyValue = 0;
+};
+
+struct NativeQueue {
+    size_t length;
+    size_t itemSize;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+namespace {
+    const auto startTime = std::chrono::steady_clock::now();
+    thread_local NativeTask *currentTask = nullptr;
+
+    std::chrono::steady_clock::time_point deadline(TickType_t ticks) {
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks);
+    }
+
+    /// 条件が満たされるまで最大 ticks 待つ (portMAX_DELAY は無期限)
+    template<typename Predicate>
+    bool waitFor(std::condition_variable &condition, std::unique_lock<std::mutex> &lock,
+                 TickType_t ticks, Predicate predicate) {
+        if (ticks == portMAX_DELAY) {
+            condition.wait(lock, predicate);
+            return true;
+        }
+        return condition.wait_until(lock, deadline(ticks), predicate);
+    }
+}
+
+// ====== Task ======
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackSize,
+                                   void *parameters, UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    (void) stackSize;
+    (void) priority;
+    auto task = new NativeTask();
+    task->name = name;
+    task->core = core;
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    std::thread([function, parameters, task]() {
+        currentTask = task;
+        function(parameters);
+    }).detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+    // タスク関数から戻らないようにスレッドを止めておく
+    if (handle == nullptr || handle == currentTask) {
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::hours(1));
+        }
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *previousWakeTime, TickType_t increment) {
+    const TickType_t wakeTime = *previousWakeTime + increment;
+    *previousWakeTime = wakeTime;
+    const auto remaining = static_cast<int32_t>(wakeTime - xTaskGetTickCount());
+    if (remaining <= 0) {
+        return pdFALSE;
+    }
+    std::this_thread::sleep_until(startTime + std::chrono::milliseconds(wakeTime));
+    return pdTRUE;
+}
+
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime).count());
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return currentTask;
+}
+
+BaseType_t xPortGetCoreID() {
+    return currentTask != nullptr ? currentTask->core : APP_CPU_NUM;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) {
+    return 0;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *, UBaseType_t, uint32_t *totalRunTime) {
+    if (totalRunTime != nullptr) {
+        *totalRunTime = 0;
+    }
+    return 0;
+}
+
+// ====== Notification ======
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+    NativeTask *task = currentTask;
+    if (task == nullptr) {
+        return 0;
+    }
+    std::unique_lock<std::mutex> lock(task->mutex);
+    waitFor(task->condition, lock, ticksToWait, [task]() { return task->notifyValue > 0; });
+    const uint32_t value = task->notifyValue;
+    if (value > 0) {
+        task->notifyValue = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+    {
+        std::lock_guard<std::mutex> lock(handle->mutex);
+        handle->notifyValue++;
+    }
+    handle->condition.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t handle, BaseType_t *higherPriorityTaskWoken) {
+    xTaskNotifyGive(handle);
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+// ====== Queue ======
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    auto queue = new NativeQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait) {
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!waitFor(queue->condition, lock, ticksToWait,
+                     [queue]() { return queue->items.size() < queue->length; })) {
+            return pdFAIL;
+        }
+        const auto bytes = static_cast<const uint8_t *>(item);
+        queue->items.emplace_back(bytes, bytes + (item != nullptr ? queue->itemSize : 0));
+    }
+    queue->condition.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait) {
+    {
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        if (!waitFor(queue->condition, lock, ticksToWait, [queue]() { return !queue->items.empty(); })) {
+            return pdFALSE;
+        }
+        if (item != nullptr && queue->itemSize > 0) {
+            memcpy(item, queue->items.front().data(), queue->itemSize);
+        }
+        queue->items.pop_front();
+    }
+    queue->condition.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->items.clear();
+    }
+    queue->condition.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->items.size();
+}
+
+// ====== Semaphore ======
+// FreeRTOSと同じく長さ1・要素サイズ0のキューとして扱う
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    auto semaphore = xQueueCreate(1, 0);
+    xQueueSend(semaphore, nullptr, 0);
+    return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    return xQueueReceive(semaphore, nullptr, ticksToWait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return xQueueSend(semaphore, nullptr, 0);
+}
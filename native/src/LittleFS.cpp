@@ -0,0 +1,165 @@
+/// \file LittleFS.cpp
+/// \brief ホスト (Linux) ビルド用の LittleFS の代替
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <LittleFS.h>
+
+LittleFSFS LittleFS;
+
+namespace {
+    const size_t partitionSize = 0x1F0000;
+    const size_t blockSize = 4096;
+}
+
+struct fs::File::Impl {
+    std::string path;
+    std::string name;
+    FILE *file = nullptr;
+    DIR *dir = nullptr;
+
+    ~Impl() {
+        if (file != nullptr) {
+            fclose(file);
+        }
+        if (dir != nullptr) {
+            closedir(dir);
+        }
+    }
+};
+
+size_t fs::File::write(const uint8_t *data, size_t size) {
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    return fwrite(data, 1, size, impl->file);
+}
+
+size_t fs::File::read(uint8_t *data, size_t size) {
+    if (!impl || impl->file == nullptr) {
+        return 0;
+    }
+    return fread(data, 1, size, impl->file);
+}
+
+void fs::File::flush() {
+    if (impl && impl->file != nullptr) {
+        fflush(impl->file);
+    }
+}
+
+void fs::File::close() {
+    impl.reset();
+}
+
+size_t fs::File::size() const {
+    struct stat st{};
+    if (!impl || stat(impl->path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return st.st_size;
+}
+
+fs::File::operator bool() const {
+    return impl && (impl->file != nullptr || impl->dir != nullptr);
+}
+
+const char *fs::File::name() const {
+    return impl ? impl->name.c_str() : "";
+}
+
+bool fs::File::isDirectory() const {
+    return impl && impl->dir != nullptr;
+}
+
+fs::File fs::File::openNextFile() {
+    File next;
+    if (!isDirectory()) {
+        return next;
+    }
+    while (dirent *entry = readdir(impl->dir)) {
+        const std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        next.impl = std::make_shared<Impl>();
+        next.impl->path = impl->path + "/" + name;
+        next.impl->name = name;
+        struct stat st{};
+        if (stat(next.impl->path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            next.impl->dir = opendir(next.impl->path.c_str());
+        } else {
+            next.impl->file = fopen(next.impl->path.c_str(), "rb");
+        }
+        return next;
+    }
+    return next;
+}
+
+fs::File fs::FS::open(const char *path, const char *mode, bool) {
+    File file;
+    file.impl = std::make_shared<File::Impl>();
+    file.impl->path = hostPath(path);
+    const std::string p = path;
+    file.impl->name = p.substr(p.find_last_of('/') + 1);
+
+    struct stat st{};
+    if (stat(file.impl->path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        file.impl->dir = opendir(file.impl->path.c_str());
+    } else {
+        const std::string hostMode = std::string(mode) + "b";
+        file.impl->file = fopen(file.impl->path.c_str(), hostMode.c_str());
+    }
+    if (!file) {
+        file.impl.reset();
+    }
+    return file;
+}
+
+bool fs::FS::exists(const char *path) {
+    return access(hostPath(path).c_str(), F_OK) == 0;
+}
+
+bool fs::FS::remove(const char *path) {
+    return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool fs::FS::mkdir(const char *path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+std::string fs::FS::hostPath(const char *path) const {
+    return root + (path[0] == '/' ? "" : "/") + path;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char *, uint8_t, const char *partitionLabel) {
+    const char *env = getenv("NATIVE_LITTLEFS");
+    root = env != nullptr ? env : std::string("/tmp/littlefs-") + partitionLabel;
+    struct stat st{};
+    if (stat(root.c_str(), &st) == 0) {
+        return S_ISDIR(st.st_mode);
+    }
+    return formatOnFail && ::mkdir(root.c_str(), 0755) == 0;
+}
+
+void LittleFSFS::end() {
+    root.clear();
+}
+
+size_t LittleFSFS::totalBytes() {
+    return partitionSize;
+}
+
+size_t LittleFSFS::usedBytes() {
+    // ファイルごとにブロック単位で切り上げる
+    size_t used = 0;
+    File dir = open("/");
+    File entry = dir.openNextFile();
+    while (entry) {
+        used += (entry.size() + blockSize - 1) / blockSize * blockSize;
+        entry = dir.openNextFile();
+    }
+    return used;
+}
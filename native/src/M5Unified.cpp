@@ -0,0 +1,204 @@
+/// \file M5Unified.cpp
+/// \brief ホスト (Linux) ビルド用の M5Unified の代替
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <M5Unified.h>
+
+namespace fonts {
+    const IFont Font0;
+    const IFont Font2;
+    const IFont Font4;
+}
+
+namespace m5 {
+    I2C_Class In_I2C;
+
+    M5Unified::M5Unified() : In_I2C(m5::In_I2C) {}
+
+    namespace {
+        // 合成モーション: 起動から2秒間は静止 (キャリブレーション用)，
+        // その後ロールとピッチがそれぞれ 0.2 Hz / 0.13 Hz で ±30 度揺れる
+        const float stillSeconds = 2.0f;
+        const float rollAmplitude = 30.0f;
+        const float pitchAmplitude = 30.0f;
+        const float rollFrequency = 0.2f;
+        const float pitchFrequency = 0.13f;
+
+        // MPU6886
+        const uint8_t mpu6886Address = 0x68;
+        const uint8_t regGyroConfig = 0x1B;
+        const uint8_t regAccelConfig = 0x1C;
+        const uint8_t regIntEnable = 0x38;
+        const uint8_t regIntStatus = 0x3A;
+        const uint8_t regAccelXoutH = 0x3B;
+        const uint8_t womInterrupts = 0xE0;
+        const uint8_t interruptPin = 35;
+        // M5.Imu が返す値はチップの X軸・Z軸を反転したもの (データレジスタはチップの向き)
+        const float axisSign[3] = {-1.0f, 1.0f, -1.0f};
+
+        // ACCEL_CONFIG / GYRO_CONFIG (M5Unified と同じ ±8 G, ±2000 dps で始める)
+        std::atomic<uint8_t> accelConfig{0x10};
+        std::atomic<uint8_t> gyroConfig{0x18};
+
+        float accRes() {
+            return 2.0f * (1 << ((accelConfig >> 3) & 0x03)) / 32768.0f;
+        }
+
+        float gyroRes() {
+            return 250.0f * (1 << ((gyroConfig >> 3) & 0x03)) / 32768.0f;
+        }
+
+        void putInt16(uint8_t *p, float value) {
+            const float clamped = std::max(-32768.0f, std::min(32767.0f, roundf(value)));
+            const auto raw = static_cast<uint16_t>(static_cast<int16_t>(clamped));
+            p[0] = static_cast<uint8_t>(raw >> 8);
+            p[1] = static_cast<uint8_t>(raw & 0xFF);
+        }
+
+        struct MotionPattern {
+            float movingSeconds = 0.0f;  // 0 なら動き続ける
+            float stillSeconds = 0.0f;
+        };
+
+        MotionPattern loadMotionPattern() {
+            MotionPattern pattern;
+            const char *env = getenv("NATIVE_MOTION");
+            if (env != nullptr && sscanf(env, "%f,%f", &pattern.movingSeconds, &pattern.stillSeconds) != 2) {
+                pattern = MotionPattern();
+            }
+            return pattern;
+        }
+
+        const MotionPattern motionPattern = loadMotionPattern();
+
+        float elapsedSeconds() {
+            const float t = micros() / 1000000.0f - stillSeconds;
+            return t > 0.0f ? t : 0.0f;
+        }
+
+        /// 動いていた時間の合計 (静止中は進まない)
+        float seconds() {
+            const float t = elapsedSeconds();
+            if (motionPattern.movingSeconds <= 0.0f) {
+                return t;
+            }
+            const float cycle = motionPattern.movingSeconds + motionPattern.stillSeconds;
+            const float cycles = floorf(t / cycle);
+            return cycles * motionPattern.movingSeconds + std::min(t - cycles * cycle, motionPattern.movingSeconds);
+        }
+
+        bool isStill() {
+            if (micros() < stillSeconds * 1000000.0f) {
+                return true;
+            }
+            if (motionPattern.movingSeconds <= 0.0f) {
+                return false;
+            }
+            const float cycle = motionPattern.movingSeconds + motionPattern.stillSeconds;
+            return fmodf(elapsedSeconds(), cycle) >= motionPattern.movingSeconds;
+        }
+
+        // Wake-on-Motion: 有効な間，静止から動き出したら割り込みを発生させる
+        std::atomic<uint8_t> intEnable{0};
+        std::atomic<uint8_t> intStatus{0};
+        std::atomic<bool> watching{false};
+
+        void watchMotion() {
+            bool wasStill = isStill();
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                const bool still = isStill();
+                if (wasStill && !still && (intEnable & womInterrupts) != 0) {
+                    intStatus = womInterrupts;
+                    nativeRaiseInterrupt(interruptPin);
+                }
+                wasStill = still;
+            }
+        }
+    }
+
+    bool I2C_Class::readRegister(uint8_t address, uint8_t reg, uint8_t *data, size_t length, uint32_t) const {
+        if (address != mpu6886Address || reg != regAccelXoutH || length != 14) {
+            return false;
+        }
+        // 加速度・温度・角速度のデータレジスタを合成モーションから作る
+        float acc[3];
+        float gyro[3];
+        M5.Imu.getAccelData(&acc[0], &acc[1], &acc[2]);
+        M5.Imu.getGyroData(&gyro[0], &gyro[1], &gyro[2]);
+        for (size_t i = 0; i < 3; i++) {
+            putInt16(&data[i * 2], axisSign[i] * acc[i] / accRes());
+            putInt16(&data[8 + i * 2], axisSign[i] * gyro[i] / gyroRes());
+        }
+        putInt16(&data[6], 0.0f);
+        return true;
+    }
+
+    uint8_t I2C_Class::readRegister8(uint8_t address, uint8_t reg, uint32_t) const {
+        if (address != mpu6886Address) {
+            return 0;
+        }
+        switch (reg) {
+            case regIntStatus:
+                return intStatus.exchange(0);
+            case regAccelConfig:
+                return accelConfig;
+            case regGyroConfig:
+                return gyroConfig;
+            default:
+                return 0;
+        }
+    }
+
+    bool I2C_Class::writeRegister8(uint8_t address, uint8_t reg, uint8_t value, uint32_t) const {
+        if (address != mpu6886Address) {
+            return false;
+        }
+        if (reg == regAccelConfig) {
+            accelConfig = value;
+        } else if (reg == regGyroConfig) {
+            gyroConfig = value;
+        } else if (reg == regIntEnable) {
+            intEnable = value;
+            if ((value & womInterrupts) != 0 && !watching.exchange(true)) {
+                std::thread(watchMotion).detach();
+            }
+        }
+        return true;
+    }
+
+    bool IMU_Class::getAccelData(float *ax, float *ay, float *az) {
+        const float t = seconds();
+        const float roll = rollAmplitude * sinf(2.0f * PI * rollFrequency * t) * DEG_TO_RAD;
+        const float pitch = pitchAmplitude * sinf(2.0f * PI * pitchFrequency * t) * DEG_TO_RAD;
+        // IMUManager の getRoll()/getPitch() と同じ向きの重力ベクトル
+        *ax = -sinf(pitch);
+        *ay = cosf(pitch) * sinf(roll);
+        *az = cosf(pitch) * cosf(roll);
+        return true;
+    }
+
+    bool IMU_Class::getGyroData(float *gx, float *gy, float *gz) {
+        const float t = seconds();
+        if (isStill()) {
+            *gx = *gy = *gz = 0.0f;
+            return true;
+        }
+        const float roll = rollAmplitude * sinf(2.0f * PI * rollFrequency * t) * DEG_TO_RAD;
+        const float rollRate = rollAmplitude * 2.0f * PI * rollFrequency * cosf(2.0f * PI * rollFrequency * t);
+        const float pitchRate = pitchAmplitude * 2.0f * PI * pitchFrequency * cosf(2.0f * PI * pitchFrequency * t);
+        // オイラー角の変化率をセンサ座標の角速度に直す (ヨーは 0 のまま)
+        *gx = rollRate;
+        *gy = cosf(roll) * pitchRate;
+        *gz = -sinf(roll) * pitchRate;
+        return true;
+    }
+}
+
+m5::M5Unified M5;
@@ -0,0 +1,181 @@
+/// \file Preferences.cpp
+/// \brief ホスト (Linux) ビルド用の Preferences (NVS) の代替
+
+#include <map>
+#include <mutex>
+#include <Preferences.h>
+
+namespace {
+    std::mutex storageMutex;
+
+    /// "namespace.key" -> 値 (数値は文字列，バイト列はそのまま)
+    std::map<std::string, std::string> &storage() {
+        static std::map<std::string, std::string> values = []() {
+            std::map<std::string, std::string> initial;
+            const char *env = getenv("NATIVE_PREFERENCES");
+            if (env == nullptr) {
+                return initial;
+            }
+            std::string entries(env);
+            size_t begin = 0;
+            while (begin < entries.size()) {
+                size_t end = entries.find(';', begin);
+                if (end == std::string::npos) {
+                    end = entries.size();
+                }
+                const std::string entry = entries.substr(begin, end - begin);
+                const size_t equal = entry.find('=');
+                if (equal != std::string::npos) {
+                    initial[entry.substr(0, equal)] = entry.substr(equal + 1);
+                }
+                begin = end + 1;
+            }
+            return initial;
+        }();
+        return values;
+    }
+}
+
+bool Preferences::begin(const char *name, bool readOnlyMode) {
+    space = name;
+    readOnly = readOnlyMode;
+    opened = true;
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+bool Preferences::clear() {
+    if (!opened || readOnly) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(storageMutex);
+    auto &values = storage();
+    const std::string prefix = space + ".";
+    for (auto it = values.begin(); it != values.end();) {
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? values.erase(it) : std::next(it);
+    }
+    return true;
+}
+
+bool Preferences::remove(const char *key) {
+    if (!opened || readOnly) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(storageMutex);
+    return storage().erase(space + "." + key) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+    std::string value;
+    return find(key, value);
+}
+
+bool Preferences::find(const char *key, std::string &value) {
+    if (!opened) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(storageMutex);
+    const auto &values = storage();
+    const auto it = values.find(space + "." + key);
+    if (it == values.end()) {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+size_t Preferences::store(const char *key, const std::string &value) {
+    if (!opened || readOnly) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(storageMutex);
+    storage()[space + "." + key] = value;
+    return value.size();
+}
+
+size_t Preferences::putBool(const char *key, bool value) {
+    return store(key, value ? "1" : "0") > 0 ? 1 : 0;
+}
+
+size_t Preferences::putUChar(const char *key, uint8_t value) {
+    return store(key, std::to_string(value)) > 0 ? 1 : 0;
+}
+
+size_t Preferences::putUShort(const char *key, uint16_t value) {
+    return store(key, std::to_string(value)) > 0 ? 2 : 0;
+}
+
+size_t Preferences::putInt(const char *key, int32_t value) {
+    return store(key, std::to_string(value)) > 0 ? 4 : 0;
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+    return store(key, std::to_string(value)) > 0 ? 4 : 0;
+}
+
+size_t Preferences::putFloat(const char *key, float value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return store(key, buffer) > 0 ? 4 : 0;
+}
+
+size_t Preferences::putString(const char *key, const char *value) {
+    return store(key, value);
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length) {
+    const auto bytes = static_cast<const char *>(value);
+    return store(key, std::string(bytes, length));
+}
+
+bool Preferences::getBool(const char *key, bool defaultValue) {
+    std::string value;
+    return find(key, value) ? value != "0" : defaultValue;
+}
+
+uint8_t Preferences::getUChar(const char *key, uint8_t defaultValue) {
+    std::string value;
+    return find(key, value) ? static_cast<uint8_t>(strtoul(value.c_str(), nullptr, 10)) : defaultValue;
+}
+
+uint16_t Preferences::getUShort(const char *key, uint16_t defaultValue) {
+    std::string value;
+    return find(key, value) ? static_cast<uint16_t>(strtoul(value.c_str(), nullptr, 10)) : defaultValue;
+}
+
+int32_t Preferences::getInt(const char *key, int32_t defaultValue) {
+    std::string value;
+    return find(key, value) ? static_cast<int32_t>(strtol(value.c_str(), nullptr, 10)) : defaultValue;
+}
+
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue) {
+    std::string value;
+    return find(key, value) ? static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10)) : defaultValue;
+}
+
+float Preferences::getFloat(const char *key, float defaultValue) {
+    std::string value;
+    return find(key, value) ? strtof(value.c_str(), nullptr) : defaultValue;
+}
+
+String Preferences::getString(const char *key, const String &defaultValue) {
+    std::string value;
+    return find(key, value) ? String(value) : defaultValue;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+    std::string value;
+    return find(key, value) ? value.size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t length) {
+    std::string value;
+    if (!find(key, value) || value.size() > length) {
+        return 0;
+    }
+    memcpy(buffer, value.data(), value.size());
+    return value.size();
+}
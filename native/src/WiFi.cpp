@@ -0,0 +1,136 @@
+/// \file WiFi.cpp
+/// \brief ホスト (Linux) ビルド用の WiFi / WiFiUDP の代替
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+WiFiClass WiFi;
+
+WiFiUDP::~WiFiUDP() {
+    stop();
+}
+
+bool WiFiUDP::open() {
+    if (fd >= 0) {
+        return true;
+    }
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    return fd >= 0;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    stop();
+    if (!open()) {
+        return 0;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiUDP::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    txBuffer.clear();
+    rxBuffer.clear();
+    rxPosition = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    if (!open()) {
+        return 0;
+    }
+    destinationAddress = ip;
+    destinationPort = port;
+    txBuffer.clear();
+    return 1;
+}
+
+int WiFiUDP::beginPacket(const char *host, uint16_t port) {
+    IPAddress ip;
+    if (!ip.fromString(host)) {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo *result = nullptr;
+        if (getaddrinfo(host, nullptr, &hints, &result) != 0 || result == nullptr) {
+            return 0;
+        }
+        ip = IPAddress(static_cast<uint32_t>(reinterpret_cast<sockaddr_in *>(result->ai_addr)->sin_addr.s_addr));
+        freeaddrinfo(result);
+    }
+    return beginPacket(ip, port);
+}
+
+size_t WiFiUDP::write(uint8_t data) {
+    txBuffer.push_back(data);
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t *data, size_t size) {
+    txBuffer.insert(txBuffer.end(), data, data + size);
+    return size;
+}
+
+int WiFiUDP::endPacket() {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = static_cast<uint32_t>(destinationAddress);
+    address.sin_port = htons(destinationPort);
+    const auto sent = sendto(fd, txBuffer.data(), txBuffer.size(), 0,
+                             reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    txBuffer.clear();
+    return sent >= 0 ? 1 : 0;
+}
+
+int WiFiUDP::parsePacket() {
+    if (fd < 0) {
+        return 0;
+    }
+    rxBuffer.resize(1500);
+    rxPosition = 0;
+    sockaddr_in address{};
+    socklen_t addressLength = sizeof(address);
+    const auto received = recvfrom(fd, rxBuffer.data(), rxBuffer.size(), MSG_DONTWAIT,
+                                   reinterpret_cast<sockaddr *>(&address), &addressLength);
+    if (received <= 0) {
+        rxBuffer.clear();
+        return 0;
+    }
+    rxBuffer.resize(received);
+    remoteAddress = IPAddress(static_cast<uint32_t>(address.sin_addr.s_addr));
+    remotePortNumber = ntohs(address.sin_port);
+    return static_cast<int>(received);
+}
+
+void WiFiUDP::flush() {
+    rxBuffer.clear();
+    rxPosition = 0;
+}
+
+int WiFiUDP::available() {
+    return static_cast<int>(rxBuffer.size() - rxPosition);
+}
+
+int WiFiUDP::read() {
+    return rxPosition < rxBuffer.size() ? rxBuffer[rxPosition++] : -1;
+}
+
+int WiFiUDP::read(uint8_t *data, size_t size) {
+    const size_t n = std::min(size, rxBuffer.size() - rxPosition);
+    memcpy(data, &rxBuffer[rxPosition], n);
+    rxPosition += n;
+    return static_cast<int>(n);
+}
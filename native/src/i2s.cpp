@@ -0,0 +1,160 @@
+/// \file i2s.cpp
+/// \brief ホスト (Linux) ビルド用の I2S ドライバの代替
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "driver/i2s.h"
+
+namespace {
+    struct NativeI2S {
+        i2s_config_t config{};
+        QueueHandle_t eventQueue = nullptr;
+        std::mutex mutex;
+        std::deque<std::vector<int16_t>> buffers;  // 読み出し待ちのDMAバッファ
+        std::atomic<bool> running{false};
+        std::atomic<bool> stopped{false};  // i2s_stop() 中はバッファを作らない
+        std::thread thread;
+    };
+
+    NativeI2S driver;
+
+    // 合成音: 440 Hz の正弦波 + ホワイトノイズ + DCオフセット (PDMマイクの実測に近い振幅)
+    const float toneFrequency = 440.0f;
+    const float toneAmplitude = 2000.0f;
+    const float noiseAmplitude = 200.0f;
+    const float dcOffset = 300.0f;
+
+    void generate() {
+        const size_t length = driver.config.dma_buf_len;
+        const size_t count = driver.config.dma_buf_count;
+        const auto period = std::chrono::microseconds(1000000ULL * length / driver.config.sample_rate);
+
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> noise(-noiseAmplitude, noiseAmplitude);
+        const float phaseStep = 2.0f * static_cast<float>(M_PI) * toneFrequency / driver.config.sample_rate;
+        float phase = 0.0f;
+
+        auto wakeTime = std::chrono::steady_clock::now();
+        while (driver.running) {
+            wakeTime += period;
+            std::this_thread::sleep_until(wakeTime);
+            if (driver.stopped) {
+                continue;
+            }
+
+            std::vector<int16_t> buffer(length);
+            for (auto &sample: buffer) {
+                sample = static_cast<int16_t>(dcOffset + toneAmplitude * sinf(phase) + noise(random));
+                phase += phaseStep;
+                if (phase > 2.0f * static_cast<float>(M_PI)) {
+                    phase -= 2.0f * static_cast<float>(M_PI);
+                }
+            }
+
+            i2s_event_t event{};
+            {
+                std::lock_guard<std::mutex> lock(driver.mutex);
+                if (driver.buffers.size() >= count) {
+                    // ESP-IDFと同じく最も古いバッファを上書きする
+                    driver.buffers.pop_front();
+                    event.type = I2S_EVENT_RX_Q_OVF;
+                    xQueueSend(driver.eventQueue, &event, 0);
+                }
+                driver.buffers.push_back(std::move(buffer));
+            }
+            event.type = I2S_EVENT_RX_DONE;
+            event.size = length * sizeof(int16_t);
+            xQueueSend(driver.eventQueue, &event, 0);
+        }
+    }
+}
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t *config, int queueSize, void *queue) {
+    if (port != I2S_NUM_0 || driver.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    driver.config = *config;
+    driver.eventQueue = nullptr;
+    if (queue != nullptr && queueSize > 0) {
+        driver.eventQueue = xQueueCreate(queueSize, sizeof(i2s_event_t));
+        *static_cast<QueueHandle_t *>(queue) = driver.eventQueue;
+    }
+    driver.running = true;
+    driver.thread = std::thread(generate);
+    return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port) {
+    if (port != I2S_NUM_0 || !driver.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    driver.running = false;
+    driver.thread.join();
+    std::lock_guard<std::mutex> lock(driver.mutex);
+    driver.buffers.clear();
+    return ESP_OK;
+}
+
+esp_err_t i2s_set_pin(i2s_port_t, const i2s_pin_config_t *) {
+    return ESP_OK;
+}
+
+esp_err_t i2s_set_clk(i2s_port_t, uint32_t rate, i2s_bits_per_sample_t, i2s_channel_t) {
+    driver.config.sample_rate = rate;
+    return ESP_OK;
+}
+
+esp_err_t i2s_stop(i2s_port_t port) {
+    if (port != I2S_NUM_0 || !driver.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    driver.stopped = true;
+    std::lock_guard<std::mutex> lock(driver.mutex);
+    driver.buffers.clear();
+    return ESP_OK;
+}
+
+esp_err_t i2s_start(i2s_port_t port) {
+    if (port != I2S_NUM_0 || !driver.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    driver.stopped = false;
+    return ESP_OK;
+}
+
+esp_err_t i2s_read(i2s_port_t port, void *dest, size_t size, size_t *bytesRead, TickType_t ticksToWait) {
+    *bytesRead = 0;
+    if (port != I2S_NUM_0 || !driver.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ticksToWait);
+    auto out = static_cast<uint8_t *>(dest);
+    while (*bytesRead < size) {
+        {
+            std::lock_guard<std::mutex> lock(driver.mutex);
+            while (!driver.buffers.empty() && *bytesRead < size) {
+                auto &buffer = driver.buffers.front();
+                const size_t bytes = std::min(size - *bytesRead, buffer.size() * sizeof(int16_t));
+                memcpy(out + *bytesRead, buffer.data(), bytes);
+                *bytesRead += bytes;
+                buffer.erase(buffer.begin(), buffer.begin() + bytes / sizeof(int16_t));
+                if (buffer.empty()) {
+                    driver.buffers.pop_front();
+                }
+            }
+        }
+        if (*bytesRead >= size || (ticksToWait != portMAX_DELAY && std::chrono::steady_clock::now() >= deadline)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return ESP_OK;
+}
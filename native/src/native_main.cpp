@@ -0,0 +1,20 @@
+/// \file native_main.cpp
+/// \brief ホスト (Linux) ビルドのエントリポイント
+///
+/// Arduinoのコアと同じく setup() を一度呼んだ後 loop() を呼び続ける．
+
+#include <Arduino.h>
+
+void setup();
+
+void loop();
+
+int main() {
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    setup();
+    while (true) {
+        loop();
+        // ESP32のloopTaskと同じくloop()の間で他のタスクに譲る
+        delay(1);
+    }
+}
@@ -1,43 +1,318 @@
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <Arduino.h>
+#include <esp_timer.h>
 #include <M5Unified.h>
 #include <WiFiManager.h>
 #include <Preferences.h>
-#include <ArduinoOSCWiFi.h>
-#include <driver/i2s.h>
 
+#include "CaptureRecorder.h"
+#include "ClockSync.h"
+#include "CongestionController.h"
 #include "IMUManager.h"
+#include "DeltaGate.h"
 #include "DisplayManager.h"
+#include "I2CArbiter.h"
+#include "MicManager.h"
+#include "MotionDetector.h"
+#include "OSCManager.h"
+#include "OSCMessageReader.h"
+#include "OSCMessageTemplate.h"
+#include "PerfMonitor.h"
+#include "PowerGovernor.h"
+#include "SnapshotBuffer.h"
+#include "TaskConfig.h"
+#include "TaskMonitor.h"
+#include "WireFormat.h"
+
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
 
 
 // ====== Global ======
 IMUManager imuManager;
 Preferences preferences;
 DisplayManager displayManager;
+MicManager micManager;
+OSCManager oscManager;
+TaskMonitor taskMonitor;
+ClockSync clockSync;
+CongestionController congestionController;
+PowerGovernor powerGovernor;
+I2CArbiter i2cArbiter;
+MotionDetector motionDetector;
+CaptureRecorder captureRecorder;
 
-const int micSamplingRate = 16000; // サンプリング周波数 16 kHz
-const int micSampleSize = 512; // 平均を取るサンプル数
-const int micBufferSize = micSampleSize * 2;
 const int clkPin = 0;
 const int dataPin = 34;
 
-const TickType_t healthCheckInterval = pdMS_TO_TICKS(30000);         // 30   s
-const TickType_t imuUpdateInterval = pdMS_TO_TICKS(10);              // 10   ms (100  Hz)
-const TickType_t oscSendInterval_60fps = pdMS_TO_TICKS(16.6);        // 16.6 ms (60   Hz)
-const TickType_t oscSendInterval_30fps = pdMS_TO_TICKS(33.3);        // 33.3 ms (30   Hz)
-const TickType_t oscSendInterval_15fps = pdMS_TO_TICKS(66.6);        // 66.6 ms (15   Hz)
-const TickType_t micSamplingInterval = pdMS_TO_TICKS(5);             // 5    ms (200  Hz)
-
-const TickType_t i2sWaitTime = pdMS_TO_TICKS(100);                   // 100 ms
-
 String oscServerIp;
 int oscServerPort;
+String oscDestinations;  // OSCサーバー以外の送信先 "ip:port,ip:port" (マルチキャストアドレスも可)
 String clientName;
-
-uint8_t buffer[micBufferSize] = {0};
-int16_t *adcBuffer = nullptr;
-auto totalPower = 0.0f;
-auto numPower = 0;
+uint8_t nodeId;  // バイナリ形式で送るノード番号 (clientName 末尾の数字)
+
+// IMUの取得方法 (-D IMU_FIFO_RATE=1000 などでFIFOからまとめて読み出す．FIFOを使えなければ setup() で 0 に戻す)
+#ifdef IMU_FIFO_RATE
+uint16_t imuFifoRate = IMU_FIFO_RATE;
+#else
+uint16_t imuFifoRate = 0;
+#endif
+
+// 姿勢推定の方法 (-D IMU_FUSION_MADGWICK / -D IMU_FUSION_MAHONY でクォータニオンによる3軸推定)
+#if defined(IMU_FUSION_MADGWICK)
+const IMUManager::FusionMode imuFusionMode = IMUManager::FusionMode::Madgwick;
+#elif defined(IMU_FUSION_MAHONY)
+const IMUManager::FusionMode imuFusionMode = IMUManager::FusionMode::Mahony;
+#else
+const IMUManager::FusionMode imuFusionMode = IMUManager::FusionMode::Kalman;
+#endif
+const bool imuFusionEnabled = imuFusionMode != IMUManager::FusionMode::Kalman;
+
+// 帯域エネルギーの解析 (-D MIC_SPECTRUM で /mic/bands を送信する)
+#ifdef MIC_SPECTRUM
+const bool micSpectrumEnabled = true;
+#else
+const bool micSpectrumEnabled = false;
+#endif
+const size_t micSpectrumDecimation = 2;                              // 2ブロック (32 ms) に1回FFTする
+
+// 送信周期内に溜まったブロックのまとめ方 (-D MIC_REPORT_MODE=Max / Latest で変える．既定は Mean)
+enum class MicReportMode : uint8_t {
+    Mean,   // 平均
+    Max,    // 最大
+    Latest  // 最新
+};
+#ifdef MIC_REPORT_MODE
+const MicReportMode defaultMicReportMode = MicReportMode::MIC_REPORT_MODE;
+#else
+const MicReportMode defaultMicReportMode = MicReportMode::Mean;
+#endif
+const std::array<const char *, 3> micReportModeNames = {{"mean", "max", "latest"}};  // MicReportMode の順
+
+// OSC送信レイアウト (-D OSC_BUNDLE でIMU/MICを1つのBundleにまとめる，
+// -D WIRE_BINARY で32バイトのバイナリ形式にする)
+#if defined(WIRE_BINARY)
+const OSCManager::Layout defaultOscLayout = OSCManager::Layout::Binary;
+#elif defined(OSC_BUNDLE)
+const OSCManager::Layout defaultOscLayout = OSCManager::Layout::Bundle;
+#else
+const OSCManager::Layout defaultOscLayout = OSCManager::Layout::Message;
+#endif
+const std::array<const char *, 3> layoutNames = {{"message", "bundle", "binary"}};  // Layout の順
+
+// Message 形式での取得時刻 (-D OSC_MESSAGE_TIMESTAMP で /imu/*, /mic/volume の末尾にタイムタグ 't' を付ける)
+#ifdef OSC_MESSAGE_TIMESTAMP
+const bool messageTimestampEnabled = true;
+#else
+const bool messageTimestampEnabled = false;
+#endif
+
+// 変化のないフレームの間引き (-D OSC_DEADBAND で有効にする)
+#ifdef OSC_DEADBAND
+const bool oscDeadbandEnabled = true;
+#else
+const bool oscDeadbandEnabled = false;
+#endif
+const uint32_t keyframeIntervalUs = 1000000;                          // 変化がなくても1秒に1回は送る
+const std::array<float, 3> accThreshold = {0.02f, 0.02f, 0.02f};     // [G]
+const std::array<float, 3> gyroThreshold = {2.0f, 2.0f, 2.0f};       // [deg/s]
+const std::array<float, 2> rotationThreshold = {0.5f, 0.5f};         // [deg]
+const std::array<float, 4> quaternionThreshold = {0.004f, 0.004f, 0.004f, 0.004f};  // 約0.5度
+const std::array<float, 3> linearAccThreshold = {0.02f, 0.02f, 0.02f};  // [G]
+const std::array<float, 1> micThreshold = {1.0f};                    // [dB]
+
+// サーバーとの時計の同期 (-D CLOCK_SYNC で ping/pong を行い，タイムタグをサーバーの時刻にする)
+#ifdef CLOCK_SYNC
+const bool clockSyncEnabled = true;
+#else
+const bool clockSyncEnabled = false;
+#endif
+const TickType_t clockSyncTimeout = pdMS_TO_TICKS(200);              // pong を待つ時間
+
+// 静止している間の省電力 (-D POWER_GOVERNOR で静止時間に応じて周期・CPUクロック・WiFiのスリープを切り替える)
+#ifdef POWER_GOVERNOR
+const bool powerGovernorEnabled = true;
+#else
+const bool powerGovernorEnabled = false;
+#endif
+const uint32_t powerIdleAfterMs = 5000;                               // 5秒静止したら Idle
+const uint32_t powerSleepAfterMs = 60000;                             // 1分静止したら Sleep
+const uint16_t wakeOnMotionThresholdMg = 40;
+const uint8_t imuInterruptPin = 35;                                   // MPU6886 の INT
+
+// 電力状態ごとの設定 (Active, Idle, Sleep の順)
+struct PowerProfile {
+    uint32_t cpuMhz;
+    TickType_t periodScale;       // IMU・送信タスクの周期を何倍にするか
+    wifi_ps_type_t wifiSleep;
+    bool lightSleep;              // 自動ライトスリープ (CONFIG_PM_ENABLE のビルドのみ)
+    bool micEnabled;
+};
+const std::array<PowerProfile, numPowerStates> powerProfiles = {{
+        {240, 1, WIFI_PS_MIN_MODEM, false, true},
+        {80, 4, WIFI_PS_MIN_MODEM, true, true},
+        {80, 10, WIFI_PS_MAX_MODEM, true, false},
+}};
+std::atomic<bool> motionInterrupt(false);
+int16_t bootBatteryVoltage = 0;                                       // 起動時の電池電圧 [mV]
+
+// 電池残量などは変化が遅いので，この時間内なら内部I2Cを読み直さない
+const uint32_t powerReadingMaxAgeMs = 5000;
+
+// OSCサーバーの初期値 (Preferences にない場合・保存された値が不正な場合)
+const char *const defaultOscServerIp = "192.168.100.10";
+const int defaultOscServerPort = 9000;
+
+// OSCのソケットを開けなかった場合のやり直し
+const int oscSetupRetries = 10;
+const uint32_t oscSetupRetryDelayMs = 1000;
+
+// 実行中の設定変更 (-D REMOTE_CONFIG で /{client_name}/config/* と /all/config/* を受け付け，Preferences に保存する)
+#ifdef REMOTE_CONFIG
+const bool remoteConfigEnabled = true;
+#else
+const bool remoteConfigEnabled = false;
+#endif
+const uint16_t oscReceivePort = 9001;                                 // 設定変更を受け付けるポート
+const uint32_t controlReceiveTimeoutMs = 1000;
+const float maxStreamRate = 1000.0f;                                  // [Hz]
+
+// 起動時の再接続 (-D FAST_BOOT で前回の接続先 (BSSID・チャンネル・IPアドレス) に直接つなぎ，失敗した時だけ WiFiManager を使う)
+#ifdef FAST_BOOT
+const bool fastBootEnabled = true;
+#else
+const bool fastBootEnabled = false;
+#endif
+const uint32_t fastConnectTimeoutMs = 3000;
+const TickType_t bootReportDelay = pdMS_TO_TICKS(1000);              // 最初のパケットを待ってから起動時間を通知する
+
+// 前回接続したアクセスポイントとIPアドレス (Preferences の "wifi" に保存する)
+struct WiFiCache {
+    std::array<uint8_t, 6> bssid;
+    uint8_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+};
+uint32_t wifiStartMs = 0;
+uint32_t wifiConnectMs = 0;
+bool fastConnected = false;
+
+// 混雑に応じた送信レートの調整 (-D ADAPTIVE_RATE で送信の失敗・RSSI・往復時間から送信周期を延ばし，Bundle にまとめる)
+#ifdef ADAPTIVE_RATE
+const bool adaptiveRateEnabled = true;
+#else
+const bool adaptiveRateEnabled = false;
+#endif
+
+// 動きのイベントの検出 (-D MOTION_EVENTS でIMUのサンプルごとに衝撃・回転・振り・静止を検出し，
+// 周期的な送信を待たずに /{client_name}/event/* で送る)
+#ifdef MOTION_EVENTS
+const bool motionEventsEnabled = true;
+#else
+const bool motionEventsEnabled = false;
+#endif
+
+// フラッシュへの記録 (-D CAPTURE でIMUのサンプルとマイクの特徴量を LittleFS のパーティションに記録する．
+// partitions_capture.csv が必要なので platformio.ini の capture 環境でビルドする)
+#ifdef CAPTURE
+const bool captureEnabled = true;
+#else
+const bool captureEnabled = false;
+#endif
+const char capturePartition[] = "capture";
+
+// 周期を変更できるタスク (電力状態による周期の倍率もこれらにかける)
+const std::array<TaskId, 4> streamTasks = {{TaskId::Imu, TaskId::SendImuOsc, TaskId::SendMicOsc,
+                                            TaskId::SendMicBandsOsc}};
+
+// 個別に止められるストリーム
+enum class Stream : uint8_t {
+    Acc,
+    Gyro,
+    Rotation,
+    Orientation,  // quaternion と euler
+    LinearAcc,
+    Mic,
+    Bands,
+    Count
+};
+const size_t numStreams = static_cast<size_t>(Stream::Count);
+const std::array<const char *, numStreams> streamNames = {{"acc", "gyro", "rotation", "orientation",
+                                                           "linear_acc", "mic", "bands"}};
+const uint32_t allStreams = (1u << numStreams) - 1;
+
+// 実行中に変わる設定 (起動時に Preferences から読み込む)
+std::array<std::atomic<TickType_t>, numTasks> taskPeriods;
+std::atomic<uint32_t> enabledStreams(allStreams);
+std::atomic<OSCManager::Layout> oscLayout(defaultOscLayout);
+Preferences streamPreferences;
+
+// pong は controlTask が受信時刻 (t4) を付けて clockSyncTask に渡す
+struct SyncPong {
+    uint64_t t1;
+    uint64_t t2;
+    uint64_t t3;
+    uint64_t t4;
+};
+QueueHandle_t syncPongQueue = nullptr;
+
+DeltaGate<3> accGate;
+DeltaGate<3> gyroGate;
+DeltaGate<2> rotationGate;
+DeltaGate<4> orientationGate;
+DeltaGate<3> linearAccGate;
+DeltaGate<1> micGate;
+
+std::atomic<MicReportMode> micReportMode(defaultMicReportMode);
+
+// Bundle送信時にIMUのBundleへ相乗りさせるMICの値
+struct MicLevel {
+    float power;
+    float db;
+    uint32_t timestampUs;  // 最後に取り込んだブロックの読み出し完了時刻 micros()
+};
+SnapshotBuffer<MicLevel> micLevel;
+std::atomic<bool> micPending(false);
+
+// 表示タスクが読む値 (表示のためにI2Cなどを読み直さない)
+std::atomic<float> micDbLevel(0.0f);
+std::atomic<int32_t> batteryLevel(0);
+std::atomic<bool> batteryCharging(false);
+
+// 送信するOSCメッセージの雛形 (clientName確定後に一度だけ組み立てる)
+OSCMessageTemplate accMessage;
+OSCMessageTemplate gyroMessage;
+OSCMessageTemplate rotationMessage;
+OSCMessageTemplate quaternionMessage;
+OSCMessageTemplate eulerMessage;
+OSCMessageTemplate linearAccMessage;
+OSCMessageTemplate micMessage;       // sendMicOscTask が送る
+OSCMessageTemplate micBundleMessage; // sendImuOscTask が Bundle に載せる (同じアドレスでもタスクごとに分ける)
+OSCMessageTemplate batteryMessage;
+OSCMessageTemplate micStatusMessage;
+OSCMessageTemplate micBandsMessage;
+OSCMessageTemplate cpuMessage;
+OSCMessageTemplate suppressionMessage;
+OSCMessageTemplate syncPingMessage;
+OSCMessageTemplate syncPongMessage;
+OSCMessageTemplate syncStatusMessage;
+OSCMessageTemplate powerMessage;
+OSCMessageTemplate configStatusMessage;
+OSCMessageTemplate congestionMessage;
+OSCMessageTemplate bootMessage;
+OSCMessageTemplate captureMessage;
+std::array<OSCMessageTemplate, I2CArbiter::numClients> i2cMessages;
+std::array<OSCMessageTemplate, MotionDetector::numEventTypes> motionEventMessages;
+std::array<OSCMessageTemplate, OSCManager::maxDestinations> destinationMessages;
+std::array<OSCMessageTemplate, numTasks> taskMessages;
+#if PERF_ENABLED
+std::array<OSCMessageTemplate, PerfMonitor::numMetrics> perfMessages;
+#endif
 
 
 // ====== TaskHandler ======
@@ -46,6 +321,13 @@ TaskHandle_t imuTaskHandle = nullptr;
 TaskHandle_t micTaskHandle = nullptr;
 TaskHandle_t sendImuOscTaskHandle = nullptr;
 TaskHandle_t sendMicOscTaskHandle = nullptr;
+TaskHandle_t sendMicBandsOscTaskHandle = nullptr;
+TaskHandle_t clockSyncTaskHandle = nullptr;
+TaskHandle_t controlTaskHandle = nullptr;
+TaskHandle_t congestionTaskHandle = nullptr;
+TaskHandle_t displayTaskHandle = nullptr;
+TaskHandle_t motionEventTaskHandle = nullptr;
+TaskHandle_t captureTaskHandle = nullptr;
 
 // ====== Task ======
 [[noreturn]] void healthCheckTask(void *pvParameters);
@@ -58,28 +340,88 @@ TaskHandle_t sendMicOscTaskHandle = nullptr;
 
 [[noreturn]] void sendMicOscTask(void *pvParameters);
 
+[[noreturn]] void sendMicBandsOscTask(void *pvParameters);
+
+[[noreturn]] void clockSyncTask(void *pvParameters);
+
+[[noreturn]] void controlTask(void *pvParameters);
+
+[[noreturn]] void congestionTask(void *pvParameters);
+
+[[noreturn]] void displayTask(void *pvParameters);
+
+[[noreturn]] void motionEventTask(void *pvParameters);
+
+[[noreturn]] void captureTask(void *pvParameters);
+
 
 // ====== Semaphore ======
-volatile SemaphoreHandle_t imuSemaphore = xSemaphoreCreateBinary();
-volatile SemaphoreHandle_t micSemaphore = xSemaphoreCreateBinary();
 volatile SemaphoreHandle_t displaySemaphore = xSemaphoreCreateBinary();
 
 
 // ====== Function ======
-void i2sInit();
+bool beginFastConnect();
+
+void connectWiFi(bool fastConnecting);
 
-float calcDecibel(float value);
+bool loadWiFiCache(WiFiCache &cache);
 
-void processSignal();
+void saveWiFiCache();
 
-void connectWiFi();
+void sendBootStatus();
 
 bool readOscPreference();
 
+void setupOscDestinations();
+
+void loadStreamConfig();
+
+void saveStreamConfig();
+
+void handleConfigPacket(const uint8_t *data, size_t size);
+
+bool applyConfig(const char *command, const OSCMessageReader &message);
+
+void sendConfigStatus();
+
+bool isStreamEnabled(Stream stream);
+
+OSCManager::Layout getOscLayout();
+
+void buildOscMessages();
+
+void setupDeltaGates();
+
+uint8_t parseNodeId(const String &name);
+
+DeltaGateStats getImuGateStats();
+
+void createTask(TaskId id, TaskFunction_t function, TaskHandle_t *handle);
+
+TickType_t getTaskPeriod(TaskId id);
+
+TickType_t limitTaskPeriod(TaskId id, TickType_t period);
+
+uint32_t getTaskPeriodUs(TaskId id);
+
+void waitForPeriod(TaskId id, TickType_t &lastWakeTime);
+
+void updatePowerState();
+
+void applyPowerState(PowerState state);
+
+void wakePeriodicTasks();
+
+void onMotionInterrupt();
+
+uint64_t getSampleTime(uint32_t timestampUs);
+
 
 void setup() {
     M5.begin();
     M5.Power.begin();
+    i2cArbiter.setup();
+    imuManager.setBus(&i2cArbiter);
     displayManager.showInitScreen();
     Serial.begin(115200);
 
@@ -94,7 +436,10 @@ void setup() {
     M5.Lcd.setCursor(0, 0);
 
     // ====== I2S ======
-    i2sInit();
+    micManager.setup(clkPin, dataPin);
+    if (micSpectrumEnabled) {
+        micManager.enableSpectrum(micSpectrumDecimation);
+    }
 
     // ====== OSC ======
     if (readOscPreference()) {
@@ -103,85 +448,227 @@ void setup() {
         Serial.println("Failed to read OSC preference.");
     }
 
+    loadStreamConfig();
+
     // ====== WiFi ======
-    connectWiFi();
+    // 前回の接続先への接続を先に始めておき，つながるまでの間にIMUを初期化する
+    const bool fastConnecting = fastBootEnabled && beginFastConnect();
 
     // ====== IMU ======
-    M5.Imu.init();
+    {
+        I2CArbiter::Lock lock(&i2cArbiter, I2CArbiter::Client::Imu);
+        M5.Imu.init();
+    }
     imuManager.setup(false);
+    imuManager.setFusionMode(imuFusionMode);
+    if (imuFifoRate > 0 && !imuManager.enableFifo(imuFifoRate)) {
+        Serial.println("IMU FIFO is not available, polling instead");
+        imuFifoRate = 0;
+    }
+    if (motionEventsEnabled) {
+        imuManager.setMotionDetector(&motionDetector);
+    }
+
+    connectWiFi(fastConnecting);
+
+    setupOscDestinations();
+    buildOscMessages();
+    nodeId = parseNodeId(clientName);
+    if (oscDeadbandEnabled) {
+        setupDeltaGates();
+    }
+
+    // ====== Capture ======
+    // 起動時から記録し，Bボタンで止める・新しいファイルで再開する
+    const bool captureMounted = captureEnabled && captureRecorder.setup(capturePartition, clientName.c_str(), nodeId);
+    if (captureMounted) {
+        imuManager.setRecorder(&captureRecorder);
+        micManager.setRecorder(&captureRecorder);
+        captureRecorder.requestStart();
+    } else if (captureEnabled) {
+        Serial.println("Failed to mount capture partition.");
+    }
+
+    // ====== Power ======
+    if (powerGovernorEnabled) {
+        bootBatteryVoltage = i2cArbiter.readPower(0).batteryVoltage;
+        powerGovernor.setup(powerIdleAfterMs, powerSleepAfterMs, millis());
+        pinMode(imuInterruptPin, INPUT);
+        attachInterrupt(digitalPinToInterrupt(imuInterruptPin), onMotionInterrupt, RISING);
+    }
 
     // ====== Task ======
-    imuSemaphore = xSemaphoreCreateBinary();
-    micSemaphore = xSemaphoreCreateBinary();
     displaySemaphore = xSemaphoreCreateBinary();
-    if (imuSemaphore == nullptr || micSemaphore == nullptr || displaySemaphore == nullptr) {
+    if (displaySemaphore == nullptr) {
         Serial.println("Failed to create semaphore.");
         delay(1000);
         ESP.restart();
         delay(1000);
     }
-    xSemaphoreGive(imuSemaphore);
-    xSemaphoreGive(micSemaphore);
     xSemaphoreGive(displaySemaphore);
 
 
-    xTaskCreatePinnedToCore(
-            healthCheckTask,
-            "Health Check Task",
-            4096,
-            nullptr,
-            1,
-            &healthCheckTaskHandle,
-            APP_CPU_NUM
-    );
+    // 配置・優先度・スタック・周期は TaskConfig.h の一覧で決める
+    createTask(TaskId::HealthCheck, healthCheckTask, &healthCheckTaskHandle);
+    if (motionEventsEnabled) {
+        // IMUタスクより先に作っておき，最初のイベントから起こせるようにする
+        createTask(TaskId::MotionEvent, motionEventTask, &motionEventTaskHandle);
+    }
+    createTask(TaskId::Imu, imuTask, &imuTaskHandle);
+    createTask(TaskId::SendImuOsc, sendImuOscTask, &sendImuOscTaskHandle);
+    createTask(TaskId::SendMicOsc, sendMicOscTask, &sendMicOscTaskHandle);
+    createTask(TaskId::Mic, micTask, &micTaskHandle);
+    if (micSpectrumEnabled) {
+        createTask(TaskId::SendMicBandsOsc, sendMicBandsOscTask, &sendMicBandsOscTaskHandle);
+    }
+    if (clockSyncEnabled) {
+        syncPongQueue = xQueueCreate(4, sizeof(SyncPong));
+        createTask(TaskId::ClockSync, clockSyncTask, &clockSyncTaskHandle);
+    }
+    if (clockSyncEnabled || remoteConfigEnabled) {
+        createTask(TaskId::Control, controlTask, &controlTaskHandle);
+    }
+    if (adaptiveRateEnabled) {
+        createTask(TaskId::Congestion, congestionTask, &congestionTaskHandle);
+    }
+    if (captureMounted) {
+        createTask(TaskId::Capture, captureTask, &captureTaskHandle);
+    }
+    if (displayManager.beginDashboard()) {
+        createTask(TaskId::Display, displayTask, &displayTaskHandle);
+    } else {
+        Serial.println("Failed to allocate display sprite.");
+    }
+}
 
+void createTask(TaskId id, TaskFunction_t function, TaskHandle_t *handle) {
+    const auto &config = getTaskConfig(id);
     xTaskCreatePinnedToCore(
-            imuTask,
-            "IMU Task",
-            4096,
+            function,
+            config.name,
+            config.stackSize,
             nullptr,
-            2,
-            &imuTaskHandle,
-            APP_CPU_NUM
+            config.priority,
+            handle,
+            config.core
     );
+    taskMonitor.add(static_cast<size_t>(id), *handle, config.core);
+}
 
-    xTaskCreatePinnedToCore(
-            sendImuOscTask,
-            "IMU OSC Task",
-            4096,
-            nullptr,
-            2,
-            &sendImuOscTaskHandle,
-            APP_CPU_NUM
-    );
+TickType_t getTaskPeriod(TaskId id) {
+    TickType_t period = taskPeriods[static_cast<size_t>(id)];
+    if (std::find(streamTasks.begin(), streamTasks.end(), id) == streamTasks.end()) {
+        return period;
+    }
+    // FIFOは溜められる量が決まっているので，IMUの読み出し周期は延ばさない
+    if (powerGovernorEnabled && !(id == TaskId::Imu && imuFifoRate > 0)) {
+        period *= powerProfiles[static_cast<size_t>(powerGovernor.getState())].periodScale;
+    }
+    // 混雑している間は送信だけを間引く (IMUの読み出しと姿勢推定はそのまま続ける)
+    if (adaptiveRateEnabled && id != TaskId::Imu) {
+        period = static_cast<TickType_t>(period / congestionController.getRateScale() + 0.5f);
+    }
+    return period;
+}
 
-    xTaskCreatePinnedToCore(
-            sendMicOscTask,
-            "MIC OSC Task",
-            4096,
-            nullptr,
-            4,
-            &sendMicOscTaskHandle,
-            APP_CPU_NUM
-    );
+TickType_t limitTaskPeriod(TaskId id, TickType_t period) {
+    if (id != TaskId::Imu || imuFifoRate == 0) {
+        return period;
+    }
+    // FIFOは溜められる量が決まっているので，IMUの読み出し周期は FIFO が溢れない長さまでにする
+    const TickType_t maxPeriod = std::max<TickType_t>(
+            1, pdMS_TO_TICKS(IMUManager::getMaxFifoReadPeriodUs(imuFifoRate) / 1000));
+    return std::min(period, maxPeriod);
+}
 
+uint32_t getTaskPeriodUs(TaskId id) {
+    return getTaskPeriod(id) * portTICK_PERIOD_MS * 1000;
+}
 
-    xTaskCreatePinnedToCore(
-            micTask,
-            "MIC Task",
-            2048,
-            nullptr,
-            3,
-            &micTaskHandle,
-            APP_CPU_NUM
-    );
+void waitForPeriod(TaskId id, TickType_t &lastWakeTime) {
+    const TickType_t period = getTaskPeriod(id);
+    if (!powerGovernorEnabled && !remoteConfigEnabled) {
+        xTaskDelayUntil(&lastWakeTime, period);
+        return;
+    }
+
+    // 電力状態や設定が変わると wakePeriodicTasks() (IMUタスクは動き出しの割り込み) から起こされ，
+    // 延ばしていた周期の途中でも新しい周期で回り始める
+    const TickType_t elapsed = xTaskGetTickCount() - lastWakeTime;
+    if (elapsed < period && ulTaskNotifyTake(pdTRUE, period - elapsed) > 0) {
+        lastWakeTime = xTaskGetTickCount();
+        return;
+    }
+    lastWakeTime += period;
+}
+
+void updatePowerState() {
+    const uint32_t nowMs = millis();
+    bool changed = false;
+    if (motionInterrupt.exchange(false)) {
+        imuManager.clearMotionInterrupt();
+        changed = powerGovernor.wake(nowMs);
+    }
+    changed = powerGovernor.update(imuManager.getSnapshot().stillMs, nowMs) || changed;
+    if (changed) {
+        applyPowerState(powerGovernor.getState());
+    }
+}
+
+void applyPowerState(PowerState state) {
+    const auto &profile = powerProfiles[static_cast<size_t>(state)];
+
+#if CONFIG_PM_ENABLE
+    // 周波数の上限を決め，待ち時間には自動でライトスリープに入れるようにする
+    // (ライトスリープ中の動き出しは次のIMUの読み出しで拾う)
+    esp_pm_config_esp32_t pmConfig = {};
+    pmConfig.max_freq_mhz = static_cast<int>(profile.cpuMhz);
+    pmConfig.min_freq_mhz = 40;
+    pmConfig.light_sleep_enable = profile.lightSleep;
+    esp_pm_configure(&pmConfig);
+#else
+    setCpuFrequencyMhz(profile.cpuMhz);
+#endif
+    WiFi.setSleep(profile.wifiSleep);
+    micManager.setEnabled(profile.micEnabled);
+
+    // Active 中は割り込みを止めておき，IMUタスクの周期を乱さないようにする
+    imuManager.setWakeOnMotion(state != PowerState::Active, wakeOnMotionThresholdMg);
+
+    wakePeriodicTasks();
+
+    Serial.print("Power state: ");
+    Serial.println(PowerGovernor::getName(state));
+}
+
+void wakePeriodicTasks() {
+    for (auto handle: {imuTaskHandle, sendImuOscTaskHandle, sendMicOscTaskHandle, sendMicBandsOscTaskHandle}) {
+        if (handle != nullptr && handle != xTaskGetCurrentTaskHandle()) {
+            xTaskNotifyGive(handle);
+        }
+    }
+}
+
+void IRAM_ATTR onMotionInterrupt() {
+    motionInterrupt = true;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    if (imuTaskHandle != nullptr) {
+        vTaskNotifyGiveFromISR(imuTaskHandle, &higherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+uint64_t getSampleTime(uint32_t timestampUs) {
+    // micros() の取得時刻を64bitに展開し，同期済みならサーバーの時刻 (NTP形式の経過時間) にする
+    return clockSync.toServerTime(ClockSync::extend(timestampUs, esp_timer_get_time()));
 }
 
 bool readOscPreference() {
     try {
         preferences.begin("osc", true);
-        oscServerIp = preferences.getString("oscServerIp", "192.168.100.10");
-        oscServerPort = preferences.getInt("oscServerPort", 9000);
+        oscServerIp = preferences.getString("oscServerIp", defaultOscServerIp);
+        oscServerPort = preferences.getInt("oscServerPort", defaultOscServerPort);
+        oscDestinations = preferences.getString("destinations", "");
         clientName = preferences.getString("clientName", "ccbt1");
         preferences.end();
     } catch (std::exception &e) {
@@ -192,72 +679,555 @@ bool readOscPreference() {
     return true;
 }
 
-void connectWiFi() {
-    displayManager.showWiFiConnectingScreen();
+void setupOscDestinations() {
+    // 保存されたOSCサーバーのアドレスが不正なら，初期値に戻して送信と設定変更の受け付けを続ける
+    IPAddress serverIp;
+    if (!serverIp.fromString(oscServerIp) || oscServerPort <= 0 || oscServerPort > 65535) {
+        Serial.print("Invalid OSC server, using the default: ");
+        Serial.print(oscServerIp);
+        Serial.print(":");
+        Serial.println(oscServerPort);
+        oscServerIp = defaultOscServerIp;
+        oscServerPort = defaultOscServerPort;
+    }
+
+    // ソケットを開けない (lwIP のソケットが足りない・ポートが使用中など) 場合は少し待ってやり直し，
+    // 続けて失敗する場合は再起動する
+    for (int attempt = 1;
+         !oscManager.setup(oscServerIp.c_str(), oscServerPort, remoteConfigEnabled ? oscReceivePort : 0);
+         attempt++) {
+        if (attempt >= oscSetupRetries) {
+            Serial.println("OSC setup failed, restarting");
+            ESP.restart();
+        }
+        delay(oscSetupRetryDelayMs);
+    }
+
+    // "192.168.100.20:9000,239.0.0.1:9000" のようにカンマ区切りで並べる
+    const char *p = oscDestinations.c_str();
+    while (*p != '\0') {
+        const char *end = strchr(p, ',');
+        const size_t length = end != nullptr ? static_cast<size_t>(end - p) : strlen(p);
+        char entry[32];
+        if (length > 0 && length < sizeof(entry)) {
+            memcpy(entry, p, length);
+            entry[length] = '\0';
+            char *colon = strchr(entry, ':');
+            const auto port = colon != nullptr ? static_cast<uint16_t>(strtoul(colon + 1, nullptr, 10)) : 0;
+            if (colon != nullptr) {
+                *colon = '\0';
+            }
+            if (!oscManager.addDestination(entry, port)) {
+                Serial.print("Invalid OSC destination: ");
+                Serial.println(entry);
+            }
+        }
+        p += length;
+        if (*p == ',') {
+            p++;
+        }
+    }
+}
+
+void loadStreamConfig() {
+    for (size_t i = 0; i < numTasks; i++) {
+        taskPeriods[i] = taskConfigs[i].period;
+    }
+    if (!remoteConfigEnabled) {
+        return;
+    }
+
+    streamPreferences.begin("stream", true);
+    for (const auto id: streamTasks) {
+        const auto &config = getTaskConfig(id);
+        taskPeriods[static_cast<size_t>(id)] = limitTaskPeriod(id, streamPreferences.getUInt(config.id, config.period));
+    }
+    enabledStreams = streamPreferences.getUInt("streams", allStreams) & allStreams;
+    const uint8_t layout = streamPreferences.getUChar("format", static_cast<uint8_t>(defaultOscLayout));
+    if (layout < layoutNames.size()) {
+        oscLayout = static_cast<OSCManager::Layout>(layout);
+    }
+    const uint8_t reportMode = streamPreferences.getUChar("mic_report", static_cast<uint8_t>(defaultMicReportMode));
+    if (reportMode < micReportModeNames.size()) {
+        micReportMode = static_cast<MicReportMode>(reportMode);
+    }
+    streamPreferences.end();
+}
+
+void saveStreamConfig() {
+    // 変わった値だけを書き込む (フラッシュの書き換え回数を抑える)
+    streamPreferences.begin("stream", false);
+    for (const auto id: streamTasks) {
+        const auto &config = getTaskConfig(id);
+        const uint32_t period = taskPeriods[static_cast<size_t>(id)];
+        if (streamPreferences.getUInt(config.id, config.period) != period) {
+            streamPreferences.putUInt(config.id, period);
+        }
+    }
+    if (streamPreferences.getUInt("streams", allStreams) != enabledStreams) {
+        streamPreferences.putUInt("streams", enabledStreams);
+    }
+    const auto layout = static_cast<uint8_t>(oscLayout.load());
+    if (streamPreferences.getUChar("format", static_cast<uint8_t>(defaultOscLayout)) != layout) {
+        streamPreferences.putUChar("format", layout);
+    }
+    const auto reportMode = static_cast<uint8_t>(micReportMode.load());
+    if (streamPreferences.getUChar("mic_report", static_cast<uint8_t>(defaultMicReportMode)) != reportMode) {
+        streamPreferences.putUChar("mic_report", reportMode);
+    }
+    streamPreferences.end();
+}
+
+void handleConfigPacket(const uint8_t *data, size_t size) {
+    OSCMessageReader reader;
+    if (!reader.begin(data, size)) {
+        return;
+    }
+
+    // 自分宛て (/{client_name}/config/...) と全ノード宛て (/all/config/...) だけを受け付ける
+    char ownPrefix[32];
+    snprintf(ownPrefix, sizeof(ownPrefix), "/%s/config/", clientName.c_str());
+    const char allPrefix[] = "/all/config/";
+
+    bool changed = false;
+    while (reader.next()) {
+        const char *address = reader.getAddress();
+        const char *command = nullptr;
+        if (strncmp(address, ownPrefix, strlen(ownPrefix)) == 0) {
+            command = address + strlen(ownPrefix);
+        } else if (strncmp(address, allPrefix, strlen(allPrefix)) == 0) {
+            command = address + strlen(allPrefix);
+        }
+        if (command != nullptr && applyConfig(command, reader)) {
+            changed = true;
+        }
+    }
+    if (!changed) {
+        return;
+    }
+
+    saveStreamConfig();
+    wakePeriodicTasks();
+    sendConfigStatus();
+}
+
+bool applyConfig(const char *command, const OSCMessageReader &message) {
+    float value = 0.0f;
+
+    // rate/{task} float(hz)
+    if (strncmp(command, "rate/", 5) == 0) {
+        for (const auto id: streamTasks) {
+            if (strcmp(command + 5, getTaskConfig(id).id) != 0) {
+                continue;
+            }
+            if (!message.getNumber(0, value) || !(value > 0.0f) || value > maxStreamRate) {
+                return false;
+            }
+            const TickType_t period = limitTaskPeriod(id, std::max<TickType_t>(1, pdMS_TO_TICKS(1000.0f / value)));
+            return taskPeriods[static_cast<size_t>(id)].exchange(period) != period;
+        }
+        return false;
+    }
+
+    // stream/{name} bool(enabled)
+    if (strncmp(command, "stream/", 7) == 0) {
+        for (size_t i = 0; i < numStreams; i++) {
+            if (strcmp(command + 7, streamNames[i]) != 0) {
+                continue;
+            }
+            if (!message.getNumber(0, value)) {
+                return false;
+            }
+            const uint32_t bit = 1u << i;
+            const bool enable = value != 0.0f;
+            const uint32_t previous = enable ? enabledStreams.fetch_or(bit) : enabledStreams.fetch_and(~bit);
+            return ((previous & bit) != 0) != enable;
+        }
+        return false;
+    }
+
+    // 名前または番号で指定された選択肢の番号を返す (不正なら names.size())
+    auto getChoice = [&message, &value](const std::array<const char *, 3> &names) -> size_t {
+        const char *name = message.getString(0);
+        if (name != nullptr) {
+            return std::find_if(names.begin(), names.end(), [name](const char *n) {
+                return strcmp(n, name) == 0;
+            }) - names.begin();
+        }
+        if (message.getNumber(0, value) && value >= 0.0f) {
+            return std::min(static_cast<size_t>(value), names.size());
+        }
+        return names.size();
+    };
+
+    // format string(message|bundle|binary) または int(0 - 2)
+    if (strcmp(command, "format") == 0) {
+        const size_t layout = getChoice(layoutNames);
+        if (layout >= layoutNames.size()) {
+            return false;
+        }
+        const auto next = static_cast<OSCManager::Layout>(layout);
+        return oscLayout.exchange(next) != next;
+    }
+
+    // mic/report string(mean|max|latest) または int(0 - 2)
+    if (strcmp(command, "mic/report") == 0) {
+        const size_t reportMode = getChoice(micReportModeNames);
+        if (reportMode >= micReportModeNames.size()) {
+            return false;
+        }
+        const auto next = static_cast<MicReportMode>(reportMode);
+        return micReportMode.exchange(next) != next;
+    }
+
+    // reset: ビルド時の設定に戻す
+    if (strcmp(command, "reset") == 0) {
+        for (const auto id: streamTasks) {
+            taskPeriods[static_cast<size_t>(id)] = getTaskConfig(id).period;
+        }
+        enabledStreams = allStreams;
+        oscLayout = defaultOscLayout;
+        micReportMode = defaultMicReportMode;
+        return true;
+    }
+    return false;
+}
+
+void sendConfigStatus() {
+    for (size_t i = 0; i < streamTasks.size(); i++) {
+        const TickType_t period = taskPeriods[static_cast<size_t>(streamTasks[i])];
+        configStatusMessage.setFloat(i, 1000.0f / (period * portTICK_PERIOD_MS));
+    }
+    configStatusMessage.setInt(streamTasks.size(), enabledStreams);
+    configStatusMessage.setInt(streamTasks.size() + 1, static_cast<int32_t>(oscLayout.load()));
+    configStatusMessage.setInt(streamTasks.size() + 2, static_cast<int32_t>(micReportMode.load()));
+    oscManager.send(configStatusMessage);
+}
+
+bool isStreamEnabled(Stream stream) {
+    return (enabledStreams & (1u << static_cast<size_t>(stream))) != 0;
+}
+
+OSCManager::Layout getOscLayout() {
+    const OSCManager::Layout layout = oscLayout;
+    // 混雑している間は1メッセージ1パケットをやめて，1フレーム分を Bundle にまとめる
+    if (adaptiveRateEnabled && layout == OSCManager::Layout::Message && congestionController.isBundled()) {
+        return OSCManager::Layout::Bundle;
+    }
+    return layout;
+}
+
+void buildOscMessages() {
+    // アドレスとタイプタグはここで一度だけエンコードし，送信時は値だけを書き換える
+    auto build = [](OSCMessageTemplate &message, const char *path, const char *typeTags) {
+        char address[64];
+        snprintf(address, sizeof(address), "/%s%s", clientName.c_str(), path);
+        if (!message.build(address, typeTags)) {
+            Serial.print("Failed to build OSC message: ");
+            Serial.println(address);
+        }
+    };
+
+    // 取得時刻を付ける場合は値の後ろにタイムタグを1つ足す (タイムタグのインデックスは値の個数)
+    auto buildSampled = [&build](OSCMessageTemplate &message, const char *path, const char *typeTags) {
+        char sampledTypeTags[8];
+        snprintf(sampledTypeTags, sizeof(sampledTypeTags), "%s%s", typeTags, messageTimestampEnabled ? "t" : "");
+        build(message, path, sampledTypeTags);
+    };
+
+    buildSampled(accMessage, "/imu/acc", "fff");
+    buildSampled(gyroMessage, "/imu/gyro", "fff");
+    buildSampled(rotationMessage, "/imu/rotation", "ff");
+    buildSampled(quaternionMessage, "/imu/quaternion", "ffff");
+    buildSampled(eulerMessage, "/imu/euler", "fff");
+    buildSampled(linearAccMessage, "/imu/linear_acc", "fff");
+    buildSampled(micMessage, "/mic/volume", "ff");
+    buildSampled(micBundleMessage, "/mic/volume", "ff");
+    build(batteryMessage, "/status/battery", "iT");
+    build(micStatusMessage, "/status/mic", "iii");
+
+    // 帯域数 + 重心 + フラックス
+    char bandsTypeTags[SpectrumAnalyzer::numBands + 3];
+    for (size_t i = 0; i < SpectrumAnalyzer::numBands + 2; i++) {
+        bandsTypeTags[i] = 'f';
+    }
+    bandsTypeTags[SpectrumAnalyzer::numBands + 2] = '\0';
+    build(micBandsMessage, "/mic/bands", bandsTypeTags);
+
+    build(cpuMessage, "/status/cpu", "ffi");
+    build(suppressionMessage, "/status/suppression", "ffii");
+    build(syncPingMessage, "/sync/ping", "t");
+    build(syncPongMessage, "/sync/pong", "ttt");
+    build(syncStatusMessage, "/status/sync", "Tiiifii");
+    build(powerMessage, "/status/power", "ifffiif");
+    build(configStatusMessage, "/status/config", "ffffiii");
+    build(congestionMessage, "/status/congestion", "fTfiiii");
+    build(bootMessage, "/status/boot", "iiT");
+    build(captureMessage, "/status/capture", "Tiiiiii");
+    for (size_t i = 0; i < OSCManager::maxDestinations; i++) {
+        char path[32];
+        snprintf(path, sizeof(path), "/status/destination/%u", static_cast<unsigned>(i));
+        build(destinationMessages[i], path, "ii");
+    }
+    for (size_t i = 0; i < numTasks; i++) {
+        char path[32];
+        snprintf(path, sizeof(path), "/status/task/%s", taskConfigs[i].id);
+        build(taskMessages[i], path, "fi");
+    }
+    for (size_t i = 0; i < I2CArbiter::numClients; i++) {
+        char path[32];
+        snprintf(path, sizeof(path), "/status/i2c/%s", I2CArbiter::getName(static_cast<I2CArbiter::Client>(i)));
+        build(i2cMessages[i], path, "fiii");
+    }
+    for (size_t i = 0; i < MotionDetector::numEventTypes; i++) {
+        const auto type = static_cast<MotionDetector::EventType>(i);
+        char path[32];
+        snprintf(path, sizeof(path), "/event/%s", MotionDetector::getName(type));
+        // 衝撃には開始・終了がないので active を付けない
+        build(motionEventMessages[i], path, type == MotionDetector::EventType::Impact ? "tf" : "tTf");
+    }
+
+#if PERF_ENABLED
+    for (size_t i = 0; i < PerfMonitor::numMetrics; i++) {
+        char path[48];
+        snprintf(path, sizeof(path), "/status/perf/%s", PerfMonitor::getName(static_cast<PerfMonitor::Metric>(i)));
+        build(perfMessages[i], path, "iiiiii");
+    }
+#endif
+}
+
+void setupDeltaGates() {
+    accGate.setup(accThreshold, keyframeIntervalUs);
+    gyroGate.setup(gyroThreshold, keyframeIntervalUs);
+    rotationGate.setup(rotationThreshold, keyframeIntervalUs);
+    orientationGate.setup(quaternionThreshold, keyframeIntervalUs);
+    linearAccGate.setup(linearAccThreshold, keyframeIntervalUs);
+    micGate.setup(micThreshold, keyframeIntervalUs);
+}
 
+uint8_t parseNodeId(const String &name) {
+    // "ccbt12" -> 12 (末尾に数字がなければ 0)
+    size_t begin = name.length();
+    while (begin > 0 && isdigit(static_cast<unsigned char>(name.c_str()[begin - 1]))) {
+        begin--;
+    }
+    return static_cast<uint8_t>(strtoul(name.c_str() + begin, nullptr, 10));
+}
+
+DeltaGateStats getImuGateStats() {
+    DeltaGateStats total{};
+    for (const auto &stats: {accGate.getStats(), gyroGate.getStats(), rotationGate.getStats(),
+                             orientationGate.getStats(), linearAccGate.getStats()}) {
+        total.sent += stats.sent;
+        total.suppressed += stats.suppressed;
+    }
+    return total;
+}
+
+bool beginFastConnect() {
+    WiFiCache cache{};
+    if (!loadWiFiCache(cache)) {
+        return false;
+    }
+    // SSID とパスワードは WiFiManager で接続した時に WiFi ドライバが保存したものを使う
     WiFiManager wm;
-    WiFiManagerParameter oscServerIpParam("oscServerIp",
-                                          "OSC Server IP",
-                                          oscServerIp.c_str(),
-                                          15);
-    WiFiManagerParameter oscServerPortParam("oscServerPort",
-                                            "OSC Server Port",
-                                            std::to_string(oscServerPort).c_str(),
-                                            5);
-    WiFiManagerParameter clientNameParam("clientName",
-                                         "Client Name",
-                                         clientName.c_str(),
-                                         15);
+    const String ssid = wm.getWiFiSSID(true);
+    const String pass = wm.getWiFiPass(true);
+    if (ssid.length() == 0) {
+        return false;
+    }
 
+    wifiStartMs = millis();
     WiFiClass::mode(WIFI_STA);
+    // DHCPを待たないよう前回のアドレスをそのまま使い，チャンネルとBSSIDを指定してスキャンを省く
+    // (接続先の設定が前回と同じなら WiFi ドライバは設定を保存し直さない)
+    WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+    WiFi.begin(ssid.c_str(), pass.c_str(), cache.channel, cache.bssid.data(), true);
+    return true;
+}
 
-    wm.setConnectRetries(3);
-    wm.setConnectTimeout(30);
-    wm.setConfigPortalTimeout(180);
-    wm.setMinimumSignalQuality();
-    wm.setSTAStaticIPConfig(
-            IPAddress(192, 168, 100, 11),
-            IPAddress(192, 168, 100, 1),
-            IPAddress(255, 255, 255, 0)
-    );
-    wm.setSaveConfigCallback([]() {
-        displayManager.showWiFiSettingSavedScreen();
-    });
-
-    wm.addParameter(&oscServerIpParam);
-    wm.addParameter(&oscServerPortParam);
-    wm.addParameter(&clientNameParam);
-
-    auto ssid = wm.getDefaultAPName();
-    if (wm.autoConnect(ssid.c_str())) {
-        Serial.println("WiFi connected");
-        Serial.print("IP: ");
-        Serial.println(WiFi.localIP());
-        Serial.print("MAC: ");
-        Serial.println(WiFi.macAddress());
-
-        displayManager.showWiFiSettingSuccessScreen();
+void connectWiFi(bool fastConnecting) {
+    displayManager.showWiFiConnectingScreen();
+
+    if (fastConnecting) {
+        while (WiFiClass::status() != WL_CONNECTED && millis() - wifiStartMs < fastConnectTimeoutMs) {
+            delay(10);
+        }
+        fastConnected = WiFiClass::status() == WL_CONNECTED;
+        if (!fastConnected) {
+            // アクセスポイントが変わった場合など．DHCPに戻してから WiFiManager に任せる
+            Serial.println("Fast connect failed");
+            WiFi.disconnect();
+            WiFi.config(IPAddress(), IPAddress(), IPAddress());
+        }
+    }
+
+    if (fastConnected) {
+        // ポータルを開いていないので OSC の設定は読み込んだままで，保存し直す必要もない
+        Serial.println("WiFi connected (fast)");
     } else {
-        displayManager.showWiFiSettingFailedScreen();
-        delay(2000);
-        ESP.restart();
-        delay(1000);
+        if (!fastConnecting) {
+            wifiStartMs = millis();
+        }
+
+        WiFiManager wm;
+        WiFiManagerParameter oscServerIpParam("oscServerIp",
+                                              "OSC Server IP",
+                                              oscServerIp.c_str(),
+                                              15);
+        WiFiManagerParameter oscServerPortParam("oscServerPort",
+                                                "OSC Server Port",
+                                                std::to_string(oscServerPort).c_str(),
+                                                5);
+        WiFiManagerParameter oscDestinationsParam("destinations",
+                                                  "Extra Destinations (ip:port,ip:port)",
+                                                  oscDestinations.c_str(),
+                                                  70);
+        WiFiManagerParameter clientNameParam("clientName",
+                                             "Client Name",
+                                             clientName.c_str(),
+                                             15);
+
+        WiFiClass::mode(WIFI_STA);
+
+        wm.setConnectRetries(3);
+        wm.setConnectTimeout(30);
+        wm.setConfigPortalTimeout(180);
+        wm.setMinimumSignalQuality();
+        wm.setSTAStaticIPConfig(
+                IPAddress(192, 168, 100, 11),
+                IPAddress(192, 168, 100, 1),
+                IPAddress(255, 255, 255, 0)
+        );
+        wm.setSaveConfigCallback([]() {
+            displayManager.showWiFiSettingSavedScreen();
+        });
+
+        wm.addParameter(&oscServerIpParam);
+        wm.addParameter(&oscServerPortParam);
+        wm.addParameter(&oscDestinationsParam);
+        wm.addParameter(&clientNameParam);
+
+        auto ssid = wm.getDefaultAPName();
+        if (wm.autoConnect(ssid.c_str())) {
+            Serial.println("WiFi connected");
+        } else {
+            displayManager.showWiFiSettingFailedScreen();
+            delay(2000);
+            ESP.restart();
+            delay(1000);
+        }
+
+        // 変わった項目だけを書き込む (起動のたびにフラッシュを書き換えない)
+        oscServerIp = oscServerIpParam.getValue();
+        oscServerPort = strtol(oscServerPortParam.getValue(), nullptr, 10);
+        oscDestinations = oscDestinationsParam.getValue();
+        clientName = clientNameParam.getValue();
+        preferences.begin("osc", false);
+        if (preferences.getString("oscServerIp", "") != oscServerIp) {
+            preferences.putString("oscServerIp", oscServerIp);
+        }
+        if (preferences.getInt("oscServerPort", 0) != oscServerPort) {
+            preferences.putInt("oscServerPort", oscServerPort);
+        }
+        if (preferences.getString("destinations", "") != oscDestinations) {
+            preferences.putString("destinations", oscDestinations);
+        }
+        if (preferences.getString("clientName", "") != clientName) {
+            preferences.putString("clientName", clientName);
+        }
+        preferences.end();
     }
+    wifiConnectMs = millis() - wifiStartMs;
+
+    Serial.print("IP: ");
+    Serial.println(WiFi.localIP());
+    Serial.print("MAC: ");
+    Serial.println(WiFi.macAddress());
+    Serial.print("Connect time [ms]: ");
+    Serial.println(wifiConnectMs);
+    displayManager.showWiFiSettingSuccessScreen();
+
+    if (fastBootEnabled) {
+        saveWiFiCache();
+    }
+
+    const auto power = i2cArbiter.readPower(powerReadingMaxAgeMs);
+    displayManager.showStatusScreen(clientName.c_str(), oscServerPort, power.batteryLevel, power.charging);
+}
+
+bool loadWiFiCache(WiFiCache &cache) {
+    preferences.begin("wifi", true);
+    const bool found = preferences.getBytes("bssid", cache.bssid.data(), cache.bssid.size()) == cache.bssid.size();
+    cache.channel = preferences.getUChar("channel", 0);
+    cache.ip = preferences.getUInt("ip", 0);
+    cache.gateway = preferences.getUInt("gateway", 0);
+    cache.subnet = preferences.getUInt("subnet", 0);
+    cache.dns = preferences.getUInt("dns", 0);
+    preferences.end();
+    return found && cache.channel != 0 && cache.ip != 0;
+}
 
-    preferences.begin("osc", false);
-    oscServerIp = oscServerIpParam.getValue();
-    oscServerPort = strtol(oscServerPortParam.getValue(), nullptr, 10);
-    clientName = clientNameParam.getValue();
-    preferences.putString("oscServerIp", oscServerIp);
-    preferences.putInt("oscServerPort", oscServerPort);
-    preferences.putString("clientName", clientName);
+void saveWiFiCache() {
+    const uint8_t *bssid = WiFi.BSSID();
+    if (bssid == nullptr) {
+        return;
+    }
+    WiFiCache current{};
+    std::copy(bssid, bssid + current.bssid.size(), current.bssid.begin());
+    current.channel = static_cast<uint8_t>(WiFi.channel());
+    current.ip = WiFi.localIP();
+    current.gateway = WiFi.gatewayIP();
+    current.subnet = WiFi.subnetMask();
+    current.dns = WiFi.dnsIP();
+
+    // 同じアクセスポイントにつながっている間は何も書き込まない
+    WiFiCache saved{};
+    loadWiFiCache(saved);
+    preferences.begin("wifi", false);
+    if (saved.bssid != current.bssid) {
+        preferences.putBytes("bssid", current.bssid.data(), current.bssid.size());
+    }
+    if (saved.channel != current.channel) {
+        preferences.putUChar("channel", current.channel);
+    }
+    if (saved.ip != current.ip) {
+        preferences.putUInt("ip", current.ip);
+    }
+    if (saved.gateway != current.gateway) {
+        preferences.putUInt("gateway", current.gateway);
+    }
+    if (saved.subnet != current.subnet) {
+        preferences.putUInt("subnet", current.subnet);
+    }
+    if (saved.dns != current.dns) {
+        preferences.putUInt("dns", current.dns);
+    }
     preferences.end();
+}
 
-    displayManager.showStatusScreen(clientName.c_str(), oscServerPort);
+void sendBootStatus() {
+    // micros() はアプリの起動 (esp_timer の開始) からの時間
+    const uint32_t firstSendUs = oscManager.getFirstSendUs();
+    bootMessage.setInt(0, firstSendUs / 1000);
+    bootMessage.setInt(1, wifiConnectMs);
+    bootMessage.setBool(2, fastConnected);
+    oscManager.send(bootMessage);
 }
 
 void loop() {
-    M5.update();
+    // ボタンの読み出しも内部I2C (電源ボタン) を使うので，IMUの読み出しと重ならないようにする
+    {
+        I2CArbiter::Lock lock(&i2cArbiter, I2CArbiter::Client::System);
+        M5.update();
+    }
+    if (captureEnabled && M5.BtnB.wasPressed()) {
+        if (captureRecorder.isRecording()) {
+            captureRecorder.requestStop();
+        } else {
+            captureRecorder.requestStart();
+        }
+    }
     if (M5.BtnA.wasReleaseFor(3000)) {
         xSemaphoreTake(displaySemaphore, portMAX_DELAY);
 
@@ -267,12 +1237,19 @@ void loop() {
         // 5秒間ボタンが押されなければreturn false
         unsigned long startMillis = millis();
         while (true) {
-            M5.update();
+            {
+                I2CArbiter::Lock lock(&i2cArbiter, I2CArbiter::Client::System);
+                M5.update();
+            }
             if (M5.BtnA.wasPressed()) {
                 Serial.println("Reset WiFi Setting confirmed.");
                 preferences.begin("osc", false);
                 preferences.clear();
                 preferences.end();
+                // 前回の接続先も忘れ，次の起動では WiFiManager から始める
+                preferences.begin("wifi", false);
+                preferences.clear();
+                preferences.end();
 
                 delay(1000);
                 WiFi.disconnect(true, true);
@@ -296,23 +1273,21 @@ void loop() {
 
 // ====== Task ======
 [[noreturn]] void healthCheckTask(void *pvParameters) {
-    TickType_t xLastWakeTime = xTaskGetTickCount();
     static auto connectionFailedCount = 0;
     static auto reconnectCount = 0;
-    String batteryAddress = "/" + clientName + "/status/battery";
+
+    // 起動直後に一度，起動から最初のパケットを送るまでの時間を通知する
+    vTaskDelay(bootReportDelay);
+    sendBootStatus();
+    TickType_t xLastWakeTime = xTaskGetTickCount();
 
     while (true) {
         // WiFiの疎通確認
         // auto reconnect で対応しきれない場合に再接続を試みる
 
         xTaskDelayUntil(&xLastWakeTime,
-                        healthCheckInterval);
-
-        xSemaphoreTake(displaySemaphore, portMAX_DELAY);
-
-        DisplayManager::showStatusScreen(clientName.c_str(), oscServerPort);
-
-        xSemaphoreGive(displaySemaphore);
+                        getTaskConfig(TaskId::HealthCheck).period);
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::HealthCheck));
 
         if (WiFiClass::status() == WL_CONNECTED) {
             Serial.println("WiFi is connected and reachable");
@@ -338,15 +1313,115 @@ void loop() {
             reconnectCount++;
         }
 
-        auto isCharging = M5.Power.isCharging();
-        auto getBatteryLevel = M5.Power.getBatteryLevel();
+        const auto power = i2cArbiter.readPower(powerReadingMaxAgeMs);
+        auto isCharging = power.charging;
+        auto getBatteryLevel = power.batteryLevel;
+        batteryLevel = getBatteryLevel;
+        batteryCharging = isCharging;
 
         // バッテリー状態の確認低バッテリーの場合はOSCで通知する
-        OscWiFi.send(oscServerIp.c_str(),
-                     oscServerPort,
-                     batteryAddress.c_str(),
-                     getBatteryLevel,
-                     (bool) isCharging);
+        batteryMessage.setInt(0, getBatteryLevel);
+        batteryMessage.setBool(1, isCharging);
+        oscManager.send(batteryMessage);
+
+        // マイク入力が途切れていないかを通知する
+        const auto micStats = micManager.getStats();
+        micStatusMessage.setInt(0, micStats.blocks);
+        micStatusMessage.setInt(1, micStats.overruns);
+        micStatusMessage.setInt(2, micStats.droppedSamples);
+        oscManager.send(micStatusMessage);
+
+        sendBootStatus();
+
+        // 電力状態ごとの滞在時間と電池の減り方を通知する
+        if (powerGovernorEnabled) {
+            static std::array<uint32_t, numPowerStates> lastResidencyMs{};
+            const uint32_t nowMs = millis();
+            powerMessage.setInt(0, static_cast<int32_t>(powerGovernor.getState()));
+            for (size_t i = 0; i < numPowerStates; i++) {
+                const uint32_t residencyMs = powerGovernor.getResidencyMs(static_cast<PowerState>(i), nowMs);
+                powerMessage.setFloat(1 + i, (residencyMs - lastResidencyMs[i]) / 1000.0f);
+                lastResidencyMs[i] = residencyMs;
+            }
+            // 起動時からの平均 (ADCの誤差があるので短い区間では求めない)
+            const int16_t batteryVoltage = power.batteryVoltage;
+            const float hours = nowMs / 3600000.0f;
+            powerMessage.setInt(4, powerGovernor.getWakeups());
+            powerMessage.setInt(5, batteryVoltage);
+            powerMessage.setFloat(6, hours > 0.0f ? (bootBatteryVoltage - batteryVoltage) / hours : 0.0f);
+            oscManager.send(powerMessage);
+        }
+
+        // 送信先ごとの送信数と失敗数を通知する
+        for (size_t i = 0; i < oscManager.getNumDestinations(); i++) {
+            const auto stats = oscManager.getDestinationStats(i);
+            destinationMessages[i].setInt(0, stats.sent);
+            destinationMessages[i].setInt(1, stats.errors);
+            oscManager.send(destinationMessages[i]);
+        }
+
+        // 前回からの内部I2Cの使用率と待ち時間を通知する
+        for (size_t i = 0; i < I2CArbiter::numClients; i++) {
+            const auto stats = i2cArbiter.takeStats(static_cast<I2CArbiter::Client>(i));
+            i2cMessages[i].setFloat(0, stats.elapsedUs > 0 ? 100.0f * stats.busyUs / stats.elapsedUs : 0.0f);
+            i2cMessages[i].setInt(1, stats.transactions);
+            i2cMessages[i].setInt(2, stats.waitMaxUs);
+            i2cMessages[i].setInt(3, stats.deferred);
+            oscManager.send(i2cMessages[i]);
+        }
+
+        // 前回からのCPU使用率を通知する
+        // 求められなかった場合も使用率を -1 として送り，使えないことを知らせる
+        const bool sampled = taskMonitor.sample();
+        cpuMessage.setFloat(0, sampled ? taskMonitor.getCoreLoad(PRO_CPU_NUM) : -1.0f);
+        cpuMessage.setFloat(1, sampled ? taskMonitor.getCoreLoad(APP_CPU_NUM) : -1.0f);
+        cpuMessage.setInt(2, static_cast<int32_t>(taskMonitor.getSource()));
+        oscManager.send(cpuMessage);
+        for (size_t i = 0; sampled && i < numTasks; i++) {
+            if (!taskMonitor.isTracked(i)) {
+                continue;
+            }
+            const auto load = taskMonitor.getTaskLoad(i);
+            taskMessages[i].setFloat(0, load.cpuPercent);
+            taskMessages[i].setInt(1, load.stackHighWaterMark);
+            oscManager.send(taskMessages[i]);
+        }
+
+        // 前回からの間引き率を通知する
+        if (oscDeadbandEnabled) {
+            static DeltaGateStats lastImuStats{};
+            static DeltaGateStats lastMicStats{};
+            const auto imuStats = getImuGateStats();
+            const auto micStats = micGate.getStats();
+            const uint32_t imuSent = imuStats.sent - lastImuStats.sent;
+            const uint32_t imuSuppressed = imuStats.suppressed - lastImuStats.suppressed;
+            const uint32_t micSent = micStats.sent - lastMicStats.sent;
+            const uint32_t micSuppressed = micStats.suppressed - lastMicStats.suppressed;
+            lastImuStats = imuStats;
+            lastMicStats = micStats;
+
+            suppressionMessage.setFloat(0, imuSent + imuSuppressed > 0
+                                           ? static_cast<float>(imuSuppressed) / (imuSent + imuSuppressed) : 0.0f);
+            suppressionMessage.setFloat(1, micSent + micSuppressed > 0
+                                           ? static_cast<float>(micSuppressed) / (micSent + micSuppressed) : 0.0f);
+            suppressionMessage.setInt(2, imuSent);
+            suppressionMessage.setInt(3, micSent);
+            oscManager.send(suppressionMessage);
+        }
+
+#if PERF_ENABLED
+        // 前回からの実行時間・起床周期のパーセンタイルを通知する
+        for (size_t i = 0; i < PerfMonitor::numMetrics; i++) {
+            const auto summary = PerfMonitor::report(static_cast<PerfMonitor::Metric>(i));
+            perfMessages[i].setInt(0, summary.count);
+            perfMessages[i].setInt(1, summary.p50Us);
+            perfMessages[i].setInt(2, summary.p90Us);
+            perfMessages[i].setInt(3, summary.p99Us);
+            perfMessages[i].setInt(4, summary.maxUs);
+            perfMessages[i].setInt(5, summary.missed);
+            oscManager.send(perfMessages[i]);
+        }
+#endif
     }
 
     vTaskDelete(healthCheckTaskHandle);
@@ -355,11 +1430,22 @@ void loop() {
 [[noreturn]] void imuTask(void *pvParameters) {
     TickType_t xLastWakeTime = xTaskGetTickCount();
     while (true) {
-        xTaskDelayUntil(&xLastWakeTime,
-                        imuUpdateInterval);
-        xSemaphoreTake(imuSemaphore, portMAX_DELAY);
-        imuManager.update();
-        xSemaphoreGive(imuSemaphore);
+        waitForPeriod(TaskId::Imu, xLastWakeTime);
+        PERF_WAKE(ImuWake, getTaskPeriodUs(TaskId::Imu));
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::Imu));
+
+        i2cArbiter.setImuPeriod(getTaskPeriodUs(TaskId::Imu));
+        {
+            // 読み出しと姿勢推定だけを測る (通知や電力状態の更新は含めない)
+            PERF_SCOPE(ImuUpdate);
+            imuManager.update();
+        }
+        if (motionEventsEnabled && imuManager.hasMotionEvent()) {
+            xTaskNotifyGive(motionEventTaskHandle);
+        }
+        if (powerGovernorEnabled) {
+            updatePowerState();
+        }
     }
 
     vTaskDelete(imuTaskHandle);
@@ -367,23 +1453,14 @@ void loop() {
 
 
 [[noreturn]] void micTask(void *pvParameters) {
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    size_t readBytes;
-
+    // DMAバッファが埋まるたびにI2Sドライバのイベントで起こされる
     while (true) {
-        xTaskDelayUntil(&xLastWakeTime,
-                        micSamplingInterval);
-
-        xSemaphoreTake(micSemaphore, portMAX_DELAY);
-
-        i2s_read(I2S_NUM_0,
-                 (char *) buffer,
-                 micBufferSize,
-                 &readBytes,
-                 i2sWaitTime);
-        adcBuffer = (int16_t *) buffer;
-        processSignal();
-        xSemaphoreGive(micSemaphore);
+        i2s_event_t event;
+        if (!micManager.waitForEvent(event)) {
+            continue;
+        }
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::Mic));
+        micManager.handleEvent(event);
     }
     vTaskDelete(micTaskHandle);
 }
@@ -392,37 +1469,154 @@ void loop() {
 [[noreturn]] void sendImuOscTask(void *pvParameters) {
     TickType_t xLastWakeTime = xTaskGetTickCount();
 
-    // 使用するOSCアドレス
-    String accAddress = "/" + clientName + "/imu/acc";
-    String gyroAddress = "/" + clientName + "/imu/gyro";
-    String rotationAddress = "/" + clientName + "/imu/rotation";
     while (true) {
-        xTaskDelayUntil(&xLastWakeTime,
-                        oscSendInterval_60fps);
+        waitForPeriod(TaskId::SendImuOsc, xLastWakeTime);
+        PERF_WAKE(ImuOscWake, getTaskPeriodUs(TaskId::SendImuOsc));
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::SendImuOsc));
+
+        // imuTaskを待たずに最新の計測結果を取り出す
+        const auto imu = imuManager.getSnapshot();
+        const auto &acc = imu.acc;
+        const auto &gyro = imu.gyro;
+        const auto &rotation = imu.rotation;
+
+        accMessage.setFloat(0, acc[0]);
+        accMessage.setFloat(1, acc[1]);
+        accMessage.setFloat(2, acc[2]);
+        gyroMessage.setFloat(0, gyro[0]);
+        gyroMessage.setFloat(1, gyro[1]);
+        gyroMessage.setFloat(2, gyro[2]);
+        rotationMessage.setFloat(0, rotation[0]);
+        rotationMessage.setFloat(1, rotation[1]);
+        if (imuFusionEnabled) {
+            for (size_t i = 0; i < 4; i++) {
+                quaternionMessage.setFloat(i, imu.quaternion[i]);
+            }
+            for (size_t i = 0; i < 3; i++) {
+                eulerMessage.setFloat(i, imu.euler[i]);
+                linearAccMessage.setFloat(i, imu.linearAcc[i]);
+            }
+        }
 
-        xSemaphoreTake(imuSemaphore, portMAX_DELAY);
+        // 前回送った値から変化していないメッセージは送らない (OSC_DEADBAND 指定時)
+        const uint32_t nowUs = micros();
+        const uint64_t sampleTimeUs = getSampleTime(imu.timestampUs);
+        if (messageTimestampEnabled) {
+            accMessage.setTimetag(3, sampleTimeUs);
+            gyroMessage.setTimetag(3, sampleTimeUs);
+            rotationMessage.setTimetag(2, sampleTimeUs);
+            if (imuFusionEnabled) {
+                quaternionMessage.setTimetag(4, sampleTimeUs);
+                eulerMessage.setTimetag(3, sampleTimeUs);
+                linearAccMessage.setTimetag(3, sampleTimeUs);
+            }
+        }
+        const bool sendAcc = isStreamEnabled(Stream::Acc) && accGate.pass(acc, nowUs);
+        const bool sendGyro = isStreamEnabled(Stream::Gyro) && gyroGate.pass(gyro, nowUs);
+        const bool sendRotation = isStreamEnabled(Stream::Rotation) && rotationGate.pass(rotation, nowUs);
+        const bool sendOrientation = imuFusionEnabled && isStreamEnabled(Stream::Orientation) &&
+                                     orientationGate.pass(imu.quaternion, nowUs);
+        const bool sendLinearAcc = imuFusionEnabled && isStreamEnabled(Stream::LinearAcc) &&
+                                   linearAccGate.pass(imu.linearAcc, nowUs);
+
+        const OSCManager::Layout layout = getOscLayout();
+        if (layout == OSCManager::Layout::Binary) {
+            // 1フレーム分を32バイトに量子化して1パケットで送る (クォータニオン等は含まない)
+            static uint32_t wireSequence = 0;
+            WireFormat::Frame frame{};
+            frame.nodeId = nodeId;
+            frame.timestampUs = static_cast<uint32_t>(sampleTimeUs);
+            frame.acc = acc;
+            frame.gyro = gyro;
+            frame.rotation = rotation;
+            if (micPending.exchange(false)) {
+                const auto mic = micLevel.read();
+                frame.flags |= WireFormat::flagMic;
+                frame.micPower = mic.power;
+                frame.micDb = mic.db;
+            }
+
+            // すべて間引かれた場合は送らない (受信側で欠落と区別できるよう番号も進めない)
+            if (sendAcc || sendGyro || sendRotation || (frame.flags & WireFormat::flagMic)) {
+                frame.sequence = ++wireSequence;
+                uint8_t packet[WireFormat::packetSize];
+                oscManager.send(packet, WireFormat::encode(frame, packet));
+            }
+            continue;
+        }
 
-        auto acc = imuManager.getAcc();
-        auto gyro = imuManager.getGyro();
-        auto rotation = imuManager.getRotation();
+        if (layout == OSCManager::Layout::Bundle) {
+            // 1フレーム分を1つのBundleにまとめて1パケットで送る
+            size_t numMessages = 0;
+            auto add = [&numMessages](bool send, const OSCMessageTemplate &message) {
+                if (send && oscManager.addMessage(message)) {
+                    numMessages++;
+                }
+            };
+            auto addImu = [&]() {
+                add(sendAcc, accMessage);
+                add(sendGyro, gyroMessage);
+                add(sendRotation, rotationMessage);
+                add(sendOrientation, quaternionMessage);
+                add(sendOrientation, eulerMessage);
+                add(sendLinearAcc, linearAccMessage);
+            };
+
+            if (micPending.exchange(false)) {
+                // MICの送信タイミングと重なった場合は同じパケットに載せる
+                // IMUとMICはそれぞれの取得時刻をタイムタグにした Bundle に入れ，早い方の時刻の Bundle で包む
+                const auto mic = micLevel.read();
+                const uint64_t micTimeUs = getSampleTime(mic.timestampUs);
+                micBundleMessage.setFloat(0, mic.power);
+                micBundleMessage.setFloat(1, mic.db);
+                if (messageTimestampEnabled) {
+                    micBundleMessage.setTimetag(2, micTimeUs);
+                }
+
+                oscManager.beginBundle(std::min(sampleTimeUs, micTimeUs));
+                if (sendAcc || sendGyro || sendRotation || sendOrientation || sendLinearAcc) {
+                    oscManager.beginNestedBundle(sampleTimeUs);
+                    addImu();
+                    oscManager.endNestedBundle();
+                }
+                oscManager.beginNestedBundle(micTimeUs);
+                add(true, micBundleMessage);
+                oscManager.endNestedBundle();
+            } else {
+                oscManager.beginBundle(sampleTimeUs);
+                addImu();
+            }
 
-        xSemaphoreGive(imuSemaphore);
+            // すべて間引かれた場合はパケット自体を送らない
+            if (numMessages > 0) {
+                oscManager.sendBundle();
+            }
+            continue;
+        }
 
         // ACC
-        OscWiFi.send(oscServerIp,
-                     oscServerPort,
-                     accAddress, acc[0], acc[1], acc[2]);
+        if (sendAcc) {
+            oscManager.send(accMessage);
+        }
 
         // GYRO
-        OscWiFi.send(oscServerIp,
-                     oscServerPort,
-                     gyroAddress, gyro[0], gyro[1], gyro[2]);
+        if (sendGyro) {
+            oscManager.send(gyroMessage);
+        }
 
         // ROLL & PITCH
-        OscWiFi.send(oscServerIp,
-                     oscServerPort,
-                     rotationAddress, rotation[0], rotation[1]);
+        if (sendRotation) {
+            oscManager.send(rotationMessage);
+        }
 
+        // QUATERNION & EULER & LINEAR ACC
+        if (sendOrientation) {
+            oscManager.send(quaternionMessage);
+            oscManager.send(eulerMessage);
+        }
+        if (sendLinearAcc) {
+            oscManager.send(linearAccMessage);
+        }
     }
 
     vTaskDelete(sendImuOscTaskHandle);
@@ -431,87 +1625,367 @@ void loop() {
 [[noreturn]] void sendMicOscTask(void *pvParameters) {
     TickType_t xLastWakeTime = xTaskGetTickCount();
 
-    // 使用するOSCアドレス
-    String micAddress = "/" + clientName + "/mic/volume";
     auto db = 0.0f;
     auto power = 0.0f;
+    uint32_t timestampUs = 0;
     while (true) {
-        xTaskDelayUntil(&xLastWakeTime,
-                        oscSendInterval_30fps);
+        waitForPeriod(TaskId::SendMicOsc, xLastWakeTime);
+        PERF_WAKE(MicOscWake, getTaskPeriodUs(TaskId::SendMicOsc));
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::SendMicOsc));
 
-        xSemaphoreTake(micSemaphore, portMAX_DELAY);
-        // 蓄積されたデータの平均を取り、dBに変換する
-        if (numPower > 0) {
-            power = totalPower / numPower;
-            db = calcDecibel(power);
-            totalPower = 0;
-            numPower = 0;
+        // マイクを止めている間は送らない
+        if (!micManager.isEnabled()) {
+            continue;
+        }
+
+        // 前回の送信以降に溜まったブロックをまとめ、dBに変換する
+        AudioFeature feature{};
+        auto numFeatures = 0;
+        auto sumRms = 0.0f;
+        auto maxRms = 0.0f;
+        auto latestRms = 0.0f;
+        while (micManager.popFeature(feature)) {
+            sumRms += feature.rms;
+            maxRms = std::max(maxRms, feature.rms);
+            latestRms = feature.rms;
+            timestampUs = feature.timestampUs;
+            numFeatures++;
+        }
+
+        if (numFeatures > 0) {
+            switch (micReportMode.load()) {
+                case MicReportMode::Mean:
+                    power = sumRms / numFeatures;
+                    break;
+                case MicReportMode::Max:
+                    power = maxRms;
+                    break;
+                case MicReportMode::Latest:
+                    power = latestRms;
+                    break;
+            }
+            db = MicManager::calcDecibel(power);
+            micDbLevel = db;
+        }
+
+        // 前回送った音量から変化していなければ送らない (OSC_DEADBAND 指定時)
+        if (!isStreamEnabled(Stream::Mic) || !micGate.pass({db}, micros())) {
+            continue;
+        }
+
+        // Bundle・バイナリ送信時は次のIMUフレームに載せてもらう
+        if (getOscLayout() != OSCManager::Layout::Message) {
+            micLevel.publish({power, db, timestampUs});
+            micPending = true;
+            continue;
         }
-        xSemaphoreGive(micSemaphore);
 
         // MIC
-        OscWiFi.send(oscServerIp,
-                     oscServerPort,
-                     micAddress, power, db);
+        micMessage.setFloat(0, power);
+        micMessage.setFloat(1, db);
+        if (messageTimestampEnabled) {
+            micMessage.setTimetag(2, getSampleTime(timestampUs));
+        }
+        oscManager.send(micMessage);
     }
 
     vTaskDelete(sendMicOscTaskHandle);
 }
 
-void i2sInit() {
-    i2s_config_t i2s_config = {
-            .mode = (i2s_mode_t) (I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_PDM),
-            .sample_rate =  micSamplingRate,
-            .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-            .channel_format = I2S_CHANNEL_FMT_ALL_RIGHT,
-            .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-            .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-            .dma_buf_count = 2,
-            .dma_buf_len = 128,
-    };
+[[noreturn]] void sendMicBandsOscTask(void *pvParameters) {
+    TickType_t xLastWakeTime = xTaskGetTickCount();
 
-    i2s_pin_config_t pinConfig;
-    pinConfig.bck_io_num = I2S_PIN_NO_CHANGE;
-    pinConfig.ws_io_num = clkPin;
-    pinConfig.data_out_num = I2S_PIN_NO_CHANGE;
-    pinConfig.data_in_num = dataPin;
+    while (true) {
+        waitForPeriod(TaskId::SendMicBandsOsc, xLastWakeTime);
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::SendMicBandsOsc));
+        if (!micManager.isEnabled() || !isStreamEnabled(Stream::Bands)) {
+            continue;
+        }
 
-    i2s_driver_install(I2S_NUM_0, &i2s_config, 0, nullptr);
-    i2s_set_pin(I2S_NUM_0, &pinConfig);
-    i2s_set_clk(I2S_NUM_0, micSamplingRate, I2S_BITS_PER_SAMPLE_16BIT, I2S_CHANNEL_MONO);
+        const auto spectrum = micManager.getSpectrum();
+        for (size_t i = 0; i < SpectrumAnalyzer::numBands; i++) {
+            micBandsMessage.setFloat(i, spectrum.bands[i]);
+        }
+        micBandsMessage.setFloat(SpectrumAnalyzer::numBands, spectrum.centroid);
+        micBandsMessage.setFloat(SpectrumAnalyzer::numBands + 1, spectrum.flux);
+        oscManager.send(micBandsMessage);
+    }
+
+    vTaskDelete(sendMicBandsOscTaskHandle);
 }
 
-float calcDecibel(float value) {
-    // https://m5stack.oss-cn-shenzhen.aliyuncs.com/resource/docs/datasheet/core/SPM1423HM4H-B_datasheet_en.pdf
-    return 8.6859 * log(value) + 25.6699;
+[[noreturn]] void clockSyncTask(void *pvParameters) {
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    const uint64_t reportIntervalUs = healthCheckInterval * portTICK_PERIOD_MS * 1000ULL;
+    uint64_t lastReportUs = esp_timer_get_time();
+
+    while (true) {
+        // 同期が取れるまでは10倍の頻度で ping を送る
+        const TickType_t period = getTaskConfig(TaskId::ClockSync).period;
+        xTaskDelayUntil(&xLastWakeTime, clockSync.isSynced() ? period : period / 10);
+
+        {
+            TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::ClockSync));
+            syncPingMessage.setTimetag(0, clockSync.beginExchange(esp_timer_get_time()));
+            oscManager.sendToServer(syncPingMessage);
+        }
+
+        // pong を待つ (controlTask が受信した時刻を t4 として渡す)
+        const TickType_t waitStart = xTaskGetTickCount();
+        TickType_t waited = 0;
+        SyncPong pong{};
+        while ((waited = xTaskGetTickCount() - waitStart) < clockSyncTimeout &&
+               xQueueReceive(syncPongQueue, &pong, clockSyncTimeout - waited) == pdTRUE) {
+            if (clockSync.completeExchange(pong.t1, pong.t2, pong.t3, pong.t4)) {
+                break;
+            }
+        }
+
+        // 前回からの往復時間とドリフトを通知する
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::ClockSync));
+        const uint64_t nowUs = esp_timer_get_time();
+        if (nowUs - lastReportUs >= reportIntervalUs) {
+            lastReportUs = nowUs;
+            const auto stats = clockSync.takeStats();
+            syncStatusMessage.setBool(0, stats.synced);
+            syncStatusMessage.setInt(1, stats.rttMinUs);
+            syncStatusMessage.setInt(2, stats.rttMeanUs);
+            syncStatusMessage.setInt(3, stats.rttMaxUs);
+            syncStatusMessage.setFloat(4, stats.driftPpm);
+            syncStatusMessage.setInt(5, stats.exchanges);
+            syncStatusMessage.setInt(6, stats.lost);
+            oscManager.send(syncStatusMessage);
+        }
+    }
+
+    vTaskDelete(clockSyncTaskHandle);
 }
 
+[[noreturn]] void controlTask(void *pvParameters) {
+    // 送信用のソケットに届くパケット (pong・設定変更) をまとめて受け取り，振り分ける
+    std::array<uint8_t, OSCManager::bufferSize> packet{};
+    TickType_t lastReport = xTaskGetTickCount() - healthCheckInterval;
+    while (true) {
+        // 起動時と30秒に一度，現在の送信設定を通知する
+        if (remoteConfigEnabled && xTaskGetTickCount() - lastReport >= healthCheckInterval) {
+            TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::Control));
+            lastReport = xTaskGetTickCount();
+            sendConfigStatus();
+        }
+
+        bool fromServer = false;
+        const size_t size = oscManager.receive(packet.data(), packet.size(), controlReceiveTimeoutMs, fromServer);
+        if (size == 0) {
+            continue;
+        }
+        const uint64_t receivedUs = esp_timer_get_time();
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::Control));
+
+        if (clockSyncEnabled && fromServer && syncPongMessage.parse(packet.data(), size)) {
+            const SyncPong pong = {syncPongMessage.getTimetag(0),
+                                   syncPongMessage.getTimetag(1),
+                                   syncPongMessage.getTimetag(2),
+                                   receivedUs};
+            xQueueSend(syncPongQueue, &pong, 0);
+            continue;
+        }
+        if (remoteConfigEnabled) {
+            handleConfigPacket(packet.data(), size);
+        }
+    }
+
+    vTaskDelete(controlTaskHandle);
+}
+
+[[noreturn]] void congestionTask(void *pvParameters) {
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    TickType_t lastReport = xLastWakeTime;
+    uint32_t lastAttempts = 0;
+    uint32_t lastErrors = 0;
+    uint32_t lastBufferFull = 0;
+    uint32_t reportAttempts = 0;
+    uint32_t reportErrors = 0;
+    uint32_t reportBufferFull = 0;
+    uint32_t lastRttSequence = 0;
+
+    while (true) {
+        xTaskDelayUntil(&xLastWakeTime, getTaskConfig(TaskId::Congestion).period);
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::Congestion));
+
+        // 1パケットを送信先の数だけ sendto() するので，送信先すべての合計を見る
+        uint32_t attempts = 0;
+        uint32_t errors = 0;
+        for (size_t i = 0; i < oscManager.getNumDestinations(); i++) {
+            const auto stats = oscManager.getDestinationStats(i);
+            attempts += stats.sent + stats.errors;
+            errors += stats.errors;
+        }
+        const uint32_t bufferFull = oscManager.getBufferFullCount();
+
+        CongestionController::Sample sample{};
+        sample.attempts = attempts - lastAttempts;
+        sample.errors = errors - lastErrors;
+        sample.bufferFull = bufferFull - lastBufferFull;
+        // 前回から pong が返っていなければ往復時間は不明とする (古い値で判定し続けない)
+        if (clockSyncEnabled) {
+            const auto rtt = clockSync.getLatestRtt();
+            sample.rttUs = rtt.sequence != lastRttSequence ? rtt.rttUs : 0;
+            lastRttSequence = rtt.sequence;
+        }
+        lastAttempts = attempts;
+        lastErrors = errors;
+        lastBufferFull = bufferFull;
+        reportAttempts += sample.attempts;
+        reportErrors += sample.errors;
+        reportBufferFull += sample.bufferFull;
+
+        // 切断中の失敗は混雑ではないので数えない (再接続は healthCheckTask に任せる)
+        const bool wasBundled = congestionController.isBundled();
+        if (WiFiClass::status() == WL_CONNECTED) {
+            sample.rssi = WiFi.RSSI();
+            congestionController.update(sample);
+        }
+
+        // 30秒に一度と，Bundle への切り替え時に状態を通知する
+        const bool bundled = congestionController.isBundled();
+        if (bundled == wasBundled && xTaskGetTickCount() - lastReport < healthCheckInterval) {
+            continue;
+        }
+        lastReport = xTaskGetTickCount();
+        if (bundled != wasBundled) {
+            Serial.println(bundled ? "Congestion: bundling messages" : "Congestion: recovered");
+        }
+        congestionMessage.setFloat(0, congestionController.getRateScale());
+        congestionMessage.setBool(1, bundled);
+        congestionMessage.setFloat(2, reportAttempts > 0 ? static_cast<float>(reportErrors) / reportAttempts : 0.0f);
+        congestionMessage.setInt(3, reportBufferFull);
+        congestionMessage.setInt(4, sample.rssi);
+        congestionMessage.setInt(5, sample.rttUs);
+        congestionMessage.setInt(6, congestionController.getBackoffs());
+        oscManager.send(congestionMessage);
+        reportAttempts = 0;
+        reportErrors = 0;
+        reportBufferFull = 0;
+    }
+
+    vTaskDelete(congestionTaskHandle);
+}
 
-void processSignal() {
-    // https://gist.github.com/tomoto/6a1b67d9e963f9932a43c984171d80fb
-    // Author: Tomoto Mizuma (Jul 23, 2021.)
-    // Code Changed by: Daiki Miura (June 30, 2023.)
+[[noreturn]] void displayTask(void *pvParameters) {
+    // 描画とLCDへの転送はこのタスクだけで行い，他のタスクは共有の値を書くだけにする
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    TickType_t lastRateUpdate = xLastWakeTime;
+    uint32_t lastSequence = imuManager.getSnapshot().sequence;
+    uint32_t lastSent = 0;
 
-    static float filteredBase = 0.0f;
+    DashboardState state{};
+    state.clientName = clientName.c_str();
+    state.serverIp = oscServerIp.c_str();
+    state.serverPort = oscServerPort;
 
-    // 平均を取ってゼロ点を自動的に補正する
-    auto base = 0.0f;
-    for (int n = 0; n < micSampleSize; n++)
-        base += adcBuffer[n];
+    while (true) {
+        xTaskDelayUntil(&xLastWakeTime, getTaskConfig(TaskId::Display).period);
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::Display));
+
+        const auto imu = imuManager.getSnapshot();
+        state.acc = imu.acc;
+        state.gyro = imu.gyro;
+        state.rotation = imu.rotation;
+        state.micDb = micDbLevel;
+        state.micEnabled = micManager.isEnabled();
+        state.batteryLevel = batteryLevel;
+        state.charging = batteryCharging;
+
+        // 回数・電波の強さは1秒ごとに更新する
+        const TickType_t now = xTaskGetTickCount();
+        if (now - lastRateUpdate >= pdMS_TO_TICKS(1000)) {
+            const float seconds = (now - lastRateUpdate) * portTICK_PERIOD_MS / 1000.0f;
+            lastRateUpdate = now;
+
+            uint32_t sent = 0;
+            uint32_t errors = 0;
+            for (size_t i = 0; i < oscManager.getNumDestinations(); i++) {
+                const auto stats = oscManager.getDestinationStats(i);
+                sent += stats.sent;
+                errors += stats.errors;
+            }
+            state.sentPerSecond = (sent - lastSent) / seconds;
+            state.sendErrors = errors;
+            state.imuHz = (imu.sequence - lastSequence) / seconds;
+            lastSent = sent;
+            lastSequence = imu.sequence;
+
+            const bool connected = WiFiClass::status() == WL_CONNECTED;
+            state.localIp = connected ? WiFi.localIP() : IPAddress();
+            state.rssi = connected ? WiFi.RSSI() : 0;
+        }
 
-    base /= micSampleSize;
+        // 他の画面 (リセットの確認など) を表示している間は描かない
+        if (xSemaphoreTake(displaySemaphore, 0) != pdTRUE) {
+            displayManager.invalidate();
+            continue;
+        }
+        displayManager.drawDashboard(state);
+        xSemaphoreGive(displaySemaphore);
+    }
 
-    // フィルタをかけて変化を緩やかにする
-    const auto alpha = 0.98f;
-    filteredBase = filteredBase * alpha + base * (1 - alpha);
+    vTaskDelete(displayTaskHandle);
+}
 
-    // 二乗平均平方根を取る
-    auto power = 0.0;
-    for (int n = 0; n < micSampleSize; n++)
-        power += sq(adcBuffer[n] - filteredBase);
+[[noreturn]] void motionEventTask(void *pvParameters) {
+    // imuTask がイベントを検出するたびに起こされ，周期的な送信を待たずにすぐ送る
+    // (Bundle・バイナリ形式や混雑時の間引きの対象にしない)
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::MotionEvent));
+
+        MotionDetector::Event event{};
+        while (imuManager.popMotionEvent(event)) {
+            auto &message = motionEventMessages[static_cast<size_t>(event.type)];
+            message.setTimetag(0, getSampleTime(event.timestampUs));
+            if (event.type == MotionDetector::EventType::Impact) {
+                message.setFloat(1, event.value);
+            } else {
+                message.setBool(1, event.active);
+                message.setFloat(2, event.value);
+            }
+            oscManager.send(message);
+        }
+    }
 
-    power = sqrt(power / micSampleSize);
-    totalPower += power;
-    numPower++;
+    vTaskDelete(motionEventTaskHandle);
 }
 
+[[noreturn]] void captureTask(void *pvParameters) {
+    // フラッシュへの書き込みはこのタスクだけで行う (IMU・MICのタスクはRAM上のブロックに詰めるだけ)
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    TickType_t lastReport = xLastWakeTime;
+
+    while (true) {
+        xTaskDelayUntil(&xLastWakeTime, getTaskConfig(TaskId::Capture).period);
+        TaskMonitor::Busy busy(taskMonitor, static_cast<size_t>(TaskId::Capture));
+
+        // 30秒に一度と，記録を始めた・止めた時に状態を通知する
+        const bool changed = captureRecorder.service();
+        if (!changed && xTaskGetTickCount() - lastReport < healthCheckInterval) {
+            continue;
+        }
+        lastReport = xTaskGetTickCount();
+
+        const auto stats = captureRecorder.takeStats();
+        if (changed) {
+            Serial.println(stats.recording ? "Capture started" : "Capture stopped");
+        }
+        captureMessage.setBool(0, stats.recording);
+        captureMessage.setInt(1, stats.fileIndex);
+        captureMessage.setInt(2, stats.writtenBytes / 1024);
+        captureMessage.setInt(3, stats.dropped);
+        captureMessage.setInt(4, stats.writeMaxUs);
+        captureMessage.setInt(5, stats.freeBytes / 1024);
+        // フラッシュへの書き込みでIMUの読み出しが遅れていないかの目安
+        captureMessage.setInt(6, imuManager.getFifoOverflowCount());
+        oscManager.send(captureMessage);
+    }
+
+    vTaskDelete(captureTaskHandle);
+}
@@ -0,0 +1,72 @@
+/// \file Bench.h
+/// \brief ホットパスのベンチマークで共通に使う計測の仕組み
+///
+/// 1回あたりの実行時間 [ns/op]・サイクル数 [cycles/op] と，計測中に operator new が呼ばれた回数 [allocs/op] を表示する．
+/// サイクル数は x86 のタイムスタンプカウンタで数える (それ以外のホストでは 0)．
+/// ホストの値なので ESP32 の絶対値ではなく，変更の前後の比較に使う．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_BENCH_H
+#define CCBT_KOROGARU_KOEN_PARK_BENCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+namespace Bench {
+
+    /// operator new の呼び出し回数 (bench_main.cpp で operator new を置き換えて数える)
+    extern std::atomic<uint64_t> allocations;
+
+    inline uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    /// 最適化で計算が消されないよう値を使ったことにする
+    template<typename T>
+    inline void keep(const T &value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    /// fn を iterations 回実行して 1回あたりの時間と確保回数を表示する
+    template<typename Fn>
+    void run(const char *name, size_t iterations, Fn fn) {
+        // キャッシュ・分岐予測を温める
+        for (size_t i = 0; i < iterations / 10 + 1; i++) {
+            fn(i);
+        }
+
+        const uint64_t allocationsBefore = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t startCycles = cycles();
+        for (size_t i = 0; i < iterations; i++) {
+            fn(i);
+        }
+        const uint64_t elapsedCycles = cycles() - startCycles;
+        const auto end = std::chrono::steady_clock::now();
+        const uint64_t allocated = allocations.load() - allocationsBefore;
+
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        printf("%-36s %12.1f ns/op %12.0f cycles/op %10.3f allocs/op\n", name, ns / iterations,
+               static_cast<double>(elapsedCycles) / iterations, static_cast<double>(allocated) / iterations);
+    }
+
+    void runProtocol();
+    void runConcurrency();
+    void runAudio();
+    void runSpectrum();
+    void runMotion();
+    void runOrientation();
+}
+
+#endif //CCBT_KOROGARU_KOEN_PARK_BENCH_H
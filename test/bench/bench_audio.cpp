@@ -0,0 +1,39 @@
+/// \file bench_audio.cpp
+/// \brief マイクの1ブロック (256 サンプル) の処理のベンチマーク
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "AudioDSP.h"
+#include "Bench.h"
+
+void Bench::runAudio() {
+    std::array<int16_t, 256> samples{};
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<int16_t>(1200 + 8000 * std::sin(2.0 * M_PI * 1000.0 * i / 16000.0));
+    }
+
+    run("AudioDSP::computeMoments (256)", 1000000, [&](size_t i) {
+        samples[0] = static_cast<int16_t>(i);
+        const auto moments = AudioDSP::computeMoments(samples.data(), samples.size());
+        keep(moments);
+    });
+
+    const auto moments = AudioDSP::computeMoments(samples.data(), samples.size());
+    run("AudioDSP::rmsAround+peakAround", 10000000, [&](size_t i) {
+        const float center = 1200.0f + static_cast<float>(i & 15);
+        const float rms = AudioDSP::rmsAround(moments, center);
+        const float peak = AudioDSP::peakAround(moments, center);
+        keep(rms);
+        keep(peak);
+    });
+
+    run("AudioDSP::fastLog10", 10000000, [&](size_t i) {
+        const float value = AudioDSP::fastLog10(1.0f + static_cast<float>(i & 4095));
+        keep(value);
+    });
+    run("log10f (reference)", 10000000, [&](size_t i) {
+        const float value = log10f(1.0f + static_cast<float>(i & 4095));
+        keep(value);
+    });
+}
@@ -0,0 +1,47 @@
+/// \file bench_concurrency.cpp
+/// \brief タスク間の受け渡し (SpscRing・SnapshotBuffer) のベンチマーク
+///
+/// 1スレッドで push/pop・publish/read を交互に行い，競合のないときのコストを測る．
+
+#include <cstdint>
+#include "Bench.h"
+#include "SnapshotBuffer.h"
+#include "SpscRing.h"
+
+namespace {
+    /// IMUの共有状態と同程度の大きさ
+    struct Snapshot {
+        float values[24];
+        uint32_t timestampUs;
+    };
+
+    /// マイクの1ブロック分の特徴量と同程度の大きさ
+    struct Features {
+        float rms;
+        float peak;
+        float db;
+        uint32_t timestampUs;
+    };
+}
+
+void Bench::runConcurrency() {
+    SpscRing<Features, 16> ring;
+    run("SpscRing<16>::push+pop", 10000000, [&](size_t i) {
+        Features features{};
+        features.timestampUs = static_cast<uint32_t>(i);
+        ring.push(features);
+        ring.pop(features);
+        keep(features);
+    });
+
+    SnapshotBuffer<Snapshot> buffer;
+    Snapshot snapshot{};
+    run("SnapshotBuffer::publish", 10000000, [&](size_t i) {
+        snapshot.timestampUs = static_cast<uint32_t>(i);
+        buffer.publish(snapshot);
+    });
+    run("SnapshotBuffer::read", 10000000, [&](size_t) {
+        const Snapshot read = buffer.read();
+        keep(read);
+    });
+}
@@ -0,0 +1,43 @@
+/// \file bench_main.cpp
+/// \brief ホットパスのベンチマークのエントリポイント
+///
+/// $ pio run -e native_bench && .pio/build/native_bench/program
+
+#include <cstdlib>
+#include <new>
+#include "Bench.h"
+
+namespace Bench {
+    std::atomic<uint64_t> allocations(0);
+}
+
+void *operator new(size_t size) {
+    Bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void *p) noexcept {
+    operator delete(p);
+}
+
+int main() {
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    Bench::runProtocol();
+    Bench::runConcurrency();
+    Bench::runAudio();
+    Bench::runSpectrum();
+    Bench::runMotion();
+    Bench::runOrientation();
+    return 0;
+}
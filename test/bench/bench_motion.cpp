@@ -0,0 +1,20 @@
+/// \file bench_motion.cpp
+/// \brief IMUのサンプルごとに通る処理のベンチマーク
+
+#include <array>
+#include <cstdint>
+#include "Bench.h"
+#include "MotionDetector.h"
+
+void Bench::runMotion() {
+    MotionDetector detector;
+    std::array<MotionDetector::Event, MotionDetector::maxEventsPerSample> events{};
+    run("MotionDetector::update", 10000000, [&](size_t i) {
+        // 回転と揺れが混ざった入力で判定の分岐をひととおり通す
+        const float swing = (i & 64) ? 2.5f : 0.2f;
+        const size_t count = detector.update({{0.0f, swing, 1.0f}}, {{0.0f, 0.0f, static_cast<float>(i & 511)}},
+                                             static_cast<uint32_t>(i * 2000), events.data());
+        keep(count);
+        keep(events);
+    });
+}
@@ -0,0 +1,75 @@
+/// \file bench_orientation.cpp
+/// \brief 姿勢推定のベンチマーク (IMUManager の Kalman の経路と Madgwick / Mahony)
+///
+/// Kalman の経路は IMUManager::filter() と同じく，加速度から atan/sqrt でロール・ピッチを求めて
+/// 2軸の Kalman に通す．ホストは倍精度の atan/sqrt をハードウェアで計算するが，
+/// ESP32 ではソフトウェアの倍精度演算になるので，差はホストより大きくなる．
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <Kalman.h>
+#include "Bench.h"
+#include "OrientationFilter.h"
+
+namespace {
+    const double radToDeg = 57.295779513082320;
+    const float dt = 1.0f / 500.0f;
+
+    /// 回転しながら傾きが変わる入力 (1周期 256 サンプル)
+    struct Motion {
+        std::array<std::array<float, 3>, 256> acc;
+        std::array<std::array<float, 3>, 256> gyro;
+
+        Motion() {
+            for (size_t i = 0; i < acc.size(); i++) {
+                const float phase = 6.28318530718f * i / acc.size();
+                const float roll = 0.6f * sinf(phase);
+                const float pitch = 0.3f * cosf(phase);
+                acc[i] = {{-sinf(pitch), sinf(roll) * cosf(pitch), cosf(roll) * cosf(pitch)}};
+                gyro[i] = {{40.0f * cosf(phase), -20.0f * sinf(phase), 5.0f}};
+            }
+        }
+    };
+}
+
+void Bench::runOrientation() {
+    const Motion motion;
+
+    Kalman kalmanX;
+    Kalman kalmanY;
+    run("Kalman path (atan + Kalman x2)", 10000000, [&](size_t i) {
+        const auto &acc = motion.acc[i & 255];
+        const auto &gyro = motion.gyro[i & 255];
+        const double roll = atan(acc[1] / sqrt((acc[0] * acc[0]) + (acc[2] * acc[2]))) * radToDeg;
+        const double pitch = atan(-acc[0] / sqrt((acc[1] * acc[1]) + (acc[2] * acc[2]))) * radToDeg;
+        const float x = kalmanX.getAngle(roll, gyro[0], dt);
+        const float y = kalmanY.getAngle(pitch, gyro[1], dt);
+        keep(x);
+        keep(y);
+    });
+
+    OrientationFilter madgwick;
+    madgwick.setup(OrientationFilter::Algorithm::Madgwick, 0.1f);
+    run("OrientationFilter::update (Madgwick)", 10000000, [&](size_t i) {
+        const auto &acc = motion.acc[i & 255];
+        const auto &gyro = motion.gyro[i & 255];
+        madgwick.update(gyro[0], gyro[1], gyro[2], acc[0], acc[1], acc[2], dt);
+        keep(madgwick.getQuaternion());
+    });
+
+    OrientationFilter mahony;
+    mahony.setup(OrientationFilter::Algorithm::Mahony, 1.0f);
+    run("OrientationFilter::update (Mahony)", 10000000, [&](size_t i) {
+        const auto &acc = motion.acc[i & 255];
+        const auto &gyro = motion.gyro[i & 255];
+        mahony.update(gyro[0], gyro[1], gyro[2], acc[0], acc[1], acc[2], dt);
+        keep(mahony.getQuaternion());
+    });
+
+    // 送信のたびに1回だけ行うクォータニオンからオイラー角への変換
+    run("OrientationFilter::getEuler", 10000000, [&](size_t) {
+        const auto euler = madgwick.getEuler();
+        keep(euler);
+    });
+}
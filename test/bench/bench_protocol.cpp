@@ -0,0 +1,58 @@
+/// \file bench_protocol.cpp
+/// \brief 送信の1フレームごとに通る符号化のベンチマーク
+
+#include <array>
+#include "Bench.h"
+#include "CaptureFormat.h"
+#include "DeltaGate.h"
+#include "OSCMessageTemplate.h"
+#include "WireFormat.h"
+
+void Bench::runProtocol() {
+    OSCMessageTemplate message;
+    message.build("/ccbt1/imu/acc", "fff");
+    run("OSCMessageTemplate::setFloat x3", 10000000, [&](size_t i) {
+        const float value = static_cast<float>(i);
+        message.setFloat(0, value);
+        message.setFloat(1, -value);
+        message.setFloat(2, value * 0.5f);
+        keep(message);
+    });
+
+    OSCMessageTemplate bundle;
+    bundle.build("#bundle", "t");
+    run("OSCMessageTemplate::setTimetag", 10000000, [&](size_t i) {
+        bundle.setTimetag(0, 1000000ULL * i);
+        keep(bundle);
+    });
+
+    WireFormat::Frame frame{};
+    frame.acc = {{0.5f, -1.0f, 1.0f}};
+    frame.gyro = {{10.0f, -250.5f, 0.0f}};
+    frame.rotation = {{45.25f, -90.0f}};
+    uint8_t packet[WireFormat::packetSize];
+    run("WireFormat::encode", 10000000, [&](size_t i) {
+        frame.sequence = static_cast<uint32_t>(i);
+        WireFormat::encode(frame, packet);
+        keep(packet);
+    });
+
+    DeltaGate<6> gate;
+    gate.setup({{0.02f, 0.02f, 0.02f, 1.0f, 1.0f, 1.0f}}, 1000000);
+    run("DeltaGate<6>::pass", 10000000, [&](size_t i) {
+        const float noise = (i & 7) * 0.001f;
+        const bool passed = gate.pass({{noise, 0.0f, 1.0f, noise, 0.0f, 0.0f}}, static_cast<uint32_t>(i * 2000));
+        keep(passed);
+    });
+
+    std::array<uint8_t, 4096> block{};
+    CaptureFormat::BlockEncoder encoder;
+    encoder.begin(CaptureFormat::Stream::Imu, 0, 0, block.data(), block.size());
+    run("CaptureFormat::BlockEncoder::addImu", 10000000, [&](size_t i) {
+        const float v = static_cast<float>(i & 255) * 0.01f;
+        if (!encoder.addImu({{v, -v, 1.0f}}, {{v * 100.0f, 0.0f, -v}}, static_cast<uint32_t>(i * 2000))) {
+            encoder.begin(CaptureFormat::Stream::Imu, static_cast<uint32_t>(i), 0, block.data(), block.size());
+        }
+        keep(block);
+    });
+}
@@ -0,0 +1,29 @@
+/// \file bench_spectrum.cpp
+/// \brief マイクの1ブロックごとのスペクトル解析 (512 点の実数FFT + 帯域 + 重心) のベンチマーク
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "Bench.h"
+#include "SpectrumAnalyzer.h"
+
+void Bench::runSpectrum() {
+    SpectrumAnalyzer analyzer;
+    analyzer.setup(16000.0f, 125.0f);
+
+    // MicManager と同じく 256 サンプルずつ押し込んで毎ブロック解析する
+    std::array<int16_t, 256> hop{};
+    for (size_t i = 0; i < hop.size(); i++) {
+        hop[i] = static_cast<int16_t>(8000 * std::sin(2.0 * M_PI * 440.0 * i / 16000.0) + (i * 7919) % 200);
+    }
+
+    run("SpectrumAnalyzer::push (256)", 1000000, [&](size_t) {
+        analyzer.push(hop.data(), hop.size());
+    });
+    run("SpectrumAnalyzer::push+analyze", 100000, [&](size_t i) {
+        hop[0] = static_cast<int16_t>(i);
+        analyzer.push(hop.data(), hop.size());
+        const auto &result = analyzer.analyze();
+        keep(result);
+    });
+}
@@ -0,0 +1,163 @@
+/// \file test_main.cpp
+/// \brief AudioDSP の1パス集計・DC を除いた RMS / ピーク・log の近似を確かめる
+///
+/// RMS と dBFS は倍精度で素直に計算した値と比べ，近似と整数の集計で生じる誤差に上限を設ける．
+
+#include <unity.h>
+#include <cmath>
+#include <cstdint>
+#include "AudioDSP.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    // 倍精度の参照値と比べたときの許容誤差
+    const double rmsRelativeTolerance = 1e-4;
+    const double dbTolerance = 1e-3;    // [dB]
+
+    /// 再現できるよう固定の種から作る一様乱数 [-1, 1)
+    struct Random {
+        uint32_t state = 12345;
+
+        double next() {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<double>(state >> 8) / (1 << 23) - 1.0;
+        }
+    };
+
+    double referenceRms(const int16_t *samples, size_t count, double center) {
+        double squares = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            const double d = samples[i] - center;
+            squares += d * d;
+        }
+        return sqrt(squares / count);
+    }
+
+    double referenceDbfs(double rms) {
+        return 20.0 * log10(rms / 32768.0);
+    }
+
+    float dbfs(float rms) {
+        return 20.0f * AudioDSP::fastLog10(rms / 32768.0f);
+    }
+}
+
+void test_moments_of_known_block() {
+    const int16_t samples[] = {1, -2, 3, -4, 5};
+    const auto moments = AudioDSP::computeMoments(samples, 5);
+    TEST_ASSERT_EQUAL_INT64(3, moments.sum);
+    TEST_ASSERT_EQUAL_INT64(55, moments.sumSquares);
+    TEST_ASSERT_EQUAL_INT(-4, moments.min);
+    TEST_ASSERT_EQUAL_INT(5, moments.max);
+    TEST_ASSERT_EQUAL_UINT32(5, moments.count);
+}
+
+void test_moments_do_not_overflow_at_full_scale() {
+    int16_t samples[512];
+    for (auto &s : samples) {
+        s = INT16_MIN;
+    }
+    const auto moments = AudioDSP::computeMoments(samples, 512);
+    TEST_ASSERT_EQUAL_INT64(512LL * INT16_MIN, moments.sum);
+    TEST_ASSERT_EQUAL_INT64(512LL * INT16_MIN * INT16_MIN, moments.sumSquares);
+}
+
+void test_rms_of_constant_around_its_value_is_zero() {
+    int16_t samples[256];
+    for (auto &s : samples) {
+        s = 1234;
+    }
+    const auto moments = AudioDSP::computeMoments(samples, 256);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, AudioDSP::rmsAround(moments, 1234.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 1234.0f, AudioDSP::rmsAround(moments, 0.0f));
+}
+
+void test_rms_and_peak_of_square_wave_with_offset() {
+    // DC 500 に ±1000 の矩形波
+    int16_t samples[256];
+    for (size_t i = 0; i < 256; i++) {
+        samples[i] = static_cast<int16_t>(i % 2 == 0 ? 1500 : -500);
+    }
+    const auto moments = AudioDSP::computeMoments(samples, 256);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1000.0f, AudioDSP::rmsAround(moments, 500.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1000.0f, AudioDSP::peakAround(moments, 500.0f));
+    // 小数の中心でも整数部と小数部に分けて計算する
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, sqrtf(1000.0f * 1000.0f + 0.25f), AudioDSP::rmsAround(moments, 500.5f));
+}
+
+void test_empty_block() {
+    const auto moments = AudioDSP::computeMoments(nullptr, 0);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, AudioDSP::rmsAround(moments, 0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, AudioDSP::peakAround(moments, 0.0f));
+}
+
+void test_fast_log() {
+    const float values[] = {1.0f, 2.0f, 10.0f, 0.001f, 1.41421356f, 32767.0f, 1e-12f};
+    for (float x : values) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, log2f(x), AudioDSP::fastLog2(x));
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, log10f(x), AudioDSP::fastLog10(x));
+    }
+}
+
+void test_rms_and_dbfs_match_double_reference() {
+    // 無音に近いレベルから飽和する手前まで，DC オフセットとずれた中心 (DC フィルタの遅れ) を変えて比べる
+    const double amplitudes[] = {2.0, 30.0, 500.0, 8000.0, 30000.0};
+    const double offsets[] = {0.0, -1200.0, 2500.5};
+    const double centerErrors[] = {0.0, 0.37, -15.8};
+
+    Random random;
+    double worstRms = 0.0;
+    double worstDb = 0.0;
+    int16_t samples[256];
+    for (double amplitude : amplitudes) {
+        for (double offset : offsets) {
+            for (double centerError : centerErrors) {
+                for (size_t i = 0; i < 256; i++) {
+                    // 正弦波 + ノイズ
+                    double x = offset + amplitude * (0.7 * sin(0.3 * i) + 0.3 * random.next());
+                    x = x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+                    samples[i] = static_cast<int16_t>(lround(x));
+                }
+
+                const auto moments = AudioDSP::computeMoments(samples, 256);
+                const double center = static_cast<double>(moments.sum) / 256 + centerError;
+                const double expectedRms = referenceRms(samples, 256, center);
+                const float rms = AudioDSP::rmsAround(moments, static_cast<float>(center));
+
+                const double rmsError = fabs(rms - expectedRms) / expectedRms;
+                const double dbError = fabs(dbfs(rms) - referenceDbfs(expectedRms));
+                worstRms = rmsError > worstRms ? rmsError : worstRms;
+                worstDb = dbError > worstDb ? dbError : worstDb;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE_MESSAGE(worstRms < rmsRelativeTolerance, "RMS relative error");
+    TEST_ASSERT_TRUE_MESSAGE(worstDb < dbTolerance, "dBFS error");
+}
+
+void test_dbfs_of_full_scale_sine() {
+    // 振幅 32767 の正弦波は -3.01 dBFS
+    int16_t samples[256];
+    for (size_t i = 0; i < 256; i++) {
+        samples[i] = static_cast<int16_t>(lround(32767.0 * sin(2.0 * M_PI * i / 32.0)));
+    }
+    const auto moments = AudioDSP::computeMoments(samples, 256);
+    const float rms = AudioDSP::rmsAround(moments, 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(dbTolerance, referenceDbfs(32767.0 / sqrt(2.0)), dbfs(rms));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_moments_of_known_block);
+    RUN_TEST(test_moments_do_not_overflow_at_full_scale);
+    RUN_TEST(test_rms_of_constant_around_its_value_is_zero);
+    RUN_TEST(test_rms_and_peak_of_square_wave_with_offset);
+    RUN_TEST(test_empty_block);
+    RUN_TEST(test_fast_log);
+    RUN_TEST(test_rms_and_dbfs_match_double_reference);
+    RUN_TEST(test_dbfs_of_full_scale_sine);
+    return UNITY_END();
+}
@@ -0,0 +1,266 @@
+/// \file test_main.cpp
+/// \brief CaptureFormat のヘッダ・ブロックの往復・量子化の飽和・可変長整数・CRC・壊れたブロックの扱いを確かめる
+
+#include <unity.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "CaptureFormat.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    const size_t blockCapacity = 256;
+
+    /// ブロックを閉じてヘッダを読み直す
+    CaptureFormat::BlockHeader seal(CaptureFormat::BlockEncoder &encoder, uint8_t *block) {
+        const size_t size = encoder.finish();
+        CaptureFormat::sealBlock(block);
+        CaptureFormat::BlockHeader header{};
+        TEST_ASSERT_TRUE(CaptureFormat::decodeBlockHeader(block, size, header));
+        return header;
+    }
+
+    const uint8_t *payloadOf(const uint8_t *block) {
+        return block + CaptureFormat::blockHeaderSize;
+    }
+}
+
+void test_file_header_round_trip() {
+    CaptureFormat::FileHeader header{};
+    header.nodeId = 3;
+    header.clientName.fill('\0');
+    strcpy(header.clientName.data(), "ccbt3");
+    header.startUs = 0xA0B0C0D0;
+
+    uint8_t data[CaptureFormat::fileHeaderSize];
+    CaptureFormat::encodeFileHeader(header, data);
+    const uint8_t magic[] = {'K', 'C', 'A', 'P', 0x01, 0x00, 0x20, 0x00, 0x03};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(magic, data, sizeof(magic));
+
+    CaptureFormat::FileHeader decoded{};
+    TEST_ASSERT_TRUE(CaptureFormat::decodeFileHeader(data, sizeof(data), decoded));
+    TEST_ASSERT_EQUAL_UINT8(3, decoded.nodeId);
+    TEST_ASSERT_EQUAL_STRING("ccbt3", decoded.clientName.data());
+    TEST_ASSERT_EQUAL_UINT32(0xA0B0C0D0, decoded.startUs);
+}
+
+void test_file_header_rejects_other_data() {
+    CaptureFormat::FileHeader header{};
+    header.clientName.fill('\0');
+    uint8_t data[CaptureFormat::fileHeaderSize];
+    CaptureFormat::encodeFileHeader(header, data);
+
+    CaptureFormat::FileHeader decoded{};
+    TEST_ASSERT_FALSE(CaptureFormat::decodeFileHeader(data, sizeof(data) - 1, decoded));
+    data[4] = CaptureFormat::version + 1;
+    TEST_ASSERT_FALSE(CaptureFormat::decodeFileHeader(data, sizeof(data), decoded));
+    data[4] = CaptureFormat::version;
+    data[0] = 'X';
+    TEST_ASSERT_FALSE(CaptureFormat::decodeFileHeader(data, sizeof(data), decoded));
+}
+
+void test_imu_block_round_trip() {
+    uint8_t block[blockCapacity];
+    CaptureFormat::BlockEncoder encoder;
+    encoder.begin(CaptureFormat::Stream::Imu, 41, 2, block, sizeof(block));
+    TEST_ASSERT_TRUE(encoder.addImu({{0.5f, -1.0f, 1.0f}}, {{10.0f, -250.5f, 0.0f}}, 1000));
+    TEST_ASSERT_TRUE(encoder.addImu({{0.51f, -0.99f, 1.02f}}, {{11.0f, -249.0f, 0.5f}}, 2000));
+    TEST_ASSERT_TRUE(encoder.addImu({{-7.9f, 7.9f, 0.0f}}, {{2000.0f, -2000.0f, 0.0f}}, 3000));
+    const auto header = seal(encoder, block);
+
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(CaptureFormat::Stream::Imu), static_cast<uint8_t>(header.stream));
+    TEST_ASSERT_EQUAL_UINT16(3, header.records);
+    TEST_ASSERT_EQUAL_UINT32(41, header.sequence);
+    TEST_ASSERT_EQUAL_UINT32(2, header.dropped);
+    TEST_ASSERT_EQUAL_UINT32(CaptureFormat::crc32(payloadOf(block), header.payloadSize), header.crc);
+
+    CaptureFormat::BlockDecoder decoder(header, payloadOf(block));
+    CaptureFormat::Record record{};
+    TEST_ASSERT_TRUE(decoder.next(record));
+    TEST_ASSERT_EQUAL_UINT32(1000, record.timestampUs);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::accScale, 0.5f, record.acc[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::gyroScale, -250.5f, record.gyro[1]);
+    TEST_ASSERT_TRUE(decoder.next(record));
+    TEST_ASSERT_EQUAL_UINT32(2000, record.timestampUs);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::accScale, 1.02f, record.acc[2]);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::gyroScale, 0.5f, record.gyro[2]);
+    TEST_ASSERT_TRUE(decoder.next(record));
+    TEST_ASSERT_EQUAL_UINT32(3000, record.timestampUs);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::accScale, -7.9f, record.acc[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::gyroScale, 2000.0f, record.gyro[0]);
+    TEST_ASSERT_FALSE(decoder.next(record));
+}
+
+void test_audio_block_round_trip() {
+    uint8_t block[blockCapacity];
+    CaptureFormat::BlockEncoder encoder;
+    encoder.begin(CaptureFormat::Stream::Audio, 0, 0, block, sizeof(block));
+    TEST_ASSERT_TRUE(encoder.addAudio(812.4f, 3000.0f, 16000));
+    TEST_ASSERT_TRUE(encoder.addAudio(10.0f, 20.5f, 32000));
+    const auto header = seal(encoder, block);
+
+    CaptureFormat::BlockDecoder decoder(header, payloadOf(block));
+    CaptureFormat::Record record{};
+    TEST_ASSERT_TRUE(decoder.next(record));
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(CaptureFormat::Stream::Audio), static_cast<uint8_t>(record.stream));
+    TEST_ASSERT_EQUAL_UINT32(16000, record.timestampUs);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::levelScale, 812.4f, record.rms);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::levelScale, 3000.0f, record.peak);
+    TEST_ASSERT_TRUE(decoder.next(record));
+    TEST_ASSERT_EQUAL_UINT32(32000, record.timestampUs);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::levelScale, 10.0f, record.rms);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / CaptureFormat::levelScale, 20.5f, record.peak);
+    TEST_ASSERT_FALSE(decoder.next(record));
+}
+
+void test_out_of_range_values_saturate() {
+    uint8_t block[blockCapacity];
+    CaptureFormat::BlockEncoder encoder;
+    encoder.begin(CaptureFormat::Stream::Imu, 0, 0, block, sizeof(block));
+    TEST_ASSERT_TRUE(encoder.addImu({{NAN, -INFINITY, INFINITY}}, {{100000.0f, -100000.0f, NAN}}, 0));
+    auto header = seal(encoder, block);
+
+    CaptureFormat::Record record{};
+    CaptureFormat::BlockDecoder imuDecoder(header, payloadOf(block));
+    TEST_ASSERT_TRUE(imuDecoder.next(record));
+    // NaN と -inf は下限，+inf と範囲外は上限 (int16) に張り付く
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MIN / CaptureFormat::accScale, record.acc[0]);
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MIN / CaptureFormat::accScale, record.acc[1]);
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MAX / CaptureFormat::accScale, record.acc[2]);
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MAX / CaptureFormat::gyroScale, record.gyro[0]);
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MIN / CaptureFormat::gyroScale, record.gyro[1]);
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MIN / CaptureFormat::gyroScale, record.gyro[2]);
+
+    // マイクの値は 0 以上で，NaN・負の値は 0，大きすぎる値は上限に張り付く
+    encoder.begin(CaptureFormat::Stream::Audio, 0, 0, block, sizeof(block));
+    TEST_ASSERT_TRUE(encoder.addAudio(NAN, -5.0f, 0));
+    TEST_ASSERT_TRUE(encoder.addAudio(INFINITY, 1.0e9f, 0));
+    header = seal(encoder, block);
+    CaptureFormat::BlockDecoder audioDecoder(header, payloadOf(block));
+    TEST_ASSERT_TRUE(audioDecoder.next(record));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, record.rms);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, record.peak);
+    TEST_ASSERT_TRUE(audioDecoder.next(record));
+    TEST_ASSERT_EQUAL_FLOAT(record.rms, record.peak);
+    TEST_ASSERT_TRUE(record.rms >= 32768.0f);
+    TEST_ASSERT_TRUE(std::isfinite(record.rms));
+}
+
+void test_varint_and_zigzag_extremes() {
+    uint8_t block[blockCapacity];
+    CaptureFormat::BlockEncoder encoder;
+    encoder.begin(CaptureFormat::Stream::Audio, 0, 0, block, sizeof(block));
+    // dt = 0xFFFFFFFF は5バイト，rms +1 は zigzag で 2，peak 0 は 0
+    TEST_ASSERT_TRUE(encoder.addAudio(1.0f / CaptureFormat::levelScale, 0.0f, 0xFFFFFFFF));
+    // dt は 0 に巻き戻って +1，rms -1 は zigzag で 1
+    TEST_ASSERT_TRUE(encoder.addAudio(0.0f, 0.0f, 0));
+    auto header = seal(encoder, block);
+    const uint8_t expected[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x02, 0x00,
+                                0x01, 0x01, 0x00};
+    TEST_ASSERT_EQUAL_UINT16(sizeof(expected), header.payloadSize);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, payloadOf(block), sizeof(expected));
+
+    CaptureFormat::BlockDecoder decoder(header, payloadOf(block));
+    CaptureFormat::Record record{};
+    TEST_ASSERT_TRUE(decoder.next(record));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, record.timestampUs);
+    TEST_ASSERT_TRUE(decoder.next(record));
+    TEST_ASSERT_EQUAL_UINT32(0, record.timestampUs);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, record.rms);
+
+    // 下限から上限への差 (65535) と，その逆 (-65535) も往復する
+    encoder.begin(CaptureFormat::Stream::Imu, 0, 0, block, sizeof(block));
+    TEST_ASSERT_TRUE(encoder.addImu({{-8.0f, 8.0f, 0.0f}}, {{-2048.0f, 2048.0f, 0.0f}}, 0));
+    TEST_ASSERT_TRUE(encoder.addImu({{8.0f, -8.0f, 0.0f}}, {{2048.0f, -2048.0f, 0.0f}}, 0));
+    header = seal(encoder, block);
+    CaptureFormat::BlockDecoder imuDecoder(header, payloadOf(block));
+    TEST_ASSERT_TRUE(imuDecoder.next(record));
+    TEST_ASSERT_TRUE(imuDecoder.next(record));
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MAX / CaptureFormat::accScale, record.acc[0]);
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MIN / CaptureFormat::accScale, record.acc[1]);
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MAX / CaptureFormat::gyroScale, record.gyro[0]);
+    TEST_ASSERT_EQUAL_FLOAT(INT16_MIN / CaptureFormat::gyroScale, record.gyro[1]);
+}
+
+void test_crc32_known_vector() {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_UINT32(0xCBF43926, CaptureFormat::crc32(check, sizeof(check)));
+    TEST_ASSERT_EQUAL_UINT32(0x00000000, CaptureFormat::crc32(check, 0));
+}
+
+void test_encoder_stops_when_full() {
+    // ヘッダ + 最長のレコード1つ分しか入らない
+    uint8_t block[CaptureFormat::blockHeaderSize + CaptureFormat::maxImuRecordSize];
+    CaptureFormat::BlockEncoder encoder;
+    encoder.begin(CaptureFormat::Stream::Imu, 0, 0, block, sizeof(block));
+    TEST_ASSERT_TRUE(encoder.addImu({{1.0f, 1.0f, 1.0f}}, {{1.0f, 1.0f, 1.0f}}, 100));
+    TEST_ASSERT_FALSE(encoder.addImu({{1.0f, 1.0f, 1.0f}}, {{1.0f, 1.0f, 1.0f}}, 200));
+    TEST_ASSERT_EQUAL_UINT16(1, encoder.getRecords());
+}
+
+void test_decoder_rejects_truncated_payload() {
+    uint8_t block[blockCapacity];
+    CaptureFormat::BlockEncoder encoder;
+    encoder.begin(CaptureFormat::Stream::Imu, 0, 0, block, sizeof(block));
+    TEST_ASSERT_TRUE(encoder.addImu({{0.5f, -1.0f, 1.0f}}, {{10.0f, -250.5f, 0.0f}}, 1000));
+    TEST_ASSERT_TRUE(encoder.addImu({{0.6f, -1.1f, 1.1f}}, {{20.0f, -240.5f, 1.0f}}, 2000));
+    const auto header = seal(encoder, block);
+
+    // 末尾が欠けたブロック: 最初のレコードは読めるが，欠けたレコードは返さない
+    auto truncated = header;
+    truncated.payloadSize = header.payloadSize - 1;
+    CaptureFormat::BlockDecoder decoder(truncated, payloadOf(block));
+    CaptureFormat::Record record{};
+    TEST_ASSERT_TRUE(decoder.next(record));
+    TEST_ASSERT_FALSE(decoder.next(record));
+
+    // レコード数がペイロードより多いと言っているブロック
+    auto overstated = header;
+    overstated.records = header.records + 1;
+    CaptureFormat::BlockDecoder overstatedDecoder(overstated, payloadOf(block));
+    TEST_ASSERT_TRUE(overstatedDecoder.next(record));
+    TEST_ASSERT_TRUE(overstatedDecoder.next(record));
+    TEST_ASSERT_FALSE(overstatedDecoder.next(record));
+
+    // 終わらない可変長整数 (32bit に収まらない)
+    const uint8_t overlong[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00};
+    CaptureFormat::BlockHeader overlongHeader{};
+    overlongHeader.stream = CaptureFormat::Stream::Audio;
+    overlongHeader.payloadSize = sizeof(overlong);
+    overlongHeader.records = 1;
+    CaptureFormat::BlockDecoder overlongDecoder(overlongHeader, overlong);
+    TEST_ASSERT_FALSE(overlongDecoder.next(record));
+}
+
+void test_block_header_rejects_other_data() {
+    uint8_t block[blockCapacity];
+    CaptureFormat::BlockEncoder encoder;
+    encoder.begin(CaptureFormat::Stream::Audio, 0, 0, block, sizeof(block));
+    const size_t size = encoder.finish();
+
+    CaptureFormat::BlockHeader header{};
+    TEST_ASSERT_FALSE(CaptureFormat::decodeBlockHeader(block, size - 1, header));
+    block[2] = static_cast<uint8_t>(CaptureFormat::Stream::Count);
+    TEST_ASSERT_FALSE(CaptureFormat::decodeBlockHeader(block, size, header));
+    block[2] = static_cast<uint8_t>(CaptureFormat::Stream::Audio);
+    block[1] = 'X';
+    TEST_ASSERT_FALSE(CaptureFormat::decodeBlockHeader(block, size, header));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_file_header_round_trip);
+    RUN_TEST(test_file_header_rejects_other_data);
+    RUN_TEST(test_imu_block_round_trip);
+    RUN_TEST(test_audio_block_round_trip);
+    RUN_TEST(test_out_of_range_values_saturate);
+    RUN_TEST(test_varint_and_zigzag_extremes);
+    RUN_TEST(test_crc32_known_vector);
+    RUN_TEST(test_encoder_stops_when_full);
+    RUN_TEST(test_decoder_rejects_truncated_payload);
+    RUN_TEST(test_block_header_rejects_other_data);
+    return UNITY_END();
+}
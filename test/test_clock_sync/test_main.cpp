@@ -0,0 +1,116 @@
+/// \file test_main.cpp
+/// \brief ClockSync のオフセット推定・最小往復時間の採用・欠落の集計・時刻の展開を確かめる
+
+#include <unity.h>
+#include <cstdint>
+#include "ClockSync.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    /// サーバーの時計が offsetUs 進んでいて，行き forwardUs・帰り backwardUs かかる往復を1回行う
+    bool exchange(ClockSync &sync, uint64_t localUs, int64_t offsetUs, uint32_t forwardUs, uint32_t backwardUs) {
+        const uint64_t t1 = sync.beginExchange(localUs);
+        const uint64_t t2 = t1 + forwardUs + offsetUs;
+        const uint64_t t3 = t2 + 100;  // サーバー内の処理時間
+        const uint64_t t4 = t3 - offsetUs + backwardUs;
+        return sync.completeExchange(t1, t2, t3, t4);
+    }
+}
+
+void test_not_synced_until_enough_exchanges() {
+    ClockSync sync;
+    TEST_ASSERT_FALSE(sync.isSynced());
+    TEST_ASSERT_EQUAL_UINT64(12345, sync.toServerTime(12345));
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(exchange(sync, 1000000ULL * (i + 1), 5000000, 2000, 2000));
+    }
+    TEST_ASSERT_FALSE(sync.isSynced());
+    TEST_ASSERT_TRUE(exchange(sync, 4000000ULL, 5000000, 2000, 2000));
+    TEST_ASSERT_TRUE(sync.isSynced());
+}
+
+void test_symmetric_delay_gives_exact_offset() {
+    ClockSync sync;
+    for (int i = 0; i < 8; i++) {
+        exchange(sync, 1000000ULL * (i + 1), -123456, 1500, 1500);
+    }
+    const auto stats = sync.takeStats();
+    TEST_ASSERT_TRUE(stats.synced);
+    TEST_ASSERT_EQUAL_INT64(-123456, stats.offsetUs);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.rttMinUs);
+    TEST_ASSERT_EQUAL_UINT32(8, stats.exchanges);
+    TEST_ASSERT_EQUAL_UINT64(10000000ULL - 123456, sync.toServerTime(10000000ULL));
+}
+
+void test_lowest_rtt_exchange_is_used() {
+    ClockSync sync;
+    // 非対称な遅延 (帰りだけ遅い) の往復は誤差が大きいので採用されない
+    for (int i = 0; i < 7; i++) {
+        exchange(sync, 1000000ULL * (i + 1), 50000, 1000, 20000 + 1000 * i);
+    }
+    exchange(sync, 8000000ULL, 50000, 500, 500);
+    TEST_ASSERT_EQUAL_INT64(50000, sync.takeStats().offsetUs);
+    TEST_ASSERT_EQUAL_UINT32(1000, sync.getLatestRtt().rttUs);
+}
+
+void test_latest_rtt_advances_only_on_accepted_pong() {
+    ClockSync sync;
+    TEST_ASSERT_EQUAL_UINT32(0, sync.getLatestRtt().sequence);
+    TEST_ASSERT_EQUAL_UINT32(0, sync.getLatestRtt().rttUs);
+
+    exchange(sync, 1000000ULL, 0, 2000, 3000);
+    const auto first = sync.getLatestRtt();
+    TEST_ASSERT_EQUAL_UINT32(1, first.sequence);
+    TEST_ASSERT_EQUAL_UINT32(5000, first.rttUs);
+    TEST_ASSERT_EQUAL_UINT64(1000000ULL + 5100, first.receivedUs);
+
+    // pong が返らない ping では値も sequence も変わらない
+    sync.beginExchange(2000000ULL);
+    sync.beginExchange(3000000ULL);
+    TEST_ASSERT_EQUAL_UINT32(first.sequence, sync.getLatestRtt().sequence);
+
+    exchange(sync, 4000000ULL, 0, 1000, 1000);
+    TEST_ASSERT_EQUAL_UINT32(2, sync.getLatestRtt().sequence);
+    TEST_ASSERT_EQUAL_UINT32(2000, sync.getLatestRtt().rttUs);
+    // takeStats() ではリセットされない
+    sync.takeStats();
+    TEST_ASSERT_EQUAL_UINT32(2, sync.getLatestRtt().sequence);
+}
+
+void test_unanswered_pings_are_counted_as_lost() {
+    ClockSync sync;
+    sync.beginExchange(1000);
+    sync.beginExchange(2000);
+    const uint64_t t1 = sync.beginExchange(3000);
+    // 古い ping への pong は受け付けない
+    TEST_ASSERT_FALSE(sync.completeExchange(2000, 2500, 2600, 3100));
+    TEST_ASSERT_TRUE(sync.completeExchange(t1, 3500, 3600, 4100));
+
+    const auto stats = sync.takeStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.lost);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.exchanges);
+
+    // takeStats() でリセットされる
+    TEST_ASSERT_EQUAL_UINT32(0, sync.takeStats().lost);
+}
+
+void test_extend_handles_micros_wrap() {
+    const uint64_t nowUs = (1ULL << 32) + 1000;   // 32bit の micros() は折り返して 1000
+    TEST_ASSERT_EQUAL_UINT64(nowUs - 500, ClockSync::extend(500, nowUs));
+    TEST_ASSERT_EQUAL_UINT64(nowUs - 3000, ClockSync::extend(UINT32_MAX - 1999, nowUs));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_not_synced_until_enough_exchanges);
+    RUN_TEST(test_symmetric_delay_gives_exact_offset);
+    RUN_TEST(test_lowest_rtt_exchange_is_used);
+    RUN_TEST(test_latest_rtt_advances_only_on_accepted_pong);
+    RUN_TEST(test_unanswered_pings_are_counted_as_lost);
+    RUN_TEST(test_extend_handles_micros_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,166 @@
+/// \file test_main.cpp
+/// \brief CongestionController の混雑の判定・倍率の増減・Bundle の切り替えを確かめる
+
+#include <unity.h>
+#include <algorithm>
+#include <cstdint>
+#include "CongestionController.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    CongestionController::Sample clean() {
+        CongestionController::Sample sample{};
+        sample.attempts = 100;
+        sample.rssi = -60;
+        return sample;
+    }
+}
+
+void test_clean_samples_keep_full_rate() {
+    CongestionController controller;
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_UINT8(0, controller.update(clean()));
+    }
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, controller.getRateScale());
+    TEST_ASSERT_FALSE(controller.isBundled());
+    TEST_ASSERT_EQUAL_UINT32(0, controller.getBackoffs());
+}
+
+void test_loss_needs_rate_and_minimum_errors() {
+    CongestionController controller;
+    auto sample = clean();
+    sample.errors = 1;  // 1%: 偶然の失敗とみなす
+    TEST_ASSERT_EQUAL_UINT8(0, controller.update(sample));
+
+    sample.attempts = 10;
+    sample.errors = 1;  // 10% だが minErrors に満たない
+    TEST_ASSERT_EQUAL_UINT8(0, controller.update(sample));
+
+    sample.attempts = 100;
+    sample.errors = 5;
+    TEST_ASSERT_EQUAL_UINT8(CongestionController::signalLoss, controller.update(sample));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, controller.getRateScale());
+}
+
+void test_buffer_full_is_congestion() {
+    CongestionController controller;
+    auto sample = clean();
+    sample.bufferFull = 1;
+    TEST_ASSERT_EQUAL_UINT8(CongestionController::signalBuffer, controller.update(sample));
+    TEST_ASSERT_EQUAL_UINT32(1, controller.getBackoffs());
+}
+
+void test_rtt_above_twice_base_is_congestion() {
+    CongestionController controller;
+    auto sample = clean();
+    sample.rttUs = 5000;
+    TEST_ASSERT_EQUAL_UINT8(0, controller.update(sample));
+    TEST_ASSERT_EQUAL_UINT32(5000, controller.getBaseRttUs());
+
+    sample.rttUs = 2 * 5000 + 20000;   // ちょうど境界は混雑ではない
+    TEST_ASSERT_EQUAL_UINT8(0, controller.update(sample));
+    sample.rttUs = 60000;
+    TEST_ASSERT_EQUAL_UINT8(CongestionController::signalRtt, controller.update(sample));
+}
+
+void test_scale_is_floored_at_min_scale() {
+    CongestionController controller;
+    auto sample = clean();
+    sample.bufferFull = 1;
+    for (int i = 0; i < 10; i++) {
+        controller.update(sample);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(CongestionController::defaultParameters().minScale, controller.getRateScale());
+}
+
+void test_weak_rssi_caps_scale() {
+    CongestionController controller;
+    auto sample = clean();
+    sample.rssi = -85;
+    TEST_ASSERT_EQUAL_UINT8(CongestionController::signalWeakRssi, controller.update(sample));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, controller.getRateScale());
+    // 上限を下げただけで backoff とは数えない
+    TEST_ASSERT_EQUAL_UINT32(0, controller.getBackoffs());
+}
+
+void test_bundle_switch_has_hysteresis() {
+    CongestionController controller;
+    auto congested = clean();
+    congested.bufferFull = 1;
+
+    controller.update(congested);   // 0.5
+    TEST_ASSERT_TRUE(controller.isBundled());
+
+    // 0.5 -> 0.75 までは Bundle のまま
+    for (int i = 0; i < 3 + 4; i++) {
+        controller.update(clean());
+        TEST_ASSERT_TRUE(controller.isBundled());
+    }
+    controller.update(clean());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.75f, controller.getRateScale());
+    TEST_ASSERT_FALSE(controller.isBundled());
+}
+
+void test_step_response_halves_then_recovers_linearly() {
+    CongestionController controller;
+    const auto params = CongestionController::defaultParameters();
+    auto congested = clean();
+    congested.bufferFull = 1;
+
+    // 混雑が続く間は1回ごとに半分にし，下限で止める
+    const float decreased[] = {0.5f, 0.25f, 0.125f, 0.125f};
+    for (float expected : decreased) {
+        TEST_ASSERT_EQUAL_UINT8(CongestionController::signalBuffer, controller.update(congested));
+        TEST_ASSERT_FLOAT_WITHIN(1e-6f, expected, controller.getRateScale());
+    }
+
+    // 混雑が止んだら holdUpdates 回待ち，その後は increase ずつ 1 まで戻す
+    for (uint32_t i = 0; i < params.holdUpdates; i++) {
+        controller.update(clean());
+        TEST_ASSERT_FLOAT_WITHIN(1e-6f, params.minScale, controller.getRateScale());
+    }
+    float expected = params.minScale;
+    int updates = 0;
+    while (expected < 1.0f) {
+        expected = std::min(1.0f, expected + params.increase);
+        controller.update(clean());
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected, controller.getRateScale());
+        updates++;
+    }
+    TEST_ASSERT_EQUAL_INT(18, updates);     // (1 - 0.125) / 0.05 を切り上げ
+    TEST_ASSERT_EQUAL_UINT32(4, controller.getBackoffs());
+}
+
+void test_rtt_step_backs_off_once_per_sample() {
+    CongestionController controller;
+    auto sample = clean();
+    sample.rttUs = 5000;
+    controller.update(sample);
+
+    // 遅延が1回だけ跳ねた後は，新しい測定がない (0) 間は混雑とみなさない
+    sample.rttUs = 60000;
+    TEST_ASSERT_EQUAL_UINT8(CongestionController::signalRtt, controller.update(sample));
+    sample.rttUs = 0;
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_UINT8(0, controller.update(sample));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, controller.getBackoffs());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f + 2 * 0.05f, controller.getRateScale());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_samples_keep_full_rate);
+    RUN_TEST(test_loss_needs_rate_and_minimum_errors);
+    RUN_TEST(test_buffer_full_is_congestion);
+    RUN_TEST(test_rtt_above_twice_base_is_congestion);
+    RUN_TEST(test_scale_is_floored_at_min_scale);
+    RUN_TEST(test_weak_rssi_caps_scale);
+    RUN_TEST(test_bundle_switch_has_hysteresis);
+    RUN_TEST(test_step_response_halves_then_recovers_linearly);
+    RUN_TEST(test_rtt_step_backs_off_once_per_sample);
+    return UNITY_END();
+}
@@ -0,0 +1,63 @@
+/// \file test_main.cpp
+/// \brief DeltaGate のしきい値・キーフレーム・micros() の折り返しを確かめる
+
+#include <unity.h>
+#include <array>
+#include <cstdint>
+#include "DeltaGate.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_passes_everything_before_setup() {
+    DeltaGate<1> gate;
+    for (uint32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(gate.pass({{0.0f}}, i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, gate.getStats().sent);
+}
+
+void test_suppresses_changes_within_threshold() {
+    DeltaGate<3> gate;
+    gate.setup({{0.01f, 0.01f, 1.0f}}, 1000000);
+
+    TEST_ASSERT_TRUE(gate.pass({{0.0f, 0.0f, 0.0f}}, 0));
+    TEST_ASSERT_FALSE(gate.pass({{0.005f, -0.01f, 0.9f}}, 1000));
+    // どれか1軸でもしきい値を超えたら送る
+    TEST_ASSERT_TRUE(gate.pass({{0.0f, 0.0f, 1.5f}}, 2000));
+    // 比較は最後に送った値とする (少しずつの変化が積もったら送る)
+    TEST_ASSERT_FALSE(gate.pass({{0.008f, 0.0f, 1.5f}}, 3000));
+    TEST_ASSERT_TRUE(gate.pass({{0.016f, 0.0f, 1.5f}}, 4000));
+
+    const auto stats = gate.getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.sent);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.suppressed);
+}
+
+void test_keyframe_after_interval() {
+    DeltaGate<1> gate;
+    gate.setup({{1.0f}}, 100000);
+    TEST_ASSERT_TRUE(gate.pass({{0.0f}}, 0));
+    TEST_ASSERT_FALSE(gate.pass({{0.0f}}, 99999));
+    TEST_ASSERT_TRUE(gate.pass({{0.0f}}, 100000));
+    TEST_ASSERT_FALSE(gate.pass({{0.0f}}, 150000));
+}
+
+void test_keyframe_across_micros_wrap() {
+    DeltaGate<1> gate;
+    gate.setup({{1.0f}}, 100000);
+    const uint32_t start = UINT32_MAX - 50000;
+    TEST_ASSERT_TRUE(gate.pass({{0.0f}}, start));
+    TEST_ASSERT_FALSE(gate.pass({{0.0f}}, start + 60000));   // 折り返した直後
+    TEST_ASSERT_TRUE(gate.pass({{0.0f}}, start + 100000));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_passes_everything_before_setup);
+    RUN_TEST(test_suppresses_changes_within_threshold);
+    RUN_TEST(test_keyframe_after_interval);
+    RUN_TEST(test_keyframe_across_micros_wrap);
+    return UNITY_END();
+}
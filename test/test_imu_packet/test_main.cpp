@@ -0,0 +1,120 @@
+/// \file test_main.cpp
+/// \brief IMUPacket のレンジの換算・M5.Imu と同じ軸の向きへの並べ替え・一致判定を確かめる
+
+#include <unity.h>
+#include <cmath>
+#include <cstdint>
+#include "IMUPacket.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    void putInt16(uint8_t *p, int16_t value) {
+        p[0] = static_cast<uint16_t>(value) >> 8;
+        p[1] = static_cast<uint16_t>(value) & 0xFF;
+    }
+
+    /// データレジスタ (ACCEL_XOUT_H から14バイト) と同じ並びのパケットを作る
+    void makePacket(uint8_t *packet, const int16_t (&acc)[3], int16_t temp, const int16_t (&gyro)[3]) {
+        for (size_t i = 0; i < 3; i++) {
+            putInt16(&packet[i * 2], acc[i]);
+            putInt16(&packet[8 + i * 2], gyro[i]);
+        }
+        putInt16(&packet[6], temp);
+    }
+
+    IMUPacket::Sample makeSample(float ax, float ay, float az, float gx, float gy, float gz) {
+        IMUPacket::Sample sample{};
+        sample.acc = {{ax, ay, az}};
+        sample.gyro = {{gx, gy, gz}};
+        return sample;
+    }
+}
+
+void test_full_scale_from_config_registers() {
+    // FS_SEL は bit 4:3．他のビット (自己診断・DLPF) は無視する
+    TEST_ASSERT_EQUAL_FLOAT(2.0f / 32768.0f, IMUPacket::toAccRes(0x00));
+    TEST_ASSERT_EQUAL_FLOAT(4.0f / 32768.0f, IMUPacket::toAccRes(0x08));
+    TEST_ASSERT_EQUAL_FLOAT(8.0f / 32768.0f, IMUPacket::toAccRes(0x10));
+    TEST_ASSERT_EQUAL_FLOAT(16.0f / 32768.0f, IMUPacket::toAccRes(0xE7 | 0x18));
+    TEST_ASSERT_EQUAL_FLOAT(250.0f / 32768.0f, IMUPacket::toGyroRes(0x00));
+    TEST_ASSERT_EQUAL_FLOAT(500.0f / 32768.0f, IMUPacket::toGyroRes(0x08));
+    TEST_ASSERT_EQUAL_FLOAT(1000.0f / 32768.0f, IMUPacket::toGyroRes(0x10));
+    TEST_ASSERT_EQUAL_FLOAT(2000.0f / 32768.0f, IMUPacket::toGyroRes(0x18 | 0x03));
+}
+
+void test_decode_matches_m5_imu_axis_order() {
+    // 基板を裏返した向き (センサのZ軸が下向き) で静止している時のレジスタの値．
+    // M5.Imu はX軸・Z軸を反転して acc = (0, 0, 1) G を返す
+    uint8_t packet[IMUPacket::packetSize];
+    makePacket(packet, {0, 0, -4096}, 0, {0, 0, 0});
+    auto sample = IMUPacket::decode(packet, IMUPacket::toAccRes(0x10), IMUPacket::toGyroRes(0x18));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, sample.acc[0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, sample.acc[1]);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, sample.acc[2]);
+
+    // 各軸に別の値を入れ，並びと符号が入れ替わっていないことを確かめる
+    // ±8 G: 4096 LSB/G，±2000 dps: 16.384 LSB/dps
+    makePacket(packet, {4096, -8192, 16384}, 0x1234, {1638, -3277, 16384});
+    sample = IMUPacket::decode(packet, IMUPacket::toAccRes(0x10), IMUPacket::toGyroRes(0x18));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, sample.acc[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, sample.acc[1]);
+    TEST_ASSERT_EQUAL_FLOAT(-4.0f, sample.acc[2]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, -100.0f, sample.gyro[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, -200.0f, sample.gyro[1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, -1000.0f, sample.gyro[2]);
+}
+
+void test_decode_uses_the_configured_range() {
+    // 同じレジスタの値でもレンジが違えば換算後の値が変わる
+    uint8_t packet[IMUPacket::packetSize];
+    makePacket(packet, {16384, 0, 0}, 0, {0, 0, 16384});
+    const auto narrow = IMUPacket::decode(packet, IMUPacket::toAccRes(0x00), IMUPacket::toGyroRes(0x00));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, narrow.acc[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-125.0f, narrow.gyro[2]);
+    const auto wide = IMUPacket::decode(packet, IMUPacket::toAccRes(0x18), IMUPacket::toGyroRes(0x18));
+    TEST_ASSERT_EQUAL_FLOAT(-8.0f, wide.acc[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-1000.0f, wide.gyro[2]);
+}
+
+void test_decode_full_range_extremes() {
+    uint8_t packet[IMUPacket::packetSize];
+    makePacket(packet, {INT16_MIN, INT16_MAX, INT16_MIN}, 0, {INT16_MAX, INT16_MIN, INT16_MAX});
+    const auto sample = IMUPacket::decode(packet, IMUPacket::toAccRes(0x00), IMUPacket::toGyroRes(0x00));
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, sample.acc[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f, sample.acc[1]);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, sample.acc[2]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -250.0f, sample.gyro[0]);
+    TEST_ASSERT_EQUAL_FLOAT(-250.0f, sample.gyro[1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -250.0f, sample.gyro[2]);
+}
+
+void test_agrees_within_tolerance() {
+    const auto reference = makeSample(0.0f, 0.0f, 1.0f, 1.0f, -2.0f, 0.5f);
+    TEST_ASSERT_TRUE(IMUPacket::agrees(makeSample(0.05f, -0.05f, 0.95f, 3.0f, -4.0f, -1.0f), reference, 0.1f, 5.0f));
+}
+
+void test_agrees_rejects_flipped_or_rescaled_axes() {
+    const auto reference = makeSample(0.0f, 0.0f, 1.0f, 4.0f, -2.0f, 0.5f);
+    // Z軸の符号が逆 (向きをそろえていない)
+    TEST_ASSERT_FALSE(IMUPacket::agrees(makeSample(0.0f, 0.0f, -1.0f, 4.0f, -2.0f, 0.5f), reference, 0.1f, 5.0f));
+    // 加速度のレンジを取り違えた (±4 G を ±8 G として換算)
+    TEST_ASSERT_FALSE(IMUPacket::agrees(makeSample(0.0f, 0.0f, 2.0f, 4.0f, -2.0f, 0.5f), reference, 0.1f, 5.0f));
+    // 角速度だけが食い違う (X軸の符号が逆)
+    TEST_ASSERT_FALSE(IMUPacket::agrees(makeSample(0.0f, 0.0f, 1.0f, -4.0f, -2.0f, 0.5f), reference, 0.1f, 5.0f));
+    // NaN は一致しない
+    TEST_ASSERT_FALSE(IMUPacket::agrees(makeSample(NAN, 0.0f, 1.0f, 4.0f, -2.0f, 0.5f), reference, 0.1f, 5.0f));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_scale_from_config_registers);
+    RUN_TEST(test_decode_matches_m5_imu_axis_order);
+    RUN_TEST(test_decode_uses_the_configured_range);
+    RUN_TEST(test_decode_full_range_extremes);
+    RUN_TEST(test_agrees_within_tolerance);
+    RUN_TEST(test_agrees_rejects_flipped_or_rescaled_axes);
+    return UNITY_END();
+}
@@ -0,0 +1,199 @@
+/// \file test_main.cpp
+/// \brief MotionDetector の衝撃・回転・静止の検出を合成したサンプル列で確かめる
+///
+/// fixtures/ の *.csv は motion_replay と同じ形式のサンプル列 (蹴る・転がす・振る・置いたまま)，
+/// *.events はそれを流した時に出るイベントの列 (motion_replay の出力) で，両者が一致することを確かめる．
+
+#include <unity.h>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "MotionDetector.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    const uint32_t periodUs = 2000;  // 500 Hz
+
+    struct Runner {
+        MotionDetector detector;
+        std::vector<MotionDetector::Event> events;
+        uint32_t nowUs;
+
+        explicit Runner(uint32_t startUs = 0) : nowUs(startUs) {}
+
+        void run(const std::array<float, 3> &acc, const std::array<float, 3> &gyro, uint32_t durationUs) {
+            std::array<MotionDetector::Event, MotionDetector::maxEventsPerSample> buffer{};
+            for (uint32_t t = 0; t < durationUs; t += periodUs) {
+                const size_t count = detector.update(acc, gyro, nowUs, buffer.data());
+                events.insert(events.end(), buffer.begin(), buffer.begin() + count);
+                nowUs += periodUs;
+            }
+        }
+
+        size_t count(MotionDetector::EventType type) const {
+            size_t n = 0;
+            for (const auto &event : events) {
+                n += event.type == type ? 1 : 0;
+            }
+            return n;
+        }
+    };
+
+    const std::array<float, 3> gravity = {{0.0f, 0.0f, 1.0f}};
+    const std::array<float, 3> noRotation = {{0.0f, 0.0f, 0.0f}};
+
+    /// このファイルと同じディレクトリの fixtures/ のパス
+    std::string fixturePath(const char *name) {
+        const std::string file = __FILE__;
+        const size_t slash = file.find_last_of('/');
+        return (slash == std::string::npos ? std::string(".") : file.substr(0, slash)) + "/fixtures/" + name;
+    }
+
+    /// "timestamp_us,ax,ay,az,gx,gy,gz" のサンプル列を流して検出したイベント
+    std::vector<MotionDetector::Event> replay(const char *name) {
+        std::vector<MotionDetector::Event> events;
+        const std::string path = fixturePath(name) + ".csv";
+        FILE *file = fopen(path.c_str(), "r");
+        TEST_ASSERT_NOT_NULL_MESSAGE(file, path.c_str());
+
+        MotionDetector detector;
+        std::array<MotionDetector::Event, MotionDetector::maxEventsPerSample> buffer{};
+        size_t samples = 0;
+        char line[256];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            unsigned long timestampUs = 0;
+            std::array<float, 3> acc{};
+            std::array<float, 3> gyro{};
+            if (sscanf(line, "%lu,%f,%f,%f,%f,%f,%f", &timestampUs, &acc[0], &acc[1], &acc[2],
+                       &gyro[0], &gyro[1], &gyro[2]) != 7) {
+                continue;
+            }
+            samples++;
+            const size_t count = detector.update(acc, gyro, static_cast<uint32_t>(timestampUs), buffer.data());
+            events.insert(events.end(), buffer.begin(), buffer.begin() + count);
+        }
+        fclose(file);
+        TEST_ASSERT_GREATER_THAN(0, samples);
+        return events;
+    }
+
+    /// "timestamp_us,type,active,value" の期待するイベント列と比べる
+    void assertReplayMatches(const char *name) {
+        const auto events = replay(name);
+        const std::string path = fixturePath(name) + ".events";
+        FILE *file = fopen(path.c_str(), "r");
+        TEST_ASSERT_NOT_NULL_MESSAGE(file, path.c_str());
+
+        size_t index = 0;
+        char line[128];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            unsigned long timestampUs = 0;
+            char type[16] = {};
+            int active = 0;
+            float value = 0.0f;
+            if (sscanf(line, "%lu,%15[^,],%d,%f", &timestampUs, type, &active, &value) != 4) {
+                continue;
+            }
+            TEST_ASSERT_LESS_THAN_MESSAGE(events.size(), index, line);
+            const auto &event = events[index++];
+            TEST_ASSERT_EQUAL_STRING_MESSAGE(type, MotionDetector::getName(event.type), line);
+            TEST_ASSERT_EQUAL_MESSAGE(active != 0, event.active, line);
+            TEST_ASSERT_EQUAL_UINT32_MESSAGE(timestampUs, event.timestampUs, line);
+            TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.01f, value, event.value, line);
+        }
+        fclose(file);
+        TEST_ASSERT_EQUAL_UINT32(index, events.size());
+    }
+}
+
+void test_names() {
+    TEST_ASSERT_EQUAL_STRING("impact", MotionDetector::getName(MotionDetector::EventType::Impact));
+    TEST_ASSERT_EQUAL_STRING("roll", MotionDetector::getName(MotionDetector::EventType::Roll));
+    TEST_ASSERT_EQUAL_STRING("shake", MotionDetector::getName(MotionDetector::EventType::Shake));
+    TEST_ASSERT_EQUAL_STRING("still", MotionDetector::getName(MotionDetector::EventType::Still));
+}
+
+void test_rest_becomes_still_after_enter_time() {
+    Runner runner;
+    runner.run(gravity, noRotation, 900000);
+    TEST_ASSERT_EQUAL_UINT32(0, runner.events.size());
+    runner.run(gravity, noRotation, 200000);
+    TEST_ASSERT_EQUAL_UINT32(1, runner.events.size());
+    TEST_ASSERT_TRUE(runner.events[0].type == MotionDetector::EventType::Still);
+    TEST_ASSERT_TRUE(runner.events[0].active);
+    TEST_ASSERT_TRUE(runner.detector.isStill());
+}
+
+void test_impact_reports_peak_once() {
+    Runner runner;
+    runner.run(gravity, {{50.0f, 0.0f, 0.0f}}, 100000);
+    runner.run({{0.0f, 0.0f, 4.0f}}, {{50.0f, 0.0f, 0.0f}}, 4000);
+    runner.run({{0.0f, 0.0f, 6.0f}}, {{50.0f, 0.0f, 0.0f}}, 2000);
+    runner.run(gravity, {{50.0f, 0.0f, 0.0f}}, 200000);
+
+    TEST_ASSERT_EQUAL_UINT32(1, runner.count(MotionDetector::EventType::Impact));
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, runner.events[0].value);
+}
+
+void test_roll_starts_and_stops_with_hysteresis() {
+    Runner runner;
+    runner.run({{0.0f, 0.0f, 1.0f}}, {{0.0f, 0.0f, 180.0f}}, 1000000);
+    TEST_ASSERT_TRUE(runner.detector.isRolling());
+    // 終了のしきい値より上なら止まらない
+    runner.run({{0.0f, 0.0f, 1.0f}}, {{0.0f, 0.0f, 60.0f}}, 1000000);
+    TEST_ASSERT_TRUE(runner.detector.isRolling());
+    runner.run({{0.0f, 0.0f, 1.0f}}, {{0.0f, 0.0f, 20.0f}}, 1000000);
+    TEST_ASSERT_FALSE(runner.detector.isRolling());
+
+    const MotionDetector::Event *last = nullptr;
+    for (const auto &event : runner.events) {
+        if (event.type == MotionDetector::EventType::Roll) {
+            last = &event;
+        }
+    }
+    TEST_ASSERT_NOT_NULL(last);
+    TEST_ASSERT_FALSE(last->active);
+    TEST_ASSERT_GREATER_THAN(1.5f, last->value);   // 回転していた時間 [s]
+}
+
+void test_detects_across_micros_wrap() {
+    Runner runner(UINT32_MAX - 500000);
+    runner.run(gravity, noRotation, 1200000);
+    TEST_ASSERT_EQUAL_UINT32(1, runner.count(MotionDetector::EventType::Still));
+}
+
+void test_fixture_rest() {
+    assertReplayMatches("rest");
+}
+
+void test_fixture_kick() {
+    assertReplayMatches("kick");
+}
+
+void test_fixture_roll() {
+    assertReplayMatches("roll");
+}
+
+void test_fixture_shake() {
+    assertReplayMatches("shake");
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_names);
+    RUN_TEST(test_rest_becomes_still_after_enter_time);
+    RUN_TEST(test_impact_reports_peak_once);
+    RUN_TEST(test_roll_starts_and_stops_with_hysteresis);
+    RUN_TEST(test_detects_across_micros_wrap);
+    RUN_TEST(test_fixture_rest);
+    RUN_TEST(test_fixture_kick);
+    RUN_TEST(test_fixture_roll);
+    RUN_TEST(test_fixture_shake);
+    return UNITY_END();
+}
@@ -0,0 +1,100 @@
+/// \file test_main.cpp
+/// \brief OrientationFilter が静止した姿勢に収束し，reset() の初期姿勢が加速度と一致することを確かめる
+
+#include <unity.h>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "OrientationFilter.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    const float degToRad = 0.017453292519943295f;
+    const float sampleRate = 500.0f;
+
+    // IMUManager と同じゲイン
+    const float madgwickBeta = 0.1f;
+    const float mahonyKp = 1.0f;
+
+    const float roll = 30.0f;
+    const float pitch = -20.0f;
+
+    /// ロール・ピッチだけ傾けて静止したときのセンサ座標の重力 [G]
+    std::array<float, 3> gravity(float rollDeg, float pitchDeg) {
+        const float r = rollDeg * degToRad;
+        const float p = pitchDeg * degToRad;
+        return {{-sinf(p), sinf(r) * cosf(p), cosf(r) * cosf(p)}};
+    }
+
+    /// 水平 (単位クォータニオン) から始めて seconds 秒間静止させる
+    std::array<float, 3> settle(OrientationFilter &filter, float seconds) {
+        const auto acc = gravity(roll, pitch);
+        uint32_t state = 1;
+        const auto samples = static_cast<size_t>(seconds * sampleRate);
+        for (size_t i = 0; i < samples; i++) {
+            // ±0.01 G・±0.2 deg/s の決定的なノイズ
+            state = state * 1664525u + 1013904223u;
+            const float noise = static_cast<float>(state >> 8) / (1 << 24) - 0.5f;
+            filter.update(0.4f * noise, -0.4f * noise, 0.0f,
+                          acc[0] + 0.02f * noise, acc[1] - 0.02f * noise, acc[2], 1.0f / sampleRate);
+        }
+        return filter.getEuler();
+    }
+}
+
+void test_madgwick_converges_to_static_orientation() {
+    OrientationFilter filter;
+    filter.setup(OrientationFilter::Algorithm::Madgwick, madgwickBeta);
+    // beta = 0.1 rad/s なので 36° の誤差は 10 秒程度で詰まる
+    const auto euler = settle(filter, 20.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, roll, euler[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, pitch, euler[1]);
+}
+
+void test_mahony_converges_to_static_orientation() {
+    OrientationFilter filter;
+    filter.setup(OrientationFilter::Algorithm::Mahony, mahonyKp);
+    const auto euler = settle(filter, 10.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, roll, euler[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, pitch, euler[1]);
+}
+
+void test_reset_starts_at_accelerometer_tilt() {
+    const auto acc = gravity(roll, pitch);
+    OrientationFilter filter;
+    filter.setup(OrientationFilter::Algorithm::Madgwick, madgwickBeta);
+    filter.reset(acc[0], acc[1], acc[2]);
+    const auto euler = filter.getEuler();
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, roll, euler[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, pitch, euler[1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, euler[2]);
+
+    // 静止したままなら初期姿勢から動かない
+    settle(filter, 1.0f);
+    const auto settled = filter.getEuler();
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, roll, settled[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, pitch, settled[1]);
+}
+
+void test_linear_acceleration_is_zero_at_rest() {
+    const auto acc = gravity(roll, pitch);
+    OrientationFilter filter;
+    filter.setup(OrientationFilter::Algorithm::Mahony, mahonyKp);
+    filter.reset(acc[0], acc[1], acc[2]);
+    const auto linear = filter.getLinearAcceleration(acc[0], acc[1], acc[2]);
+    for (float a : linear) {
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, a);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_madgwick_converges_to_static_orientation);
+    RUN_TEST(test_mahony_converges_to_static_orientation);
+    RUN_TEST(test_reset_starts_at_accelerometer_tilt);
+    RUN_TEST(test_linear_acceleration_is_zero_at_rest);
+    return UNITY_END();
+}
@@ -0,0 +1,204 @@
+/// \file test_main.cpp
+/// \brief OSCMessageTemplate・OSCBundleBuilder の出力を ArduinoOSC のエンコーダとバイト単位で比べる
+///
+/// ArduinoOSC はこのテスト (native 環境) でだけ使い，ファームウェアにはリンクしない．
+/// 比較の前提が崩れていないよう，OSC 1.0 の仕様から手で求めたバイト列とも比べる．
+
+#include <unity.h>
+#include <cstdint>
+#include <vector>
+#include <ArduinoOSC/OscEncoder.h>
+#include <ArduinoOSC/OscMessage.h>
+#include "OSCBundleBuilder.h"
+#include "OSCMessageTemplate.h"
+
+namespace osc = arduino::osc;
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    const uint64_t timetagUs = 3723500000ULL;   // 3723.5 s
+
+    std::vector<uint8_t> bytes(const uint8_t *data, size_t size) {
+        return std::vector<uint8_t>(data, data + size);
+    }
+
+    std::vector<uint8_t> bytes(const osc::message::Encoder &encoder) {
+        const auto *data = reinterpret_cast<const uint8_t *>(encoder.data());
+        return std::vector<uint8_t>(data, data + encoder.size());
+    }
+
+    /// ArduinoOSC の TimeTag は NTP形式の 64bit 値をそのまま持つ
+    osc::TimeTag toTimeTag(uint64_t timeUs) {
+        OSCMessageTemplate message;
+        message.build("/t", "t");
+        message.setTimetag(0, timeUs);
+        const uint8_t *p = message.data() + message.size() - 8;
+        uint64_t ntp = 0;
+        for (size_t i = 0; i < 8; i++) {
+            ntp = (ntp << 8) | p[i];
+        }
+        return osc::TimeTag(ntp);
+    }
+
+    void assertSameBytes(const std::vector<uint8_t> &expected, const std::vector<uint8_t> &actual) {
+        TEST_ASSERT_EQUAL_UINT32(expected.size(), actual.size());
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data(), actual.data(), expected.size());
+    }
+
+    struct Frame {
+        OSCMessageTemplate acc;
+        OSCMessageTemplate db;
+        OSCMessageTemplate button;
+
+        Frame() {
+            acc.build("/ccbt1/imu/acc", "fff");
+            acc.setFloat(0, 0.125f);
+            acc.setFloat(1, -1.0f);
+            acc.setFloat(2, 0.984375f);
+            db.build("/ccbt1/mic/db", "f");
+            db.setFloat(0, 58.25f);
+            button.build("/ccbt1/button/a", "iT");
+            button.setInt(0, -3);
+            button.setBool(1, true);
+        }
+
+        void encode(osc::message::Encoder &encoder) const {
+            osc::message::Message accRef;
+            accRef.init("/ccbt1/imu/acc");
+            accRef.push(0.125f).push(-1.0f).push(0.984375f);
+            osc::message::Message dbRef;
+            dbRef.init("/ccbt1/mic/db");
+            dbRef.push(58.25f);
+            osc::message::Message buttonRef;
+            buttonRef.init("/ccbt1/button/a");
+            buttonRef.push(static_cast<int32_t>(-3)).push(true);
+            encoder.encode(accRef);
+            encoder.encode(dbRef);
+            encoder.encode(buttonRef);
+        }
+    };
+}
+
+void test_message_matches_spec() {
+    Frame frame;
+    const uint8_t expected[] = {
+        '/', 'c', 'c', 'b', 't', '1', '/', 'i', 'm', 'u', '/', 'a', 'c', 'c', 0, 0,
+        ',', 'f', 'f', 'f', 0, 0, 0, 0,
+        0x3E, 0x00, 0x00, 0x00,     // 0.125
+        0xBF, 0x80, 0x00, 0x00,     // -1.0
+        0x3F, 0x7C, 0x00, 0x00,     // 0.984375
+    };
+    assertSameBytes(bytes(expected, sizeof(expected)), bytes(frame.acc.data(), frame.acc.size()));
+}
+
+void test_messages_match_arduino_osc() {
+    Frame frame;
+    const OSCMessageTemplate *messages[] = {&frame.acc, &frame.db, &frame.button};
+    osc::message::Encoder reference;
+    reference.init();
+    frame.encode(reference);
+
+    // Encoder は Bundle の外ではメッセージをそのまま連結する
+    std::vector<uint8_t> actual;
+    for (const auto *message : messages) {
+        const auto encoded = bytes(message->data(), message->size());
+        actual.insert(actual.end(), encoded.begin(), encoded.end());
+    }
+    assertSameBytes(bytes(reference), actual);
+}
+
+void test_timetag_argument_matches_arduino_osc() {
+    OSCMessageTemplate message;
+    message.build("/ccbt1/clock/ping", "t");
+    message.setTimetag(0, timetagUs);
+
+    osc::message::Message referenceMessage;
+    referenceMessage.init("/ccbt1/clock/ping");
+    referenceMessage.push(toTimeTag(timetagUs));
+    osc::message::Encoder reference;
+    reference.init();
+    reference.encode(referenceMessage);
+
+    assertSameBytes(bytes(reference), bytes(message.data(), message.size()));
+    // 3723.5 s -> 秒 0x00000E8B, 小数部 0x80000000
+    const uint8_t ntp[] = {0x00, 0x00, 0x0E, 0x8B, 0x80, 0x00, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(ntp, message.data() + message.size() - 8, sizeof(ntp));
+}
+
+void test_bundle_matches_arduino_osc() {
+    Frame frame;
+    OSCBundleBuilder bundle;
+    bundle.begin(timetagUs);
+    TEST_ASSERT_TRUE(bundle.add(frame.acc));
+    TEST_ASSERT_TRUE(bundle.add(frame.db));
+    TEST_ASSERT_TRUE(bundle.add(frame.button));
+
+    osc::message::Encoder reference;
+    reference.init();
+    reference.begin_bundle(toTimeTag(timetagUs));
+    frame.encode(reference);
+    reference.end_bundle();
+
+    assertSameBytes(bytes(reference), bytes(bundle.data(), bundle.size()));
+
+    const uint8_t header[] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+                              0x00, 0x00, 0x0E, 0x8B, 0x80, 0x00, 0x00, 0x00,
+                              0x00, 0x00, 0x00, 36};    // /ccbt1/imu/acc の長さ
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(header, bundle.data(), sizeof(header));
+}
+
+void test_nested_bundle_matches_arduino_osc() {
+    Frame frame;
+    OSCBundleBuilder bundle;
+    bundle.begin(timetagUs);
+    TEST_ASSERT_TRUE(bundle.add(frame.db));
+    TEST_ASSERT_TRUE(bundle.beginNested(timetagUs + 2000));
+    TEST_ASSERT_TRUE(bundle.add(frame.acc));
+    bundle.endNested();
+
+    osc::message::Message dbRef;
+    dbRef.init("/ccbt1/mic/db");
+    dbRef.push(58.25f);
+    osc::message::Message accRef;
+    accRef.init("/ccbt1/imu/acc");
+    accRef.push(0.125f).push(-1.0f).push(0.984375f);
+
+    osc::message::Encoder reference;
+    reference.init();
+    reference.begin_bundle(toTimeTag(timetagUs));
+    reference.encode(dbRef);
+    reference.begin_bundle(toTimeTag(timetagUs + 2000));
+    reference.encode(accRef);
+    reference.end_bundle();
+    reference.end_bundle();
+
+    assertSameBytes(bytes(reference), bytes(bundle.data(), bundle.size()));
+}
+
+void test_bundle_rejects_overflow() {
+    OSCMessageTemplate message;
+    message.build("/ccbt1/imu/acc", "fff");
+    OSCBundleBuilder bundle;
+    bundle.begin(0);
+    size_t added = 0;
+    while (bundle.add(message)) {
+        added++;
+    }
+    // 16 + (4 + 36) * n <= 512
+    TEST_ASSERT_EQUAL_UINT32(12, added);
+    TEST_ASSERT_EQUAL_UINT32(16 + 40 * 12, bundle.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_message_matches_spec);
+    RUN_TEST(test_messages_match_arduino_osc);
+    RUN_TEST(test_timetag_argument_matches_arduino_osc);
+    RUN_TEST(test_bundle_matches_arduino_osc);
+    RUN_TEST(test_nested_bundle_matches_arduino_osc);
+    RUN_TEST(test_bundle_rejects_overflow);
+    return UNITY_END();
+}
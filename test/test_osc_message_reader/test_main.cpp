@@ -0,0 +1,268 @@
+/// \file test_main.cpp
+/// \brief OSCMessageReader が入れ子の Bundle を辿り，壊れたパケットを範囲外を読まずに捨てることを確かめる
+///
+/// 壊れたパケットは OSC 1.0 の仕様から手で組み立てる．
+
+#include <unity.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "OSCMessageReader.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    /// OSCのバイト列を手で組み立てる
+    struct Packet {
+        std::vector<uint8_t> bytes;
+
+        /// NUL終端して4バイト境界まで0で埋める
+        Packet &str(const char *s) {
+            const size_t length = strlen(s);
+            bytes.insert(bytes.end(), s, s + length);
+            const size_t padded = (length + 4) & ~static_cast<size_t>(3);
+            bytes.insert(bytes.end(), padded - length, 0);
+            return *this;
+        }
+
+        /// 終端もパディングもしない
+        Packet &raw(const char *s) {
+            bytes.insert(bytes.end(), s, s + strlen(s));
+            return *this;
+        }
+
+        Packet &i32(uint32_t value) {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                bytes.push_back(static_cast<uint8_t>(value >> shift));
+            }
+            return *this;
+        }
+
+        Packet &f32(float value) {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return i32(bits);
+        }
+
+        Packet &bundle() {
+            return str("#bundle").i32(0).i32(1);
+        }
+
+        /// Bundle の要素 (長さ + 中身)
+        Packet &element(const Packet &content) {
+            i32(static_cast<uint32_t>(content.bytes.size()));
+            bytes.insert(bytes.end(), content.bytes.begin(), content.bytes.end());
+            return *this;
+        }
+    };
+
+    Packet message(const char *address) {
+        return Packet().str(address).str(",");
+    }
+
+    /// パケット内のメッセージのアドレスを順に集める
+    std::vector<std::string> readAddresses(const Packet &packet) {
+        OSCMessageReader reader;
+        std::vector<std::string> addresses;
+        if (!reader.begin(packet.bytes.data(), packet.bytes.size())) {
+            return addresses;
+        }
+        while (reader.next()) {
+            addresses.push_back(reader.getAddress());
+        }
+        return addresses;
+    }
+
+    bool readsNothing(const Packet &packet) {
+        return readAddresses(packet).empty();
+    }
+}
+
+void test_reads_typed_arguments() {
+    const auto packet = Packet().str("/ccbt1/config/format").str(",ifsTF")
+            .i32(static_cast<uint32_t>(-7)).f32(2.5f).str("bundle");
+    OSCMessageReader reader;
+    TEST_ASSERT_TRUE(reader.begin(packet.bytes.data(), packet.bytes.size()));
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL_STRING("/ccbt1/config/format", reader.getAddress());
+    TEST_ASSERT_EQUAL_UINT32(5, reader.getNumArgs());
+
+    float value = 0.0f;
+    TEST_ASSERT_TRUE(reader.getNumber(0, value));
+    TEST_ASSERT_EQUAL_FLOAT(-7.0f, value);
+    TEST_ASSERT_TRUE(reader.getNumber(1, value));
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, value);
+    TEST_ASSERT_EQUAL_STRING("bundle", reader.getString(2));
+    TEST_ASSERT_FALSE(reader.getNumber(2, value));
+    TEST_ASSERT_TRUE(reader.getNumber(3, value));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, value);
+    TEST_ASSERT_TRUE(reader.getNumber(4, value));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, value);
+
+    // 範囲外・型違いは読めない
+    TEST_ASSERT_NULL(reader.getString(0));
+    TEST_ASSERT_FALSE(reader.getNumber(5, value));
+    TEST_ASSERT_EQUAL('\0', reader.getType(5));
+    TEST_ASSERT_FALSE(reader.next());
+}
+
+void test_begin_rejects_unaligned_packets() {
+    const uint8_t packet[] = {'/', 'a', 0, 0, 0};
+    OSCMessageReader reader;
+    TEST_ASSERT_FALSE(reader.begin(packet, 0));
+    TEST_ASSERT_FALSE(reader.begin(packet, 2));
+    TEST_ASSERT_FALSE(reader.begin(packet, sizeof(packet)));
+    TEST_ASSERT_FALSE(reader.next());
+}
+
+void test_walks_nested_bundles_in_order() {
+    const auto innermost = Packet().bundle().element(message("/c"));
+    const auto inner = Packet().bundle().element(message("/b")).element(innermost);
+    const auto packet = Packet().bundle().element(message("/a")).element(inner).element(message("/d"));
+
+    const auto addresses = readAddresses(packet);
+    TEST_ASSERT_EQUAL_UINT32(4, addresses.size());
+    TEST_ASSERT_EQUAL_STRING("/a", addresses[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("/b", addresses[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("/c", addresses[2].c_str());
+    TEST_ASSERT_EQUAL_STRING("/d", addresses[3].c_str());
+}
+
+void test_skips_bundles_nested_too_deep() {
+    // maxDepth を超えた Bundle の中身は読まず，その後の要素は読む
+    auto nested = Packet().bundle().element(message("/deep"));
+    for (size_t i = 0; i < OSCMessageReader::maxDepth; i++) {
+        nested = Packet().bundle().element(nested);
+    }
+    const auto packet = Packet().bundle().element(message("/a")).element(nested).element(message("/b"));
+
+    const auto addresses = readAddresses(packet);
+    TEST_ASSERT_EQUAL_UINT32(2, addresses.size());
+    TEST_ASSERT_EQUAL_STRING("/a", addresses[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("/b", addresses[1].c_str());
+}
+
+void test_drops_bundle_whose_element_overruns_it() {
+    // 内側の Bundle の2つ目の要素の長さ (64) が Bundle の終わりを越える．
+    // 内側の残りは捨て，外側の続きは読む
+    const auto inner = Packet().bundle().element(message("/a")).i32(64).str("/b").str(",");
+    const auto packet = Packet().bundle().element(inner).element(message("/c"));
+
+    const auto addresses = readAddresses(packet);
+    TEST_ASSERT_EQUAL_UINT32(2, addresses.size());
+    TEST_ASSERT_EQUAL_STRING("/a", addresses[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("/c", addresses[1].c_str());
+
+    // 外側の要素の長さがパケットの終わりを越える
+    const auto truncated = Packet().bundle().element(message("/a")).i32(0x7FFFFFFC).str("/b").str(",");
+    const auto truncatedAddresses = readAddresses(truncated);
+    TEST_ASSERT_EQUAL_UINT32(1, truncatedAddresses.size());
+    TEST_ASSERT_EQUAL_STRING("/a", truncatedAddresses[0].c_str());
+
+    // 4の倍数でない長さも境界がわからないので捨てる
+    const auto unaligned = Packet().bundle().i32(6).str("/b").str(",");
+    TEST_ASSERT_TRUE(readsNothing(unaligned));
+}
+
+void test_rejects_unterminated_address() {
+    // 4バイトちょうどで NUL がない
+    TEST_ASSERT_TRUE(readsNothing(Packet().raw("/abc")));
+    // アドレスが '/' で始まらない
+    TEST_ASSERT_TRUE(readsNothing(message("abc")));
+
+    // Bundle の要素の中で終端していないアドレスは，その要素だけを捨てる
+    const auto packet = Packet().bundle().element(Packet().raw("/abcdefg")).element(message("/b"));
+    const auto addresses = readAddresses(packet);
+    TEST_ASSERT_EQUAL_UINT32(1, addresses.size());
+    TEST_ASSERT_EQUAL_STRING("/b", addresses[0].c_str());
+}
+
+void test_rejects_unterminated_type_tags() {
+    TEST_ASSERT_TRUE(readsNothing(Packet().str("/a").raw(",iii").i32(1).i32(2).i32(3)));
+    // 要素の終わりでタイプタグが途切れる
+    const auto cut = Packet().str("/a").raw(",iii");
+    TEST_ASSERT_TRUE(readsNothing(Packet().bundle().element(cut)));
+    // ',' で始まらない
+    TEST_ASSERT_TRUE(readsNothing(Packet().str("/a").str("i").i32(1)));
+}
+
+void test_rejects_arguments_past_the_end() {
+    // 'i' の値がない
+    TEST_ASSERT_TRUE(readsNothing(Packet().str("/a").str(",i")));
+    // 's' の文字列が終端していない
+    TEST_ASSERT_TRUE(readsNothing(Packet().str("/a").str(",s").raw("abcd")));
+    // 'h' の値が4バイトしかない
+    TEST_ASSERT_TRUE(readsNothing(Packet().str("/a").str(",h").i32(1)));
+}
+
+void test_blob_length_is_checked() {
+    // 長さが残りのバイト数を越える
+    TEST_ASSERT_TRUE(readsNothing(Packet().str("/a").str(",b").i32(5).raw("abcd")));
+    TEST_ASSERT_TRUE(readsNothing(Packet().str("/a").str(",b").i32(0xFFFFFFFF).raw("abcd")));
+    // blob の後の引数の分が残っていない
+    TEST_ASSERT_TRUE(readsNothing(Packet().str("/a").str(",bi").i32(5).str("abcde")));
+
+    // 正しい blob (4バイト境界まで埋める) の後の引数は読める
+    const auto packet = Packet().str("/a").str(",bi").i32(5).str("abcde").i32(42);
+    OSCMessageReader reader;
+    TEST_ASSERT_TRUE(reader.begin(packet.bytes.data(), packet.bytes.size()));
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL('b', reader.getType(0));
+    float value = 0.0f;
+    TEST_ASSERT_TRUE(reader.getNumber(1, value));
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, value);
+}
+
+void test_rejects_more_than_max_args() {
+    auto full = Packet().str("/a").str(",iiiiiiii");
+    for (size_t i = 0; i < OSCMessageReader::maxArgs; i++) {
+        full.i32(static_cast<uint32_t>(i));
+    }
+    OSCMessageReader reader;
+    TEST_ASSERT_TRUE(reader.begin(full.bytes.data(), full.bytes.size()));
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL_UINT32(OSCMessageReader::maxArgs, reader.getNumArgs());
+
+    auto tooMany = Packet().str("/a").str(",iiiiiiiii");
+    for (size_t i = 0; i <= OSCMessageReader::maxArgs; i++) {
+        tooMany.i32(static_cast<uint32_t>(i));
+    }
+    TEST_ASSERT_TRUE(readsNothing(tooMany));
+}
+
+void test_accepts_legacy_message_without_type_tags() {
+    // タイプタグがない古い形式は引数なしのメッセージとして読む
+    const auto packet = Packet().str("/ccbt1/config/reset");
+    OSCMessageReader reader;
+    TEST_ASSERT_TRUE(reader.begin(packet.bytes.data(), packet.bytes.size()));
+    TEST_ASSERT_TRUE(reader.next());
+    TEST_ASSERT_EQUAL_STRING("/ccbt1/config/reset", reader.getAddress());
+    TEST_ASSERT_EQUAL_UINT32(0, reader.getNumArgs());
+    float value = 0.0f;
+    TEST_ASSERT_FALSE(reader.getNumber(0, value));
+    TEST_ASSERT_FALSE(reader.next());
+
+    // Bundle の中でも同じ
+    const auto addresses = readAddresses(Packet().bundle().element(Packet().str("/a")).element(message("/b")));
+    TEST_ASSERT_EQUAL_UINT32(2, addresses.size());
+    TEST_ASSERT_EQUAL_STRING("/a", addresses[0].c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reads_typed_arguments);
+    RUN_TEST(test_begin_rejects_unaligned_packets);
+    RUN_TEST(test_walks_nested_bundles_in_order);
+    RUN_TEST(test_skips_bundles_nested_too_deep);
+    RUN_TEST(test_drops_bundle_whose_element_overruns_it);
+    RUN_TEST(test_rejects_unterminated_address);
+    RUN_TEST(test_rejects_unterminated_type_tags);
+    RUN_TEST(test_rejects_arguments_past_the_end);
+    RUN_TEST(test_blob_length_is_checked);
+    RUN_TEST(test_rejects_more_than_max_args);
+    RUN_TEST(test_accepts_legacy_message_without_type_tags);
+    return UNITY_END();
+}
@@ -0,0 +1,144 @@
+/// \file test_main.cpp
+/// \brief OSCMessageTemplate のエンコード・書き換え・受信時の照合を確かめる
+
+#include <unity.h>
+#include <cstring>
+#include "OSCMessageTemplate.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    void appendFloat(uint8_t *out, float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        out[0] = bits >> 24;
+        out[1] = bits >> 16;
+        out[2] = bits >> 8;
+        out[3] = bits;
+    }
+}
+
+void test_build_pads_address_and_type_tags() {
+    OSCMessageTemplate message;
+    TEST_ASSERT_TRUE(message.build("/ccbt1/imu/acc", "fff"));
+
+    // "/ccbt1/imu/acc" (14) + NUL -> 16，",fff" + NUL -> 8，float 3つ -> 12
+    TEST_ASSERT_EQUAL_UINT32(36, message.size());
+    const uint8_t header[] = {'/', 'c', 'c', 'b', 't', '1', '/', 'i', 'm', 'u', '/', 'a', 'c', 'c', 0, 0,
+                              ',', 'f', 'f', 'f', 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(header, message.data(), sizeof(header));
+}
+
+void test_address_of_multiple_of_four_gets_full_padding() {
+    OSCMessageTemplate message;
+    TEST_ASSERT_TRUE(message.build("/abc", "i"));
+    // NUL終端のために4バイト追加される
+    const uint8_t expected[] = {'/', 'a', 'b', 'c', 0, 0, 0, 0, ',', 'i', 0, 0, 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT32(sizeof(expected), message.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, message.data(), sizeof(expected));
+}
+
+void test_set_writes_big_endian_payload() {
+    OSCMessageTemplate message;
+    TEST_ASSERT_TRUE(message.build("/a", "fi"));
+    message.setFloat(0, 1.5f);
+    message.setInt(1, -2);
+
+    uint8_t expected[16] = {'/', 'a', 0, 0, ',', 'f', 'i', 0};
+    appendFloat(&expected[8], 1.5f);
+    expected[12] = 0xFF;
+    expected[13] = 0xFF;
+    expected[14] = 0xFF;
+    expected[15] = 0xFE;
+    TEST_ASSERT_EQUAL_UINT32(sizeof(expected), message.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, message.data(), sizeof(expected));
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, message.getFloat(0));
+    TEST_ASSERT_EQUAL_INT32(-2, message.getInt(1));
+}
+
+void test_bool_is_encoded_in_type_tag() {
+    OSCMessageTemplate message;
+    TEST_ASSERT_TRUE(message.build("/b", "iT"));
+    const size_t size = message.size();
+    TEST_ASSERT_EQUAL_UINT32(12, size);  // bool はペイロードを持たない
+
+    message.setBool(1, false);
+    TEST_ASSERT_EQUAL_UINT8('F', message.data()[6]);
+    message.setBool(1, true);
+    TEST_ASSERT_EQUAL_UINT8('T', message.data()[6]);
+    TEST_ASSERT_EQUAL_UINT32(size, message.size());
+}
+
+void test_timetag_round_trip() {
+    OSCMessageTemplate message;
+    TEST_ASSERT_TRUE(message.build("/t", "t"));
+    const uint64_t timeUs = 3723000000ULL + 500000ULL;  // 3723.5 秒
+    message.setTimetag(0, timeUs);
+
+    const uint8_t *payload = message.data() + 8;
+    // 秒 3723 = 0x00000E8B，小数部 0.5 = 0x80000000
+    const uint8_t expected[] = {0x00, 0x00, 0x0E, 0x8B, 0x80, 0x00, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, payload, sizeof(expected));
+
+    for (uint64_t us = 0; us < 2000000ULL; us += 12347) {
+        message.setTimetag(0, us);
+        TEST_ASSERT_EQUAL_UINT64(us, message.getTimetag(0));
+    }
+}
+
+void test_build_rejects_unknown_tag_and_overflow() {
+    OSCMessageTemplate message;
+    TEST_ASSERT_FALSE(message.build("/a", "s"));
+
+    char address[OSCMessageTemplate::maxSize];
+    memset(address, 'x', sizeof(address) - 1);
+    address[0] = '/';
+    address[sizeof(address) - 1] = '\0';
+    TEST_ASSERT_FALSE(message.build(address, "f"));
+    TEST_ASSERT_FALSE(message.build("/a", "fffffffffffffffff"));  // maxArgs を超える
+}
+
+void test_set_out_of_range_is_ignored() {
+    OSCMessageTemplate message;
+    TEST_ASSERT_TRUE(message.build("/a", "f"));
+    uint8_t before[OSCMessageTemplate::maxSize];
+    memcpy(before, message.data(), message.size());
+    message.setFloat(1, 1.0f);
+    message.setInt(5, 1);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(before, message.data(), message.size());
+}
+
+void test_parse_matches_address_and_type_tags() {
+    OSCMessageTemplate sender;
+    OSCMessageTemplate receiver;
+    TEST_ASSERT_TRUE(sender.build("/ccbt1/config/rate", "if"));
+    TEST_ASSERT_TRUE(receiver.build("/ccbt1/config/rate", "if"));
+    sender.setInt(0, 3);
+    sender.setFloat(1, 60.0f);
+
+    TEST_ASSERT_TRUE(receiver.parse(sender.data(), sender.size()));
+    TEST_ASSERT_EQUAL_INT32(3, receiver.getInt(0));
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, receiver.getFloat(1));
+
+    OSCMessageTemplate other;
+    TEST_ASSERT_TRUE(other.build("/ccbt2/config/rate", "if"));
+    TEST_ASSERT_FALSE(receiver.parse(other.data(), other.size()));
+    TEST_ASSERT_FALSE(receiver.parse(sender.data(), sender.size() - 4));
+    // 一致しなかった場合は内容が変わらない
+    TEST_ASSERT_EQUAL_INT32(3, receiver.getInt(0));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_build_pads_address_and_type_tags);
+    RUN_TEST(test_address_of_multiple_of_four_gets_full_padding);
+    RUN_TEST(test_set_writes_big_endian_payload);
+    RUN_TEST(test_bool_is_encoded_in_type_tag);
+    RUN_TEST(test_timetag_round_trip);
+    RUN_TEST(test_build_rejects_unknown_tag_and_overflow);
+    RUN_TEST(test_set_out_of_range_is_ignored);
+    RUN_TEST(test_parse_matches_address_and_type_tags);
+    return UNITY_END();
+}
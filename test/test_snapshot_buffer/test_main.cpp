@@ -0,0 +1,86 @@
+/// \file test_main.cpp
+/// \brief SnapshotBuffer が最新の値を返し，書き込み中の値を読ませないことを確かめる
+
+#include <unity.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "SnapshotBuffer.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    /// 書き込み途中で読まれると a と b が食い違う
+    struct Pair {
+        uint32_t a;
+        uint32_t b;
+        uint32_t padding[14];
+    };
+}
+
+void test_read_before_publish_returns_default() {
+    SnapshotBuffer<Pair> buffer;
+    const Pair value = buffer.read();
+    TEST_ASSERT_EQUAL_UINT32(0, value.a);
+    TEST_ASSERT_EQUAL_UINT32(0, value.b);
+}
+
+void test_read_returns_latest() {
+    SnapshotBuffer<Pair> buffer;
+    for (uint32_t i = 1; i <= 5; i++) {
+        Pair value{};
+        value.a = i;
+        value.b = ~i;
+        buffer.publish(value);
+        const Pair read = buffer.read();
+        TEST_ASSERT_EQUAL_UINT32(i, read.a);
+        TEST_ASSERT_EQUAL_UINT32(~i, read.b);
+    }
+}
+
+void test_concurrent_reads_are_consistent() {
+    SnapshotBuffer<Pair> buffer;
+    const uint32_t count = 200000;
+    std::atomic<bool> done(false);
+
+    std::thread writer([&]() {
+        for (uint32_t i = 1; i <= count; i++) {
+            Pair value{};
+            value.a = i;
+            value.b = ~i;
+            for (auto &p : value.padding) {
+                p = i;
+            }
+            buffer.publish(value);
+        }
+        done = true;
+    });
+
+    uint32_t torn = 0;
+    uint32_t last = 0;
+    uint64_t reads = 0;
+    while (!done || last < count) {
+        const Pair value = buffer.read();
+        reads++;
+        // 最初の publish() の前は初期値 (すべて 0)
+        if (value.a != 0 && (value.b != ~value.a || value.padding[13] != value.a)) {
+            torn++;
+        }
+        last = value.a;
+    }
+    writer.join();
+
+    TEST_ASSERT_GREATER_THAN(0, reads);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(count, buffer.read().a);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_read_before_publish_returns_default);
+    RUN_TEST(test_read_returns_latest);
+    RUN_TEST(test_concurrent_reads_are_consistent);
+    return UNITY_END();
+}
@@ -0,0 +1,103 @@
+/// \file test_main.cpp
+/// \brief SpectrumAnalyzer の無音・正規化・帯域の振り分け・重心・フラックスを確かめる
+
+#include <unity.h>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "SpectrumAnalyzer.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    const float sampleRate = 16000.0f;
+    const float minFrequency = 125.0f;
+
+    void pushTone(SpectrumAnalyzer &analyzer, float frequency, float amplitude) {
+        std::array<int16_t, SpectrumAnalyzer::fftSize> samples{};
+        for (size_t n = 0; n < samples.size(); n++) {
+            samples[n] = static_cast<int16_t>(lroundf(amplitude * sinf(6.28318530718f * frequency * n / sampleRate)));
+        }
+        analyzer.push(samples.data(), samples.size());
+    }
+}
+
+void test_silence_is_far_below_full_scale() {
+    SpectrumAnalyzer analyzer;
+    analyzer.setup(sampleRate, minFrequency);
+    const auto &result = analyzer.analyze();
+    for (float band : result.bands) {
+        TEST_ASSERT_LESS_THAN(-100.0f, band);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, result.centroid);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, result.flux);
+}
+
+void test_full_scale_tone_peaks_near_zero_dbfs() {
+    SpectrumAnalyzer analyzer;
+    analyzer.setup(sampleRate, minFrequency);
+    // ビンの中心 (32 * 16000 / 512 = 1000 Hz) の正弦波
+    pushTone(analyzer, 1000.0f, 32767.0f);
+    analyzer.analyze();
+
+    // 帯域内の平均なので 0 dBFS より下がるが，最大の帯域は -15 dBFS 以内に入る
+    float maxBand = -1000.0f;
+    for (float band : analyzer.getResult().bands) {
+        maxBand = band > maxBand ? band : maxBand;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(0.5f, maxBand);
+    TEST_ASSERT_GREATER_THAN(-15.0f, maxBand);
+}
+
+void test_flux_is_positive_only_at_onset() {
+    SpectrumAnalyzer analyzer;
+    analyzer.setup(sampleRate, minFrequency);
+    analyzer.analyze();
+
+    pushTone(analyzer, 1000.0f, 8000.0f);
+    TEST_ASSERT_GREATER_THAN(0.0f, analyzer.analyze().flux);
+    // 同じ音が続けばスペクトルは増えない
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, analyzer.analyze().flux);
+}
+
+void test_pure_tone_lands_in_expected_band_and_centroid() {
+    // 帯域の境界 (ビン): 4, 7, 11, 19, 32, 54, 91, 152, 256．境界から離れたビンの中心の周波数を使う
+    struct Case {
+        float frequency;
+        size_t band;
+    };
+    const Case cases[] = {{281.25f, 1}, {750.0f, 3}, {2000.0f, 5}, {4000.0f, 6}, {6000.0f, 7}};
+    const float binHz = sampleRate / SpectrumAnalyzer::fftSize;
+
+    for (const auto &c : cases) {
+        SpectrumAnalyzer analyzer;
+        analyzer.setup(sampleRate, minFrequency);
+        pushTone(analyzer, c.frequency, 16000.0f);
+        const auto &result = analyzer.analyze();
+
+        size_t loudest = 0;
+        for (size_t b = 1; b < SpectrumAnalyzer::numBands; b++) {
+            loudest = result.bands[b] > result.bands[loudest] ? b : loudest;
+        }
+        TEST_ASSERT_EQUAL_UINT32(c.band, loudest);
+        // Hann窓の漏れは隣の帯域まで届かない
+        for (size_t b = 0; b < SpectrumAnalyzer::numBands; b++) {
+            if (b != c.band) {
+                TEST_ASSERT_LESS_THAN(result.bands[c.band] - 30.0f, result.bands[b]);
+            }
+        }
+        // 窓の漏れは左右対称なので重心はほぼ正弦波の周波数になる
+        TEST_ASSERT_FLOAT_WITHIN(0.5f * binHz, c.frequency, result.centroid);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_silence_is_far_below_full_scale);
+    RUN_TEST(test_full_scale_tone_peaks_near_zero_dbfs);
+    RUN_TEST(test_pure_tone_lands_in_expected_band_and_centroid);
+    RUN_TEST(test_flux_is_positive_only_at_onset);
+    return UNITY_END();
+}
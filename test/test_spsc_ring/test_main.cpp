@@ -0,0 +1,190 @@
+/// \file test_main.cpp
+/// \brief SpscRing の順序・満杯時の破棄・添字の折り返し・2スレッドでの受け渡しを確かめる
+
+#include <unity.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "SpscRing.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    /// 途中までしか書かれていない要素を読むと seq と check が食い違う
+    struct Item {
+        uint32_t seq;
+        uint32_t check;
+        uint32_t padding[6];
+    };
+
+    Item makeItem(uint32_t seq) {
+        Item item{};
+        item.seq = seq;
+        item.check = ~seq;
+        for (auto &p : item.padding) {
+            p = seq;
+        }
+        return item;
+    }
+
+    bool isIntact(const Item &item) {
+        return item.check == ~item.seq && item.padding[5] == item.seq;
+    }
+}
+
+void test_pop_from_empty_fails() {
+    SpscRing<uint32_t, 4> ring;
+    uint32_t value = 0;
+    TEST_ASSERT_FALSE(ring.pop(value));
+    TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+}
+
+void test_fifo_order() {
+    SpscRing<uint32_t, 8> ring;
+    for (uint32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, ring.size());
+    for (uint32_t i = 0; i < 5; i++) {
+        uint32_t value = 0;
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL_UINT32(i, value);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ring.size());
+}
+
+void test_full_ring_drops_newest() {
+    SpscRing<uint32_t, 4> ring;
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(ring.push(i));
+    }
+    TEST_ASSERT_FALSE(ring.push(100));
+    TEST_ASSERT_FALSE(ring.push(101));
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getDropped());
+    TEST_ASSERT_EQUAL_UINT32(4, ring.size());
+
+    // 残っているのは古い方
+    for (uint32_t i = 0; i < 4; i++) {
+        uint32_t value = 0;
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL_UINT32(i, value);
+    }
+}
+
+void test_wraps_many_times() {
+    SpscRing<uint32_t, 4> ring;
+    uint32_t next = 0;
+    uint32_t expected = 0;
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < 3; i++) {
+            TEST_ASSERT_TRUE(ring.push(next++));
+        }
+        for (int i = 0; i < 3; i++) {
+            uint32_t value = 0;
+            TEST_ASSERT_TRUE(ring.pop(value));
+            TEST_ASSERT_EQUAL_UINT32(expected++, value);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getDropped());
+}
+
+void test_two_threads_without_loss_or_duplication() {
+    SpscRing<Item, 8> ring;
+    const uint32_t count = 1000000;    // 添字は 12 万回以上折り返す
+
+    // 満杯なら空くまで待つ (待った回数は dropped に数えられる)
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            const Item item = makeItem(i);
+            while (!ring.push(item)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t torn = 0;
+    while (expected < count) {
+        Item item{};
+        if (!ring.pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (item.seq != expected) {
+            outOfOrder++;
+        }
+        if (!isIntact(item)) {
+            torn++;
+        }
+        expected = item.seq + 1;
+    }
+    producer.join();
+
+    Item rest{};
+    TEST_ASSERT_FALSE(ring.pop(rest));
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(count, expected);
+}
+
+void test_two_threads_drop_only_what_push_rejects() {
+    SpscRing<Item, 4> ring;
+    const uint32_t count = 1000000;
+    std::atomic<bool> done(false);
+    uint32_t rejected = 0;
+
+    // micTask と同じく満杯なら待たずに捨てる
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            if (!ring.push(makeItem(i))) {
+                rejected++;
+            }
+        }
+        done = true;
+    });
+
+    uint32_t received = 0;
+    uint32_t duplicated = 0;
+    uint32_t torn = 0;
+    int64_t last = -1;
+    for (;;) {
+        Item item{};
+        if (!ring.pop(item)) {
+            if (done) {
+                if (!ring.pop(item)) {
+                    break;
+                }
+            } else {
+                continue;
+            }
+        }
+        received++;
+        if (static_cast<int64_t>(item.seq) <= last) {
+            duplicated++;
+        }
+        if (!isIntact(item)) {
+            torn++;
+        }
+        last = item.seq;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, duplicated);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(rejected, ring.getDropped());
+    TEST_ASSERT_EQUAL_UINT32(count, received + rejected);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_pop_from_empty_fails);
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_full_ring_drops_newest);
+    RUN_TEST(test_wraps_many_times);
+    RUN_TEST(test_two_threads_without_loss_or_duplication);
+    RUN_TEST(test_two_threads_drop_only_what_push_rejects);
+    return UNITY_END();
+}
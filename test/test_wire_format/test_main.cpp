@@ -0,0 +1,99 @@
+/// \file test_main.cpp
+/// \brief WireFormat の配置・量子化・飽和・往復を確かめる
+
+#include <unity.h>
+#include <cmath>
+#include <cstdint>
+#include "WireFormat.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+namespace {
+    WireFormat::Frame makeFrame() {
+        WireFormat::Frame frame{};
+        frame.nodeId = 7;
+        frame.flags = WireFormat::flagMic;
+        frame.sequence = 0x01020304;
+        frame.timestampUs = 0xA0B0C0D0;
+        frame.acc = {{0.5f, -1.0f, 1.0f}};
+        frame.gyro = {{10.0f, -250.5f, 0.0f}};
+        frame.rotation = {{45.25f, -90.0f}};
+        frame.micPower = 812.4f;
+        frame.micDb = 58.37f;
+        return frame;
+    }
+}
+
+void test_header_layout_is_little_endian() {
+    uint8_t packet[WireFormat::packetSize];
+    TEST_ASSERT_EQUAL_UINT32(WireFormat::packetSize, WireFormat::encode(makeFrame(), packet));
+    const uint8_t header[] = {WireFormat::magic, WireFormat::version, 7, WireFormat::flagMic,
+                              0x04, 0x03, 0x02, 0x01, 0xD0, 0xC0, 0xB0, 0xA0};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(header, packet, sizeof(header));
+    // acc[0] = 0.5 G -> 2048
+    TEST_ASSERT_EQUAL_UINT8(0x00, packet[12]);
+    TEST_ASSERT_EQUAL_UINT8(0x08, packet[13]);
+    TEST_ASSERT_TRUE(WireFormat::isWireFormat(packet, sizeof(packet)));
+}
+
+void test_round_trip_within_quantization() {
+    uint8_t packet[WireFormat::packetSize];
+    const auto frame = makeFrame();
+    WireFormat::encode(frame, packet);
+
+    WireFormat::Frame decoded{};
+    TEST_ASSERT_TRUE(WireFormat::decode(packet, sizeof(packet), decoded));
+    TEST_ASSERT_EQUAL_UINT8(frame.nodeId, decoded.nodeId);
+    TEST_ASSERT_EQUAL_UINT32(frame.sequence, decoded.sequence);
+    TEST_ASSERT_EQUAL_UINT32(frame.timestampUs, decoded.timestampUs);
+    for (size_t i = 0; i < 3; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.5f / WireFormat::accScale, frame.acc[i], decoded.acc[i]);
+        TEST_ASSERT_FLOAT_WITHIN(0.5f / WireFormat::gyroScale, frame.gyro[i], decoded.gyro[i]);
+    }
+    for (size_t i = 0; i < 2; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.5f / WireFormat::rotationScale, frame.rotation[i], decoded.rotation[i]);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, frame.micPower, decoded.micPower);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f / WireFormat::dbScale, frame.micDb, decoded.micDb);
+}
+
+void test_out_of_range_values_saturate() {
+    auto frame = makeFrame();
+    frame.acc = {{100.0f, -100.0f, NAN}};
+    frame.micPower = 1e9f;
+    frame.micDb = -INFINITY;
+
+    uint8_t packet[WireFormat::packetSize];
+    WireFormat::encode(frame, packet);
+    WireFormat::Frame decoded{};
+    TEST_ASSERT_TRUE(WireFormat::decode(packet, sizeof(packet), decoded));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, INT16_MAX / WireFormat::accScale, decoded.acc[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, INT16_MIN / WireFormat::accScale, decoded.acc[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, INT16_MIN / WireFormat::accScale, decoded.acc[2]);
+    TEST_ASSERT_EQUAL_FLOAT(65535.0f, decoded.micPower);
+    TEST_ASSERT_FLOAT_IS_NEG_INF(decoded.micDb);
+}
+
+void test_decode_rejects_other_packets() {
+    uint8_t packet[WireFormat::packetSize];
+    WireFormat::encode(makeFrame(), packet);
+    WireFormat::Frame decoded{};
+    TEST_ASSERT_FALSE(WireFormat::decode(packet, sizeof(packet) - 1, decoded));
+
+    packet[1] = WireFormat::version + 1;
+    TEST_ASSERT_FALSE(WireFormat::decode(packet, sizeof(packet), decoded));
+
+    const uint8_t osc[] = {'/', 'a', 0, 0};
+    TEST_ASSERT_FALSE(WireFormat::isWireFormat(osc, sizeof(osc)));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_layout_is_little_endian);
+    RUN_TEST(test_round_trip_within_quantization);
+    RUN_TEST(test_out_of_range_values_saturate);
+    RUN_TEST(test_decode_rejects_other_packets);
+    return UNITY_END();
+}
@@ -0,0 +1,148 @@
+/// \file main.cpp
+/// \brief ノードからのバイナリ形式 (WireFormat) を受信し，従来のOSCアドレスに戻して送り直すブリッジ
+///
+/// $ binary_bridge [--listen 9100] [--out 127.0.0.1:9000] [--prefix ccbt]
+///
+/// - ノードは oscServerPort を --listen のポートに設定し，-D WIRE_BINARY でビルドする
+/// - /{prefix}{nodeId}/imu/acc などを --out に送るので，Max のパッチ (examples/sample.maxpat) はそのまま使える
+/// - バイナリ形式でないパケット (/status/* などのOSC) はそのまま --out に転送する
+/// - シーケンス番号から欠落・順序の入れ替わり・重複を数え，5秒ごとに標準エラー出力に表示する
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include "Endpoint.h"
+#include "FrameTranslator.h"
+#include "SequenceTracker.h"
+#include "WireFormat.h"
+
+namespace {
+    struct Options {
+        uint16_t listenPort = 9100;
+        sockaddr_in out{};
+        std::string prefix = "ccbt";
+    };
+
+    /// ノードごとの受信状態と送り直すメッセージの雛形
+    struct NodeState {
+        SequenceTracker sequence;
+        std::unique_ptr<FrameTranslator> translator;
+    };
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [--listen port] [--out host:port] [--prefix name]\n", name);
+        exit(2);
+    }
+
+    Options parseOptions(int argc, char **argv) {
+        Options options;
+        parseEndpoint("127.0.0.1:9000", options.out);
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+            }
+            const std::string value = argv[++i];
+            if (arg == "--listen") {
+                options.listenPort = static_cast<uint16_t>(strtoul(value.c_str(), nullptr, 10));
+            } else if (arg == "--out") {
+                if (!parseEndpoint(value, options.out)) {
+                    usage(argv[0]);
+                }
+            } else if (arg == "--prefix") {
+                options.prefix = value;
+            } else {
+                usage(argv[0]);
+            }
+        }
+        return options;
+    }
+
+    void printStats(const std::map<uint8_t, NodeState> &nodes, const std::string &prefix) {
+        for (const auto &entry: nodes) {
+            const auto &sequence = entry.second.sequence;
+            const auto &counters = sequence.getCounters();
+            fprintf(stderr, "%s%u received=%llu lost=%llu (%.2f%%) reordered=%llu duplicated=%llu restarted=%llu\n",
+                    prefix.c_str(), entry.first,
+                    static_cast<unsigned long long>(counters.received),
+                    static_cast<unsigned long long>(counters.lost),
+                    sequence.getLossPercent(),
+                    static_cast<unsigned long long>(counters.reordered),
+                    static_cast<unsigned long long>(counters.duplicated),
+                    static_cast<unsigned long long>(counters.restarted));
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    const Options options = parseOptions(argc, argv);
+
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in listenAddress{};
+    listenAddress.sin_family = AF_INET;
+    listenAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    listenAddress.sin_port = htons(options.listenPort);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&listenAddress), sizeof(listenAddress)) != 0) {
+        perror("bind");
+        return 1;
+    }
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    auto sendOut = [&](const uint8_t *data, size_t size) {
+        sendto(fd, data, size, 0, reinterpret_cast<const sockaddr *>(&options.out), sizeof(options.out));
+    };
+    const FrameTranslator::Emit emit = [&](const OSCMessageTemplate &message) {
+        sendOut(message.data(), message.size());
+    };
+
+    fprintf(stderr, "listening on :%u, forwarding to %s\n",
+            options.listenPort, formatEndpoint(options.out).c_str());
+
+    std::map<uint8_t, NodeState> nodes;
+    auto lastReport = std::chrono::steady_clock::now();
+    uint8_t buffer[1500];
+    while (true) {
+        const auto received = recv(fd, buffer, sizeof(buffer), 0);
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(5)) {
+            lastReport = now;
+            printStats(nodes, options.prefix);
+        }
+
+        if (received <= 0) {
+            continue;
+        }
+        const auto size = static_cast<size_t>(received);
+
+        // OSCのままのパケットはそのまま転送する
+        if (!WireFormat::isWireFormat(buffer, size)) {
+            sendOut(buffer, size);
+            continue;
+        }
+
+        WireFormat::Frame frame{};
+        if (!WireFormat::decode(buffer, size, frame)) {
+            continue;
+        }
+
+        NodeState &node = nodes[frame.nodeId];
+        if (!node.translator) {
+            node.translator.reset(new FrameTranslator(options.prefix + std::to_string(frame.nodeId)));
+        }
+
+        // 遅れて届いたフレームと重複は古い値なので送り直さない
+        const auto result = node.sequence.track(frame.sequence);
+        if (result != SequenceTracker::Result::Latest && result != SequenceTracker::Result::Restart) {
+            continue;
+        }
+        node.translator->translate(frame, emit);
+    }
+}
@@ -0,0 +1,342 @@
+/// \file main.cpp
+/// \brief CAPTURE で記録したファイル (.kcap) を CSV に書き出す・OSCとして送り直すツール
+///
+/// $ capture_tool dump [--mic] file.kcap...
+/// $ capture_tool replay [--target 127.0.0.1:9000] [--name ccbt1] [--speed 1] file.kcap...
+///
+/// - dump: IMUは1行1サンプルの "timestamp_us,ax,ay,az,gx,gy,gz" (motion_replay の入力と同じ)，
+///   --mic を付けるとマイクの "timestamp_us,rms,peak" を標準出力に書く
+/// - replay: 記録した間隔のまま (--speed 倍で) /{name}/imu/acc, /{name}/imu/gyro, /{name}/mic/volume を送る．
+///   --name を指定しなければファイルに記録されたクライアント名を使う
+/// - ファイルは指定した順に続けて読む (ファイルの切り替わりで間は空けない)
+/// - 末尾が欠けたブロックや CRC が合わないブロックは読み飛ばし，次の正しいブロックから読み直す．
+///   読み飛ばしたバイト数・欠けたブロック・記録時に捨てたレコードの数を標準エラーに表示する
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CaptureFormat.h"
+#include "Endpoint.h"
+#include "OSCMessageTemplate.h"
+
+namespace {
+    enum class Command {
+        Dump,
+        Replay
+    };
+
+    struct Options {
+        Command command = Command::Dump;
+        bool mic = false;
+        sockaddr_in target{};
+        std::string name;
+        double speed = 1.0;
+        std::vector<std::string> paths;
+    };
+
+    /// 1ファイル分の読み込み結果
+    struct Capture {
+        CaptureFormat::FileHeader header{};
+        std::vector<CaptureFormat::Record> records;
+    };
+
+    struct ReadStats {
+        uint64_t blocks = 0;
+        uint64_t records = 0;
+        uint64_t skippedBytes = 0;     // 壊れていて読み飛ばした
+        uint64_t missingBlocks = 0;    // sequence が飛んでいた
+        uint64_t droppedRecords = 0;   // 記録時に捨てた (ブロックヘッダの dropped)
+    };
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s dump [--mic] file.kcap...\n"
+                        "       %s replay [--target host:port] [--name client] [--speed x] file.kcap...\n",
+                name, name);
+        exit(2);
+    }
+
+    Options parseOptions(int argc, char **argv) {
+        Options options;
+        parseEndpoint("127.0.0.1:9000", options.target);
+        if (argc < 2) {
+            usage(argv[0]);
+        }
+        const std::string command = argv[1];
+        if (command == "dump") {
+            options.command = Command::Dump;
+        } else if (command == "replay") {
+            options.command = Command::Replay;
+        } else {
+            usage(argv[0]);
+        }
+
+        int i = 2;
+        while (i < argc && strncmp(argv[i], "--", 2) == 0) {
+            const std::string arg = argv[i];
+            if (arg == "--mic" && options.command == Command::Dump) {
+                options.mic = true;
+                i++;
+                continue;
+            }
+            if (i + 1 >= argc || options.command != Command::Replay) {
+                usage(argv[0]);
+            }
+            const std::string value = argv[i + 1];
+            if (arg == "--target") {
+                if (!parseEndpoint(value, options.target)) {
+                    usage(argv[0]);
+                }
+            } else if (arg == "--name") {
+                options.name = value;
+            } else if (arg == "--speed") {
+                options.speed = strtod(value.c_str(), nullptr);
+                if (!(options.speed > 0.0)) {
+                    usage(argv[0]);
+                }
+            } else {
+                usage(argv[0]);
+            }
+            i += 2;
+        }
+        for (; i < argc; i++) {
+            options.paths.emplace_back(argv[i]);
+        }
+        if (options.paths.empty()) {
+            usage(argv[0]);
+        }
+        return options;
+    }
+
+    bool readFile(const std::string &path, std::vector<uint8_t> &data) {
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            perror(path.c_str());
+            return false;
+        }
+        uint8_t buffer[4096];
+        size_t size = 0;
+        while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            data.insert(data.end(), buffer, buffer + size);
+        }
+        fclose(file);
+        return true;
+    }
+
+    /// offset から正しいブロックが始まっていれば復元して true
+    bool readBlock(const std::vector<uint8_t> &data, size_t offset, CaptureFormat::BlockHeader &header,
+                   std::vector<CaptureFormat::Record> &records) {
+        if (!CaptureFormat::decodeBlockHeader(&data[offset], data.size() - offset, header)) {
+            return false;
+        }
+        const size_t payloadOffset = offset + CaptureFormat::blockHeaderSize;
+        if (data.size() - payloadOffset < header.payloadSize ||
+            CaptureFormat::crc32(&data[payloadOffset], header.payloadSize) != header.crc) {
+            return false;
+        }
+
+        CaptureFormat::BlockDecoder decoder(header, &data[payloadOffset]);
+        CaptureFormat::Record record{};
+        uint16_t count = 0;
+        while (decoder.next(record)) {
+            records.push_back(record);
+            count++;
+        }
+        return count == header.records;
+    }
+
+    /// ファイル全体を読み，ストリームごとの記録を時刻順に並べる
+    bool readCapture(const std::string &path, Capture &capture, ReadStats &stats) {
+        std::vector<uint8_t> data;
+        if (!readFile(path, data)) {
+            return false;
+        }
+        if (data.size() < CaptureFormat::fileHeaderSize) {
+            // ファイルを開いた直後に電源が切れた
+            fprintf(stderr, "%s: truncated header\n", path.c_str());
+            return false;
+        }
+        if (!CaptureFormat::decodeFileHeader(data.data(), data.size(), capture.header)) {
+            fprintf(stderr, "%s: not a capture file\n", path.c_str());
+            return false;
+        }
+
+        // sequence はファイルを切り替えても続くので，ファイル内の最初のブロックからの欠けだけを数える
+        std::array<uint32_t, static_cast<size_t>(CaptureFormat::Stream::Count)> nextSequence{};
+        std::array<bool, static_cast<size_t>(CaptureFormat::Stream::Count)> seen{};
+        size_t offset = CaptureFormat::fileHeaderSize;
+        while (offset < data.size()) {
+            CaptureFormat::BlockHeader header{};
+            std::vector<CaptureFormat::Record> records;
+            if (!readBlock(data, offset, header, records)) {
+                // 次の magic ("KB") から読み直す
+                offset++;
+                stats.skippedBytes++;
+                continue;
+            }
+            const auto stream = static_cast<size_t>(header.stream);
+            auto &expected = nextSequence[stream];
+            if (seen[stream] && header.sequence > expected) {
+                stats.missingBlocks += header.sequence - expected;
+            }
+            expected = header.sequence + 1;
+            seen[stream] = true;
+            stats.blocks++;
+            stats.records += records.size();
+            stats.droppedRecords += header.dropped;
+            capture.records.insert(capture.records.end(), records.begin(), records.end());
+            offset += CaptureFormat::blockHeaderSize + header.payloadSize;
+        }
+
+        // ブロックはストリームごとに書き出すので，ファイル内では時刻が前後する．
+        // 切り替えの前に詰めたブロックはファイルの開始より前の時刻を含むので，
+        // micros() の一周 (約71分) の1/4だけ前を基準にした差で並べる
+        const uint32_t originUs = capture.header.startUs - 0x40000000;
+        std::stable_sort(capture.records.begin(), capture.records.end(),
+                         [originUs](const CaptureFormat::Record &a, const CaptureFormat::Record &b) {
+                             return a.timestampUs - originUs < b.timestampUs - originUs;
+                         });
+        return true;
+    }
+
+    void dump(const Capture &capture, bool mic) {
+        for (const auto &record : capture.records) {
+            if (mic && record.stream == CaptureFormat::Stream::Audio) {
+                printf("%u,%.4f,%.4f\n", record.timestampUs, record.rms, record.peak);
+            } else if (!mic && record.stream == CaptureFormat::Stream::Imu) {
+                printf("%u,%.4f,%.4f,%.4f,%.3f,%.3f,%.3f\n", record.timestampUs,
+                       record.acc[0], record.acc[1], record.acc[2],
+                       record.gyro[0], record.gyro[1], record.gyro[2]);
+            }
+        }
+    }
+
+    /// ファームウェアの MicManager::calcDecibel と同じ変換
+    float calcDecibel(float value) {
+        if (value <= 0.0f) {
+            return -INFINITY;
+        }
+        return 20.0f * log10f(value) + 25.6699f;
+    }
+
+    class Replayer {
+    public:
+        Replayer(int fd, const sockaddr_in &target, double speed) : fd(fd), target(target), speed(speed) {}
+
+        void replay(const Capture &capture, const std::string &name) {
+            auto build = [&name](OSCMessageTemplate &message, const char *path, const char *typeTags) {
+                char address[64];
+                snprintf(address, sizeof(address), "/%s%s", name.c_str(), path);
+                message.build(address, typeTags);
+            };
+            build(accMessage, "/imu/acc", "fff");
+            build(gyroMessage, "/imu/gyro", "fff");
+            build(micMessage, "/mic/volume", "ff");
+
+            if (capture.records.empty()) {
+                return;
+            }
+            // 時刻順に並んでいるので，先頭のレコードからの差 (micros() の一周をまたいでもよい) で送る
+            const auto start = std::chrono::steady_clock::now();
+            const uint32_t firstUs = capture.records.front().timestampUs;
+            for (const auto &record : capture.records) {
+                const double offsetUs = static_cast<uint32_t>(record.timestampUs - firstUs) / speed;
+                std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<int64_t>(offsetUs)));
+
+                if (record.stream == CaptureFormat::Stream::Imu) {
+                    for (size_t i = 0; i < 3; i++) {
+                        accMessage.setFloat(i, record.acc[i]);
+                        gyroMessage.setFloat(i, record.gyro[i]);
+                    }
+                    send(accMessage);
+                    send(gyroMessage);
+                } else {
+                    micMessage.setFloat(0, record.rms);
+                    micMessage.setFloat(1, calcDecibel(record.rms));
+                    send(micMessage);
+                }
+            }
+        }
+
+        uint64_t getSent() const {
+            return sent;
+        }
+
+        uint64_t getErrors() const {
+            return errors;
+        }
+
+    private:
+        int fd;
+        sockaddr_in target;
+        double speed;
+        OSCMessageTemplate accMessage;
+        OSCMessageTemplate gyroMessage;
+        OSCMessageTemplate micMessage;
+        uint64_t sent = 0;
+        uint64_t errors = 0;
+
+        void send(const OSCMessageTemplate &message) {
+            if (sendto(fd, message.data(), message.size(), 0,
+                       reinterpret_cast<const sockaddr *>(&target), sizeof(target)) < 0) {
+                errors++;
+            } else {
+                sent++;
+            }
+        }
+    };
+}
+
+int main(int argc, char **argv) {
+    const Options options = parseOptions(argc, argv);
+
+    int fd = -1;
+    if (options.command == Command::Replay) {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            perror("socket");
+            return 1;
+        }
+    }
+    Replayer replayer(fd, options.target, options.speed);
+
+    ReadStats stats;
+    int result = 0;
+    for (const auto &path : options.paths) {
+        Capture capture;
+        if (!readCapture(path, capture, stats)) {
+            result = 1;
+            continue;
+        }
+        if (options.command == Command::Dump) {
+            dump(capture, options.mic);
+            continue;
+        }
+        const std::string name = !options.name.empty() ? options.name : capture.header.clientName.data();
+        fprintf(stderr, "%s: %zu records -> /%s at %s\n", path.c_str(), capture.records.size(),
+                name.c_str(), formatEndpoint(options.target).c_str());
+        replayer.replay(capture, name);
+    }
+
+    fprintf(stderr, "blocks=%llu records=%llu skipped_bytes=%llu missing_blocks=%llu dropped_records=%llu\n",
+            static_cast<unsigned long long>(stats.blocks),
+            static_cast<unsigned long long>(stats.records),
+            static_cast<unsigned long long>(stats.skippedBytes),
+            static_cast<unsigned long long>(stats.missingBlocks),
+            static_cast<unsigned long long>(stats.droppedRecords));
+    if (options.command == Command::Replay) {
+        fprintf(stderr, "sent=%llu errors=%llu\n", static_cast<unsigned long long>(replayer.getSent()),
+                static_cast<unsigned long long>(replayer.getErrors()));
+        close(fd);
+    }
+    return result;
+}
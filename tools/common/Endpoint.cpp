@@ -0,0 +1,45 @@
+/// \file Endpoint.cpp
+/// \brief "host:port" 形式の送信先を扱う
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <cstdlib>
+#include <cstring>
+#include "Endpoint.h"
+
+bool parseEndpoint(const std::string &text, sockaddr_in &endpoint) {
+    const auto colon = text.rfind(':');
+    if (colon == std::string::npos || colon + 1 >= text.size()) {
+        return false;
+    }
+    const std::string host = text.substr(0, colon);
+    char *end = nullptr;
+    const unsigned long port = strtoul(text.c_str() + colon + 1, &end, 10);
+    if (*end != '\0' || port == 0 || port > 65535) {
+        return false;
+    }
+
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.sin_family = AF_INET;
+    endpoint.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &endpoint.sin_addr) == 1) {
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr) {
+        return false;
+    }
+    endpoint.sin_addr = reinterpret_cast<sockaddr_in *>(result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+    return true;
+}
+
+std::string formatEndpoint(const sockaddr_in &endpoint) {
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &endpoint.sin_addr, host, sizeof(host));
+    return std::string(host) + ":" + std::to_string(ntohs(endpoint.sin_port));
+}
@@ -0,0 +1,19 @@
+/// \file Endpoint.h
+/// \brief "host:port" 形式の送信先を扱う
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TOOLS_ENDPOINT_H
+#define CCBT_KOROGARU_KOEN_PARK_TOOLS_ENDPOINT_H
+
+#include <netinet/in.h>
+#include <string>
+
+
+/// "192.168.100.10:9000" を解釈する (ホスト名も可)
+/// \return 解釈できなかった場合 false
+bool parseEndpoint(const std::string &text, sockaddr_in &endpoint);
+
+/// "192.168.100.10:9000" の形式に戻す
+std::string formatEndpoint(const sockaddr_in &endpoint);
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TOOLS_ENDPOINT_H
@@ -0,0 +1,35 @@
+/// \file FrameTranslator.cpp
+/// \brief バイナリ形式 (WireFormat) の1フレームをノードのOSCメッセージに戻す
+
+#include <cstdio>
+#include "FrameTranslator.h"
+
+FrameTranslator::FrameTranslator(const std::string &clientName) {
+    auto build = [&clientName](OSCMessageTemplate &message, const char *path, const char *typeTags) {
+        char address[64];
+        snprintf(address, sizeof(address), "/%s%s", clientName.c_str(), path);
+        message.build(address, typeTags);
+    };
+    build(accMessage, "/imu/acc", "fff");
+    build(gyroMessage, "/imu/gyro", "fff");
+    build(rotationMessage, "/imu/rotation", "ff");
+    build(micMessage, "/mic/volume", "ff");
+}
+
+void FrameTranslator::translate(const WireFormat::Frame &frame, const Emit &emit) {
+    for (size_t i = 0; i < 3; i++) {
+        accMessage.setFloat(i, frame.acc[i]);
+        gyroMessage.setFloat(i, frame.gyro[i]);
+    }
+    rotationMessage.setFloat(0, frame.rotation[0]);
+    rotationMessage.setFloat(1, frame.rotation[1]);
+    emit(accMessage);
+    emit(gyroMessage);
+    emit(rotationMessage);
+
+    if (frame.flags & WireFormat::flagMic) {
+        micMessage.setFloat(0, frame.micPower);
+        micMessage.setFloat(1, frame.micDb);
+        emit(micMessage);
+    }
+}
@@ -0,0 +1,33 @@
+/// \file FrameTranslator.h
+/// \brief バイナリ形式 (WireFormat) の1フレームをノードのOSCメッセージに戻す
+///
+/// アドレスとタイプタグはノードごとに一度だけエンコードし，値だけを書き換える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TOOLS_FRAMETRANSLATOR_H
+#define CCBT_KOROGARU_KOEN_PARK_TOOLS_FRAMETRANSLATOR_H
+
+#include <functional>
+#include <string>
+#include "OSCMessageTemplate.h"
+#include "WireFormat.h"
+
+
+class FrameTranslator {
+public:
+    using Emit = std::function<void(const OSCMessageTemplate &message)>;
+
+    /// \param clientName アドレスの先頭 ("/ccbt1/imu/acc" の "ccbt1")
+    explicit FrameTranslator(const std::string &clientName);
+
+    /// /imu/acc, /imu/gyro, /imu/rotation と (含まれていれば) /mic/volume を emit に渡す
+    void translate(const WireFormat::Frame &frame, const Emit &emit);
+
+private:
+    OSCMessageTemplate accMessage;
+    OSCMessageTemplate gyroMessage;
+    OSCMessageTemplate rotationMessage;
+    OSCMessageTemplate micMessage;
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TOOLS_FRAMETRANSLATOR_H
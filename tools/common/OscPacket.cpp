@@ -0,0 +1,78 @@
+/// \file OscPacket.cpp
+/// \brief 受信したOSCパケットを最低限だけ解析する (アドレス・Bundleの展開・タイムタグ)
+
+#include <cstring>
+#include "OscPacket.h"
+
+namespace OscPacket {
+
+    namespace {
+        const char bundleTag[] = "#bundle";
+
+        uint32_t read32(const uint8_t *p) {
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+        }
+
+        bool parse(const uint8_t *data, size_t size, uint64_t timetag, const MessageHandler &handler, int depth) {
+            if (size < 4 || size % 4 != 0 || depth > 4) {
+                return false;
+            }
+            if (data[0] == '/') {
+                handler(data, size, timetag);
+                return true;
+            }
+            if (size < 16 || memcmp(data, bundleTag, sizeof(bundleTag)) != 0) {
+                return false;
+            }
+
+            const uint64_t bundleTimetag = (static_cast<uint64_t>(read32(&data[8])) << 32) | read32(&data[12]);
+            size_t offset = 16;
+            while (offset + 4 <= size) {
+                const uint32_t elementSize = read32(&data[offset]);
+                offset += 4;
+                if (elementSize > size - offset) {
+                    return false;
+                }
+                if (!parse(&data[offset], elementSize, bundleTimetag, handler, depth + 1)) {
+                    return false;
+                }
+                offset += elementSize;
+            }
+            return offset == size;
+        }
+    }
+
+    bool forEachMessage(const uint8_t *data, size_t size, const MessageHandler &handler) {
+        return parse(data, size, immediate, handler, 0);
+    }
+
+    std::string address(const uint8_t *message, size_t size) {
+        const void *end = memchr(message, '\0', size);
+        if (end == nullptr || message[0] != '/') {
+            return std::string();
+        }
+        return std::string(reinterpret_cast<const char *>(message),
+                           static_cast<const uint8_t *>(end) - message);
+    }
+
+    std::string firstSegment(const std::string &address) {
+        if (address.size() < 2 || address[0] != '/') {
+            return std::string();
+        }
+        const auto end = address.find('/', 1);
+        return address.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+    }
+
+    uint64_t timetagToMicros(uint64_t timetag) {
+        const uint64_t seconds = timetag >> 32;
+        const uint64_t fraction = timetag & 0xFFFFFFFFULL;
+        return seconds * 1000000ULL + ((fraction * 1000000ULL + (1ULL << 31)) >> 32);
+    }
+
+    uint64_t microsToTimetag(uint64_t micros) {
+        const uint64_t seconds = micros / 1000000ULL;
+        const uint64_t fraction = ((micros % 1000000ULL) << 32) / 1000000ULL;
+        return (seconds << 32) | fraction;
+    }
+}
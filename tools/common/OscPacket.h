@@ -0,0 +1,39 @@
+/// \file OscPacket.h
+/// \brief 受信したOSCパケットを最低限だけ解析する (アドレス・Bundleの展開・タイムタグ)
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TOOLS_OSCPACKET_H
+#define CCBT_KOROGARU_KOEN_PARK_TOOLS_OSCPACKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+
+namespace OscPacket {
+
+    /// タイムタグ 1 は「即時」(時刻なし) を表す
+    const uint64_t immediate = 1;
+
+    /// 1つのメッセージと，それを含むBundleのタイムタグ (Bundleでなければ immediate)
+    using MessageHandler = std::function<void(const uint8_t *message, size_t size, uint64_t timetag)>;
+
+    /// Bundleを再帰的に展開して各メッセージを handler に渡す
+    /// \return 形式が壊れていた場合 false
+    bool forEachMessage(const uint8_t *data, size_t size, const MessageHandler &handler);
+
+    /// メッセージのアドレス (空文字列なら不正)
+    std::string address(const uint8_t *message, size_t size);
+
+    /// アドレスの先頭の要素 ("/ccbt1/imu/acc" -> "ccbt1")
+    std::string firstSegment(const std::string &address);
+
+    /// ファームウェアの OSCManager が埋め込むタイムタグ (NTP形式) を [us] に戻す
+    uint64_t timetagToMicros(uint64_t timetag);
+
+    /// [us] を NTP形式のタイムタグにする
+    uint64_t microsToTimetag(uint64_t micros);
+}
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TOOLS_OSCPACKET_H
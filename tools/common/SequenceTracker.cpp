@@ -0,0 +1,53 @@
+/// \file SequenceTracker.cpp
+/// \brief シーケンス番号から欠落・順序の入れ替わり・重複・再起動を数える
+
+#include "SequenceTracker.h"
+
+SequenceTracker::Result SequenceTracker::track(uint32_t sequence) {
+    counters.received++;
+    if (!started) {
+        started = true;
+        highestSequence = sequence;
+        window = 1;
+        return Result::Latest;
+    }
+
+    const auto diff = static_cast<int32_t>(sequence - highestSequence);
+    if (diff > 0) {
+        counters.lost += diff - 1;
+        highestSequence = sequence;
+        window = static_cast<uint32_t>(diff) < windowSize ? (window << diff) | 1 : 1;
+        return Result::Latest;
+    }
+
+    const auto offset = static_cast<uint32_t>(-static_cast<int64_t>(diff));
+    if (offset > restartThreshold) {
+        counters.restarted++;
+        highestSequence = sequence;
+        window = 1;
+        return Result::Restart;
+    }
+    if (offset < windowSize && (window & (1ULL << offset))) {
+        counters.duplicated++;
+        return Result::Duplicate;
+    }
+
+    // 欠落として数えた分を戻す
+    if (offset < windowSize) {
+        window |= 1ULL << offset;
+    }
+    counters.reordered++;
+    if (counters.lost > 0) {
+        counters.lost--;
+    }
+    return Result::Late;
+}
+
+const SequenceTracker::Counters &SequenceTracker::getCounters() const {
+    return counters;
+}
+
+double SequenceTracker::getLossPercent() const {
+    const double expected = static_cast<double>(counters.received - counters.duplicated + counters.lost);
+    return expected > 0 ? 100.0 * counters.lost / expected : 0.0;
+}
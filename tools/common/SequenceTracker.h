@@ -0,0 +1,49 @@
+/// \file SequenceTracker.h
+/// \brief シーケンス番号から欠落・順序の入れ替わり・重複・再起動を数える
+///
+/// 最新の番号から windowSize 個前までの受信済みビットマップを持ち，
+/// 遅れて届いたフレームと重複したフレームを区別する．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TOOLS_SEQUENCETRACKER_H
+#define CCBT_KOROGARU_KOEN_PARK_TOOLS_SEQUENCETRACKER_H
+
+#include <cstdint>
+
+
+class SequenceTracker {
+public:
+    enum class Result {
+        Latest,     // これまでで最も新しいフレーム
+        Late,       // 欠落として数えた後に遅れて届いたフレーム
+        Duplicate,  // 受信済みのフレーム
+        Restart     // 番号が大きく戻った (ノードの再起動)
+    };
+
+    struct Counters {
+        uint64_t received;
+        uint64_t lost;
+        uint64_t reordered;
+        uint64_t duplicated;
+        uint64_t restarted;
+    };
+
+    Result track(uint32_t sequence);
+
+    const Counters &getCounters() const;
+
+    /// 欠落率 [%]
+    double getLossPercent() const;
+
+private:
+    // これ以上番号が戻った場合はノードが再起動したとみなす
+    static const uint32_t restartThreshold = 1000;
+    static const uint32_t windowSize = 64;
+
+    bool started = false;
+    uint32_t highestSequence = 0;
+    uint64_t window = 0;  // bit n: highestSequence - n を受信済み
+    Counters counters{};
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TOOLS_SEQUENCETRACKER_H
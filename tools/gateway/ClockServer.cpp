@@ -0,0 +1,60 @@
+/// \file ClockServer.cpp
+/// \brief ノードの時計合わせ (-D CLOCK_SYNC) の ping に pong を返す
+
+#include "ClockServer.h"
+#include <sys/socket.h>
+#include <chrono>
+
+namespace {
+    // 1900年 (NTP) から 1970年 (UNIX) までの秒数
+    const uint64_t ntpEpochOffsetSeconds = 2208988800ULL;
+
+    bool endsWith(const std::string &s, const std::string &suffix) {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+ClockServer::ClockServer(int fd) : fd(fd) {}
+
+bool ClockServer::handle(const std::string &clientName, const std::string &address,
+                         const uint8_t *message, size_t size,
+                         const sockaddr_in &source, uint64_t receivedUs) {
+    if (!endsWith(address, "/sync/ping")) {
+        return false;
+    }
+
+    auto found = templates.find(clientName);
+    if (found == templates.end()) {
+        Templates t;
+        t.ping.build(("/" + clientName + "/sync/ping").c_str(), "t");
+        t.pong.build(("/" + clientName + "/sync/pong").c_str(), "ttt");
+        found = templates.emplace(clientName, t).first;
+    }
+    auto &t = found->second;
+    if (!t.ping.parse(message, size)) {
+        return true;
+    }
+
+    t.pong.setTimetag(0, t.ping.getTimetag(0));
+    t.pong.setTimetag(1, receivedUs);
+    t.pong.setTimetag(2, now());
+    if (sendto(fd, t.pong.data(), t.pong.size(), 0,
+               reinterpret_cast<const sockaddr *>(&source), sizeof(source)) >= 0) {
+        answered++;
+    }
+    return true;
+}
+
+uint64_t ClockServer::getAnswered() const {
+    return answered;
+}
+
+uint64_t ClockServer::now() {
+    const auto sinceUnixEpoch = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    return fromUnixMicros(static_cast<uint64_t>(sinceUnixEpoch));
+}
+
+uint64_t ClockServer::fromUnixMicros(uint64_t unixUs) {
+    return unixUs + ntpEpochOffsetSeconds * 1000000ULL;
+}
@@ -0,0 +1,47 @@
+/// \file ClockServer.h
+/// \brief ノードの時計合わせ (-D CLOCK_SYNC) の ping に pong を返す
+///
+/// /{clientName}/sync/ping t(t1) を受け取ったら，送信元へ
+/// /{clientName}/sync/pong t(t1) t(t2) t(t3) を返す．
+/// t2 (受信時刻)・t3 (返信時刻) はホストの時計 (CLOCK_REALTIME) をNTP形式 (1900年起点) にしたもの．
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TOOLS_CLOCKSERVER_H
+#define CCBT_KOROGARU_KOEN_PARK_TOOLS_CLOCKSERVER_H
+
+#include <netinet/in.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include "OSCMessageTemplate.h"
+
+class ClockServer {
+public:
+    explicit ClockServer(int fd);
+
+    /// ping なら pong を返す
+    /// \param receivedUs パケットの受信時刻 (now() と同じ時計)
+    /// \return ping だった場合 true (受信側へは転送しない)
+    bool handle(const std::string &clientName, const std::string &address,
+                const uint8_t *message, size_t size,
+                const sockaddr_in &source, uint64_t receivedUs);
+
+    uint64_t getAnswered() const;
+
+    /// ホストの時計 [us] (NTP形式と同じ1900年起点)
+    static uint64_t now();
+
+    /// UNIX時刻 (1970年起点) [us] を now() と同じ1900年起点にする
+    static uint64_t fromUnixMicros(uint64_t unixUs);
+
+private:
+    struct Templates {
+        OSCMessageTemplate ping;
+        OSCMessageTemplate pong;
+    };
+
+    int fd;
+    std::map<std::string, Templates> templates;
+    uint64_t answered = 0;
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TOOLS_CLOCKSERVER_H
@@ -0,0 +1,154 @@
+/// \file NodeStream.cpp
+/// \brief ゲートウェイが受信するノード1台分のストリーム
+
+#include <algorithm>
+#include "NodeStream.h"
+
+namespace {
+    /// 一定レートで出し直す対象か (/imu/* と /mic/*)．/status/* などは届いた時だけ送る
+    bool isStreamAddress(const std::string &address) {
+        const auto second = address.find('/', 1);
+        if (second == std::string::npos) {
+            return false;
+        }
+        return address.compare(second, 5, "/imu/") == 0 || address.compare(second, 5, "/mic/") == 0;
+    }
+}
+
+NodeStream::NodeStream(const std::string &name) : name(name) {}
+
+const std::string &NodeStream::getName() const {
+    return name;
+}
+
+void NodeStream::receive(const WireFormat::Frame &frame, uint64_t arrivalUs) {
+    packets++;
+    sequenced = true;
+    const auto result = sequence.track(frame.sequence);
+    if (result == SequenceTracker::Result::Duplicate) {
+        return;
+    }
+
+    if (!translator) {
+        translator.reset(new FrameTranslator(name));
+    }
+    Entry entry;
+    translator->translate(frame, [&entry](const OSCMessageTemplate &message) {
+        Message m;
+        m.bytes.assign(message.data(), message.data() + message.size());
+        m.address = reinterpret_cast<const char *>(message.data());
+        entry.messages.push_back(std::move(m));
+    });
+    accept(std::move(entry), true, frame.timestampUs, arrivalUs);
+}
+
+void NodeStream::receive(std::vector<Message> received, bool timed, uint32_t timestampUs, uint64_t arrivalUs) {
+    packets++;
+    Entry entry;
+    entry.messages = std::move(received);
+    accept(std::move(entry), timed, timestampUs, arrivalUs);
+}
+
+void NodeStream::accept(Entry entry, bool timed, uint32_t timestampUs, uint64_t arrivalUs) {
+    messages += entry.messages.size();
+    if (!timed) {
+        immediate.push_back(std::move(entry));
+        return;
+    }
+
+    const int64_t sampleUs = unwrap(timestampUs);
+    const int64_t offsetUs = static_cast<int64_t>(arrivalUs) - sampleUs;
+    windowMinOffsetUs = std::min(windowMinOffsetUs, offsetUs);
+    const int64_t delayUs = offsetUs - baselineOffset();
+    delaySumUs += delayUs;
+    delayMaxUs = std::max(delayMaxUs, delayUs);
+    delayCount++;
+
+    // 既に後のサンプルを出力済みなら古い値なので捨てる
+    if (sampleUs <= lastReleasedUs) {
+        late++;
+        return;
+    }
+    jitterBuffer.emplace(sampleUs, std::move(entry));
+}
+
+void NodeStream::release(uint64_t nowUs, uint64_t jitterUs, bool rateNormalized, const Emit &emit) {
+    for (const auto &entry: immediate) {
+        deliver(entry, nowUs, rateNormalized, emit);
+    }
+    immediate.clear();
+
+    const int64_t baseline = baselineOffset();
+    while (!jitterBuffer.empty()) {
+        const auto first = jitterBuffer.begin();
+        if (jitterUs > 0 && first->first + baseline + static_cast<int64_t>(jitterUs) > static_cast<int64_t>(nowUs)) {
+            break;
+        }
+        lastReleasedUs = first->first;
+        deliver(first->second, nowUs, rateNormalized, emit);
+        jitterBuffer.erase(first);
+    }
+}
+
+void NodeStream::deliver(const Entry &entry, uint64_t nowUs, bool rateNormalized, const Emit &emit) {
+    for (const auto &message: entry.messages) {
+        if (rateNormalized && isStreamAddress(message.address)) {
+            auto &slot = latest[message.address];
+            slot.bytes = message.bytes;
+            slot.updatedUs = nowUs;
+        } else {
+            emit(message.bytes.data(), message.bytes.size());
+        }
+    }
+}
+
+void NodeStream::emitLatest(uint64_t nowUs, uint64_t holdUs, const Emit &emit) {
+    for (const auto &entry: latest) {
+        // 一定時間更新がなければノードが止まったとみなして出し直さない
+        if (nowUs - entry.second.updatedUs <= holdUs) {
+            emit(entry.second.bytes.data(), entry.second.bytes.size());
+        }
+    }
+}
+
+NodeStream::Stats NodeStream::takeStats() {
+    Stats stats{};
+    stats.packets = packets;
+    stats.messages = messages;
+    stats.late = late;
+    stats.delayMeanUs = delayCount > 0 ? delaySumUs / static_cast<int64_t>(delayCount) : 0;
+    stats.delayMaxUs = delayMaxUs;
+
+    packets = 0;
+    messages = 0;
+    late = 0;
+    delaySumUs = 0;
+    delayMaxUs = 0;
+    delayCount = 0;
+    // 時計のずれに追従するよう，基準は直前と現在の区間の最小値だけで決める
+    previousMinOffsetUs = windowMinOffsetUs;
+    windowMinOffsetUs = INT64_MAX;
+    return stats;
+}
+
+const SequenceTracker &NodeStream::getSequence() const {
+    return sequence;
+}
+
+bool NodeStream::hasSequence() const {
+    return sequenced;
+}
+
+int64_t NodeStream::unwrap(uint32_t timestampUs) {
+    if (!hasTimestamp) {
+        hasTimestamp = true;
+        lastTimestampUs = timestampUs;
+        return lastTimestampUs;
+    }
+    lastTimestampUs += static_cast<int32_t>(timestampUs - static_cast<uint32_t>(lastTimestampUs));
+    return lastTimestampUs;
+}
+
+int64_t NodeStream::baselineOffset() const {
+    return std::min(windowMinOffsetUs, previousMinOffsetUs);
+}
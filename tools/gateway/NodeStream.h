@@ -0,0 +1,114 @@
+/// \file NodeStream.h
+/// \brief ゲートウェイが受信するノード1台分のストリーム
+///
+/// サンプル時刻付きのフレーム (バイナリ形式・OSC Bundle) はジッタバッファに入れ，
+/// 到着の揺らぎを吸収してからサンプル時刻の順に取り出す．
+/// ノードの時計はホストと揃っていないため，(到着時刻 - サンプル時刻) の最小値を基準の遅延とみなし，
+/// それを超えた分を遅延の揺らぎとして数える．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TOOLS_NODESTREAM_H
+#define CCBT_KOROGARU_KOEN_PARK_TOOLS_NODESTREAM_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FrameTranslator.h"
+#include "SequenceTracker.h"
+#include "WireFormat.h"
+
+
+class NodeStream {
+public:
+    /// OSCメッセージ1つ分のバイト列
+    struct Message {
+        std::string address;
+        std::vector<uint8_t> bytes;
+    };
+
+    using Emit = std::function<void(const uint8_t *data, size_t size)>;
+
+    /// 統計の区間ごとの集計
+    struct Stats {
+        uint64_t packets;
+        uint64_t messages;
+        uint64_t late;          // ジッタバッファの遅延を超えて届き捨てたフレーム
+        int64_t delayMeanUs;    // 基準からの遅延の平均
+        int64_t delayMaxUs;     // 基準からの遅延の最大
+    };
+
+    explicit NodeStream(const std::string &name);
+
+    const std::string &getName() const;
+
+    /// バイナリ形式のフレームを受け取る
+    void receive(const WireFormat::Frame &frame, uint64_t arrivalUs);
+
+    /// OSCのメッセージ群を受け取る
+    /// \param timestampUs サンプル時刻 (timed が false なら無視する)
+    void receive(std::vector<Message> messages, bool timed, uint32_t timestampUs, uint64_t arrivalUs);
+
+    /// ジッタバッファから取り出し時刻を過ぎたフレームを出力する
+    /// \param jitterUs 基準の遅延に加えて待つ時間 (0 ならバッファしない)
+    /// \param rateNormalized true なら最新値として保持し emitLatest() で出力する，false なら emit に渡す
+    void release(uint64_t nowUs, uint64_t jitterUs, bool rateNormalized, const Emit &emit);
+
+    /// 保持している最新値のうち holdUs 以内に更新されたものを出力する
+    void emitLatest(uint64_t nowUs, uint64_t holdUs, const Emit &emit);
+
+    /// 前回からの集計を返してリセットする
+    Stats takeStats();
+
+    const SequenceTracker &getSequence() const;
+
+    bool hasSequence() const;
+
+private:
+    struct Entry {
+        std::vector<Message> messages;
+    };
+
+    struct Latest {
+        std::vector<uint8_t> bytes;
+        uint64_t updatedUs;
+    };
+
+    std::string name;
+    std::unique_ptr<FrameTranslator> translator;
+    SequenceTracker sequence;
+    bool sequenced = false;
+
+    // サンプル時刻 (32bit の折り返しを展開したもの)
+    bool hasTimestamp = false;
+    int64_t lastTimestampUs = 0;
+
+    // 到着時刻 - サンプル時刻 の最小値 (直前と現在の区間)
+    int64_t windowMinOffsetUs = INT64_MAX;
+    int64_t previousMinOffsetUs = INT64_MAX;
+    int64_t delaySumUs = 0;
+    int64_t delayMaxUs = 0;
+    uint64_t delayCount = 0;
+
+    std::multimap<int64_t, Entry> jitterBuffer;
+    int64_t lastReleasedUs = INT64_MIN;
+    std::vector<Entry> immediate;
+
+    std::map<std::string, Latest> latest;
+
+    uint64_t packets = 0;
+    uint64_t messages = 0;
+    uint64_t late = 0;
+
+    int64_t unwrap(uint32_t timestampUs);
+
+    int64_t baselineOffset() const;
+
+    void accept(Entry entry, bool timed, uint32_t timestampUs, uint64_t arrivalUs);
+
+    void deliver(const Entry &entry, uint64_t nowUs, bool rateNormalized, const Emit &emit);
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TOOLS_NODESTREAM_H
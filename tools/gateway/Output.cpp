@@ -0,0 +1,90 @@
+/// \file Output.cpp
+/// \brief ゲートウェイから任意の数の受信側へOSCを送る
+
+#include <sys/socket.h>
+#include <algorithm>
+#include <cstring>
+#include "Output.h"
+
+namespace {
+    const size_t batchSize = 64;
+    const uint8_t bundleHeader[] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0, 0, 0, 0, 0, 0, 0, 0, 1};  // 即時
+
+    void append32(std::vector<uint8_t> &bytes, uint32_t value) {
+        bytes.push_back(value >> 24);
+        bytes.push_back(value >> 16);
+        bytes.push_back(value >> 8);
+        bytes.push_back(value);
+    }
+}
+
+Output::Output(int fd, std::vector<sockaddr_in> consumers, bool bundle)
+        : fd(fd), consumers(std::move(consumers)), bundle(bundle) {}
+
+void Output::add(const uint8_t *data, size_t size) {
+    if (!bundle || sizeof(bundleHeader) + 4 + size > maxPacketSize) {
+        packets.emplace_back(data, data + size);
+        return;
+    }
+    if (current.size() + 4 + size > maxPacketSize) {
+        closeBundle();
+    }
+    if (current.empty()) {
+        current.assign(bundleHeader, bundleHeader + sizeof(bundleHeader));
+    }
+    append32(current, static_cast<uint32_t>(size));
+    current.insert(current.end(), data, data + size);
+}
+
+void Output::closeBundle() {
+    if (!current.empty()) {
+        packets.push_back(std::move(current));
+        current.clear();
+    }
+}
+
+void Output::flush() {
+    closeBundle();
+    if (packets.empty()) {
+        return;
+    }
+
+    std::vector<mmsghdr> headers(batchSize);
+    std::vector<iovec> vectors(batchSize);
+    for (auto &consumer: consumers) {
+        for (size_t begin = 0; begin < packets.size(); begin += batchSize) {
+            const size_t count = std::min(batchSize, packets.size() - begin);
+            for (size_t i = 0; i < count; i++) {
+                auto &packet = packets[begin + i];
+                vectors[i].iov_base = packet.data();
+                vectors[i].iov_len = packet.size();
+                memset(&headers[i], 0, sizeof(mmsghdr));
+                headers[i].msg_hdr.msg_name = &consumer;
+                headers[i].msg_hdr.msg_namelen = sizeof(consumer);
+                headers[i].msg_hdr.msg_iov = &vectors[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            size_t done = 0;
+            while (done < count) {
+                const int sent = sendmmsg(fd, &headers[done], count - done, 0);
+                if (sent <= 0) {
+                    // 送れなかった残りは捨てる (受信側が止まっていても取り込みを止めない)
+                    sendErrors += count - done;
+                    break;
+                }
+                done += sent;
+                sentPackets += sent;
+            }
+        }
+    }
+    packets.clear();
+}
+
+uint64_t Output::getSentPackets() const {
+    return sentPackets;
+}
+
+uint64_t Output::getSendErrors() const {
+    return sendErrors;
+}
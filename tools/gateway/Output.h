@@ -0,0 +1,46 @@
+/// \file Output.h
+/// \brief ゲートウェイから任意の数の受信側へOSCを送る
+///
+/// 1回のループで溜まったパケットを sendmmsg でまとめて送る．
+/// bundle を有効にすると，メッセージを最大 maxPacketSize バイトのOSC Bundleに詰めて送る．
+
+
+#ifndef CCBT_KOROGARU_KOEN_PARK_TOOLS_OUTPUT_H
+#define CCBT_KOROGARU_KOEN_PARK_TOOLS_OUTPUT_H
+
+#include <netinet/in.h>
+#include <cstdint>
+#include <vector>
+
+
+class Output {
+public:
+    static const size_t maxPacketSize = 1400;
+
+    Output(int fd, std::vector<sockaddr_in> consumers, bool bundle);
+
+    /// OSCメッセージ (またはパケット) を1つ追加する
+    void add(const uint8_t *data, size_t size);
+
+    /// 溜まったパケットをすべての受信側に送る
+    void flush();
+
+    uint64_t getSentPackets() const;
+
+    uint64_t getSendErrors() const;
+
+private:
+    int fd;
+    std::vector<sockaddr_in> consumers;
+    bool bundle;
+
+    std::vector<std::vector<uint8_t>> packets;
+    std::vector<uint8_t> current;  // 組み立て中のBundle
+
+    uint64_t sentPackets = 0;
+    uint64_t sendErrors = 0;
+
+    void closeBundle();
+};
+
+#endif //CCBT_KOROGARU_KOEN_PARK_TOOLS_OUTPUT_H
@@ -0,0 +1,354 @@
+/// \file main.cpp
+/// \brief 全ノードのストリームを1つのソケットで受け，まとめて任意の数の受信側へ送り直すゲートウェイ
+///
+/// $ gateway [--listen 9100] [--out 127.0.0.1:9000 ...] [--rate 60] [--jitter 0] [--hold 2000]
+///           [--bundle] [--prefix ccbt] [--stats 5] [--quiet]
+///
+/// - OSC (Message / Bundle) とバイナリ形式 (WireFormat) のどちらも受け付け，clientName ごとに集計する
+/// - recvmmsg でまとめて受信する
+/// - --jitter [ms]: サンプル時刻付きのフレームをその分だけ待たせ，到着の揺らぎを吸収してから順に出す
+/// - --rate [Hz]: /imu/*・/mic/* を各ノードの最新値としてこのレートで出し直す (0 なら届いた順にそのまま)
+///   --hold [ms] 以上更新のないノードは出し直さない
+/// - /status/* などは届いた時にそのまま送る
+/// - --out を複数指定すると同じものをすべてに送る
+/// - --stats [s] ごとにノード別のレート・欠落・遅延を標準エラー出力に表示する
+/// - ノードの時計合わせ (-D CLOCK_SYNC) の ping には pong を返す (受信側へは転送しない)
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ClockServer.h"
+#include "Endpoint.h"
+#include "NodeStream.h"
+#include "OscPacket.h"
+#include "Output.h"
+#include "WireFormat.h"
+
+namespace {
+    struct Options {
+        uint16_t listenPort = 9100;
+        std::vector<sockaddr_in> outs;
+        double rateHz = 60.0;
+        uint64_t jitterUs = 0;
+        uint64_t holdUs = 2000000;
+        bool bundle = false;
+        std::string prefix = "ccbt";
+        int statsSeconds = 5;
+        bool quiet = false;
+    };
+
+    const size_t batchSize = 64;
+    const size_t maxDatagramSize = 1500;
+    const size_t controlSize = 64;  // SO_TIMESTAMPNS の受信時刻
+    const int receiveBufferSize = 4 * 1024 * 1024;
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [--listen port] [--out host:port ...] [--rate hz] [--jitter ms] [--hold ms]\n"
+                        "       [--bundle] [--prefix name] [--stats seconds] [--quiet]\n", name);
+        exit(2);
+    }
+
+    Options parseOptions(int argc, char **argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (arg == "--bundle") {
+                options.bundle = true;
+                continue;
+            }
+            if (arg == "--quiet") {
+                options.quiet = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+            }
+            const std::string value = argv[++i];
+            if (arg == "--listen") {
+                options.listenPort = static_cast<uint16_t>(strtoul(value.c_str(), nullptr, 10));
+            } else if (arg == "--out") {
+                sockaddr_in out{};
+                if (!parseEndpoint(value, out)) {
+                    usage(argv[0]);
+                }
+                options.outs.push_back(out);
+            } else if (arg == "--rate") {
+                options.rateHz = strtod(value.c_str(), nullptr);
+            } else if (arg == "--jitter") {
+                options.jitterUs = static_cast<uint64_t>(strtod(value.c_str(), nullptr) * 1000.0);
+            } else if (arg == "--hold") {
+                options.holdUs = static_cast<uint64_t>(strtod(value.c_str(), nullptr) * 1000.0);
+            } else if (arg == "--prefix") {
+                options.prefix = value;
+            } else if (arg == "--stats") {
+                options.statsSeconds = atoi(value.c_str());
+            } else {
+                usage(argv[0]);
+            }
+        }
+        if (options.outs.empty()) {
+            sockaddr_in out{};
+            parseEndpoint("127.0.0.1:9000", out);
+            options.outs.push_back(out);
+        }
+        return options;
+    }
+
+    uint64_t nowMicros() {
+        static const auto start = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+
+    double cpuSeconds() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    }
+
+    /// SO_TIMESTAMPNS の受信時刻を ClockServer::now() と同じ時計にして返す
+    uint64_t kernelTimestamp(msghdr &header, uint64_t fallbackUs) {
+        for (cmsghdr *c = CMSG_FIRSTHDR(&header); c != nullptr; c = CMSG_NXTHDR(&header, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                timespec ts{};
+                memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+                return ClockServer::fromUnixMicros(static_cast<uint64_t>(ts.tv_sec) * 1000000ULL +
+                                                   static_cast<uint64_t>(ts.tv_nsec) / 1000);
+            }
+        }
+        return fallbackUs;
+    }
+
+    class Gateway {
+    public:
+        Gateway(const Options &options, ClockServer &clockServer) : options(options), clockServer(clockServer) {}
+
+        /// 受信したパケット1つを振り分ける
+        /// \param receivedUs カーネルの受信時刻 (ClockServer::now() と同じ時計)
+        void receive(const uint8_t *data, size_t size, uint64_t arrivalUs,
+                     const sockaddr_in &source, uint64_t receivedUs) {
+            receivedPackets++;
+            if (WireFormat::isWireFormat(data, size)) {
+                WireFormat::Frame frame{};
+                if (!WireFormat::decode(data, size, frame)) {
+                    malformed++;
+                    return;
+                }
+                node(options.prefix + std::to_string(frame.nodeId)).receive(frame, arrivalUs);
+                return;
+            }
+
+            // 1パケット内のメッセージをノードごとにまとめる (通常は1ノード分)
+            // 入れ子のBundle (IMUとMICで時刻が異なる) は最初のメッセージの時刻で扱う
+            std::map<std::string, std::vector<NodeStream::Message>> byNode;
+            uint64_t timetag = OscPacket::immediate;
+            bool hasTimetag = false;
+            const bool valid = OscPacket::forEachMessage(
+                    data, size, [&](const uint8_t *message, size_t messageSize, uint64_t tag) {
+                        NodeStream::Message m;
+                        m.address = OscPacket::address(message, messageSize);
+                        const std::string name = OscPacket::firstSegment(m.address);
+                        if (name.empty() ||
+                            clockServer.handle(name, m.address, message, messageSize, source, receivedUs)) {
+                            return;
+                        }
+                        m.bytes.assign(message, message + messageSize);
+                        byNode[name].push_back(std::move(m));
+                        if (!hasTimetag) {
+                            timetag = tag;
+                            hasTimetag = true;
+                        }
+                    });
+            if (!valid) {
+                malformed++;
+                return;
+            }
+
+            const bool timed = timetag != OscPacket::immediate;
+            const auto timestampUs = static_cast<uint32_t>(OscPacket::timetagToMicros(timetag));
+            for (auto &entry: byNode) {
+                node(entry.first).receive(std::move(entry.second), timed, timestampUs, arrivalUs);
+            }
+        }
+
+        /// ジッタバッファから取り出し，必要なら一定レートで出し直す
+        void service(uint64_t nowUs, bool tick, Output &output) {
+            const NodeStream::Emit emit = [&output](const uint8_t *data, size_t size) {
+                output.add(data, size);
+            };
+            const bool rateNormalized = options.rateHz > 0;
+            for (auto &entry: nodes) {
+                entry.second->release(nowUs, options.jitterUs, rateNormalized, emit);
+                if (rateNormalized && tick) {
+                    entry.second->emitLatest(nowUs, options.holdUs, emit);
+                }
+            }
+        }
+
+        void printStats(double elapsedSeconds, double cpuPercent, const Output &output) {
+            uint64_t totalPackets = 0;
+            uint64_t totalLost = 0;
+            uint64_t totalExpected = 0;
+            for (auto &entry: nodes) {
+                auto &stream = *entry.second;
+                const auto stats = stream.takeStats();
+                totalPackets += stats.packets;
+
+                char loss[32] = "-";
+                if (stream.hasSequence()) {
+                    const auto &counters = stream.getSequence().getCounters();
+                    totalLost += counters.lost;
+                    totalExpected += counters.received - counters.duplicated + counters.lost;
+                    snprintf(loss, sizeof(loss), "%.2f%%", stream.getSequence().getLossPercent());
+                }
+                if (!options.quiet) {
+                    fprintf(stderr, "  %-12s %7.1f pkt/s %7.1f msg/s loss=%-7s late=%-4llu delay(mean/max)=%.1f/%.1f ms\n",
+                            stream.getName().c_str(),
+                            stats.packets / elapsedSeconds,
+                            stats.messages / elapsedSeconds,
+                            loss,
+                            static_cast<unsigned long long>(stats.late),
+                            stats.delayMeanUs / 1000.0,
+                            stats.delayMaxUs / 1000.0);
+                }
+            }
+            fprintf(stderr, "nodes=%zu in=%.0f pkt/s loss=%.3f%% out=%llu pkt (errors=%llu) malformed=%llu sync=%llu cpu=%.1f%%\n",
+                    nodes.size(),
+                    totalPackets / elapsedSeconds,
+                    totalExpected > 0 ? 100.0 * totalLost / totalExpected : 0.0,
+                    static_cast<unsigned long long>(output.getSentPackets()),
+                    static_cast<unsigned long long>(output.getSendErrors()),
+                    static_cast<unsigned long long>(malformed),
+                    static_cast<unsigned long long>(clockServer.getAnswered()),
+                    cpuPercent);
+        }
+
+    private:
+        const Options &options;
+        ClockServer &clockServer;
+        std::map<std::string, std::unique_ptr<NodeStream>> nodes;
+        uint64_t receivedPackets = 0;
+        uint64_t malformed = 0;
+
+        NodeStream &node(const std::string &name) {
+            auto &stream = nodes[name];
+            if (!stream) {
+                stream.reset(new NodeStream(name));
+            }
+            return *stream;
+        }
+    };
+}
+
+int main(int argc, char **argv) {
+    const Options options = parseOptions(argc, argv);
+
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in listenAddress{};
+    listenAddress.sin_family = AF_INET;
+    listenAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    listenAddress.sin_port = htons(options.listenPort);
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&listenAddress), sizeof(listenAddress)) != 0) {
+        perror("bind");
+        return 1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+    // ping の受信時刻 (t2) をカーネルで記録する (recvmmsg でまとめて読む時の待ち時間を含めない)
+    const int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+
+    fprintf(stderr, "listening on :%u, forwarding to", options.listenPort);
+    for (const auto &out: options.outs) {
+        fprintf(stderr, " %s", formatEndpoint(out).c_str());
+    }
+    fprintf(stderr, " (rate=%.1f Hz, jitter=%.1f ms)\n", options.rateHz, options.jitterUs / 1000.0);
+
+    ClockServer clockServer(fd);
+    Gateway gateway(options, clockServer);
+    Output output(fd, options.outs, options.bundle);
+
+    // recvmmsg 用の受信バッファ
+    std::vector<std::vector<uint8_t>> buffers(batchSize, std::vector<uint8_t>(maxDatagramSize));
+    std::vector<iovec> vectors(batchSize);
+    std::vector<mmsghdr> headers(batchSize);
+    std::vector<sockaddr_in> sources(batchSize);
+    std::vector<std::vector<uint8_t>> controls(batchSize, std::vector<uint8_t>(controlSize));
+
+    const uint64_t tickUs = options.rateHz > 0 ? static_cast<uint64_t>(1000000.0 / options.rateHz) : 0;
+    const uint64_t statsUs = static_cast<uint64_t>(options.statsSeconds) * 1000000ULL;
+    uint64_t nextTickUs = nowMicros() + tickUs;
+    uint64_t lastStatsUs = nowMicros();
+    double lastCpu = cpuSeconds();
+
+    while (true) {
+        // 次の出力時刻までに受信がなければ抜ける (ジッタバッファの取り出しは 1 ms 単位)
+        uint64_t nowUs = nowMicros();
+        int timeoutMs = 1;
+        if (tickUs > 0 && options.jitterUs == 0) {
+            timeoutMs = nextTickUs > nowUs ? static_cast<int>((nextTickUs - nowUs + 999) / 1000) : 0;
+        }
+        pollfd pfd{fd, POLLIN, 0};
+        const int ready = poll(&pfd, 1, timeoutMs);
+
+        if (ready > 0) {
+            // 溜まっている分を batchSize 個ずつまとめて取り出す
+            while (true) {
+                for (size_t i = 0; i < batchSize; i++) {
+                    vectors[i].iov_base = buffers[i].data();
+                    vectors[i].iov_len = buffers[i].size();
+                    memset(&headers[i], 0, sizeof(mmsghdr));
+                    headers[i].msg_hdr.msg_iov = &vectors[i];
+                    headers[i].msg_hdr.msg_iovlen = 1;
+                    headers[i].msg_hdr.msg_name = &sources[i];
+                    headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                    headers[i].msg_hdr.msg_control = controls[i].data();
+                    headers[i].msg_hdr.msg_controllen = controls[i].size();
+                }
+                const int count = recvmmsg(fd, headers.data(), batchSize, MSG_DONTWAIT, nullptr);
+                if (count <= 0) {
+                    break;
+                }
+                const uint64_t arrivalUs = nowMicros();
+                const uint64_t fallbackReceivedUs = ClockServer::now();
+                for (int i = 0; i < count; i++) {
+                    gateway.receive(buffers[i].data(), headers[i].msg_len, arrivalUs, sources[i],
+                                    kernelTimestamp(headers[i].msg_hdr, fallbackReceivedUs));
+                }
+                if (static_cast<size_t>(count) < batchSize) {
+                    break;
+                }
+            }
+        }
+
+        nowUs = nowMicros();
+        const bool tick = tickUs > 0 && nowUs >= nextTickUs;
+        if (tick) {
+            nextTickUs += tickUs;
+            // 大きく遅れた場合は追いつこうとせず次の周期から再開する
+            if (nextTickUs < nowUs) {
+                nextTickUs = nowUs + tickUs;
+            }
+        }
+        gateway.service(nowUs, tick, output);
+        output.flush();
+
+        if (statsUs > 0 && nowUs - lastStatsUs >= statsUs) {
+            const double elapsed = (nowUs - lastStatsUs) / 1e6;
+            const double cpu = cpuSeconds();
+            gateway.printStats(elapsed, 100.0 * (cpu - lastCpu) / elapsed, output);
+            lastStatsUs = nowUs;
+            lastCpu = cpu;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/// \file main.cpp
+/// \brief 記録したIMUのサンプル列をファームウェアと同じ MotionDetector に流し，検出したイベントを表示するツール
+///
+/// $ motion_replay [--impact g] [--roll dps] [--shake g] [trace.csv]
+///
+/// - 入力は1行1サンプルの "timestamp_us,ax,ay,az,gx,gy,gz" (加速度 [G]・角速度 [deg/s]，校正済みの値)
+///   ファイルを指定しなければ標準入力から読む．数値で始まらない行 (見出しなど) は読み飛ばす
+/// - 出力は1行1イベントの "timestamp_us,type,active,value" (MotionDetector::Event と同じ意味)
+/// - 最後にイベントの種類ごとの数を標準エラーに表示する
+/// - しきい値を変えた時の検出の違いを，同じ記録で確かめられる
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "MotionDetector.h"
+
+namespace {
+    struct Options {
+        MotionDetector::Parameters parameters = MotionDetector::defaultParameters();
+        const char *path = nullptr;
+    };
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [--impact g] [--roll dps] [--shake g] [trace.csv]\n", name);
+        exit(2);
+    }
+
+    Options parseOptions(int argc, char **argv) {
+        Options options;
+        auto &p = options.parameters;
+        int i = 1;
+        for (; i + 1 < argc && strncmp(argv[i], "--", 2) == 0; i += 2) {
+            const std::string arg = argv[i];
+            const float value = strtof(argv[i + 1], nullptr);
+            if (!(value > 0.0f)) {
+                usage(argv[0]);
+            }
+            // 終了 (戻り) 側のしきい値は初期値と同じ比で動かす
+            if (arg == "--impact") {
+                p.impactRelease *= value / p.impactThreshold;
+                p.impactThreshold = value;
+            } else if (arg == "--roll") {
+                p.rollStopDps *= value / p.rollStartDps;
+                p.rollStartDps = value;
+            } else if (arg == "--shake") {
+                p.shakeLow *= value / p.shakeHigh;
+                p.shakeHigh = value;
+            } else {
+                usage(argv[0]);
+            }
+        }
+        if (i < argc) {
+            if (strncmp(argv[i], "--", 2) == 0 || i + 1 < argc) {
+                usage(argv[0]);
+            }
+            options.path = argv[i];
+        }
+        return options;
+    }
+}
+
+int main(int argc, char **argv) {
+    const Options options = parseOptions(argc, argv);
+
+    FILE *input = stdin;
+    if (options.path != nullptr) {
+        input = fopen(options.path, "r");
+        if (input == nullptr) {
+            perror(options.path);
+            return 1;
+        }
+    }
+
+    MotionDetector detector;
+    detector.setup(options.parameters);
+
+    std::array<uint32_t, MotionDetector::numEventTypes> counts{};
+    std::array<MotionDetector::Event, MotionDetector::maxEventsPerSample> events{};
+    uint64_t samples = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), input) != nullptr) {
+        unsigned long timestampUs = 0;
+        std::array<float, 3> acc{};
+        std::array<float, 3> gyro{};
+        if (sscanf(line, "%lu,%f,%f,%f,%f,%f,%f", &timestampUs, &acc[0], &acc[1], &acc[2],
+                   &gyro[0], &gyro[1], &gyro[2]) != 7) {
+            continue;
+        }
+        samples++;
+
+        const size_t count = detector.update(acc, gyro, static_cast<uint32_t>(timestampUs), events.data());
+        for (size_t i = 0; i < count; i++) {
+            const auto &event = events[i];
+            counts[static_cast<size_t>(event.type)]++;
+            printf("%u,%s,%d,%.3f\n", event.timestampUs, MotionDetector::getName(event.type),
+                   event.active ? 1 : 0, event.value);
+        }
+    }
+    if (input != stdin) {
+        fclose(input);
+    }
+
+    fprintf(stderr, "%llu samples:", static_cast<unsigned long long>(samples));
+    for (size_t i = 0; i < counts.size(); i++) {
+        fprintf(stderr, " %s=%u", MotionDetector::getName(static_cast<MotionDetector::EventType>(i)), counts[i]);
+    }
+    fprintf(stderr, "\n");
+    return 0;
+}
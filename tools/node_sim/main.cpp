@@ -0,0 +1,275 @@
+/// \file main.cpp
+/// \brief 多数のノードの送信を1プロセスで模擬する負荷試験用ツール
+///
+/// $ node_sim [--nodes 100] [--target 127.0.0.1:9100] [--rate 60] [--format binary|osc|bundle]
+///            [--duration 10] [--loss 0] [--prefix ccbt] [--start-id 1]
+///
+/// - 各ノードは送信周期の中で位相をずらし，時計 (timestampUs) もノードごとにずらす
+/// - MICは2フレームに1回 (30 Hz) 含める
+/// - --loss [%] の割合でフレームを送らずに捨てる (ゲートウェイの欠落の集計を確かめる)
+/// - 同じ時刻に送るパケットは sendmmsg でまとめて送る
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Endpoint.h"
+#include "FrameTranslator.h"
+#include "OscPacket.h"
+#include "WireFormat.h"
+
+namespace {
+    enum class Format {
+        Binary,
+        Message,
+        Bundle
+    };
+
+    struct Options {
+        int nodes = 100;
+        sockaddr_in target{};
+        double rateHz = 60.0;
+        Format format = Format::Binary;
+        double durationSeconds = 10.0;
+        double lossPercent = 0.0;
+        std::string prefix = "ccbt";
+        int startId = 1;
+    };
+
+    const size_t batchSize = 64;
+
+    void usage(const char *name) {
+        fprintf(stderr, "usage: %s [--nodes n] [--target host:port] [--rate hz] [--format binary|osc|bundle]\n"
+                        "       [--duration seconds] [--loss percent] [--prefix name] [--start-id n]\n", name);
+        exit(2);
+    }
+
+    Options parseOptions(int argc, char **argv) {
+        Options options;
+        parseEndpoint("127.0.0.1:9100", options.target);
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string arg = argv[i];
+            const std::string value = argv[i + 1];
+            if (arg == "--nodes") {
+                options.nodes = atoi(value.c_str());
+            } else if (arg == "--target") {
+                if (!parseEndpoint(value, options.target)) {
+                    usage(argv[0]);
+                }
+            } else if (arg == "--rate") {
+                options.rateHz = strtod(value.c_str(), nullptr);
+            } else if (arg == "--format") {
+                if (value == "binary") {
+                    options.format = Format::Binary;
+                } else if (value == "osc") {
+                    options.format = Format::Message;
+                } else if (value == "bundle") {
+                    options.format = Format::Bundle;
+                } else {
+                    usage(argv[0]);
+                }
+            } else if (arg == "--duration") {
+                options.durationSeconds = strtod(value.c_str(), nullptr);
+            } else if (arg == "--loss") {
+                options.lossPercent = strtod(value.c_str(), nullptr);
+            } else if (arg == "--prefix") {
+                options.prefix = value;
+            } else if (arg == "--start-id") {
+                options.startId = atoi(value.c_str());
+            } else {
+                usage(argv[0]);
+            }
+        }
+        if (argc % 2 == 0 || options.nodes <= 0 || options.rateHz <= 0 ||
+            options.startId < 0 || options.startId + options.nodes - 1 > 255) {
+            // ノード番号はバイナリ形式で 1 バイト
+            usage(argv[0]);
+        }
+        return options;
+    }
+
+    /// 1台分の状態
+    struct Node {
+        WireFormat::Frame frame;
+        uint32_t clockOffsetUs;  // ノードの micros() とホストの時計の差
+        uint64_t phaseUs;        // 送信周期内の位相
+        double motionPhase;
+        std::unique_ptr<FrameTranslator> translator;
+    };
+
+    void appendInt32(std::vector<uint8_t> &out, uint32_t value) {
+        out.push_back(value >> 24);
+        out.push_back(value >> 16);
+        out.push_back(value >> 8);
+        out.push_back(value);
+    }
+
+    /// 合成モーション (ゆっくり揺れる傾き) とマイクの値でフレームを更新する
+    void updateFrame(Node &node, uint64_t hostUs, uint64_t frameIndex) {
+        const double t = hostUs / 1e6;
+        const double roll = 30.0 * sin(0.5 * t + node.motionPhase);
+        const double pitch = 20.0 * sin(0.3 * t + node.motionPhase * 2.0);
+        const double rad = M_PI / 180.0;
+
+        auto &frame = node.frame;
+        frame.timestampUs = static_cast<uint32_t>(hostUs) + node.clockOffsetUs;
+        frame.acc = {{static_cast<float>(-sin(pitch * rad)),
+                      static_cast<float>(sin(roll * rad) * cos(pitch * rad)),
+                      static_cast<float>(cos(roll * rad) * cos(pitch * rad))}};
+        frame.gyro = {{static_cast<float>(15.0 * cos(0.5 * t + node.motionPhase)),
+                       static_cast<float>(6.0 * cos(0.3 * t + node.motionPhase * 2.0)),
+                       0.0f}};
+        frame.rotation = {{static_cast<float>(roll), static_cast<float>(pitch)}};
+        frame.flags = frameIndex % 2 == 0 ? WireFormat::flagMic : 0;
+        frame.micPower = 800.0f;
+        frame.micDb = 58.0f;
+    }
+
+    /// 指定した形式で1フレーム分のパケットを作る
+    void encodeFrame(Node &node, Format format, std::vector<std::vector<uint8_t>> &packets) {
+        if (format == Format::Binary) {
+            std::vector<uint8_t> packet(WireFormat::packetSize);
+            WireFormat::encode(node.frame, packet.data());
+            packets.push_back(std::move(packet));
+            return;
+        }
+        if (format == Format::Message) {
+            node.translator->translate(node.frame, [&packets](const OSCMessageTemplate &message) {
+                packets.emplace_back(message.data(), message.data() + message.size());
+            });
+            return;
+        }
+
+        // ファームウェアの OSCManager と同じく，タイムタグにサンプル時刻を入れたBundle
+        std::vector<uint8_t> bundle = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0};
+        const uint64_t timetag = OscPacket::microsToTimetag(node.frame.timestampUs);
+        appendInt32(bundle, static_cast<uint32_t>(timetag >> 32));
+        appendInt32(bundle, static_cast<uint32_t>(timetag));
+        node.translator->translate(node.frame, [&bundle](const OSCMessageTemplate &message) {
+            appendInt32(bundle, static_cast<uint32_t>(message.size()));
+            bundle.insert(bundle.end(), message.data(), message.data() + message.size());
+        });
+        packets.push_back(std::move(bundle));
+    }
+
+    /// 溜まったパケットを sendmmsg でまとめて送る
+    uint64_t sendAll(int fd, const sockaddr_in &target, std::vector<std::vector<uint8_t>> &packets,
+                     uint64_t &errors) {
+        std::vector<iovec> vectors(batchSize);
+        std::vector<mmsghdr> headers(batchSize);
+        uint64_t sent = 0;
+        for (size_t offset = 0; offset < packets.size(); offset += batchSize) {
+            const size_t count = std::min(batchSize, packets.size() - offset);
+            for (size_t i = 0; i < count; i++) {
+                vectors[i].iov_base = packets[offset + i].data();
+                vectors[i].iov_len = packets[offset + i].size();
+                memset(&headers[i], 0, sizeof(mmsghdr));
+                headers[i].msg_hdr.msg_name = const_cast<sockaddr_in *>(&target);
+                headers[i].msg_hdr.msg_namelen = sizeof(target);
+                headers[i].msg_hdr.msg_iov = &vectors[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+            const int result = sendmmsg(fd, headers.data(), count, 0);
+            if (result < 0) {
+                errors += count;
+                continue;
+            }
+            sent += result;
+            errors += count - result;
+        }
+        packets.clear();
+        return sent;
+    }
+}
+
+int main(int argc, char **argv) {
+    const Options options = parseOptions(argc, argv);
+
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+
+    const auto periodUs = static_cast<uint64_t>(1000000.0 / options.rateHz);
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    std::vector<Node> nodes(options.nodes);
+    for (int i = 0; i < options.nodes; i++) {
+        auto &node = nodes[i];
+        const int id = options.startId + i;
+        node.frame = WireFormat::Frame{};
+        node.frame.nodeId = static_cast<uint8_t>(id);
+        node.clockOffsetUs = static_cast<uint32_t>(random());
+        node.phaseUs = periodUs * i / options.nodes;
+        node.motionPhase = unit(random) * 2.0 * M_PI;
+        node.translator.reset(new FrameTranslator(options.prefix + std::to_string(id)));
+    }
+
+    fprintf(stderr, "%d nodes (%s%d - %s%d) -> %s at %.1f Hz for %.0f s\n",
+            options.nodes,
+            options.prefix.c_str(), options.startId,
+            options.prefix.c_str(), options.startId + options.nodes - 1,
+            formatEndpoint(options.target).c_str(), options.rateHz, options.durationSeconds);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsedMicros = [&start]() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+    };
+    const auto durationUs = static_cast<uint64_t>(options.durationSeconds * 1e6);
+
+    // 送信周期を位相ごとの小さな刻み (1 ms) に分け，刻みごとに送る時刻が来たノードをまとめて送る
+    const uint64_t stepUs = 1000;
+    std::vector<uint64_t> frameIndex(nodes.size(), 0);
+    std::vector<std::vector<uint8_t>> packets;
+    uint64_t frames = 0;
+    uint64_t dropped = 0;
+    uint64_t sent = 0;
+    uint64_t errors = 0;
+
+    for (uint64_t stepStart = 0; stepStart < durationUs; stepStart += stepUs) {
+        const uint64_t nowUs = elapsedMicros();
+        if (nowUs < stepStart) {
+            std::this_thread::sleep_for(std::chrono::microseconds(stepStart - nowUs));
+        }
+        const uint64_t stepEnd = stepStart + stepUs;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            auto &node = nodes[i];
+            // このノードの次の送信時刻
+            while (frameIndex[i] * periodUs + node.phaseUs < stepEnd) {
+                const uint64_t sampleUs = frameIndex[i] * periodUs + node.phaseUs;
+                updateFrame(node, sampleUs, frameIndex[i]);
+                node.frame.sequence++;
+                frameIndex[i]++;
+                frames++;
+                if (unit(random) * 100.0 < options.lossPercent) {
+                    dropped++;
+                    continue;
+                }
+                encodeFrame(node, options.format, packets);
+            }
+        }
+        sent += sendAll(fd, options.target, packets, errors);
+    }
+
+    const double elapsed = elapsedMicros() / 1e6;
+    fprintf(stderr, "frames=%llu (%.0f/s) dropped=%llu packets=%llu (%.0f/s) errors=%llu\n",
+            static_cast<unsigned long long>(frames), frames / elapsed,
+            static_cast<unsigned long long>(dropped),
+            static_cast<unsigned long long>(sent), sent / elapsed,
+            static_cast<unsigned long long>(errors));
+    close(fd);
+    return 0;
+}